@@ -43,6 +43,12 @@ If you have questions concerning this license or the applicable additional terms
 #define CM_FILEID			"CM"
 #define CM_FILEVERSION		"1.00"
 
+#define CM_BINARY_FILE_EXT	"cmb"
+#define CM_BINARY_FILEID	( ( 'C' << 24 ) | ( 'M' << 16 ) | ( 'B' << 8 ) | ' ' )
+#define CM_BINARY_VERSION	1
+
+static idCVar cm_binaryFiles( "cm_binaryFiles", "1", CVAR_GAME | CVAR_BOOL, "load collision models from .cmb files and write them next to the .cm files" );
+
 /*
 ===============================================================================
 
@@ -257,6 +263,8 @@ void idCollisionModelManagerLocal::WriteCollisionModelsToFile( const char *filen
 	}
 
 	fileSystem->CloseFile( fp );
+
+	WriteBinaryCollisionModelsToFile( filename, firstModel, lastModel, mapFileCRC );
 }
 
 /*
@@ -556,6 +564,11 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	idToken token;
 	idLexer *src;
 	unsigned int crc;
+	int firstModel;
+
+	if ( LoadBinaryCollisionModelFile( name, mapFileCRC ) ) {
+		return true;
+	}
 
 	// load it
 	fileName = name;
@@ -593,6 +606,7 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 	}
 
 	// parse the file
+	firstModel = numModels;
 	while ( 1 ) {
 		if ( !src->ReadToken( &token ) ) {
 			break;
@@ -611,5 +625,553 @@ bool idCollisionModelManagerLocal::LoadCollisionModelFile( const char *name, uns
 
 	delete src;
 
+	// the next load of this file can skip the parsing
+	WriteBinaryCollisionModelsToFile( name, firstModel, numModels, crc );
+
+	return true;
+}
+
+
+/*
+===============================================================================
+
+Binary collision model file
+
+The .cmb file holds the same models as the .cm file next to it, but with the
+vertex, edge, polygon and brush memory written as it is laid out in memory and
+the tree with the polygon and brush references already filtered into it.
+Loading is a single file read, a copy of each array and a fixup pass for the
+material pointers and the node links.  The file is in native byte order and
+is only used while the .cm file it was written with is unchanged.
+
+===============================================================================
+*/
+
+/*
+================
+CM_BinaryFileName
+================
+*/
+static void CM_BinaryFileName( const char *name, idStr &fileName ) {
+	fileName = name;
+	fileName.SetFileExtension( CM_BINARY_FILE_EXT );
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryNodes
+
+Polygon and brush references are written as the indexes stored in the
+checkcount of each polygon and brush by WriteBinaryCollisionModel.
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryNodes( idFile *fp, cm_node_t *node ) {
+	cm_polygonRef_t *pref;
+	cm_brushRef_t *bref;
+	int num;
+
+	fp->WriteInt( node->planeType );
+	fp->WriteFloat( node->planeDist );
+
+	for ( num = 0, pref = node->polygons; pref; pref = pref->next ) {
+		num++;
+	}
+	fp->WriteInt( num );
+	for ( pref = node->polygons; pref; pref = pref->next ) {
+		fp->WriteInt( -1 - pref->p->checkcount );
+	}
+
+	for ( num = 0, bref = node->brushes; bref; bref = bref->next ) {
+		num++;
+	}
+	fp->WriteInt( num );
+	for ( bref = node->brushes; bref; bref = bref->next ) {
+		fp->WriteInt( -1 - bref->b->checkcount );
+	}
+
+	if ( node->planeType != -1 ) {
+		WriteBinaryNodes( fp, node->children[0] );
+		WriteBinaryNodes( fp, node->children[1] );
+	}
+}
+
+/*
+================
+CM_CollectPolygons
+================
+*/
+static void CM_CollectPolygons( cm_node_t *node, int checkCount, idList<cm_polygon_t *> &polygons ) {
+	for ( cm_polygonRef_t *pref = node->polygons; pref; pref = pref->next ) {
+		if ( pref->p->checkcount != checkCount ) {
+			pref->p->checkcount = checkCount;
+			polygons.Append( pref->p );
+		}
+	}
+	if ( node->planeType != -1 ) {
+		CM_CollectPolygons( node->children[0], checkCount, polygons );
+		CM_CollectPolygons( node->children[1], checkCount, polygons );
+	}
+}
+
+/*
+================
+CM_CollectBrushes
+================
+*/
+static void CM_CollectBrushes( cm_node_t *node, int checkCount, idList<cm_brush_t *> &brushes ) {
+	for ( cm_brushRef_t *bref = node->brushes; bref; bref = bref->next ) {
+		if ( bref->b->checkcount != checkCount ) {
+			bref->b->checkcount = checkCount;
+			brushes.Append( bref->b );
+		}
+	}
+	if ( node->planeType != -1 ) {
+		CM_CollectBrushes( node->children[0], checkCount, brushes );
+		CM_CollectBrushes( node->children[1], checkCount, brushes );
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModel
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idList<const idMaterial *> materials;
+	idList<byte> copy;
+	int i, size, polygonMemory, brushMemory;
+
+	checkCount++;
+	CM_CollectPolygons( model->node, checkCount, polygons );
+	checkCount++;
+	CM_CollectBrushes( model->node, checkCount, brushes );
+
+	polygonMemory = 0;
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		polygonMemory += sizeof( cm_polygon_t ) + ( polygons[i]->numEdges - 1 ) * sizeof( polygons[i]->edges[0] );
+		materials.AddUnique( polygons[i]->material );
+	}
+	brushMemory = 0;
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		brushMemory += sizeof( cm_brush_t ) + ( brushes[i]->numPlanes - 1 ) * sizeof( brushes[i]->planes[0] );
+	}
+
+	fp->WriteString( model->name );
+	fp->WriteVec3( model->bounds[0] );
+	fp->WriteVec3( model->bounds[1] );
+	fp->WriteInt( model->contents );
+	fp->WriteInt( model->numInternalEdges );
+	fp->WriteInt( model->numSharpEdges );
+
+	fp->WriteInt( model->numVertices );
+	fp->Write( model->vertices, model->numVertices * sizeof( model->vertices[0] ) );
+	fp->WriteInt( model->numEdges );
+	fp->Write( model->edges, model->numEdges * sizeof( model->edges[0] ) );
+
+	fp->WriteInt( materials.Num() );
+	for ( i = 0; i < materials.Num(); i++ ) {
+		fp->WriteString( materials[i]->GetName() );
+	}
+
+	// the polygons in the layout of the polygon block with the material index in place of the pointer
+	fp->WriteInt( polygons.Num() );
+	fp->WriteInt( polygonMemory );
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		size = sizeof( cm_polygon_t ) + ( polygons[i]->numEdges - 1 ) * sizeof( polygons[i]->edges[0] );
+		copy.SetNum( size, false );
+		memcpy( copy.Ptr(), polygons[i], size );
+		cm_polygon_t *p = (cm_polygon_t *) copy.Ptr();
+		p->material = (const idMaterial *) (intptr_t) materials.FindIndex( polygons[i]->material );
+		p->checkcount = 0;
+		fp->Write( p, size );
+	}
+
+	// the brush material isn't written to the text file either
+	fp->WriteInt( brushes.Num() );
+	fp->WriteInt( brushMemory );
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		size = sizeof( cm_brush_t ) + ( brushes[i]->numPlanes - 1 ) * sizeof( brushes[i]->planes[0] );
+		copy.SetNum( size, false );
+		memcpy( copy.Ptr(), brushes[i], size );
+		cm_brush_t *b = (cm_brush_t *) copy.Ptr();
+		b->material = NULL;
+		b->checkcount = 0;
+		fp->Write( b, size );
+	}
+
+	// temporarily store the indexes in the checkcounts, they can never match the positive checkCount
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		polygons[i]->checkcount = -1 - i;
+	}
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		brushes[i]->checkcount = -1 - i;
+	}
+
+	WriteBinaryNodes( fp, model->node );
+
+	for ( i = 0; i < polygons.Num(); i++ ) {
+		polygons[i]->checkcount = 0;
+	}
+	for ( i = 0; i < brushes.Num(); i++ ) {
+		brushes[i]->checkcount = 0;
+	}
+}
+
+/*
+================
+idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile
+================
+*/
+void idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC ) {
+	idStr name, binaryName;
+	idFile *fp;
+	ID_TIME_T sourceTimeStamp;
+	int sourceLength;
+	const int byteOrder = 1;
+
+	if ( !cm_binaryFiles.GetBool() || firstModel >= lastModel ) {
+		return;
+	}
+
+	// the binary file is only valid for the .cm file it was written with
+	name = filename;
+	name.SetFileExtension( CM_FILE_EXT );
+	sourceLength = fileSystem->ReadFile( name, NULL, &sourceTimeStamp );
+	if ( sourceLength <= 0 ) {
+		return;
+	}
+
+	CM_BinaryFileName( filename, binaryName );
+	fp = fileSystem->OpenFileWrite( binaryName, "fs_devpath" );
+	if ( !fp ) {
+		common->DPrintf( "idCollisionModelManagerLocal::WriteBinaryCollisionModelsToFile: Error opening file %s\n", binaryName.c_str() );
+		return;
+	}
+
+	fp->WriteInt( CM_BINARY_FILEID );
+	fp->WriteInt( CM_BINARY_VERSION );
+	fp->Write( &byteOrder, sizeof( byteOrder ) );
+	fp->WriteInt( sizeof( cm_vertex_t ) );
+	fp->WriteInt( sizeof( cm_edge_t ) );
+	fp->WriteInt( sizeof( cm_polygon_t ) );
+	fp->WriteInt( sizeof( cm_brush_t ) );
+	fp->WriteUnsignedInt( mapFileCRC );
+	fp->WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+	fp->WriteInt( sourceLength );
+
+	fp->WriteInt( lastModel - firstModel );
+	for ( int i = firstModel; i < lastModel; i++ ) {
+		WriteBinaryCollisionModel( fp, models[i] );
+	}
+
+	fileSystem->CloseFile( fp );
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryNodes
+================
+*/
+cm_node_t *idCollisionModelManagerLocal::ReadBinaryNodes( idFile *fp, cm_model_t *model, cm_node_t *parent,
+									const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes, int depth ) {
+	cm_node_t *node;
+	cm_polygonRef_t **lastPolygonRef;
+	cm_brushRef_t **lastBrushRef;
+	int i, num, index;
+
+	// a corrupt file could otherwise recurse forever
+	if ( depth > 1024 || fp->Tell() >= fp->Length() ) {
+		return NULL;
+	}
+
+	model->numNodes++;
+	node = AllocNode( model, model->numNodes < NODE_BLOCK_SIZE_SMALL ? NODE_BLOCK_SIZE_SMALL : NODE_BLOCK_SIZE_LARGE );
+	node->brushes = NULL;
+	node->polygons = NULL;
+	node->parent = parent;
+	node->children[0] = node->children[1] = NULL;
+	fp->ReadInt( node->planeType );
+	fp->ReadFloat( node->planeDist );
+	if ( node->planeType < -1 || node->planeType > 2 ) {
+		return NULL;
+	}
+
+	// keep the reference order of the written tree
+	fp->ReadInt( num );
+	lastPolygonRef = &node->polygons;
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadInt( index );
+		if ( index < 0 || index >= polygons.Num() ) {
+			return NULL;
+		}
+		cm_polygonRef_t *pref = AllocPolygonReference( model, model->numPolygonRefs < REFERENCE_BLOCK_SIZE_SMALL ? REFERENCE_BLOCK_SIZE_SMALL : REFERENCE_BLOCK_SIZE_LARGE );
+		pref->p = polygons[index];
+		pref->next = NULL;
+		*lastPolygonRef = pref;
+		lastPolygonRef = &pref->next;
+		model->numPolygonRefs++;
+	}
+
+	fp->ReadInt( num );
+	lastBrushRef = &node->brushes;
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadInt( index );
+		if ( index < 0 || index >= brushes.Num() ) {
+			return NULL;
+		}
+		cm_brushRef_t *bref = AllocBrushReference( model, model->numBrushRefs < REFERENCE_BLOCK_SIZE_SMALL ? REFERENCE_BLOCK_SIZE_SMALL : REFERENCE_BLOCK_SIZE_LARGE );
+		bref->b = brushes[index];
+		bref->next = NULL;
+		*lastBrushRef = bref;
+		lastBrushRef = &bref->next;
+		model->numBrushRefs++;
+	}
+
+	if ( node->planeType != -1 ) {
+		node->children[0] = ReadBinaryNodes( fp, model, node, polygons, brushes, depth + 1 );
+		if ( !node->children[0] ) {
+			return NULL;
+		}
+		node->children[1] = ReadBinaryNodes( fp, model, node, polygons, brushes, depth + 1 );
+		if ( !node->children[1] ) {
+			return NULL;
+		}
+	}
+	return node;
+}
+
+/*
+================
+idCollisionModelManagerLocal::ReadBinaryCollisionModel
+================
+*/
+bool idCollisionModelManagerLocal::ReadBinaryCollisionModel( idFile *fp, cm_model_t *model ) {
+	idList<const idMaterial *> materials;
+	idList<cm_polygon_t *> polygons;
+	idList<cm_brush_t *> brushes;
+	idStr materialName;
+	int i, j, num, memory, size;
+	byte *ptr, *end;
+
+	fp->ReadString( model->name );
+	fp->ReadVec3( model->bounds[0] );
+	fp->ReadVec3( model->bounds[1] );
+	fp->ReadInt( model->contents );
+	fp->ReadInt( model->numInternalEdges );
+	fp->ReadInt( model->numSharpEdges );
+
+	// vertices
+	fp->ReadInt( num );
+	if ( num < 0 || num > ( fp->Length() - fp->Tell() ) / (int)sizeof( cm_vertex_t ) ) {
+		return false;
+	}
+	model->numVertices = model->maxVertices = num;
+	model->vertices = (cm_vertex_t *) Mem_Alloc( num * sizeof( cm_vertex_t ) );
+	fp->Read( model->vertices, num * sizeof( cm_vertex_t ) );
+	for ( i = 0; i < num; i++ ) {
+		model->vertices[i].side = 0;
+		model->vertices[i].sideSet = 0;
+		model->vertices[i].checkcount = 0;
+	}
+
+	// edges, including the normals CalculateEdgeNormals would create
+	fp->ReadInt( num );
+	if ( num < 0 || num > ( fp->Length() - fp->Tell() ) / (int)sizeof( cm_edge_t ) ) {
+		return false;
+	}
+	model->numEdges = model->maxEdges = num;
+	model->edges = (cm_edge_t *) Mem_Alloc( num * sizeof( cm_edge_t ) );
+	fp->Read( model->edges, num * sizeof( cm_edge_t ) );
+	for ( i = 0; i < num; i++ ) {
+		cm_edge_t *edge = &model->edges[i];
+		if ( edge->vertexNum[0] < 0 || edge->vertexNum[0] >= model->numVertices ||
+				edge->vertexNum[1] < 0 || edge->vertexNum[1] >= model->numVertices ) {
+			return false;
+		}
+		edge->side = 0;
+		edge->sideSet = 0;
+		edge->checkcount = 0;
+	}
+
+	// materials
+	fp->ReadInt( num );
+	if ( num < 0 || num > fp->Length() - fp->Tell() ) {
+		return false;
+	}
+	materials.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		fp->ReadString( materialName );
+		materials[i] = declManager->FindMaterial( materialName );
+	}
+
+	// polygons, copied into the polygon block as they are and then fixed up
+	fp->ReadInt( num );
+	fp->ReadInt( memory );
+	if ( num < 0 || memory < num * (int)sizeof( cm_polygon_t ) || memory > fp->Length() - fp->Tell() ) {
+		return false;
+	}
+	model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc( sizeof( cm_polygonBlock_t ) + memory );
+	model->polygonBlock->bytesRemaining = 0;
+	model->polygonBlock->next = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t ) + memory;
+	ptr = ( (byte *) model->polygonBlock ) + sizeof( cm_polygonBlock_t );
+	end = ptr + memory;
+	fp->Read( ptr, memory );
+	polygons.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		cm_polygon_t *p = (cm_polygon_t *) ptr;
+		if ( end - ptr < (int)sizeof( cm_polygon_t ) || p->numEdges < 1 ) {
+			return false;
+		}
+		size = sizeof( cm_polygon_t ) + ( p->numEdges - 1 ) * sizeof( p->edges[0] );
+		if ( end - ptr < size ) {
+			return false;
+		}
+		for ( j = 0; j < p->numEdges; j++ ) {
+			if ( abs( p->edges[j] ) >= model->numEdges ) {
+				return false;
+			}
+		}
+		intptr_t materialNum = (intptr_t) p->material;
+		if ( materialNum < 0 || materialNum >= materials.Num() ) {
+			return false;
+		}
+		p->material = materials[materialNum];
+		p->contents = p->material->GetContentFlags();
+		p->checkcount = 0;
+		polygons[i] = p;
+		ptr += size;
+	}
+	model->numPolygons = num;
+	model->polygonMemory = memory;
+
+	// brushes
+	fp->ReadInt( num );
+	fp->ReadInt( memory );
+	if ( num < 0 || memory < num * (int)sizeof( cm_brush_t ) || memory > fp->Length() - fp->Tell() ) {
+		return false;
+	}
+	model->brushBlock = (cm_brushBlock_t *) Mem_Alloc( sizeof( cm_brushBlock_t ) + memory );
+	model->brushBlock->bytesRemaining = 0;
+	model->brushBlock->next = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t ) + memory;
+	ptr = ( (byte *) model->brushBlock ) + sizeof( cm_brushBlock_t );
+	end = ptr + memory;
+	fp->Read( ptr, memory );
+	brushes.SetNum( num );
+	for ( i = 0; i < num; i++ ) {
+		cm_brush_t *b = (cm_brush_t *) ptr;
+		if ( end - ptr < (int)sizeof( cm_brush_t ) || b->numPlanes < 1 ) {
+			return false;
+		}
+		size = sizeof( cm_brush_t ) + ( b->numPlanes - 1 ) * sizeof( b->planes[0] );
+		if ( end - ptr < size ) {
+			return false;
+		}
+		b->material = NULL;
+		b->checkcount = 0;
+		b->primitiveNum = 0;
+		brushes[i] = b;
+		ptr += size;
+	}
+	model->numBrushes = num;
+	model->brushMemory = memory;
+
+	// the tree with the references as they were filtered into it
+	model->node = ReadBinaryNodes( fp, model, NULL, polygons, brushes, 0 );
+	if ( !model->node ) {
+		return false;
+	}
+
+	// total memory used by this model
+	model->usedMemory = model->numVertices * sizeof(cm_vertex_t) +
+						model->numEdges * sizeof(cm_edge_t) +
+						model->polygonMemory +
+						model->brushMemory +
+						model->numNodes * sizeof(cm_node_t) +
+						model->numPolygonRefs * sizeof(cm_polygonRef_t) +
+						model->numBrushRefs * sizeof(cm_brushRef_t);
+
+	return true;
+}
+
+/*
+================
+idCollisionModelManagerLocal::LoadBinaryCollisionModelFile
+================
+*/
+bool idCollisionModelManagerLocal::LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC ) {
+	idStr fileName, binaryName;
+	void *buffer;
+	int length, id, version, byteOrder, vertexSize, edgeSize, polygonSize, brushSize, sourceLength, cachedLength, count;
+	unsigned int crc, cachedTimeStamp;
+	ID_TIME_T sourceTimeStamp;
+
+	if ( !cm_binaryFiles.GetBool() ) {
+		return false;
+	}
+
+	fileName = name;
+	fileName.SetFileExtension( CM_FILE_EXT );
+	sourceLength = fileSystem->ReadFile( fileName, NULL, &sourceTimeStamp );
+	if ( sourceLength <= 0 ) {
+		return false;
+	}
+
+	CM_BinaryFileName( name, binaryName );
+	length = fileSystem->ReadFile( binaryName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory fp( binaryName, (const char *) buffer, length );
+
+	fp.ReadInt( id );
+	fp.ReadInt( version );
+	fp.Read( &byteOrder, sizeof( byteOrder ) );
+	fp.ReadInt( vertexSize );
+	fp.ReadInt( edgeSize );
+	fp.ReadInt( polygonSize );
+	fp.ReadInt( brushSize );
+	fp.ReadUnsignedInt( crc );
+	fp.ReadUnsignedInt( cachedTimeStamp );
+	fp.ReadInt( cachedLength );
+	fp.ReadInt( count );
+
+	if ( id != CM_BINARY_FILEID || version != CM_BINARY_VERSION || byteOrder != 1 ||
+			vertexSize != sizeof( cm_vertex_t ) || edgeSize != sizeof( cm_edge_t ) ||
+			polygonSize != sizeof( cm_polygon_t ) || brushSize != sizeof( cm_brush_t ) ||
+			( mapFileCRC && crc != mapFileCRC ) ||
+			cachedTimeStamp != (unsigned int)sourceTimeStamp || cachedLength != sourceLength ||
+			count < 0 || numModels + count > MAX_SUBMODELS ) {
+		common->DPrintf( "%s is out of date\n", binaryName.c_str() );
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
+	int firstModel = numModels;
+	bool valid = true;
+	for ( int i = 0; i < count; i++ ) {
+		cm_model_t *model = AllocModel();
+		models[numModels] = model;
+		numModels++;
+		if ( !ReadBinaryCollisionModel( &fp, model ) ) {
+			valid = false;
+			break;
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		common->Warning( "%s is corrupt", binaryName.c_str() );
+		while ( numModels > firstModel ) {
+			numModels--;
+			FreeModel( models[numModels] );
+			models[numModels] = NULL;
+		}
+		return false;
+	}
+
 	return true;
 }
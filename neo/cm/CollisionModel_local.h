@@ -489,6 +489,13 @@ private:			// CollisionMap_files.cpp
 	void			ParseBrushes( idLexer *src, cm_model_t *model );
 	bool			ParseCollisionModel( idLexer *src );
 	bool			LoadCollisionModelFile( const char *name, unsigned int mapFileCRC );
+					// binary files
+	void			WriteBinaryNodes( idFile *fp, cm_node_t *node );
+	void			WriteBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	void			WriteBinaryCollisionModelsToFile( const char *filename, int firstModel, int lastModel, unsigned int mapFileCRC );
+	cm_node_t *		ReadBinaryNodes( idFile *fp, cm_model_t *model, cm_node_t *parent, const idList<cm_polygon_t *> &polygons, const idList<cm_brush_t *> &brushes, int depth );
+	bool			ReadBinaryCollisionModel( idFile *fp, cm_model_t *model );
+	bool			LoadBinaryCollisionModelFile( const char *name, unsigned int mapFileCRC );
 
 private:			// CollisionMap_debug
 	int				ContentsFromString( const char *string ) const;
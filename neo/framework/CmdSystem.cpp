@@ -498,6 +498,10 @@ void idCmdSystemLocal::ExecuteTokenizedString( const idCmdArgs &args ) {
 			if ( !cmd->function ) {
 				break;
 			} else {
+				if ( cmd->flags & CMD_FL_RENDERER ) {
+					// the render thread may still be drawing the last frame
+					renderSystem->SyncRenderThread();
+				}
 				cmd->function( args );
 			}
 			return;
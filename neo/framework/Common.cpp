@@ -2324,6 +2324,7 @@ void idCommonLocal::InitCommands( void ) {
 	cmdSystem->AddCommand( "runAAS", RunAAS_f, CMD_FL_TOOL, "compiles an AAS file for a map", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "runAASDir", RunAASDir_f, CMD_FL_TOOL, "compiles AAS files for all maps in a folder", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "runReach", RunReach_f, CMD_FL_TOOL, "calculates reachability for an AAS file", idCmdSystem::ArgCompletion_MapName );
+	cmdSystem->AddCommand( "convertAAS", ConvertAAS_f, CMD_FL_TOOL, "writes binary versions of the AAS files of a map", idCmdSystem::ArgCompletion_MapName );
 	cmdSystem->AddCommand( "roq", RoQFileEncode_f, CMD_FL_TOOL, "encodes a roq file" );
 #endif
 
@@ -2421,6 +2422,9 @@ idCommonLocal::Frame
 void idCommonLocal::Frame( void ) {
 	try {
 
+		// close the previous frame for the profiler
+		profiler->BeginFrame();
+
 		// pump all the events
 		Sys_GenerateEvents();
 
@@ -2457,10 +2461,12 @@ void idCommonLocal::Frame( void ) {
 			int		com_frameMsec = nowTime - lastTime;
 			lastTime = nowTime;
 			Printf( "frame:%i all:%3i gfr:%3i rf:%3i bk:%3i\n", com_frameNumber, com_frameMsec, time_gameFrame, time_frontend, time_backend );
-			time_gameFrame = 0;
-			time_gameDraw = 0;
 		}	
 
+		// the renderer has recorded them in its counter history by now
+		time_gameFrame = 0;
+		time_gameDraw = 0;
+
 		com_frameNumber++;
 
 		// set idLib frame number for frame based memory dumps
@@ -2531,6 +2537,8 @@ void idCommonLocal::SingleAsyncTic( void ) {
 	// critical data structures
 	Sys_EnterCriticalSection();
 
+	PROFILE_SCOPE( "SingleAsyncTic" );
+
 	asyncStats_t *stat = &com_asyncStats[com_ticNumber & (MAX_ASYNC_STATS-1)];
 	memset( stat, 0, sizeof( *stat ) );
 	stat->milliseconds = Sys_Milliseconds();
@@ -2651,6 +2659,7 @@ void idCommonLocal::LoadGameDLL( void ) {
 	gameImport.declManager				= ::declManager;
 	gameImport.AASFileManager			= ::AASFileManager;
 	gameImport.collisionModelManager	= ::collisionModelManager;
+	gameImport.profiler					= ::profiler;
 
 	gameExport							= *GetGameAPI( &gameImport );
 
@@ -2803,6 +2812,9 @@ void idCommonLocal::Init( int argc, const char **argv, const char *cmdline ) {
 		// init commands
 		InitCommands();
 
+		// init the profiler, this is the main thread
+		profiler->Init();
+
 #ifdef ID_WRITE_VERSION
 		config_compressor = idCompressor::AllocArithmetic();
 #endif
@@ -2858,6 +2870,12 @@ void idCommonLocal::Shutdown( void ) {
 	// game specific shut down
 	ShutdownGame( false );
 
+	// stop the job workers
+	parallelJobManager->Shutdown();
+
+	// stop recording and free the profile rings
+	profiler->Shutdown();
+
 	// shut down non-portable system services
 	Sys_Shutdown();
 
@@ -2961,6 +2979,9 @@ void idCommonLocal::InitGame( void ) {
 	// if any archived cvars are modified after this, we will trigger a writing of the config file
 	cvarSystem->ClearModifiedFlags( CVAR_ARCHIVE );
 
+	// start the job workers now that jobs_numThreads has its archived value
+	parallelJobManager->Init();
+
 	// cvars are initialized, but not the rendering system. Allow preference startup dialog
 	Sys_DoPreferences();
 
@@ -0,0 +1,462 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+idCVar com_profile( "com_profile", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "record profile zones continuously, profileDump writes the last frames" );
+
+const int PROFILE_MAX_THREADS		= MAX_THREADS + 1;	// main thread and everything created with Sys_CreateThread
+const int PROFILE_MAIN_EVENTS		= 1 << 18;			// ring size of the main thread, must be a power of two
+const int PROFILE_THREAD_EVENTS		= 1 << 15;			// ring size of the other threads, must be a power of two
+const int PROFILE_MAX_DEPTH			= 32;
+const int PROFILE_MAX_FRAMES		= 1024;				// must be a power of two
+const int PROFILE_DEFAULT_FRAMES	= 60;
+const int PROFILE_MAX_ZONES			= 4096;
+const int PROFILE_ZONE_NAME_BYTES	= 128 * 1024;		// storage for the registered zone names
+const int PROFILE_ZONE_HASH_SIZE	= 1024;				// must be a power of two
+
+typedef struct {
+	int						zone;
+	double					start;
+	double					end;
+} profileEvent_t;
+
+typedef struct {
+	char					name[32];
+	profileEvent_t *		events;
+	int						maxEvents;
+	volatile int			numEvents;		// total written, the ring index is numEvents & ( maxEvents - 1 )
+	int						depth;
+	int						zones[PROFILE_MAX_DEPTH];
+	double					zoneStarts[PROFILE_MAX_DEPTH];
+} profileThread_t;
+
+class idProfilerLocal : public idProfiler {
+public:
+							idProfilerLocal( void );
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+	virtual void			BeginFrame( void );
+	virtual int				FindZone( const char *name );
+	virtual void			BeginZone( int zone );
+	virtual void			EndZone( void );
+	virtual void			SetThreadName( const char *name );
+
+private:
+	bool					initialized;
+	profileThread_t			threads[PROFILE_MAX_THREADS];
+	volatile int			numThreads;
+
+	// zones are never unregistered, the game DLL keeps zone numbers in statics
+	const char *			zoneNames[PROFILE_MAX_ZONES];
+	int						zoneHashNext[PROFILE_MAX_ZONES];
+	int						zoneHash[PROFILE_ZONE_HASH_SIZE];
+	int						numZones;
+	char					zoneNameData[PROFILE_ZONE_NAME_BYTES];
+	int						zoneNameDataUsed;
+	int						frameZone;
+
+	double					frameStarts[PROFILE_MAX_FRAMES];
+	int						numFrames;			// frames begun since Init
+	int						recordedFrames;		// frames begun since recording was last switched on
+	int						captureFrames;		// frames requested by profileDump while com_profile is off
+	idStr					captureFile;
+
+	profileThread_t *		GetThread( void );
+	void					AllocEvents( void );
+	void					FreeEvents( void );
+	void					WriteTrace( const char *fileName, int lastFrame, int frames, double endTime );
+
+	static void				ProfileDump_f( const idCmdArgs &args );
+};
+
+static idProfilerLocal		profilerLocal;
+idProfiler *				profiler = &profilerLocal;
+
+// slot of the calling thread, NULL until its first zone
+static ID_THREAD_LOCAL profileThread_t *	profileThread;
+
+/*
+================
+idProfilerLocal::idProfilerLocal
+================
+*/
+idProfilerLocal::idProfilerLocal( void ) {
+	recording = false;
+	initialized = false;
+	memset( threads, 0, sizeof( threads ) );
+	numThreads = 0;
+	memset( zoneHash, -1, sizeof( zoneHash ) );
+	numZones = 0;
+	zoneNameDataUsed = 0;
+	frameZone = 0;
+	numFrames = 0;
+	recordedFrames = 0;
+	captureFrames = 0;
+}
+
+/*
+================
+idProfilerLocal::Init
+
+Must be called from the main thread, which gets the first slot
+================
+*/
+void idProfilerLocal::Init( void ) {
+	if ( initialized ) {
+		return;
+	}
+	initialized = true;
+
+	profileThread = NULL;
+	numThreads = 0;
+	SetThreadName( "main" );
+	frameZone = FindZone( "frame" );
+
+	cmdSystem->AddCommand( "profileDump", ProfileDump_f, CMD_FL_SYSTEM, "writes the profile zones of the last or next frames as a Chrome trace, usage: profileDump [frames] [file]" );
+}
+
+/*
+================
+idProfilerLocal::Shutdown
+================
+*/
+void idProfilerLocal::Shutdown( void ) {
+	if ( !initialized ) {
+		return;
+	}
+	recording = false;
+	captureFrames = 0;
+	FreeEvents();
+	cmdSystem->RemoveCommand( "profileDump" );
+	initialized = false;
+}
+
+/*
+================
+idProfilerLocal::AllocEvents
+
+The rings are only allocated the first time recording is switched on
+================
+*/
+void idProfilerLocal::AllocEvents( void ) {
+	for ( int i = 0; i < PROFILE_MAX_THREADS; i++ ) {
+		profileThread_t *thread = &threads[i];
+		if ( thread->events == NULL ) {
+			thread->maxEvents = ( i == 0 ) ? PROFILE_MAIN_EVENTS : PROFILE_THREAD_EVENTS;
+			thread->events = (profileEvent_t *)Mem_Alloc( thread->maxEvents * sizeof( profileEvent_t ) );
+		}
+		thread->numEvents = 0;
+	}
+}
+
+/*
+================
+idProfilerLocal::FreeEvents
+================
+*/
+void idProfilerLocal::FreeEvents( void ) {
+	for ( int i = 0; i < PROFILE_MAX_THREADS; i++ ) {
+		Mem_Free( threads[i].events );
+		threads[i].events = NULL;
+		threads[i].maxEvents = 0;
+		threads[i].numEvents = 0;
+	}
+}
+
+/*
+================
+idProfilerLocal::GetThread
+
+Returns NULL if there are more threads than slots
+================
+*/
+profileThread_t *idProfilerLocal::GetThread( void ) {
+	if ( profileThread == NULL ) {
+		// a dedicated lock, the zones are also used while other critical sections are held
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FIVE );
+		if ( numThreads < PROFILE_MAX_THREADS ) {
+			profileThread = &threads[numThreads];
+			idStr::snPrintf( profileThread->name, sizeof( profileThread->name ), "thread %d", numThreads );
+			numThreads++;
+		}
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FIVE );
+	}
+	return profileThread;
+}
+
+/*
+================
+idProfilerLocal::SetThreadName
+================
+*/
+void idProfilerLocal::SetThreadName( const char *name ) {
+	profileThread_t *thread = GetThread();
+	if ( thread ) {
+		idStr::Copynz( thread->name, name, sizeof( thread->name ) );
+	}
+}
+
+/*
+================
+idProfilerLocal::FindZone
+
+The name is copied into storage owned by the profiler the first time it is
+seen, without the heap because any thread may register zones.  Once the
+storage is full every new name shares zone 0.
+================
+*/
+int idProfilerLocal::FindZone( const char *name ) {
+	const int hash = idStr::Hash( name ) & ( PROFILE_ZONE_HASH_SIZE - 1 );
+	int zone;
+
+	Sys_EnterCriticalSection( CRITICAL_SECTION_FIVE );
+
+	if ( numZones == 0 ) {
+		zoneNames[0] = "too many profile zones";
+		zoneHashNext[0] = -1;
+		numZones = 1;
+	}
+
+	for ( zone = zoneHash[hash]; zone >= 0; zone = zoneHashNext[zone] ) {
+		if ( idStr::Cmp( zoneNames[zone], name ) == 0 ) {
+			break;
+		}
+	}
+
+	if ( zone < 0 ) {
+		const int length = idStr::Length( name ) + 1;
+		if ( numZones < PROFILE_MAX_ZONES && zoneNameDataUsed + length <= PROFILE_ZONE_NAME_BYTES ) {
+			zone = numZones++;
+			char *copy = &zoneNameData[zoneNameDataUsed];
+			zoneNameDataUsed += length;
+			memcpy( copy, name, length );
+			zoneNames[zone] = copy;
+			zoneHashNext[zone] = zoneHash[hash];
+			zoneHash[hash] = zone;
+		} else {
+			zone = 0;
+		}
+	}
+
+	Sys_LeaveCriticalSection( CRITICAL_SECTION_FIVE );
+
+	return zone;
+}
+
+/*
+================
+idProfilerLocal::BeginZone
+================
+*/
+void idProfilerLocal::BeginZone( int zone ) {
+	profileThread_t *thread = GetThread();
+	if ( !thread ) {
+		return;
+	}
+	if ( thread->depth < PROFILE_MAX_DEPTH ) {
+		thread->zones[thread->depth] = zone;
+		thread->zoneStarts[thread->depth] = Sys_GetClockTicks();
+	}
+	thread->depth++;
+}
+
+/*
+================
+idProfilerLocal::EndZone
+
+Only the owning thread writes to a ring, the event is filled in before it is counted
+================
+*/
+void idProfilerLocal::EndZone( void ) {
+	profileThread_t *thread = GetThread();
+	if ( !thread || thread->depth <= 0 ) {
+		return;
+	}
+	thread->depth--;
+	if ( thread->depth >= PROFILE_MAX_DEPTH || thread->events == NULL ) {
+		return;
+	}
+	profileEvent_t *event = &thread->events[thread->numEvents & ( thread->maxEvents - 1 )];
+	event->zone = thread->zones[thread->depth];
+	event->start = thread->zoneStarts[thread->depth];
+	event->end = Sys_GetClockTicks();
+	thread->numEvents++;
+}
+
+/*
+================
+idProfilerLocal::BeginFrame
+================
+*/
+void idProfilerLocal::BeginFrame( void ) {
+	if ( !initialized ) {
+		return;
+	}
+
+	double now = Sys_GetClockTicks();
+
+	if ( recording && recordedFrames > 0 ) {
+		// the frame that just ended is a zone of its own
+		profileThread_t *thread = &threads[0];
+		profileEvent_t *event = &thread->events[thread->numEvents & ( thread->maxEvents - 1 )];
+		event->zone = frameZone;
+		event->start = frameStarts[( numFrames - 1 ) & ( PROFILE_MAX_FRAMES - 1 )];
+		event->end = now;
+		thread->numEvents++;
+
+		if ( captureFrames > 0 && recordedFrames >= captureFrames ) {
+			WriteTrace( captureFile, numFrames - 1, captureFrames, now );
+			captureFrames = 0;
+		}
+	}
+
+	frameStarts[numFrames & ( PROFILE_MAX_FRAMES - 1 )] = now;
+	numFrames++;
+
+	bool record = com_profile.GetBool() || captureFrames > 0;
+	if ( record && !recording ) {
+		AllocEvents();
+		recordedFrames = 0;
+	}
+	recording = record;
+	if ( recording ) {
+		recordedFrames++;
+	}
+}
+
+/*
+================
+idProfilerLocal::WriteTrace
+
+Writes the frames up to and including lastFrame in the Chrome trace event format,
+timestamps are in microseconds from the start of the first frame
+================
+*/
+void idProfilerLocal::WriteTrace( const char *fileName, int lastFrame, int frames, double endTime ) {
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't write %s", fileName );
+		return;
+	}
+
+	const double startTime = frameStarts[( lastFrame - frames + 1 ) & ( PROFILE_MAX_FRAMES - 1 )];
+	const double usecPerTick = 1000000.0 / Sys_ClockTicksPerSecond();
+	int numEvents = 0;
+	bool truncated = false;
+
+	f->Printf( "{\"traceEvents\":[\n" );
+	f->Printf( "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"%s\"}}", GAME_NAME );
+
+	const int count = numThreads;
+	for ( int i = 0; i < count; i++ ) {
+		const profileThread_t *thread = &threads[i];
+		f->Printf( ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}", i, thread->name );
+		f->Printf( ",\n{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"sort_index\":%d}}", i, i );
+
+		if ( thread->events == NULL ) {
+			continue;
+		}
+
+		// other threads may still be writing, only read up to what they have counted
+		const int last = thread->numEvents;
+		int first = last - thread->maxEvents;
+		if ( first < 0 ) {
+			first = 0;
+		} else if ( thread->events[first & ( thread->maxEvents - 1 )].start > startTime ) {
+			truncated = true;
+		}
+
+		for ( int j = first; j < last; j++ ) {
+			const profileEvent_t *event = &thread->events[j & ( thread->maxEvents - 1 )];
+			if ( event->start < startTime || event->start >= endTime ) {
+				continue;
+			}
+			f->Printf( ",\n{\"name\":\"%s\",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+				zoneNames[event->zone], i, ( event->start - startTime ) * usecPerTick, ( event->end - event->start ) * usecPerTick );
+			numEvents++;
+		}
+	}
+
+	f->Printf( "\n],\n\"displayTimeUnit\":\"ms\"}\n" );
+	fileSystem->CloseFile( f );
+
+	common->Printf( "wrote %d zones of %d frames to %s\n", numEvents, frames, fileName );
+	if ( truncated ) {
+		common->Printf( "the oldest frames were partially overwritten, dump fewer frames\n" );
+	}
+}
+
+/*
+================
+idProfilerLocal::ProfileDump_f
+
+With com_profile on the frames that were just recorded are written,
+otherwise the next frames are recorded and written when they are done
+================
+*/
+void idProfilerLocal::ProfileDump_f( const idCmdArgs &args ) {
+	idProfilerLocal &p = profilerLocal;
+
+	int frames = PROFILE_DEFAULT_FRAMES;
+	if ( args.Argc() > 1 ) {
+		frames = atoi( args.Argv( 1 ) );
+	}
+	frames = Max( 1, Min( PROFILE_MAX_FRAMES - 1, frames ) );
+
+	idStr fileName;
+	if ( args.Argc() > 2 ) {
+		fileName = args.Argv( 2 );
+		fileName.DefaultFileExtension( ".json" );
+	} else {
+		fileName = va( "profiles/frame%d.json", p.numFrames );
+	}
+
+	if ( p.recording && com_profile.GetBool() ) {
+		// the current frame isn't done yet
+		const int completed = p.recordedFrames - 1;
+		if ( completed <= 0 ) {
+			common->Printf( "no frames recorded yet\n" );
+			return;
+		}
+		const int lastFrame = p.numFrames - 2;
+		p.WriteTrace( fileName, lastFrame, Min( frames, completed ), p.frameStarts[( lastFrame + 1 ) & ( PROFILE_MAX_FRAMES - 1 )] );
+		return;
+	}
+
+	if ( p.captureFrames > 0 ) {
+		common->Printf( "already recording %d frames for %s\n", p.captureFrames, p.captureFile.c_str() );
+		return;
+	}
+	p.captureFrames = frames;
+	p.captureFile = fileName;
+	common->Printf( "recording %d frames for %s\n", frames, fileName.c_str() );
+}
@@ -0,0 +1,107 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#ifndef __PROFILER_H__
+#define __PROFILER_H__
+
+/*
+===============================================================================
+
+	Scoped CPU profiler.
+
+	Named zones nest per thread and are written to a ring buffer owned by
+	the thread while recording is on.  Recording is either continuous with
+	com_profile, or armed for the next frames by profileDump.  The recorded
+	frames are written in the Chrome trace event format, which can be opened
+	with chrome://tracing or any other trace viewer.
+
+	PROFILE_SCOPE( "name" ) times the rest of the enclosing block, the name
+	is registered once and the scope only passes the zone number around.
+	PROFILE_SCOPE_NAMED( name ) looks a name that isn't constant up every
+	time it records.  Registering copies the name into storage owned by the
+	profiler, so names from the game DLL or temporary strings are fine.
+
+===============================================================================
+*/
+
+class idProfiler {
+public:
+	virtual					~idProfiler( void ) {}
+
+	virtual void			Init( void ) = 0;
+	virtual void			Shutdown( void ) = 0;
+
+							// Called by the main thread at the start of every frame.
+	virtual void			BeginFrame( void ) = 0;
+
+							// Returns the zone for the name, registering it the first time.
+	virtual int				FindZone( const char *name ) = 0;
+	virtual void			BeginZone( int zone ) = 0;
+	virtual void			EndZone( void ) = 0;
+
+							// Names the calling thread in the trace.
+	virtual void			SetThreadName( const char *name ) = 0;
+
+							// Cheap enough to test before every zone.
+	bool					IsRecording( void ) const { return recording; }
+
+protected:
+	volatile bool			recording;
+};
+
+extern idProfiler *			profiler;
+
+class idProfileScope {
+public:
+							idProfileScope( int zone ) {
+								active = profiler->IsRecording();
+								if ( active ) {
+									profiler->BeginZone( zone );
+								}
+							}
+							idProfileScope( const char *name ) {
+								active = profiler->IsRecording();
+								if ( active ) {
+									profiler->BeginZone( profiler->FindZone( name ) );
+								}
+							}
+							~idProfileScope( void ) {
+								if ( active ) {
+									profiler->EndZone();
+								}
+							}
+
+private:
+	bool					active;
+};
+
+#define PROFILE_SCOPE( name )		static const int profileZone = profiler->FindZone( name ); idProfileScope profileScope( profileZone )
+#define PROFILE_SCOPE_NAMED( name )	idProfileScope profileScope( name )
+
+#endif /* !__PROFILER_H__ */
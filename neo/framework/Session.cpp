@@ -317,6 +317,7 @@ void idSessionLocal::Clear() {
 	guiActive = NULL;
 	aviCaptureMode = false;
 	timeDemo = TD_NO;
+	benchFrontEnd = false;
 	waitingOnBind = false;
 	lastPacifierTime = 0;
 	
@@ -665,6 +666,26 @@ static void Session_TimeDemoQuit_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+================
+Session_BenchFrontEnd_f
+================
+*/
+static void Session_BenchFrontEnd_f( const idCmdArgs &args ) {
+	if ( args.Argc() >= 2 ) {
+		sessLocal.BenchFrontEnd( va( "demos/%s", args.Argv(1) ), false );
+	}
+}
+
+/*
+================
+Session_BenchFrontEndQuit_f
+================
+*/
+static void Session_BenchFrontEndQuit_f( const idCmdArgs &args ) {
+	sessLocal.BenchFrontEnd( va( "demos/%s", args.Argv(1) ), true );
+}
+
 /*
 ================
 Session_AVIDemo_f
@@ -851,7 +872,8 @@ void idSessionLocal::StopPlayingRenderDemo() {
 	sw->StopAllSounds();
 	soundSystem->SetPlayingSoundWorld( menuSoundWorld );
 
-	common->Printf( "stopped playing %s.\n", readDemo->GetName() );
+	idStr demoName = readDemo->GetName();
+	common->Printf( "stopped playing %s.\n", demoName.c_str() );
 	delete readDemo;
 	readDemo = NULL;
 
@@ -862,6 +884,10 @@ void idSessionLocal::StopPlayingRenderDemo() {
 		idStr	message = va( "%i frames rendered in %3.1f seconds = %3.1f fps\n", numDemoFrames, demoSeconds, demoFPS );
 
 		common->Printf( "%s", message.c_str() );
+		if ( benchFrontEnd ) {
+			renderSystem->EndFrontEndBenchmark( demoName );
+			benchFrontEnd = false;
+		}
 		if ( timeDemo == TD_YES_THEN_QUIT ) {
 			cmdSystem->BufferCommandText( CMD_EXEC_APPEND, "quit\n" );
 		} else {
@@ -981,6 +1007,26 @@ void idSessionLocal::TimeRenderDemo( const char *demoName, bool twice ) {
 	timeDemo = TD_YES;
 }
 
+/*
+================
+idSessionLocal::BenchFrontEnd
+
+A timeDemo that also times the front end phases of every frame, the demo is played
+once before to precache everything.  The results go to benchmarks/<demo>_frontend.json
+================
+*/
+void idSessionLocal::BenchFrontEnd( const char *demoName, bool quit ) {
+	TimeRenderDemo( demoName, true );
+	if ( timeDemo != TD_YES ) {
+		return;
+	}
+	if ( quit ) {
+		timeDemo = TD_YES_THEN_QUIT;
+	}
+	benchFrontEnd = true;
+	renderSystem->BeginFrontEndBenchmark();
+}
+
 
 /*
 ================
@@ -2363,6 +2409,8 @@ idSessionLocal::Draw
 ===============
 */
 void idSessionLocal::Draw() {
+	PROFILE_SCOPE( "idSessionLocal::Draw" );
+
 	bool fullConsole = false;
 
 	if ( insideExecuteMapChange ) {
@@ -2480,6 +2528,8 @@ void idSessionLocal::UpdateScreen( bool outOfSequence ) {
 
 	insideUpdateScreen = true;
 
+	PROFILE_SCOPE( "idSessionLocal::UpdateScreen" );
+
 	// if this is a long-operation update and we are in windowed mode,
 	// release the mouse capture back to the desktop
 	if ( outOfSequence ) {
@@ -2506,6 +2556,7 @@ idSessionLocal::Frame
 ===============
 */
 void idSessionLocal::Frame() {
+	PROFILE_SCOPE( "idSessionLocal::Frame" );
 
 	if ( com_asyncSound.GetInteger() == 0 ) {
 		soundSystem->AsyncUpdate( Sys_Milliseconds() );
@@ -2735,6 +2786,8 @@ void idSessionLocal::RunGameTic() {
 	logCmd_t	logCmd;
 	usercmd_t	cmd;
 
+	PROFILE_SCOPE( "idSessionLocal::RunGameTic" );
+
 	// if we are doing a command demo, read or write from the file
 	if ( cmdDemoFile ) {
 		if ( !cmdDemoFile->Read( &logCmd, sizeof( logCmd ) ) ) {
@@ -2861,6 +2914,8 @@ void idSessionLocal::Init() {
 	cmdSystem->AddCommand( "playDemo", Session_PlayDemo_f, CMD_FL_SYSTEM, "plays back a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "timeDemo", Session_TimeDemo_f, CMD_FL_SYSTEM, "times a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "timeDemoQuit", Session_TimeDemoQuit_f, CMD_FL_SYSTEM, "times a demo and quits", idCmdSystem::ArgCompletion_DemoName );
+	cmdSystem->AddCommand( "benchFrontEnd", Session_BenchFrontEnd_f, CMD_FL_SYSTEM, "times the front end phases of a demo and writes them as JSON", idCmdSystem::ArgCompletion_DemoName );
+	cmdSystem->AddCommand( "benchFrontEndQuit", Session_BenchFrontEndQuit_f, CMD_FL_SYSTEM, "times the front end phases of a demo, writes them as JSON and quits", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "aviDemo", Session_AVIDemo_f, CMD_FL_SYSTEM, "writes AVIs for a demo", idCmdSystem::ArgCompletion_DemoName );
 	cmdSystem->AddCommand( "compressDemo", Session_CompressDemo_f, CMD_FL_SYSTEM, "compresses a demo file", idCmdSystem::ArgCompletion_DemoName );
 #endif
@@ -222,6 +222,7 @@ public:
 	int					aviTicStart;
 
 	timeDemo_t			timeDemo;
+	bool				benchFrontEnd;		// the renderer times the front end phases of the timeDemo
 	int					timeDemoStartTime;
 	int					numDemoFrames;		// for timeDemo and demoShot
 	int					demoTimeOffset;
@@ -280,6 +281,7 @@ public:
 	void				StopPlayingRenderDemo();
 	void				CompressDemoFile( const char *scheme, const char *name );
 	void				TimeRenderDemo( const char *name, bool twice = false );
+	void				BenchFrontEnd( const char *name, bool quit );
 	void				AVIRenderDemo( const char *name );
 	void				AVICmdDemo( const char *name );
 	void				AVIGame( const char *name );
@@ -1440,7 +1440,9 @@ bool idEntity::UpdateRenderEntity( renderEntity_s *renderEntity, const renderVie
 
 	idAnimator *animator = GetAnimator();
 	if ( animator ) {
-		return animator->CreateFrame( gameLocal.time, false );
+		// the frame may already have been created by idGameLocal::CreateAnimationFrames
+		bool created = animator->CreateFrame( gameLocal.time, false );
+		return animator->ConsumeJobFrame() || created;
 	}
 
 	return false;
@@ -46,6 +46,7 @@ idUserInterfaceManager *	uiManager = NULL;
 idDeclManager *				declManager = NULL;
 idAASFileManager *			AASFileManager = NULL;
 idCollisionModelManager *	collisionModelManager = NULL;
+idProfiler *				profiler = NULL;
 idCVar *					idCVar::staticVars = NULL;
 
 idCVar com_forceGenericSIMD( "com_forceGenericSIMD", "0", CVAR_BOOL|CVAR_SYSTEM, "force generic platform independent SIMD" );
@@ -101,6 +102,7 @@ extern "C" gameExport_t *GetGameAPI( gameImport_t *import ) {
 		declManager					= import->declManager;
 		AASFileManager				= import->AASFileManager;
 		collisionModelManager		= import->collisionModelManager;
+		profiler					= import->profiler;
 	}
 
 	// set interface pointers used by idLib
@@ -153,6 +155,7 @@ idGameLocal::idGameLocal
 */
 idGameLocal::idGameLocal() {
 	Clear();
+	animationJobs = NULL;
 }
 
 /*
@@ -316,6 +319,8 @@ void idGameLocal::Init( void ) {
 		kv = dict->MatchPrefix( "type", kv );
 	}
 
+	animationJobs = sys->GetJobManager()->AllocJobList( "animation" );
+
 	gamestate = GAMESTATE_NOMAP;
 
 	Printf( "...%d aas types\n", aasList.Num() );
@@ -375,6 +380,11 @@ void idGameLocal::Shutdown( void ) {
 
 	ShutdownConsoleCommands();
 
+	if ( animationJobs ) {
+		sys->GetJobManager()->FreeJobList( animationJobs );
+		animationJobs = NULL;
+	}
+
 	// free memory allocated by class objects
 	Clear();
 
@@ -2163,6 +2173,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 	idPlayer	*player;
 	const renderView_t *view;
 
+	PROFILE_SCOPE( "idGameLocal::RunFrame" );
+
 #ifdef _DEBUG
 	if ( isMultiplayer ) {
 		assert( !isClient );
@@ -2266,6 +2278,8 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 			} else {
 				num = 0;
 				for( ent = activeEntities.Next(); ent != NULL; ent = ent->activeNode.Next() ) {
+					// zone per class, the name is only looked up while recording
+					PROFILE_SCOPE_NAMED( ent->GetClassname() );
 					ent->Think();
 					num++;
 				}
@@ -2292,7 +2306,10 @@ gameReturn_t idGameLocal::RunFrame( const usercmd_t *clientCmds ) {
 		timer_events.Start();
 
 		// service any pending events
-		idEvent::ServiceEvents();
+		{
+			PROFILE_SCOPE( "idEvent::ServiceEvents" );
+			idEvent::ServiceEvents();
+		}
 
 		timer_events.Stop();
 
@@ -2434,6 +2451,74 @@ void idGameLocal::CalcFov( float base_fov, float &fov_x, float &fov_y ) const {
 	}
 }
 
+// the bounds are from the previous frame, and the view can move between tics
+const float ANIMATION_FRAME_CULL_EPSILON = 32.0f;
+
+/*
+================
+idGameLocal::CreateAnimationFrames
+
+The renderer asks for the animation frame of an entity through its callback while it adds
+the model surfaces, one entity at a time.  This creates the frames of the animating entities
+in the view pvs whose bounds touch the player's view frustum up front as parallel jobs, so
+the callbacks only have to report them.  Entities that still get rendered otherwise (shadows,
+mirrors, remote cameras) create their frame in the callback as before.
+================
+*/
+void idGameLocal::CreateAnimationFrames( idPlayer *player ) {
+	idEntity *ent;
+	idAnimator *animator;
+	idFrustum viewFrustum;
+
+	if ( !animationJobs || !g_parallelAnimation.GetBool() || g_debugAnim.GetInteger() != -1 ) {
+		return;
+	}
+
+	if ( inCinematic && skipCinematic ) {
+		return;
+	}
+
+	const renderView_t *view = player->GetRenderView();
+	if ( !view ) {
+		return;
+	}
+
+	// the view drawn may still be offset a little by the player view effects
+	const float farDist = MAX_WORLD_SIZE;
+	viewFrustum.SetOrigin( view->vieworg );
+	viewFrustum.SetAxis( view->viewaxis );
+	viewFrustum.SetSize( 1.0f, farDist, farDist * idMath::Tan( DEG2RAD( view->fov_x * 0.5f ) ), farDist * idMath::Tan( DEG2RAD( view->fov_y * 0.5f ) ) );
+
+	pvsHandle_t viewPVS = GetClientPVS( player, PVS_NORMAL );
+
+	int numJobs = 0;
+	for ( ent = spawnedEntities.Next(); ent != NULL; ent = ent->spawnNode.Next() ) {
+		if ( ent->GetModelDefHandle() == -1 || ent->IsHidden() ) {
+			continue;
+		}
+		animator = ent->GetAnimator();
+		if ( !animator || !animator->ModelHandle() ) {
+			continue;
+		}
+		if ( !pvs.InCurrentPVS( viewPVS, ent->GetPVSAreas(), ent->GetNumPVSAreas() ) ) {
+			continue;
+		}
+		const renderEntity_t *renderEntity = ent->GetRenderEntity();
+		if ( viewFrustum.CullBox( idBox( renderEntity->bounds.Expand( ANIMATION_FRAME_CULL_EPSILON ), renderEntity->origin, renderEntity->axis ) ) ) {
+			continue;
+		}
+		animationJobs->AddJob( idAnimator::CreateFrameJob, animator );
+		numJobs++;
+	}
+
+	pvs.FreeCurrentPVS( viewPVS );
+
+	if ( numJobs ) {
+		animationJobs->Submit();
+		animationJobs->Wait();
+	}
+}
+
 /*
 ================
 idGameLocal::Draw
@@ -2442,6 +2527,12 @@ makes rendering and sound system calls
 ================
 */
 bool idGameLocal::Draw( int clientNum ) {
+	PROFILE_SCOPE( "idGameLocal::Draw" );
+
+	if ( entities[ clientNum ] && entities[ clientNum ]->IsType( idPlayer::Type ) ) {
+		CreateAnimationFrames( static_cast<idPlayer *>(entities[ clientNum ]) );
+	}
+
 	if ( isMultiplayer ) {
 		return mpGame.Draw( clientNum );
 	}
@@ -493,6 +493,8 @@ private:
 	pvsHandle_t				playerPVS;				// merged pvs of all players
 	pvsHandle_t				playerConnectedAreas;	// all areas connected to any player area
 
+	idParallelJobList *		animationJobs;			// creates the animation frames of visible entities before the view is rendered
+
 	idVec3					gravity;				// global gravity vector
 	gameState_t				gamestate;				// keeps track of whether we're spawning, shutting down, or normal gameplay
 	bool					influenceActive;		// true when a phantasm is happening
@@ -535,6 +537,7 @@ private:
 	void					SortActiveEntityList( void );
 	void					ShowTargets( void );
 	void					RunDebugInfo( void );
+	void					CreateAnimationFrames( idPlayer *player );
 
 	void					InitScriptForMap( void );
 
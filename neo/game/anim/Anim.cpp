@@ -33,6 +33,35 @@ If you have questions concerning this license or the applicable additional terms
 
 bool idAnimManager::forceExport = false;
 
+static const int BMD5ANIM_MAGIC		= ( 'B' << 24 ) | ( 'A' << 16 ) | ( 'N' << 8 ) | 'M';
+static const int BMD5ANIM_VERSION	= 1;		// bump when LoadAnim changes the parsed data
+
+/*
+generated/<anim>.bmd5anim is the header followed by raw arrays, each one starts on a
+four byte boundary so the file can be used in place:
+
+	jointAnimInfo_t		joints[ numJoints ]			nameIndex is the offset of the name in the name table
+	char				names[ namesSize ]			zero terminated joint names, padded to four bytes
+	idBounds			bounds[ numFrames ]
+	idJointQuat			baseFrame[ numJoints ]
+	float				componentFrames[ numFrames * numAnimatedComponents ]
+*/
+typedef struct {
+	int						magic;
+	int						version;
+	int						byteOrder;				// native 1, rejects files from a machine with the other order
+	int						boundsSize;
+	int						jointQuatSize;
+	unsigned int			sourceChecksum;			// CRC of the md5anim text
+	int						sourceLength;
+	int						numFrames;
+	int						frameRate;
+	int						numJoints;
+	int						numAnimatedComponents;
+	int						namesSize;
+	float					totaldelta[ 3 ];
+} md5AnimCacheHeader_t;
+
 /***********************************************************************
 
 	idMD5Anim
@@ -50,6 +79,8 @@ idMD5Anim::idMD5Anim() {
 	numJoints	= 0;
 	frameRate	= 24;
 	animLength	= 0;
+	maxTranslationError = 0.0f;
+	maxRotationError = 0.0f;
 	totaldelta.Zero();
 }
 
@@ -74,11 +105,16 @@ void idMD5Anim::Free( void ) {
 	animLength	= 0;
 	name		= "";
 
+	maxTranslationError = 0.0f;
+	maxRotationError = 0.0f;
 	totaldelta.Zero();
 
 	jointInfo.Clear();
 	bounds.Clear();
 	componentFrames.Clear();
+	compressedFrames.Clear();
+	componentScale.Clear();
+	componentBias.Clear();
 }
 
 /*
@@ -126,6 +162,19 @@ const char *idMD5Anim::Name( void ) const {
 	return name;
 }
 
+/*
+=====================
+idMD5Anim::GetCompressionError
+
+Returns false if the frames are stored as full floats
+=====================
+*/
+bool idMD5Anim::GetCompressionError( float &translation, float &rotation ) const {
+	translation = maxTranslationError;
+	rotation = maxRotationError;
+	return ( compressedFrames.Num() > 0 );
+}
+
 /*
 ====================
 idMD5Anim::Reload
@@ -147,6 +196,7 @@ idMD5Anim::Allocated
 */
 size_t idMD5Anim::Allocated( void ) const {
 	size_t	size = bounds.Allocated() + jointInfo.Allocated() + componentFrames.Allocated() + name.Allocated();
+	size += compressedFrames.Allocated() + componentScale.Allocated() + componentBias.Allocated();
 	return size;
 }
 
@@ -161,8 +211,11 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	idToken	token;
 	int		i, j;
 	int		num;
+	void	*buffer;
+	int		length;
 
-	if ( !parser.LoadFile( filename ) ) {
+	length = fileSystem->ReadFile( filename, &buffer, NULL );
+	if ( length < 0 ) {
 		return false;
 	}
 
@@ -170,6 +223,21 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 
 	name = filename;
 
+	const unsigned int checksum = (unsigned int)CRC32_BlockChecksum( buffer, length );
+	if ( g_useCachedAnims.GetBool() && LoadBinaryAnim( checksum, length ) ) {
+		fileSystem->FreeFile( buffer );
+
+		if ( g_compressAnims.GetBool() ) {
+			CompressFrames();
+		}
+		return true;
+	}
+
+	if ( !parser.LoadMemory( (const char *)buffer, length, filename ) ) {
+		fileSystem->FreeFile( buffer );
+		return false;
+	}
+
 	parser.ExpectTokenString( MD5_VERSION_STRING );
 	version = parser.ParseInt();
 	if ( version != MD5_VERSION ) {
@@ -320,13 +388,359 @@ bool idMD5Anim::LoadAnim( const char *filename ) {
 	}
 	baseFrame[ 0 ].t.Zero();
 
+	parser.FreeSource();
+	fileSystem->FreeFile( buffer );
+
 	// we don't count last frame because it would cause a 1 frame pause at the end
 	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
 
+	if ( g_useCachedAnims.GetBool() ) {
+		WriteBinaryAnim( checksum, length );
+	}
+
+	if ( g_compressAnims.GetBool() ) {
+		CompressFrames();
+	}
+
 	// done
 	return true;
 }
 
+/*
+====================
+MD5Anim_BinaryFileName
+====================
+*/
+static void MD5Anim_BinaryFileName( const char *animName, idStr &fileName ) {
+	fileName = "generated/";
+	fileName += animName;
+	fileName.SetFileExtension( "bmd5anim" );
+}
+
+/*
+====================
+MD5Anim_CacheBlock
+
+Returns the next count elements of the cache file, or NULL if the file is too short
+====================
+*/
+static const byte *MD5Anim_CacheBlock( const byte *&data, const byte *end, int count, int elementSize ) {
+	if ( count < 0 || count > ( end - data ) / elementSize ) {
+		return NULL;
+	}
+	const byte *block = data;
+	data += count * elementSize;
+	return block;
+}
+
+/*
+====================
+idMD5Anim::LoadBinaryAnim
+
+The anim is read from generated/<anim>.bmd5anim with a single file read.  The cache
+is keyed on a checksum of the md5anim text, not the timestamp, so repacking a pk4
+doesn't invalidate it but any edit to the text does.
+====================
+*/
+bool idMD5Anim::LoadBinaryAnim( unsigned int sourceChecksum, int sourceLength ) {
+	idStr	fileName;
+	void	*buffer;
+
+	MD5Anim_BinaryFileName( name, fileName );
+
+	int length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	bool valid = ReadBinaryAnim( (const byte *)buffer, length, sourceChecksum, sourceLength );
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		gameLocal.DPrintf( "%s is out of date\n", fileName.c_str() );
+		idStr animName = name;
+		Free();
+		name = animName;
+	}
+	return valid;
+}
+
+/*
+====================
+idMD5Anim::ReadBinaryAnim
+
+Applies the same checks as the text parse, so a corrupt cache is rejected instead of
+producing an invalid anim
+====================
+*/
+bool idMD5Anim::ReadBinaryAnim( const byte *data, int length, unsigned int sourceChecksum, int sourceLength ) {
+	md5AnimCacheHeader_t	header;
+	const byte				*end = data + length;
+	int						i;
+
+	if ( length < (int)sizeof( header ) ) {
+		return false;
+	}
+	memcpy( &header, data, sizeof( header ) );
+	data += sizeof( header );
+
+	if ( header.magic != BMD5ANIM_MAGIC || header.version != BMD5ANIM_VERSION || header.byteOrder != 1 ||
+			header.boundsSize != sizeof( idBounds ) || header.jointQuatSize != sizeof( idJointQuat ) ) {
+		return false;
+	}
+	if ( header.sourceChecksum != sourceChecksum || header.sourceLength != sourceLength ) {
+		return false;
+	}
+	if ( header.numFrames <= 0 || header.numJoints <= 0 || header.frameRate <= 0 ||
+			header.numAnimatedComponents < 0 || header.numAnimatedComponents > header.numJoints * 6 ) {
+		return false;
+	}
+
+	const jointAnimInfo_t *cachedJoints = (const jointAnimInfo_t *)MD5Anim_CacheBlock( data, end, header.numJoints, sizeof( jointAnimInfo_t ) );
+	const char *names = (const char *)MD5Anim_CacheBlock( data, end, header.namesSize, 1 );
+	const byte *cachedBounds = MD5Anim_CacheBlock( data, end, header.numFrames, sizeof( idBounds ) );
+	const byte *cachedBaseFrame = MD5Anim_CacheBlock( data, end, header.numJoints, sizeof( idJointQuat ) );
+	if ( !cachedJoints || !names || !cachedBounds || !cachedBaseFrame ) {
+		return false;
+	}
+	if ( header.numAnimatedComponents > 0 && header.numFrames > 0x7fffffff / header.numAnimatedComponents ) {
+		return false;
+	}
+	const byte *cachedFrames = MD5Anim_CacheBlock( data, end, header.numFrames * header.numAnimatedComponents, sizeof( float ) );
+	if ( !cachedFrames ) {
+		return false;
+	}
+
+	numFrames = header.numFrames;
+	numJoints = header.numJoints;
+	frameRate = header.frameRate;
+	numAnimatedComponents = header.numAnimatedComponents;
+	totaldelta.Set( header.totaldelta[ 0 ], header.totaldelta[ 1 ], header.totaldelta[ 2 ] );
+
+	jointInfo.SetGranularity( 1 );
+	jointInfo.SetNum( numJoints );
+	for( i = 0; i < numJoints; i++ ) {
+		const jointAnimInfo_t &joint = cachedJoints[ i ];
+
+		if ( joint.nameIndex < 0 || joint.nameIndex >= header.namesSize || !memchr( names + joint.nameIndex, 0, header.namesSize - joint.nameIndex ) ) {
+			return false;
+		}
+		if ( joint.parentNum >= i || ( i != 0 && joint.parentNum < 0 ) || ( joint.animBits & ~63 ) ) {
+			return false;
+		}
+		if ( ( numAnimatedComponents > 0 ) && ( ( joint.firstComponent < 0 ) || ( joint.firstComponent >= numAnimatedComponents ) ) ) {
+			return false;
+		}
+
+		jointInfo[ i ] = joint;
+		jointInfo[ i ].nameIndex = animationLib.JointIndex( names + joint.nameIndex );
+	}
+
+	bounds.SetGranularity( 1 );
+	bounds.SetNum( numFrames );
+	memcpy( bounds.Ptr(), cachedBounds, numFrames * sizeof( bounds[ 0 ] ) );
+
+	baseFrame.SetGranularity( 1 );
+	baseFrame.SetNum( numJoints );
+	memcpy( baseFrame.Ptr(), cachedBaseFrame, numJoints * sizeof( baseFrame[ 0 ] ) );
+
+	componentFrames.SetGranularity( 1 );
+	componentFrames.SetNum( numAnimatedComponents * numFrames );
+	memcpy( componentFrames.Ptr(), cachedFrames, numAnimatedComponents * numFrames * sizeof( componentFrames[ 0 ] ) );
+
+	// we don't count last frame because it would cause a 1 frame pause at the end
+	animLength = ( ( numFrames - 1 ) * 1000 + frameRate - 1 ) / frameRate;
+
+	return true;
+}
+
+/*
+====================
+idMD5Anim::WriteBinaryAnim
+
+Written from the parsed anim, so the root joint already has the total delta removed
+====================
+*/
+void idMD5Anim::WriteBinaryAnim( unsigned int sourceChecksum, int sourceLength ) const {
+	md5AnimCacheHeader_t	header;
+	idList<jointAnimInfo_t>	cachedJoints;
+	idList<char>			names;
+	idStr					fileName;
+	int						i;
+
+	MD5Anim_BinaryFileName( name, fileName );
+
+	idFile *file = fileSystem->OpenFileWrite( fileName, "fs_basepath" );
+	if ( file == NULL ) {
+		// the base path may be read only, the anim is simply parsed every time
+		gameLocal.DPrintf( "couldn't write anim cache file %s\n", fileName.c_str() );
+		return;
+	}
+
+	cachedJoints.SetNum( numJoints );
+	for( i = 0; i < numJoints; i++ ) {
+		const char *jointName = animationLib.JointName( jointInfo[ i ].nameIndex );
+
+		cachedJoints[ i ] = jointInfo[ i ];
+		cachedJoints[ i ].nameIndex = names.Num();
+		do {
+			names.Append( *jointName );
+		} while ( *jointName++ );
+	}
+	while ( names.Num() & 3 ) {
+		names.Append( 0 );
+	}
+
+	memset( &header, 0, sizeof( header ) );
+	header.magic = BMD5ANIM_MAGIC;
+	header.version = BMD5ANIM_VERSION;
+	header.byteOrder = 1;
+	header.boundsSize = sizeof( idBounds );
+	header.jointQuatSize = sizeof( idJointQuat );
+	header.sourceChecksum = sourceChecksum;
+	header.sourceLength = sourceLength;
+	header.numFrames = numFrames;
+	header.frameRate = frameRate;
+	header.numJoints = numJoints;
+	header.numAnimatedComponents = numAnimatedComponents;
+	header.namesSize = names.Num();
+	header.totaldelta[ 0 ] = totaldelta.x;
+	header.totaldelta[ 1 ] = totaldelta.y;
+	header.totaldelta[ 2 ] = totaldelta.z;
+
+	file->Write( &header, sizeof( header ) );
+	file->Write( cachedJoints.Ptr(), cachedJoints.Num() * sizeof( cachedJoints[ 0 ] ) );
+	file->Write( names.Ptr(), names.Num() );
+	file->Write( bounds.Ptr(), bounds.Num() * sizeof( bounds[ 0 ] ) );
+	file->Write( baseFrame.Ptr(), baseFrame.Num() * sizeof( baseFrame[ 0 ] ) );
+	file->Write( componentFrames.Ptr(), componentFrames.Num() * sizeof( componentFrames[ 0 ] ) );
+
+	fileSystem->CloseFile( file );
+}
+
+/*
+====================
+MD5Anim_JointFromComponents
+
+Replaces the animated parts of the joint with the frame components
+====================
+*/
+static void MD5Anim_JointFromComponents( idJointQuat &joint, const float *jointframe, int animBits ) {
+	if ( animBits & ANIM_TX ) {
+		joint.t.x = *jointframe++;
+	}
+	if ( animBits & ANIM_TY ) {
+		joint.t.y = *jointframe++;
+	}
+	if ( animBits & ANIM_TZ ) {
+		joint.t.z = *jointframe++;
+	}
+	if ( animBits & ( ANIM_QX | ANIM_QY | ANIM_QZ ) ) {
+		if ( animBits & ANIM_QX ) {
+			joint.q.x = *jointframe++;
+		}
+		if ( animBits & ANIM_QY ) {
+			joint.q.y = *jointframe++;
+		}
+		if ( animBits & ANIM_QZ ) {
+			joint.q.z = *jointframe;
+		}
+		joint.q.w = joint.q.CalcW();
+	}
+}
+
+/*
+====================
+idMD5Anim::CompressFrames
+
+Quantizes every animated component to 16 bits over the range it covers in the
+anim and releases the float frames.  The largest translation and rotation error
+of any joint in any frame is kept for listAnims.
+====================
+*/
+void idMD5Anim::CompressFrames( void ) {
+	int		i, j;
+	float	*decoded;
+
+	if ( !numAnimatedComponents ) {
+		return;
+	}
+
+	componentScale.SetGranularity( 1 );
+	componentScale.SetNum( numAnimatedComponents );
+	componentBias.SetGranularity( 1 );
+	componentBias.SetNum( numAnimatedComponents );
+	compressedFrames.SetGranularity( 1 );
+	compressedFrames.SetNum( numAnimatedComponents * numFrames );
+
+	for( j = 0; j < numAnimatedComponents; j++ ) {
+		float minValue = componentFrames[ j ];
+		float maxValue = componentFrames[ j ];
+		for( i = 1; i < numFrames; i++ ) {
+			const float value = componentFrames[ numAnimatedComponents * i + j ];
+			minValue = Min( minValue, value );
+			maxValue = Max( maxValue, value );
+		}
+
+		componentBias[ j ] = minValue;
+		componentScale[ j ] = ( maxValue - minValue ) * ( 1.0f / 65535.0f );
+		const float invScale = ( componentScale[ j ] > 0.0f ) ? 1.0f / componentScale[ j ] : 0.0f;
+
+		for( i = 0; i < numFrames; i++ ) {
+			const int index = numAnimatedComponents * i + j;
+			const int q = idMath::Ftoi( ( componentFrames[ index ] - minValue ) * invScale + 0.5f );
+			compressedFrames[ index ] = (unsigned short)idMath::ClampInt( 0, 65535, q );
+		}
+	}
+
+	// measure the error of the decoded joints against the original ones
+	maxTranslationError = 0.0f;
+	maxRotationError = 0.0f;
+	decoded = (float *)_alloca16( numAnimatedComponents * sizeof( decoded[ 0 ] ) );
+	for( i = 0; i < numFrames; i++ ) {
+		const float *original = &componentFrames[ numAnimatedComponents * i ];
+		GetFrameComponents( i, 0, numAnimatedComponents, decoded );
+
+		for( j = 0; j < numJoints; j++ ) {
+			const int animBits = jointInfo[ j ].animBits;
+			if ( !animBits ) {
+				continue;
+			}
+
+			idJointQuat joint1 = baseFrame[ j ];
+			idJointQuat joint2 = baseFrame[ j ];
+			MD5Anim_JointFromComponents( joint1, original + jointInfo[ j ].firstComponent, animBits );
+			MD5Anim_JointFromComponents( joint2, decoded + jointInfo[ j ].firstComponent, animBits );
+
+			maxTranslationError = Max( maxTranslationError, ( joint1.t - joint2.t ).Length() );
+
+			const float cosom = idMath::Fabs( joint1.q.x * joint2.q.x + joint1.q.y * joint2.q.y + joint1.q.z * joint2.q.z + joint1.q.w * joint2.q.w );
+			maxRotationError = Max( maxRotationError, RAD2DEG( 2.0f * idMath::ACos( Min( cosom, 1.0f ) ) ) );
+		}
+	}
+
+	componentFrames.Clear();
+}
+
+/*
+====================
+idMD5Anim::GetFrameComponents
+
+Returns numComponents animated components of the frame starting at firstComponent.
+Compressed frames are decoded into buffer, which must have room for numComponents floats.
+====================
+*/
+const float *idMD5Anim::GetFrameComponents( int framenum, int firstComponent, int numComponents, float *buffer ) const {
+	const int offset = numAnimatedComponents * framenum + firstComponent;
+
+	if ( !compressedFrames.Num() ) {
+		return &componentFrames[ offset ];
+	}
+
+	SIMDProcessor->DequantizeComponents( buffer, &compressedFrames[ offset ], &componentScale[ firstComponent ], &componentBias[ firstComponent ], numComponents );
+	return buffer;
+}
+
 /*
 ====================
 idMD5Anim::IncreaseRefs
@@ -442,8 +856,10 @@ void idMD5Anim::GetOrigin( idVec3 &offset, int time, int cyclecount ) const {
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+	float buffer1[ 6 ], buffer2[ 6 ];
+	const int numComponents = Min( 6, numAnimatedComponents - jointInfo[ 0 ].firstComponent );
+	const float *componentPtr1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, numComponents, buffer1 );
+	const float *componentPtr2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, numComponents, buffer2 );
 
 	if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
 		offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
@@ -484,8 +900,10 @@ void idMD5Anim::GetOriginRotation( idQuat &rotation, int time, int cyclecount )
 
 	ConvertTimeToFrame( time, cyclecount, frame );
 
-	const float	*jointframe1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-	const float	*jointframe2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+	float buffer1[ 6 ], buffer2[ 6 ];
+	const int numComponents = Min( 6, numAnimatedComponents - jointInfo[ 0 ].firstComponent );
+	const float	*jointframe1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, numComponents, buffer1 );
+	const float	*jointframe2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, numComponents, buffer2 );
 
 	if ( animBits & ANIM_TX ) {
 		jointframe1++;
@@ -598,8 +1016,10 @@ void idMD5Anim::GetBounds( idBounds &bnds, int time, int cyclecount ) const {
 	// origin position
 	offset = baseFrame[ 0 ].t;
 	if ( jointInfo[ 0 ].animBits & ( ANIM_TX | ANIM_TY | ANIM_TZ ) ) {
-		const float *componentPtr1 = &componentFrames[ numAnimatedComponents * frame.frame1 + jointInfo[ 0 ].firstComponent ];
-		const float *componentPtr2 = &componentFrames[ numAnimatedComponents * frame.frame2 + jointInfo[ 0 ].firstComponent ];
+		float buffer1[ 6 ], buffer2[ 6 ];
+		const int numComponents = Min( 6, numAnimatedComponents - jointInfo[ 0 ].firstComponent );
+		const float *componentPtr1 = GetFrameComponents( frame.frame1, jointInfo[ 0 ].firstComponent, numComponents, buffer1 );
+		const float *componentPtr2 = GetFrameComponents( frame.frame2, jointInfo[ 0 ].firstComponent, numComponents, buffer2 );
 
 		if ( jointInfo[ 0 ].animBits & ANIM_TX ) {
 			offset.x = *componentPtr1 * frame.frontlerp + *componentPtr2 * frame.backlerp;
@@ -652,8 +1072,15 @@ void idMD5Anim::GetInterpolatedFrame( frameBlend_t &frame, idJointQuat *joints,
 	lerpIndex = (int *)_alloca16( baseFrame.Num() * sizeof( lerpIndex[ 0 ] ) );
 	numLerpJoints = 0;
 
-	frame1 = &componentFrames[ frame.frame1 * numAnimatedComponents ];
-	frame2 = &componentFrames[ frame.frame2 * numAnimatedComponents ];
+	if ( compressedFrames.Num() ) {
+		float *buffer1 = (float *)_alloca16( numAnimatedComponents * sizeof( buffer1[ 0 ] ) );
+		float *buffer2 = (float *)_alloca16( numAnimatedComponents * sizeof( buffer2[ 0 ] ) );
+		frame1 = GetFrameComponents( frame.frame1, 0, numAnimatedComponents, buffer1 );
+		frame2 = GetFrameComponents( frame.frame2, 0, numAnimatedComponents, buffer2 );
+	} else {
+		frame1 = &componentFrames[ frame.frame1 * numAnimatedComponents ];
+		frame2 = &componentFrames[ frame.frame2 * numAnimatedComponents ];
+	}
 
 	for ( i = 0; i < numIndexes; i++ ) {
 		int j = index[i];
@@ -833,7 +1260,12 @@ void idMD5Anim::GetSingleFrame( int framenum, idJointQuat *joints, const int *in
 		return;
 	}
 
-	frame = &componentFrames[ framenum * numAnimatedComponents ];
+	if ( compressedFrames.Num() ) {
+		float *buffer = (float *)_alloca16( numAnimatedComponents * sizeof( buffer[ 0 ] ) );
+		frame = GetFrameComponents( framenum, 0, numAnimatedComponents, buffer );
+	} else {
+		frame = &componentFrames[ framenum * numAnimatedComponents ];
+	}
 
 	for ( i = 0; i < numIndexes; i++ ) {
 		int j = index[i];
@@ -1046,7 +1478,12 @@ void idAnimManager::ListAnims( void ) const {
 		if ( animptr && *animptr ) {
 			anim = *animptr;
 			s = anim->Size();
-			gameLocal.Printf( "%8d bytes : %2d refs : %s\n", s, anim->NumRefs(), anim->Name() );
+			float translationError, rotationError;
+			if ( anim->GetCompressionError( translationError, rotationError ) ) {
+				gameLocal.Printf( "%8d bytes : %2d refs : %s (max error %.4f units %.4f degrees)\n", s, anim->NumRefs(), anim->Name(), translationError, rotationError );
+			} else {
+				gameLocal.Printf( "%8d bytes : %2d refs : %s\n", s, anim->NumRefs(), anim->Name() );
+			}
 			size += s;
 			num++;
 		}
@@ -228,10 +228,21 @@ private:
 	idList<jointAnimInfo_t>	jointInfo;
 	idList<idJointQuat>		baseFrame;
 	idList<float>			componentFrames;
+	idList<unsigned short>	compressedFrames;		// componentFrames quantized to 16 bits when g_compressAnims is set
+	idList<float>			componentScale;			// per component range of the quantized values
+	idList<float>			componentBias;
+	float					maxTranslationError;	// largest joint translation error caused by the quantization
+	float					maxRotationError;		// largest joint rotation error in degrees
 	idStr					name;
 	idVec3					totaldelta;
 	mutable int				ref_count;
 
+	void					CompressFrames( void );
+	const float *			GetFrameComponents( int framenum, int firstComponent, int numComponents, float *buffer ) const;
+	bool					LoadBinaryAnim( unsigned int sourceChecksum, int sourceLength );
+	bool					ReadBinaryAnim( const byte *data, int length, unsigned int sourceChecksum, int sourceLength );
+	void					WriteBinaryAnim( unsigned int sourceChecksum, int sourceLength ) const;
+
 public:
 							idMD5Anim();
 							~idMD5Anim();
@@ -254,6 +265,7 @@ public:
 	int						NumJoints( void ) const;
 	const idVec3			&TotalMovementDelta( void ) const;
 	const char				*Name( void ) const;
+	bool					GetCompressionError( float &translation, float &rotation ) const;
 
 	void					GetFrameBlend( int framenum, frameBlend_t &frame ) const;	// frame 1 is first frame
 	void					ConvertTimeToFrame( int time, int cyclecount, frameBlend_t &frame ) const;
@@ -515,6 +527,8 @@ public:
 	void						ForceUpdate( void );
 	void						ClearForceUpdate( void );
 	bool						CreateFrame( int animtime, bool force );
+	static void					CreateFrameJob( void *data );
+	bool						ConsumeJobFrame( void );
 	bool						FrameHasChanged( int animtime ) const;
 	void						GetDelta( int fromtime, int totime, idVec3 &delta ) const;
 	bool						GetDeltaRotation( int fromtime, int totime, idMat3 &delta ) const;
@@ -576,6 +590,7 @@ private:
 	mutable bool				stoppedAnimatingUpdate;
 	bool						removeOriginOffset;
 	bool						forceUpdate;
+	bool						jobFrameCreated;		// set when CreateFrameJob made a new frame that hasn't been reported to the renderer
 
 	idBounds					frameBounds;
 
@@ -35,6 +35,9 @@ static const char *channelNames[ ANIM_NumAnimChannels ] = {
 	"all", "torso", "legs", "head", "eyelids"
 };
 
+// at file scope so it is registered before CreateFrame runs in a job
+static idCVar r_showSkel( "r_showSkel", "0", CVAR_RENDERER | CVAR_INTEGER, "", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
+
 /***********************************************************************
 
 	idAnim
@@ -3009,6 +3012,7 @@ idAnimator::idAnimator() {
 	stoppedAnimatingUpdate	= false;
 	removeOriginOffset		= false;
 	forceUpdate				= false;
+	jobFrameCreated			= false;
 
 	frameBounds.Clear();
 
@@ -4161,6 +4165,36 @@ bool idAnimator::FrameHasChanged( int currentTime ) const {
 	return false;
 }
 
+/*
+=====================
+idAnimator::CreateFrameJob
+
+Runs CreateFrame for idGameLocal::CreateAnimationFrames.  Only the animator's own frame
+is written, so the animators of different entities can be processed in parallel.
+A new frame that wasn't reported yet stays flagged until ConsumeJobFrame, the entity
+may have been culled by the renderer since the last job.
+=====================
+*/
+void idAnimator::CreateFrameJob( void *data ) {
+	idAnimator *animator = static_cast<idAnimator *>( data );
+	if ( animator->CreateFrame( gameLocal.time, false ) ) {
+		animator->jobFrameCreated = true;
+	}
+}
+
+/*
+=====================
+idAnimator::ConsumeJobFrame
+
+Returns true once if CreateFrameJob created a new frame
+=====================
+*/
+bool idAnimator::ConsumeJobFrame( void ) {
+	bool created = jobFrameCreated;
+	jobFrameCreated = false;
+	return created;
+}
+
 /*
 =====================
 idAnimator::CreateFrame
@@ -4179,8 +4213,6 @@ bool idAnimator::CreateFrame( int currentTime, bool force ) {
 	const jointMod_t *	jointMod;
 	const idJointQuat *	defaultPose;
 
-	static idCVar		r_showSkel( "r_showSkel", "0", CVAR_RENDERER | CVAR_INTEGER, "", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
-
 	if ( gameLocal.inCinematic && gameLocal.skipCinematic ) {
 		return false;
 	}
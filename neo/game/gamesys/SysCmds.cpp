@@ -1442,6 +1442,44 @@ static void Cmd_ListAnims_f( const idCmdArgs &args ) {
 	}
 }
 
+/*
+==================
+Cmd_BuildMD5Cache_f
+
+Loads every md5mesh and md5anim so the binary caches are written for the ones that
+are missing or out of date
+==================
+*/
+static void Cmd_BuildMD5Cache_f( const idCmdArgs &args ) {
+	idFileList	*files;
+	int			i, numMeshes, numAnims;
+
+	if ( !cvarSystem->GetCVarBool( "r_useCachedModels" ) ) {
+		gameLocal.Warning( "r_useCachedModels is disabled, no md5mesh cache files will be written" );
+	}
+	if ( !g_useCachedAnims.GetBool() ) {
+		gameLocal.Warning( "g_useCachedAnims is disabled, no md5anim cache files will be written" );
+	}
+
+	files = fileSystem->ListFilesTree( "models", "." MD5_MESH_EXT, true );
+	numMeshes = files->GetNumFiles();
+	for( i = 0; i < numMeshes; i++ ) {
+		renderModelManager->FindModel( files->GetFile( i ) );
+	}
+	fileSystem->FreeFileList( files );
+
+	files = fileSystem->ListFilesTree( "models", "." MD5_ANIM_EXT, true );
+	numAnims = files->GetNumFiles();
+	for( i = 0; i < numAnims; i++ ) {
+		// loaded outside of the anim manager so nothing stays in memory
+		idMD5Anim anim;
+		anim.LoadAnim( files->GetFile( i ) );
+	}
+	fileSystem->FreeFileList( files );
+
+	gameLocal.Printf( "checked the cache of %d md5 meshes and %d md5 anims\n", numMeshes, numAnims );
+}
+
 /*
 ==================
 Cmd_AASStats_f
@@ -2354,6 +2392,7 @@ void idGameLocal::InitConsoleCommands( void ) {
 	cmdSystem->AddCommand( "reexportmodels",		Cmd_ReexportModels_f,		CMD_FL_GAME|CMD_FL_CHEAT,	"reexports models", ArgCompletion_DefFile );
 	cmdSystem->AddCommand( "reloadanims",			Cmd_ReloadAnims_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"reloads animations" );
 	cmdSystem->AddCommand( "listAnims",				Cmd_ListAnims_f,			CMD_FL_GAME,				"lists all animations" );
+	cmdSystem->AddCommand( "buildMD5Cache",			Cmd_BuildMD5Cache_f,		CMD_FL_GAME,				"writes the binary cache files of all md5 meshes and anims" );
 	cmdSystem->AddCommand( "aasStats",				Cmd_AASStats_f,				CMD_FL_GAME,				"shows AAS stats" );
 	cmdSystem->AddCommand( "testDamage",			Cmd_TestDamage_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"tests a damage def", idCmdSystem::ArgCompletion_Decl<DECL_ENTITYDEF> );
 	cmdSystem->AddCommand( "weaponSplat",			Cmd_WeaponSplat_f,			CMD_FL_GAME|CMD_FL_CHEAT,	"projects a blood splat on the player weapon" );
@@ -114,6 +114,9 @@ idCVar g_skipParticles(				"g_skipParticles",			"0",			CVAR_GAME | CVAR_BOOL, ""
 
 idCVar g_disasm(					"g_disasm",					"0",			CVAR_GAME | CVAR_BOOL, "disassemble script into base/script/disasm.txt on the local drive when script is compiled" );
 idCVar g_debugBounds(				"g_debugBounds",			"0",			CVAR_GAME | CVAR_BOOL, "checks for models with bounds > 2048" );
+idCVar g_compressAnims(				"g_compressAnims",			"0",			CVAR_GAME | CVAR_BOOL, "store md5 anim frames as 16 bit quantized components, applies to anims loaded afterwards.  listAnims shows the max error of each anim" );
+idCVar g_useCachedAnims(			"g_useCachedAnims",			"1",			CVAR_GAME | CVAR_BOOL, "load md5 anims from generated/*.bmd5anim when the md5anim text is unchanged, and write the cache after parsing the text" );
+idCVar g_parallelAnimation(			"g_parallelAnimation",		"1",			CVAR_GAME | CVAR_BOOL, "create the animation frames of the entities in the view pvs as parallel jobs before rendering" );
 idCVar g_debugAnim(					"g_debugAnim",				"-1",			CVAR_GAME | CVAR_INTEGER, "displays information on which animations are playing on the specified entity number.  set to -1 to disable." );
 idCVar g_debugMove(					"g_debugMove",				"0",			CVAR_GAME | CVAR_BOOL, "" );
 idCVar g_debugDamage(				"g_debugDamage",			"0",			CVAR_GAME | CVAR_BOOL, "" );
@@ -50,6 +50,9 @@ extern idCVar	g_muzzleFlash;
 
 extern idCVar	g_disasm;
 extern idCVar	g_debugBounds;
+extern idCVar	g_compressAnims;
+extern idCVar	g_useCachedAnims;
+extern idCVar	g_parallelAnimation;
 extern idCVar	g_debugAnim;
 extern idCVar	g_debugMove;
 extern idCVar	g_debugDamage;
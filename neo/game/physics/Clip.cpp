@@ -996,6 +996,8 @@ void idClip::TranslationEntities( trace_t &results, const idVec3 &start, const i
 	trace_t trace;
 	const idTraceModel *trm;
 
+	PROFILE_SCOPE( "idClip::TranslationEntities" );
+
 	if ( TestHugeTranslation( results, mdl, start, end, trmAxis ) ) {
 		return;
 	}
@@ -1057,6 +1059,8 @@ bool idClip::Translation( trace_t &results, const idVec3 &start, const idVec3 &e
 	trace_t trace;
 	const idTraceModel *trm;
 
+	PROFILE_SCOPE( "idClip::Translation" );
+
 	if ( TestHugeTranslation( results, mdl, start, end, trmAxis ) ) {
 		return true;
 	}
@@ -1130,6 +1134,8 @@ bool idClip::Rotation( trace_t &results, const idVec3 &start, const idRotation &
 	trace_t trace;
 	const idTraceModel *trm;
 
+	PROFILE_SCOPE( "idClip::Rotation" );
+
 	trm = TraceModelForClipModel( mdl );
 
 	if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
@@ -1200,6 +1206,8 @@ bool idClip::Motion( trace_t &results, const idVec3 &start, const idVec3 &end, c
 	idRotation endRotation;
 	const idTraceModel *trm;
 
+	PROFILE_SCOPE( "idClip::Motion" );
+
 	assert( rotation.GetOrigin() == start );
 
 	if ( TestHugeTranslation( results, mdl, start, end, trmAxis ) ) {
@@ -1427,6 +1435,8 @@ int idClip::Contents( const idVec3 &start, const idClipModel *mdl, const idMat3
 	idBounds traceBounds;
 	const idTraceModel *trm;
 
+	PROFILE_SCOPE( "idClip::Contents" );
+
 	trm = TraceModelForClipModel( mdl );
 
 	if ( !passEntity || passEntity->entityNumber != ENTITYNUM_WORLD ) {
@@ -987,6 +987,64 @@ static idHeap *			mem_heap = NULL;
 static memoryStats_t	mem_total_allocs = { 0, 0x0fffffff, -1, 0 };
 static memoryStats_t	mem_frame_allocs;
 static memoryStats_t	mem_frame_frees;
+static int				mem_threadSafe = 0;
+
+/*
+==================
+Mem_EnableThreadSafety
+
+  enables nest, every enable needs a matching disable
+  only enable or disable while no other thread allocates, or while it is
+  already enabled
+==================
+*/
+void Mem_EnableThreadSafety( bool enable ) {
+	if ( enable ) {
+		mem_threadSafe++;
+	} else {
+		assert( mem_threadSafe > 0 );
+		mem_threadSafe--;
+	}
+}
+
+/*
+==================
+Mem_IsThreadSafe
+==================
+*/
+bool Mem_IsThreadSafe( void ) {
+	return mem_threadSafe > 0;
+}
+
+/*
+==================
+Mem_Lock
+
+  returns true if the lock was taken, which must be passed to Mem_Unlock
+==================
+*/
+static bool Mem_Lock( void ) {
+#ifndef GAME_DLL
+	if ( mem_threadSafe > 0 ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_THREE );
+		return true;
+	}
+#endif
+	return false;
+}
+
+/*
+==================
+Mem_Unlock
+==================
+*/
+static void Mem_Unlock( bool locked ) {
+#ifndef GAME_DLL
+	if ( locked ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_THREE );
+	}
+#endif
+}
 
 /*
 ==================
@@ -1074,8 +1132,10 @@ void *Mem_Alloc( const int size ) {
 #endif
 		return malloc( size );
 	}
+	bool locked = Mem_Lock();
 	void *mem = mem_heap->Allocate( size );
 	Mem_UpdateAllocStats( mem_heap->Msize( mem ) );
+	Mem_Unlock( locked );
 	return mem;
 }
 
@@ -1095,8 +1155,10 @@ void Mem_Free( void *ptr ) {
 		free( ptr );
 		return;
 	}
+	bool locked = Mem_Lock();
 	Mem_UpdateFreeStats( mem_heap->Msize( ptr ) );
  	mem_heap->Free( ptr );
+	Mem_Unlock( locked );
 }
 
 /*
@@ -1114,7 +1176,9 @@ void *Mem_Alloc16( const int size ) {
 #endif
 		return malloc( size );
 	}
+	bool locked = Mem_Lock();
 	void *mem = mem_heap->Allocate16( size );
+	Mem_Unlock( locked );
 	// make sure the memory is 16 byte aligned
 	assert( ( ((int)mem) & 15) == 0 );
 	return mem;
@@ -1138,7 +1202,9 @@ void Mem_Free16( void *ptr ) {
 	}
 	// make sure the memory is 16 byte aligned
 	assert( ( ((int)ptr) & 15) == 0 );
+	bool locked = Mem_Lock();
  	mem_heap->Free16( ptr );
+	Mem_Unlock( locked );
 }
 
 /*
@@ -1576,6 +1642,8 @@ void *Mem_AllocDebugMemory( const int size, const char *fileName, const int line
 		return malloc( size );
 	}
 
+	bool locked = Mem_Lock();
+
 	if ( align16 ) {
 		p = mem_heap->Allocate16( size + sizeof( debugMemory_t ) );
 	}
@@ -1598,6 +1666,8 @@ void *Mem_AllocDebugMemory( const int size, const char *fileName, const int line
 	mem_debugMemory = m;
 	idLib::sys->GetCallStack( m->callStack, MAX_CALLSTACK_DEPTH );
 
+	Mem_Unlock( locked );
+
 	return ( ( (byte *) p ) + sizeof( debugMemory_t ) );
 }
 
@@ -1624,6 +1694,8 @@ void Mem_FreeDebugMemory( void *p, const char *fileName, const int lineNumber, c
 
 	m = (debugMemory_t *) ( ( (byte *) p ) - sizeof( debugMemory_t ) );
 
+	bool locked = Mem_Lock();
+
 	if ( m->size < 0 ) {
 		idLib::common->FatalError( "memory freed twice, first from %s, now from %s", idLib::sys->GetCallStackStr( m->callStack, MAX_CALLSTACK_DEPTH ), idLib::sys->GetCallStackCurStr( MAX_CALLSTACK_DEPTH ) );
 	}
@@ -1652,6 +1724,8 @@ void Mem_FreeDebugMemory( void *p, const char *fileName, const int lineNumber, c
 	else {
  		mem_heap->Free( m );
 	}
+
+	Mem_Unlock( locked );
 }
 
 /*
@@ -60,6 +60,11 @@ void		Mem_Dump_f( const class idCmdArgs &args );
 void		Mem_DumpCompressed_f( const class idCmdArgs &args );
 void		Mem_AllocDefragBlock( void );
 
+// while enabled every zone heap and idStr data allocation is serialized with a
+// critical section, so job functions may allocate memory, enables nest
+void		Mem_EnableThreadSafety( bool enable );
+bool		Mem_IsThreadSafe( void );
+
 
 #ifndef ID_DEBUG_MEMORY
 
@@ -35,6 +35,36 @@ If you have questions concerning this license or the applicable additional terms
 
 #ifdef USE_STRING_DATA_ALLOCATOR
 static idDynamicBlockAlloc<char, 1<<18, 128>	stringDataAllocator;
+
+/*
+============
+StringDataLock
+
+  the allocator gets its blocks with Mem_Alloc16, so it has its own lock that is always taken before the heap lock
+============
+*/
+static bool StringDataLock( void ) {
+#ifndef GAME_DLL
+	if ( Mem_IsThreadSafe() ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_FOUR );
+		return true;
+	}
+#endif
+	return false;
+}
+
+/*
+============
+StringDataUnlock
+============
+*/
+static void StringDataUnlock( bool locked ) {
+#ifndef GAME_DLL
+	if ( locked ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_FOUR );
+	}
+#endif
+}
 #endif
 
 idVec4	g_color_table[16] =
@@ -95,7 +125,9 @@ void idStr::ReAllocate( int amount, bool keepold ) {
 	alloced = newsize;
 
 #ifdef USE_STRING_DATA_ALLOCATOR
+	bool locked = StringDataLock();
 	newbuffer = stringDataAllocator.Alloc( alloced );
+	StringDataUnlock( locked );
 #else
 	newbuffer = new char[ alloced ];
 #endif
@@ -106,7 +138,9 @@ void idStr::ReAllocate( int amount, bool keepold ) {
 
 	if ( data && data != baseBuffer ) {
 #ifdef USE_STRING_DATA_ALLOCATOR
+		bool locked = StringDataLock();
 		stringDataAllocator.Free( data );
+		StringDataUnlock( locked );
 #else
 		delete [] data;
 #endif
@@ -123,7 +157,9 @@ idStr::FreeData
 void idStr::FreeData( void ) {
 	if ( data && data != baseBuffer ) {
 #ifdef USE_STRING_DATA_ALLOCATOR
+		bool locked = StringDataLock();
 		stringDataAllocator.Free( data );
+		StringDataUnlock( locked );
 #else
 		delete[] data;
 #endif
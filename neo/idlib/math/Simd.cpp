@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "Simd_SSE.h"
 #include "Simd_SSE2.h"
 #include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
 #include "Simd_AltiVec.h"
 
 
@@ -75,6 +76,10 @@ void idSIMD::InitProcessor( const char *module, bool forceGeneric ) {
 		if ( !processor ) {
 			if ( ( cpuid & CPUID_ALTIVEC ) ) {
 				processor = new idSIMD_AltiVec;
+#ifdef ID_SIMD_AVX2
+			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) && ( cpuid & CPUID_AVX2 ) && ( cpuid & CPUID_FMA3 ) ) {
+				processor = new idSIMD_AVX2;
+#endif
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) && ( cpuid & CPUID_SSE3 ) ) {
 				processor = new idSIMD_SSE3;
 			} else if ( ( cpuid & CPUID_MMX ) && ( cpuid & CPUID_SSE ) && ( cpuid & CPUID_SSE2 ) ) {
@@ -2282,6 +2287,55 @@ void TestMatXLDLTFactor( void ) {
 	}
 }
 
+/*
+============
+TestDequantizeComponents
+============
+*/
+void TestDequantizeComponents( void ) {
+	int i;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( unsigned short src[COUNT] );
+	ALIGN16( float scale[COUNT] );
+	ALIGN16( float bias[COUNT] );
+	ALIGN16( float fdst0[COUNT] );
+	ALIGN16( float fdst1[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		src[i] = srnd.RandomInt( 65536 );
+		scale[i] = srnd.RandomFloat() * 0.001f;
+		bias[i] = srnd.CRandomFloat() * 100.0f;
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->DequantizeComponents( fdst0, src, scale, bias, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+	PrintClocks( "generic->DequantizeComponents()", COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->DequantizeComponents( fdst1, src, scale, bias, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( idMath::Fabs( fdst0[i] - fdst1[i] ) > 1e-4f ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->DequantizeComponents() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestBlendJoints
@@ -2833,6 +2887,251 @@ void TestOverlayPointCull( void ) {
 	PrintClocks( va( "   simd->OverlayPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
 }
 
+/*
+============
+TestLightPointCull
+============
+*/
+void TestLightPointCull( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( float planeSide[COUNT] );
+	ALIGN16( byte cullBits0[COUNT] );
+	ALIGN16( byte cullBits1[COUNT] );
+	ALIGN16( byte cullBits2[COUNT] );
+	const int frontBits = ( 1 << 1 ) | ( 1 << 4 );
+	const float epsilon = 0.1f;
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	planes[0].SetNormal( idVec3(  1,  0,  0 ) );
+	planes[1].SetNormal( idVec3( -1,  0,  0 ) );
+	planes[2].SetNormal( idVec3(  0,  1,  0 ) );
+	planes[3].SetNormal( idVec3(  0, -1,  0 ) );
+	planes[4].SetNormal( idVec3(  0,  0,  1 ) );
+	planes[5].SetNormal( idVec3(  0,  0, -1 ) );
+	planes[0][3] = -5.3f;
+	planes[1][3] = 5.3f;
+	planes[2][3] = -4.4f;
+	planes[3][3] = 4.4f;
+	planes[4][3] = -3.5f;
+	planes[5][3] = 3.5f;
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+
+	// scalar reference, one pass over the vertices per plane
+	p_generic->Memset( cullBits0, 0, COUNT );
+	for ( j = 0; j < 6; j++ ) {
+		if ( frontBits & ( 1 << j ) ) {
+			continue;
+		}
+		p_generic->Dot( planeSide, planes[j], drawVerts, COUNT );
+		p_generic->CmpLT( cullBits0, j, planeSide, epsilon, COUNT );
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->LightPointCull( cullBits1, planes, frontBits, epsilon, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( cullBits0[i] != cullBits1[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "generic->LightPointCull() %s", result ), COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->LightPointCull( cullBits2, planes, frontBits, epsilon, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( cullBits0[i] != cullBits2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->LightPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestShadowPointCull
+============
+*/
+void TestShadowPointCull( void ) {
+	int i, j;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( idPlane planes[6] );
+	ALIGN16( idDrawVert drawVerts[COUNT] );
+	ALIGN16( float planeSide[COUNT] );
+	ALIGN16( byte side1[COUNT] );
+	ALIGN16( byte side2[COUNT] );
+	ALIGN16( unsigned short pointCull0[COUNT] );
+	ALIGN16( unsigned short pointCull1[COUNT] );
+	ALIGN16( unsigned short pointCull2[COUNT] );
+	const int frontBits = ( 1 << ( 2 + 6 ) ) | ( 1 << ( 5 + 6 ) );
+	const float epsilon = 0.1f;
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	planes[0].SetNormal( idVec3(  1,  0,  0 ) );
+	planes[1].SetNormal( idVec3( -1,  0,  0 ) );
+	planes[2].SetNormal( idVec3(  0,  1,  0 ) );
+	planes[3].SetNormal( idVec3(  0, -1,  0 ) );
+	planes[4].SetNormal( idVec3(  0,  0,  1 ) );
+	planes[5].SetNormal( idVec3(  0,  0, -1 ) );
+	planes[0][3] = -5.3f;
+	planes[1][3] = 5.3f;
+	planes[2][3] = -4.4f;
+	planes[3][3] = 4.4f;
+	planes[4][3] = -3.5f;
+	planes[5][3] = 3.5f;
+
+	for ( i = 0; i < COUNT; i++ ) {
+		for ( j = 0; j < 3; j++ ) {
+			drawVerts[i].xyz[j] = srnd.CRandomFloat() * 10.0f;
+		}
+	}
+
+	// scalar reference, one pass over the vertices per plane
+	p_generic->Memset( side1, 0, COUNT );
+	p_generic->Memset( side2, 0, COUNT );
+	for ( j = 0; j < 6; j++ ) {
+		if ( frontBits & ( 1 << ( j + 6 ) ) ) {
+			continue;
+		}
+		p_generic->Dot( planeSide, planes[j], drawVerts, COUNT );
+		p_generic->CmpLT( side1, j, planeSide, epsilon, COUNT );
+		p_generic->CmpGT( side2, j, planeSide, -epsilon, COUNT );
+	}
+	for ( i = 0; i < COUNT; i++ ) {
+		pointCull0[i] = frontBits | side1[i] | ( side2[i] << 6 );
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_generic->ShadowPointCull( pointCull1, planes, frontBits, epsilon, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( pointCull0[i] != pointCull1[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "generic->ShadowPointCull() %s", result ), COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		p_simd->ShadowPointCull( pointCull2, planes, frontBits, epsilon, drawVerts, COUNT );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < COUNT; i++ ) {
+		if ( pointCull0[i] != pointCull2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= COUNT ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->ShadowPointCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
+/*
+============
+TestShadowSilEdgeCull
+============
+*/
+void TestShadowSilEdgeCull( void ) {
+	int i, num0, num1, num2;
+	TIME_TYPE start, end, bestClocksGeneric, bestClocksSIMD;
+	ALIGN16( silEdge_t silEdges[COUNT] );
+	ALIGN16( byte faceCastsShadow[COUNT+1] );
+	ALIGN16( unsigned short pointCull[COUNT] );
+	ALIGN16( int silIndexes0[COUNT] );
+	ALIGN16( int silIndexes1[COUNT] );
+	ALIGN16( int silIndexes2[COUNT] );
+	const char *result;
+
+	idRandom srnd( RANDOM_SEED );
+
+	for ( i = 0; i < COUNT; i++ ) {
+		silEdges[i].p1 = srnd.RandomInt( COUNT + 1 );
+		silEdges[i].p2 = srnd.RandomInt( COUNT + 1 );
+		silEdges[i].v1 = srnd.RandomInt( COUNT );
+		silEdges[i].v2 = srnd.RandomInt( COUNT );
+		faceCastsShadow[i] = srnd.RandomInt( 2 );
+		// mostly inside with an occasional point clearly outside a plane
+		pointCull[i] = 0xfc0 ^ ( ( srnd.RandomInt( 4 ) == 0 ) << ( 6 + srnd.RandomInt( 6 ) ) );
+	}
+	faceCastsShadow[COUNT] = 1;
+
+	// scalar reference
+	for ( num0 = 0, i = 0; i < COUNT; i++ ) {
+		const silEdge_t &sil = silEdges[i];
+		if ( !( faceCastsShadow[sil.p1] ^ faceCastsShadow[sil.p2] ) ) {
+			continue;
+		}
+		if ( ( pointCull[sil.v1] ^ 0xfc0 ) & ( pointCull[sil.v2] ^ 0xfc0 ) & 0xfc0 ) {
+			continue;
+		}
+		silIndexes0[num0++] = i;
+	}
+
+	bestClocksGeneric = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		num1 = p_generic->ShadowSilEdgeCull( silIndexes1, silEdges, COUNT, faceCastsShadow, pointCull );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksGeneric );
+	}
+
+	for ( i = 0; i < num0; i++ ) {
+		if ( silIndexes0[i] != silIndexes1[i] ) {
+			break;
+		}
+	}
+	result = ( i >= num0 && num0 == num1 ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "generic->ShadowSilEdgeCull() %s", result ), COUNT, bestClocksGeneric );
+
+	bestClocksSIMD = 0;
+	for ( i = 0; i < NUMTESTS; i++ ) {
+		StartRecordTime( start );
+		num2 = p_simd->ShadowSilEdgeCull( silIndexes2, silEdges, COUNT, faceCastsShadow, pointCull );
+		StopRecordTime( end );
+		GetBest( start, end, bestClocksSIMD );
+	}
+
+	for ( i = 0; i < num0; i++ ) {
+		if ( silIndexes0[i] != silIndexes2[i] ) {
+			break;
+		}
+	}
+	result = ( i >= num0 && num0 == num2 ) ? "ok" : S_COLOR_RED"X";
+	PrintClocks( va( "   simd->ShadowSilEdgeCull() %s", result ), COUNT, bestClocksSIMD, bestClocksGeneric );
+}
+
 /*
 ============
 TestDeriveTriPlanes
@@ -4013,6 +4312,14 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 				return;
 			}
 			p_simd = new idSIMD_SSE3();
+#ifdef ID_SIMD_AVX2
+		} else if ( idStr::Icmp( argString, "AVX2" ) == 0 ) {
+			if ( !( cpuid & CPUID_MMX ) || !( cpuid & CPUID_SSE ) || !( cpuid & CPUID_SSE2 ) || !( cpuid & CPUID_SSE3 ) || !( cpuid & CPUID_AVX2 ) || !( cpuid & CPUID_FMA3 ) ) {
+				common->Printf( "CPU does not support MMX & SSE & SSE2 & SSE3 & AVX2 & FMA\n" );
+				return;
+			}
+			p_simd = new idSIMD_AVX2();
+#endif
 		} else if ( idStr::Icmp( argString, "AltiVec" ) == 0 ) {
 			if ( !( cpuid & CPUID_ALTIVEC ) ) {
 				common->Printf( "CPU does not support AltiVec\n" );
@@ -4020,7 +4327,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 			}
 			p_simd = new idSIMD_AltiVec();
 		} else {
-			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AltiVec\n" );
+			common->Printf( "invalid argument, use: MMX, 3DNow, SSE, SSE2, SSE3, AVX2, AltiVec\n" );
 			return;
 		}
 	}
@@ -4058,6 +4365,7 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 
 	idLib::common->Printf("====================================\n" );
 
+	TestDequantizeComponents();
 	TestBlendJoints();
 	TestConvertJointQuatsToJointMats();
 	TestConvertJointMatsToJointQuats();
@@ -4067,6 +4375,9 @@ void idSIMD::Test_f( const idCmdArgs &args ) {
 	TestTracePointCull();
 	TestDecalPointCull();
 	TestOverlayPointCull();
+	TestLightPointCull();
+	TestShadowPointCull();
+	TestShadowSilEdgeCull();
 	TestDeriveTriPlanes();
 	TestDeriveTangents();
 	TestDeriveUnsmoothedTangents();
@@ -80,6 +80,7 @@ class idDrawVert;
 class idJointQuat;
 class idJointMat;
 struct dominantTri_s;
+struct silEdge_s;
 
 const int MIXBUFFER_SAMPLES = 4096;
 
@@ -170,6 +171,7 @@ public:
 	virtual bool VPCALL MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const int n ) = 0;
 
 	// rendering
+	virtual void VPCALL DequantizeComponents( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) = 0;
 	virtual void VPCALL BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) = 0;
 	virtual void VPCALL ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) = 0;
 	virtual void VPCALL ConvertJointMatsToJointQuats( idJointQuat *jointQuats, const idJointMat *jointMats, const int numJoints ) = 0;
@@ -179,6 +181,9 @@ public:
 	virtual void VPCALL TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
 	virtual void VPCALL OverlayPointCull( byte *cullBits, idVec2 *texCoords, const idPlane *planes, const idDrawVert *verts, const int numVerts ) = 0;
+	virtual void VPCALL LightPointCull( byte *cullBits, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) = 0;
+	virtual void VPCALL ShadowPointCull( unsigned short *pointCull, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) = 0;
+	virtual int  VPCALL ShadowSilEdgeCull( int *silIndexes, const silEdge_s *silEdges, const int numSilEdges, const byte *faceCastsShadow, const unsigned short *pointCull ) = 0;
 	virtual void VPCALL DeriveTriPlanes( idPlane *planes, const idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) = 0;
 	virtual void VPCALL DeriveUnsmoothedTangents( idDrawVert *verts, const dominantTri_s *dominantTris, const int numVerts ) = 0;
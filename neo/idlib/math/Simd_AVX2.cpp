@@ -0,0 +1,1235 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company. 
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).  
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../precompiled.h"
+#pragma hdrstop
+
+#include "Simd_Generic.h"
+#include "Simd_MMX.h"
+#include "Simd_SSE.h"
+#include "Simd_SSE2.h"
+#include "Simd_SSE3.h"
+#include "Simd_AVX2.h"
+
+
+//===============================================================
+//
+//	AVX2 & FMA implementation of idSIMDProcessor
+//
+//===============================================================
+
+#ifdef ID_SIMD_AVX2
+
+/*
+
+	Everything below is only ever executed after idSIMD::InitProcessor
+	verified that both the CPU and the OS support AVX2 and FMA, so the
+	whole remainder of this file is allowed to use these instructions.
+
+	Each kernel processes eight elements at a time and hands the left
+	over elements to the generic implementation, unless the kernel has
+	state that is carried between elements in which case the last batch
+	is padded instead.
+
+*/
+
+#if defined(__clang__)
+#pragma clang attribute push( __attribute__(( target( "avx,avx2,fma" ) )), apply_to = function )
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target( "avx,avx2,fma" )
+#endif
+
+#include <immintrin.h>
+
+#define DRAWVERT_STRIDE		( sizeof( idDrawVert ) / sizeof( float ) )
+#define JOINTQUAT_STRIDE	( sizeof( idJointQuat ) / sizeof( float ) )
+
+/*
+============
+AVX2_HorizontalMin
+============
+*/
+static ID_INLINE float AVX2_HorizontalMin( const __m256 v ) {
+	__m128 m = _mm_min_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_min_ps( m, _mm_movehl_ps( m, m ) );
+	m = _mm_min_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( m );
+}
+
+/*
+============
+AVX2_HorizontalMax
+============
+*/
+static ID_INLINE float AVX2_HorizontalMax( const __m256 v ) {
+	__m128 m = _mm_max_ps( _mm256_castps256_ps128( v ), _mm256_extractf128_ps( v, 1 ) );
+	m = _mm_max_ps( m, _mm_movehl_ps( m, m ) );
+	m = _mm_max_ss( m, _mm_shuffle_ps( m, m, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	return _mm_cvtss_f32( m );
+}
+
+/*
+============
+AVX2_SignBit
+
+  returns 1 in every lane with the float sign bit set and 0 otherwise
+============
+*/
+static ID_INLINE __m256i AVX2_SignBit( const __m256 v ) {
+	return _mm256_srli_epi32( _mm256_castps_si256( v ), 31 );
+}
+
+/*
+============
+AVX2_StoreBytes
+
+  stores the low byte of each of the eight lanes
+============
+*/
+static ID_INLINE void AVX2_StoreBytes( byte *dst, const __m256i v ) {
+	__m256i w = _mm256_packus_epi32( v, v );
+	w = _mm256_packus_epi16( w, w );
+	__m128i b = _mm_unpacklo_epi32( _mm256_castsi256_si128( w ), _mm256_extracti128_si256( w, 1 ) );
+	_mm_storel_epi64( (__m128i *) dst, b );
+}
+
+/*
+============
+AVX2_RSqrt
+
+  reciprocal square root with one Newton-Raphson iteration, x == 0 yields a huge number like idMath::RSqrt
+============
+*/
+static ID_INLINE __m256 AVX2_RSqrt( __m256 x ) {
+	x = _mm256_max_ps( x, _mm256_set1_ps( 1e-30f ) );
+	const __m256 r = _mm256_rsqrt_ps( x );
+	const __m256 hx = _mm256_mul_ps( x, _mm256_set1_ps( 0.5f ) );
+	return _mm256_mul_ps( r, _mm256_fnmadd_ps( _mm256_mul_ps( hx, r ), r, _mm256_set1_ps( 1.5f ) ) );
+}
+
+/*
+============
+AVX2_DrawVertOffsets
+
+  float offsets of eight consecutive idDrawVerts
+============
+*/
+static ID_INLINE __m256i AVX2_DrawVertOffsets( void ) {
+	return _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( DRAWVERT_STRIDE ) );
+}
+
+/*
+============
+AVX2_StoreShorts
+
+  stores the low 16 bits of each of the eight lanes
+============
+*/
+static ID_INLINE void AVX2_StoreShorts( unsigned short *dst, const __m256i v ) {
+	const __m256i w = _mm256_permute4x64_epi64( _mm256_packus_epi32( v, v ), _MM_SHUFFLE( 3, 1, 2, 0 ) );
+	_mm_storeu_si128( (__m128i *) dst, _mm256_castsi256_si128( w ) );
+}
+
+/*
+============
+AVX2_GatherBytes
+
+  gathers src[index] for eight indexes, only reads the aligned dwords that hold
+  the bytes so a gather never touches memory past the end of the array
+============
+*/
+static ID_INLINE __m256i AVX2_GatherBytes( const byte *src, const __m256i index ) {
+	const int misalign = (int)( (uintptr_t)src & 3 );
+	const __m256i ofs = _mm256_add_epi32( index, _mm256_set1_epi32( misalign ) );
+	const __m256i dwords = _mm256_i32gather_epi32( (const int *)( src - misalign ), _mm256_srli_epi32( ofs, 2 ), 4 );
+	const __m256i shift = _mm256_slli_epi32( _mm256_and_si256( ofs, _mm256_set1_epi32( 3 ) ), 3 );
+	return _mm256_and_si256( _mm256_srlv_epi32( dwords, shift ), _mm256_set1_epi32( 0xFF ) );
+}
+
+/*
+============
+AVX2_GatherShorts
+
+  same as AVX2_GatherBytes for an array of 16 bit values
+============
+*/
+static ID_INLINE __m256i AVX2_GatherShorts( const unsigned short *src, const __m256i index ) {
+	const int misalign = (int)( (uintptr_t)src & 3 );
+	const __m256i ofs = _mm256_add_epi32( _mm256_slli_epi32( index, 1 ), _mm256_set1_epi32( misalign ) );
+	const __m256i dwords = _mm256_i32gather_epi32( (const int *)( (const byte *)src - misalign ), _mm256_srli_epi32( ofs, 2 ), 4 );
+	const __m256i shift = _mm256_slli_epi32( _mm256_and_si256( ofs, _mm256_set1_epi32( 3 ) ), 3 );
+	return _mm256_and_si256( _mm256_srlv_epi32( dwords, shift ), _mm256_set1_epi32( 0xFFFF ) );
+}
+
+/*
+============
+idSIMD_AVX2::GetName
+============
+*/
+const char * idSIMD_AVX2::GetName( void ) const {
+	return "MMX & SSE & SSE2 & SSE3 & AVX2 & FMA";
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( float &min, float &max, const float *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const __m256 v = _mm256_loadu_ps( src + i );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	min = AVX2_HorizontalMin( vmin );
+	max = AVX2_HorizontalMax( vmax );
+
+	for ( ; i < count; i++ ) {
+		if ( src[i] < min ) {
+			min = src[i];
+		}
+		if ( src[i] > max ) {
+			max = src[i];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec2 &min, idVec2 &max, const idVec2 *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	for ( i = 0; i + 4 <= count; i += 4 ) {
+		const __m256 v = _mm256_loadu_ps( src[i].ToFloatPtr() );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	// lanes alternate between x and y
+	__m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+	m0 = _mm_min_ps( m0, _mm_movehl_ps( m0, m0 ) );
+	m1 = _mm_max_ps( m1, _mm_movehl_ps( m1, m1 ) );
+	_mm_storel_pi( (__m64 *) min.ToFloatPtr(), m0 );
+	_mm_storel_pi( (__m64 *) max.ToFloatPtr(), m1 );
+
+	for ( ; i < count; i++ ) {
+		const idVec2 &v = src[i];
+		if ( v[0] < min[0] ) { min[0] = v[0]; } if ( v[0] > max[0] ) { max[0] = v[0]; }
+		if ( v[1] < min[1] ) { min[1] = v[1]; } if ( v[1] > max[1] ) { max[1] = v[1]; }
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idVec3 *src, const int count ) {
+	__m256 vmin0, vmin1, vmin2, vmax0, vmax1, vmax2;
+	ALIGN16( float mins[24] );
+	ALIGN16( float maxs[24] );
+	int i;
+
+	vmin0 = vmin1 = vmin2 = _mm256_set1_ps( idMath::INFINITY );
+	vmax0 = vmax1 = vmax2 = _mm256_set1_ps( -idMath::INFINITY );
+
+	// eight vectors fill three registers, each register lane always holds the same component
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const float *p = src[i].ToFloatPtr();
+		const __m256 v0 = _mm256_loadu_ps( p + 0 );
+		const __m256 v1 = _mm256_loadu_ps( p + 8 );
+		const __m256 v2 = _mm256_loadu_ps( p + 16 );
+		vmin0 = _mm256_min_ps( vmin0, v0 );
+		vmin1 = _mm256_min_ps( vmin1, v1 );
+		vmin2 = _mm256_min_ps( vmin2, v2 );
+		vmax0 = _mm256_max_ps( vmax0, v0 );
+		vmax1 = _mm256_max_ps( vmax1, v1 );
+		vmax2 = _mm256_max_ps( vmax2, v2 );
+	}
+
+	_mm256_storeu_ps( mins + 0, vmin0 );
+	_mm256_storeu_ps( mins + 8, vmin1 );
+	_mm256_storeu_ps( mins + 16, vmin2 );
+	_mm256_storeu_ps( maxs + 0, vmax0 );
+	_mm256_storeu_ps( maxs + 8, vmax1 );
+	_mm256_storeu_ps( maxs + 16, vmax2 );
+
+	min[0] = min[1] = min[2] = idMath::INFINITY; max[0] = max[1] = max[2] = -idMath::INFINITY;
+	for ( int j = 0; j < 24; j++ ) {
+		const int c = j % 3;
+		if ( mins[j] < min[c] ) {
+			min[c] = mins[j];
+		}
+		if ( maxs[j] > max[c] ) {
+			max[c] = maxs[j];
+		}
+	}
+
+	for ( ; i < count; i++ ) {
+		const idVec3 &v = src[i];
+		if ( v[0] < min[0] ) { min[0] = v[0]; } if ( v[0] > max[0] ) { max[0] = v[0]; }
+		if ( v[1] < min[1] ) { min[1] = v[1]; } if ( v[1] > max[1] ) { max[1] = v[1]; }
+		if ( v[2] < min[2] ) { min[2] = v[2]; } if ( v[2] > max[2] ) { max[2] = v[2]; }
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+
+  the fourth lane of every load is the first texture coordinate of the vertex and is ignored
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	for ( i = 0; i + 2 <= count; i += 2 ) {
+		const __m256 v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[i+0].xyz.ToFloatPtr() ) ),
+															_mm_loadu_ps( src[i+1].xyz.ToFloatPtr() ), 1 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+
+	if ( i < count ) {
+		const __m128 v = _mm_loadu_ps( src[i].xyz.ToFloatPtr() );
+		m0 = _mm_min_ps( m0, v );
+		m1 = _mm_max_ps( m1, v );
+	}
+
+	ALIGN16( float mins[4] );
+	ALIGN16( float maxs[4] );
+	_mm_store_ps( mins, m0 );
+	_mm_store_ps( maxs, m1 );
+	min.Set( mins[0], mins[1], mins[2] );
+	max.Set( maxs[0], maxs[1], maxs[2] );
+}
+
+/*
+============
+idSIMD_AVX2::MinMax
+============
+*/
+void VPCALL idSIMD_AVX2::MinMax( idVec3 &min, idVec3 &max, const idDrawVert *src, const int *indexes, const int count ) {
+	__m256 vmin = _mm256_set1_ps( idMath::INFINITY );
+	__m256 vmax = _mm256_set1_ps( -idMath::INFINITY );
+	int i;
+
+	for ( i = 0; i + 2 <= count; i += 2 ) {
+		const __m256 v = _mm256_insertf128_ps( _mm256_castps128_ps256( _mm_loadu_ps( src[indexes[i+0]].xyz.ToFloatPtr() ) ),
+															_mm_loadu_ps( src[indexes[i+1]].xyz.ToFloatPtr() ), 1 );
+		vmin = _mm256_min_ps( vmin, v );
+		vmax = _mm256_max_ps( vmax, v );
+	}
+
+	__m128 m0 = _mm_min_ps( _mm256_castps256_ps128( vmin ), _mm256_extractf128_ps( vmin, 1 ) );
+	__m128 m1 = _mm_max_ps( _mm256_castps256_ps128( vmax ), _mm256_extractf128_ps( vmax, 1 ) );
+
+	if ( i < count ) {
+		const __m128 v = _mm_loadu_ps( src[indexes[i]].xyz.ToFloatPtr() );
+		m0 = _mm_min_ps( m0, v );
+		m1 = _mm_max_ps( m1, v );
+	}
+
+	ALIGN16( float mins[4] );
+	ALIGN16( float maxs[4] );
+	_mm_store_ps( mins, m0 );
+	_mm_store_ps( maxs, m1 );
+	min.Set( mins[0], mins[1], mins[2] );
+	max.Set( maxs[0], maxs[1], maxs[2] );
+}
+
+/*
+============
+idSIMD_AVX2::DequantizeComponents
+============
+*/
+void VPCALL idSIMD_AVX2::DequantizeComponents( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) {
+	int i;
+
+	for ( i = 0; i + 8 <= count; i += 8 ) {
+		const __m256 q = _mm256_cvtepi32_ps( _mm256_cvtepu16_epi32( _mm_loadu_si128( (const __m128i *) ( src + i ) ) ) );
+		_mm256_storeu_ps( dst + i, _mm256_fmadd_ps( q, _mm256_loadu_ps( scale + i ), _mm256_loadu_ps( bias + i ) ) );
+	}
+
+	if ( i < count ) {
+		idSIMD_Generic::DequantizeComponents( dst + i, src + i, scale + i, bias + i, count - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::BlendJoints
+
+  Slerps eight joints at a time in structure-of-arrays form. Mirrors idQuat::Slerp
+  with idMath::ATan16 and idMath::Sin16, the angles are always in [0, PI/2] so the
+  range reduction of Sin16 is not needed.
+============
+*/
+void VPCALL idSIMD_AVX2::BlendJoints( idJointQuat *joints, const idJointQuat *blendJoints, const float lerp, const int *index, const int numJoints ) {
+	int i, k;
+
+	if ( lerp <= 0.0f ) {
+		return;
+	}
+
+	if ( lerp >= 1.0f ) {
+		for ( i = 0; i < numJoints; i++ ) {
+			const int j = index[i];
+			joints[j] = blendJoints[j];
+		}
+		return;
+	}
+
+	assert( sizeof( idJointQuat ) == 7 * sizeof( float ) );
+
+	const float *fromPtr = joints[0].q.ToFloatPtr();
+	const float *toPtr = blendJoints[0].q.ToFloatPtr();
+
+	const __m256 vLerp = _mm256_set1_ps( lerp );
+	const __m256 vInvLerp = _mm256_set1_ps( 1.0f - lerp );
+	const __m256 vOne = _mm256_set1_ps( 1.0f );
+	const __m256 vHalfPi = _mm256_set1_ps( idMath::HALF_PI );
+	const __m256 vEpsilon = _mm256_set1_ps( 1e-6f );
+	const __m256 vSignBit = _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+	const __m256i vStride = _mm256_set1_epi32( JOINTQUAT_STRIDE );
+
+	ALIGN16( float result[7][8] );
+	ALIGN16( int tailIndex[8] );
+
+	for ( i = 0; i < numJoints; i += 8 ) {
+		const int *batchIndex = index + i;
+		const int numBatch = Min( numJoints - i, 8 );
+
+		// pad the last batch by repeating the last joint, only the valid lanes are written back
+		if ( numBatch < 8 ) {
+			for ( k = 0; k < 8; k++ ) {
+				tailIndex[k] = batchIndex[Min( k, numBatch - 1 )];
+			}
+			batchIndex = tailIndex;
+		}
+
+		const __m256i offsets = _mm256_mullo_epi32( _mm256_loadu_si256( (const __m256i *) batchIndex ), vStride );
+
+		const __m256 fx = _mm256_i32gather_ps( fromPtr + 0, offsets, 4 );
+		const __m256 fy = _mm256_i32gather_ps( fromPtr + 1, offsets, 4 );
+		const __m256 fz = _mm256_i32gather_ps( fromPtr + 2, offsets, 4 );
+		const __m256 fw = _mm256_i32gather_ps( fromPtr + 3, offsets, 4 );
+		__m256 tx = _mm256_i32gather_ps( toPtr + 0, offsets, 4 );
+		__m256 ty = _mm256_i32gather_ps( toPtr + 1, offsets, 4 );
+		__m256 tz = _mm256_i32gather_ps( toPtr + 2, offsets, 4 );
+		__m256 tw = _mm256_i32gather_ps( toPtr + 3, offsets, 4 );
+
+		// take the shortest path
+		__m256 cosom = _mm256_mul_ps( fx, tx );
+		cosom = _mm256_fmadd_ps( fy, ty, cosom );
+		cosom = _mm256_fmadd_ps( fz, tz, cosom );
+		cosom = _mm256_fmadd_ps( fw, tw, cosom );
+		const __m256 sign = _mm256_and_ps( cosom, vSignBit );
+		cosom = _mm256_xor_ps( cosom, sign );
+		tx = _mm256_xor_ps( tx, sign );
+		ty = _mm256_xor_ps( ty, sign );
+		tz = _mm256_xor_ps( tz, sign );
+		tw = _mm256_xor_ps( tw, sign );
+
+		// sinom = 1 / sin( omega ) with two Newton-Raphson iterations like idMath::InvSqrt
+		const __m256 sinSqr = _mm256_max_ps( _mm256_fnmadd_ps( cosom, cosom, vOne ), _mm256_set1_ps( 1e-30f ) );
+		__m256 sinom = _mm256_rsqrt_ps( sinSqr );
+		const __m256 halfSinSqr = _mm256_mul_ps( sinSqr, _mm256_set1_ps( 0.5f ) );
+		sinom = _mm256_mul_ps( sinom, _mm256_fnmadd_ps( _mm256_mul_ps( halfSinSqr, sinom ), sinom, _mm256_set1_ps( 1.5f ) ) );
+		sinom = _mm256_mul_ps( sinom, _mm256_fnmadd_ps( _mm256_mul_ps( halfSinSqr, sinom ), sinom, _mm256_set1_ps( 1.5f ) ) );
+
+		// omega = idMath::ATan16( sin, cos ), both are positive
+		const __m256 sinAngle = _mm256_mul_ps( sinSqr, sinom );
+		const __m256 swap = _mm256_cmp_ps( sinAngle, cosom, _CMP_GT_OQ );
+		const __m256 a = _mm256_div_ps( _mm256_blendv_ps( sinAngle, cosom, swap ), _mm256_blendv_ps( cosom, sinAngle, swap ) );
+		const __m256 s = _mm256_mul_ps( a, a );
+		__m256 p = _mm256_set1_ps( 0.0028662257f );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.0161657367f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.0429096138f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.0752896400f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.1065626393f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.1420889944f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( 0.1999355085f ) );
+		p = _mm256_fmadd_ps( p, s, _mm256_set1_ps( -0.3333314528f ) );
+		p = _mm256_fmadd_ps( p, s, vOne );
+		p = _mm256_mul_ps( p, a );
+		const __m256 omega = _mm256_blendv_ps( p, _mm256_sub_ps( vHalfPi, p ), swap );
+
+		// scale0 = idMath::Sin16( ( 1 - t ) * omega ) * sinom and scale1 = idMath::Sin16( t * omega ) * sinom
+		const __m256 a0 = _mm256_mul_ps( vInvLerp, omega );
+		const __m256 a1 = _mm256_mul_ps( vLerp, omega );
+		const __m256 s0 = _mm256_mul_ps( a0, a0 );
+		const __m256 s1 = _mm256_mul_ps( a1, a1 );
+		__m256 p0 = _mm256_set1_ps( -2.39e-08f );
+		__m256 p1 = p0;
+		p0 = _mm256_fmadd_ps( p0, s0, _mm256_set1_ps( 2.7526e-06f ) );
+		p1 = _mm256_fmadd_ps( p1, s1, _mm256_set1_ps( 2.7526e-06f ) );
+		p0 = _mm256_fmadd_ps( p0, s0, _mm256_set1_ps( -1.98409e-04f ) );
+		p1 = _mm256_fmadd_ps( p1, s1, _mm256_set1_ps( -1.98409e-04f ) );
+		p0 = _mm256_fmadd_ps( p0, s0, _mm256_set1_ps( 8.3333315e-03f ) );
+		p1 = _mm256_fmadd_ps( p1, s1, _mm256_set1_ps( 8.3333315e-03f ) );
+		p0 = _mm256_fmadd_ps( p0, s0, _mm256_set1_ps( -1.666666664e-01f ) );
+		p1 = _mm256_fmadd_ps( p1, s1, _mm256_set1_ps( -1.666666664e-01f ) );
+		p0 = _mm256_fmadd_ps( p0, s0, vOne );
+		p1 = _mm256_fmadd_ps( p1, s1, vOne );
+		__m256 scale0 = _mm256_mul_ps( _mm256_mul_ps( p0, a0 ), sinom );
+		__m256 scale1 = _mm256_mul_ps( _mm256_mul_ps( p1, a1 ), sinom );
+
+		// nearly identical quaternions are interpolated linearly
+		const __m256 linear = _mm256_cmp_ps( _mm256_sub_ps( vOne, cosom ), vEpsilon, _CMP_LE_OQ );
+		scale0 = _mm256_blendv_ps( scale0, vInvLerp, linear );
+		scale1 = _mm256_blendv_ps( scale1, vLerp, linear );
+
+		_mm256_store_ps( result[0], _mm256_fmadd_ps( scale0, fx, _mm256_mul_ps( scale1, tx ) ) );
+		_mm256_store_ps( result[1], _mm256_fmadd_ps( scale0, fy, _mm256_mul_ps( scale1, ty ) ) );
+		_mm256_store_ps( result[2], _mm256_fmadd_ps( scale0, fz, _mm256_mul_ps( scale1, tz ) ) );
+		_mm256_store_ps( result[3], _mm256_fmadd_ps( scale0, fw, _mm256_mul_ps( scale1, tw ) ) );
+
+		// translation
+		for ( k = 0; k < 3; k++ ) {
+			const __m256 f = _mm256_i32gather_ps( fromPtr + 4 + k, offsets, 4 );
+			const __m256 t = _mm256_i32gather_ps( toPtr + 4 + k, offsets, 4 );
+			_mm256_store_ps( result[4+k], _mm256_fmadd_ps( vLerp, _mm256_sub_ps( t, f ), f ) );
+		}
+
+		for ( k = 0; k < numBatch; k++ ) {
+			idJointQuat &joint = joints[batchIndex[k]];
+			joint.q.x = result[0][k];
+			joint.q.y = result[1][k];
+			joint.q.z = result[2][k];
+			joint.q.w = result[3][k];
+			joint.t.x = result[4][k];
+			joint.t.y = result[5][k];
+			joint.t.z = result[6][k];
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ConvertJointQuatsToJointMats
+============
+*/
+void VPCALL idSIMD_AVX2::ConvertJointQuatsToJointMats( idJointMat *jointMats, const idJointQuat *jointQuats, const int numJoints ) {
+	int i, k;
+
+	assert( sizeof( idJointQuat ) == 7 * sizeof( float ) );
+	assert( sizeof( idJointMat ) == 12 * sizeof( float ) );
+
+	const __m256i offsets = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( JOINTQUAT_STRIDE ) );
+	const __m256 vOne = _mm256_set1_ps( 1.0f );
+
+	ALIGN16( float result[12][8] );
+
+	for ( i = 0; i + 8 <= numJoints; i += 8 ) {
+		const float *q = jointQuats[i].q.ToFloatPtr();
+
+		const __m256 x = _mm256_i32gather_ps( q + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( q + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( q + 2, offsets, 4 );
+		const __m256 w = _mm256_i32gather_ps( q + 3, offsets, 4 );
+
+		const __m256 x2 = _mm256_add_ps( x, x );
+		const __m256 y2 = _mm256_add_ps( y, y );
+		const __m256 z2 = _mm256_add_ps( z, z );
+
+		const __m256 xx = _mm256_mul_ps( x, x2 );
+		const __m256 xy = _mm256_mul_ps( x, y2 );
+		const __m256 xz = _mm256_mul_ps( x, z2 );
+		const __m256 yy = _mm256_mul_ps( y, y2 );
+		const __m256 yz = _mm256_mul_ps( y, z2 );
+		const __m256 zz = _mm256_mul_ps( z, z2 );
+		const __m256 wx = _mm256_mul_ps( w, x2 );
+		const __m256 wy = _mm256_mul_ps( w, y2 );
+		const __m256 wz = _mm256_mul_ps( w, z2 );
+
+		// transposed idQuat::ToMat3, see idJointMat::SetRotation
+		_mm256_store_ps( result[ 0], _mm256_sub_ps( vOne, _mm256_add_ps( yy, zz ) ) );
+		_mm256_store_ps( result[ 1], _mm256_add_ps( xy, wz ) );
+		_mm256_store_ps( result[ 2], _mm256_sub_ps( xz, wy ) );
+		_mm256_store_ps( result[ 3], _mm256_i32gather_ps( q + 4, offsets, 4 ) );
+		_mm256_store_ps( result[ 4], _mm256_sub_ps( xy, wz ) );
+		_mm256_store_ps( result[ 5], _mm256_sub_ps( vOne, _mm256_add_ps( xx, zz ) ) );
+		_mm256_store_ps( result[ 6], _mm256_add_ps( yz, wx ) );
+		_mm256_store_ps( result[ 7], _mm256_i32gather_ps( q + 5, offsets, 4 ) );
+		_mm256_store_ps( result[ 8], _mm256_add_ps( xz, wy ) );
+		_mm256_store_ps( result[ 9], _mm256_sub_ps( yz, wx ) );
+		_mm256_store_ps( result[10], _mm256_sub_ps( vOne, _mm256_add_ps( xx, yy ) ) );
+		_mm256_store_ps( result[11], _mm256_i32gather_ps( q + 6, offsets, 4 ) );
+
+		for ( k = 0; k < 8; k++ ) {
+			float *m = jointMats[i+k].ToFloatPtr();
+			m[ 0] = result[ 0][k];
+			m[ 1] = result[ 1][k];
+			m[ 2] = result[ 2][k];
+			m[ 3] = result[ 3][k];
+			m[ 4] = result[ 4][k];
+			m[ 5] = result[ 5][k];
+			m[ 6] = result[ 6][k];
+			m[ 7] = result[ 7][k];
+			m[ 8] = result[ 8][k];
+			m[ 9] = result[ 9][k];
+			m[10] = result[10][k];
+			m[11] = result[11][k];
+		}
+	}
+
+	if ( i < numJoints ) {
+		idSIMD_Generic::ConvertJointQuatsToJointMats( jointMats + i, jointQuats + i, numJoints - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TransformVerts
+
+  The first two rows of the joint matrix are weighted in one 256 bit register
+  and the third row in a 128 bit register, the sums are reduced once per vertex.
+============
+*/
+void VPCALL idSIMD_AVX2::TransformVerts( idDrawVert *verts, const int numVerts, const idJointMat *joints, const idVec4 *weights, const int *index, const int ) {
+	int i, j;
+	const byte *jointsPtr = (byte *)joints;
+
+	for( j = i = 0; i < numVerts; i++ ) {
+		const float *m = (const float *)( jointsPtr + index[j*2+0] );
+		__m256 w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+		__m256 r01 = _mm256_mul_ps( _mm256_loadu_ps( m + 0 ), w );
+		__m128 r2 = _mm_mul_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ) );
+
+		while( index[j*2+1] == 0 ) {
+			j++;
+			m = (const float *)( jointsPtr + index[j*2+0] );
+			w = _mm256_broadcast_ps( (const __m128 *) weights[j].ToFloatPtr() );
+			r01 = _mm256_fmadd_ps( _mm256_loadu_ps( m + 0 ), w, r01 );
+			r2 = _mm_fmadd_ps( _mm_loadu_ps( m + 8 ), _mm256_castps256_ps128( w ), r2 );
+		}
+		j++;
+
+		const __m128 r0 = _mm256_castps256_ps128( r01 );
+		const __m128 r1 = _mm256_extractf128_ps( r01, 1 );
+		const __m128 v = _mm_hadd_ps( _mm_hadd_ps( r0, r1 ), _mm_hadd_ps( r2, r2 ) );
+
+		float *xyz = verts[i].xyz.ToFloatPtr();
+		_mm_storel_pi( (__m64 *) xyz, v );
+		_mm_store_ss( xyz + 2, _mm_movehl_ps( v, v ) );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::TracePointCull
+============
+*/
+void VPCALL idSIMD_AVX2::TracePointCull( byte *cullBits, byte &totalOr, const float radius, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	int i;
+
+	const __m256i offsets = AVX2_DrawVertOffsets();
+	const __m256 vRadius = _mm256_set1_ps( radius );
+	const __m256i vFlip = _mm256_set1_epi32( 0x0F );
+	__m256i vOr = _mm256_setzero_si256();
+
+	const __m256 p0a = _mm256_set1_ps( planes[0][0] ), p0b = _mm256_set1_ps( planes[0][1] ), p0c = _mm256_set1_ps( planes[0][2] ), p0d = _mm256_set1_ps( planes[0][3] );
+	const __m256 p1a = _mm256_set1_ps( planes[1][0] ), p1b = _mm256_set1_ps( planes[1][1] ), p1c = _mm256_set1_ps( planes[1][2] ), p1d = _mm256_set1_ps( planes[1][3] );
+	const __m256 p2a = _mm256_set1_ps( planes[2][0] ), p2b = _mm256_set1_ps( planes[2][1] ), p2c = _mm256_set1_ps( planes[2][2] ), p2d = _mm256_set1_ps( planes[2][3] );
+	const __m256 p3a = _mm256_set1_ps( planes[3][0] ), p3b = _mm256_set1_ps( planes[3][1] ), p3c = _mm256_set1_ps( planes[3][2] ), p3d = _mm256_set1_ps( planes[3][3] );
+
+	for ( i = 0; i + 8 <= numVerts; i += 8 ) {
+		const float *v = verts[i].xyz.ToFloatPtr();
+		const __m256 x = _mm256_i32gather_ps( v + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( v + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( v + 2, offsets, 4 );
+
+		const __m256 d0 = _mm256_fmadd_ps( p0a, x, _mm256_fmadd_ps( p0b, y, _mm256_fmadd_ps( p0c, z, p0d ) ) );
+		const __m256 d1 = _mm256_fmadd_ps( p1a, x, _mm256_fmadd_ps( p1b, y, _mm256_fmadd_ps( p1c, z, p1d ) ) );
+		const __m256 d2 = _mm256_fmadd_ps( p2a, x, _mm256_fmadd_ps( p2b, y, _mm256_fmadd_ps( p2c, z, p2d ) ) );
+		const __m256 d3 = _mm256_fmadd_ps( p3a, x, _mm256_fmadd_ps( p3b, y, _mm256_fmadd_ps( p3c, z, p3d ) ) );
+
+		__m256i bits;
+		bits = AVX2_SignBit( _mm256_add_ps( d0, vRadius ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_add_ps( d1, vRadius ) ), 1 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_add_ps( d2, vRadius ) ), 2 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_add_ps( d3, vRadius ) ), 3 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_sub_ps( d0, vRadius ) ), 4 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_sub_ps( d1, vRadius ) ), 5 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_sub_ps( d2, vRadius ) ), 6 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( AVX2_SignBit( _mm256_sub_ps( d3, vRadius ) ), 7 ) );
+
+		bits = _mm256_xor_si256( bits, vFlip );		// flip lower four bits
+
+		vOr = _mm256_or_si256( vOr, bits );
+		AVX2_StoreBytes( cullBits + i, bits );
+	}
+
+	__m128i o = _mm_or_si128( _mm256_castsi256_si128( vOr ), _mm256_extracti128_si256( vOr, 1 ) );
+	o = _mm_or_si128( o, _mm_srli_si128( o, 8 ) );
+	o = _mm_or_si128( o, _mm_srli_si128( o, 4 ) );
+	byte tOr = (byte) _mm_cvtsi128_si32( o );
+
+	if ( i < numVerts ) {
+		byte tailOr;
+		idSIMD_Generic::TracePointCull( cullBits + i, tailOr, radius, planes, verts + i, numVerts - i );
+		tOr |= tailOr;
+	}
+
+	totalOr = tOr;
+}
+
+/*
+============
+idSIMD_AVX2::DecalPointCull
+============
+*/
+void VPCALL idSIMD_AVX2::DecalPointCull( byte *cullBits, const idPlane *planes, const idDrawVert *verts, const int numVerts ) {
+	int i, p;
+
+	const __m256i offsets = AVX2_DrawVertOffsets();
+	const __m256i vFlip = _mm256_set1_epi32( 0x3F );
+	__m256 pa[6], pb[6], pc[6], pd[6];
+
+	for ( p = 0; p < 6; p++ ) {
+		pa[p] = _mm256_set1_ps( planes[p][0] );
+		pb[p] = _mm256_set1_ps( planes[p][1] );
+		pc[p] = _mm256_set1_ps( planes[p][2] );
+		pd[p] = _mm256_set1_ps( planes[p][3] );
+	}
+
+	for ( i = 0; i + 8 <= numVerts; i += 8 ) {
+		const float *v = verts[i].xyz.ToFloatPtr();
+		const __m256 x = _mm256_i32gather_ps( v + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( v + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( v + 2, offsets, 4 );
+
+#define PLANE_SIGN( n )	AVX2_SignBit( _mm256_fmadd_ps( pa[n], x, _mm256_fmadd_ps( pb[n], y, _mm256_fmadd_ps( pc[n], z, pd[n] ) ) ) )
+		__m256i bits;
+		bits = PLANE_SIGN( 0 );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( PLANE_SIGN( 1 ), 1 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( PLANE_SIGN( 2 ), 2 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( PLANE_SIGN( 3 ), 3 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( PLANE_SIGN( 4 ), 4 ) );
+		bits = _mm256_or_si256( bits, _mm256_slli_epi32( PLANE_SIGN( 5 ), 5 ) );
+#undef PLANE_SIGN
+
+		AVX2_StoreBytes( cullBits + i, _mm256_xor_si256( bits, vFlip ) );		// flip lower 6 bits
+	}
+
+	if ( i < numVerts ) {
+		idSIMD_Generic::DecalPointCull( cullBits + i, planes, verts + i, numVerts - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::LightPointCull
+============
+*/
+void VPCALL idSIMD_AVX2::LightPointCull( byte *cullBits, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) {
+	int i, p, numTestPlanes;
+	__m256 pa[6], pb[6], pc[6], pd[6];
+	__m256i pbit[6];
+
+	for ( numTestPlanes = 0, p = 0; p < 6; p++ ) {
+		if ( frontBits & ( 1 << p ) ) {
+			continue;
+		}
+		pa[numTestPlanes] = _mm256_set1_ps( planes[p][0] );
+		pb[numTestPlanes] = _mm256_set1_ps( planes[p][1] );
+		pc[numTestPlanes] = _mm256_set1_ps( planes[p][2] );
+		pd[numTestPlanes] = _mm256_set1_ps( planes[p][3] );
+		pbit[numTestPlanes] = _mm256_set1_epi32( 1 << p );
+		numTestPlanes++;
+	}
+
+	const __m256i offsets = AVX2_DrawVertOffsets();
+	const __m256 vEpsilon = _mm256_set1_ps( epsilon );
+
+	for ( i = 0; i + 8 <= numVerts; i += 8 ) {
+		const float *v = verts[i].xyz.ToFloatPtr();
+		const __m256 x = _mm256_i32gather_ps( v + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( v + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( v + 2, offsets, 4 );
+
+		__m256i bits = _mm256_setzero_si256();
+		for ( p = 0; p < numTestPlanes; p++ ) {
+			const __m256 d = _mm256_fmadd_ps( pa[p], x, _mm256_fmadd_ps( pb[p], y, _mm256_fmadd_ps( pc[p], z, pd[p] ) ) );
+			const __m256i lt = _mm256_castps_si256( _mm256_cmp_ps( d, vEpsilon, _CMP_LT_OQ ) );
+			bits = _mm256_or_si256( bits, _mm256_and_si256( lt, pbit[p] ) );
+		}
+
+		AVX2_StoreBytes( cullBits + i, bits );
+	}
+
+	if ( i < numVerts ) {
+		idSIMD_Generic::LightPointCull( cullBits + i, planes, frontBits, epsilon, verts + i, numVerts - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ShadowPointCull
+============
+*/
+void VPCALL idSIMD_AVX2::ShadowPointCull( unsigned short *pointCull, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) {
+	int i, p, numTestPlanes;
+	__m256 pa[6], pb[6], pc[6], pd[6];
+	__m256i pbit[6];
+
+	for ( numTestPlanes = 0, p = 0; p < 6; p++ ) {
+		if ( frontBits & ( 1 << ( p + 6 ) ) ) {
+			continue;
+		}
+		pa[numTestPlanes] = _mm256_set1_ps( planes[p][0] );
+		pb[numTestPlanes] = _mm256_set1_ps( planes[p][1] );
+		pc[numTestPlanes] = _mm256_set1_ps( planes[p][2] );
+		pd[numTestPlanes] = _mm256_set1_ps( planes[p][3] );
+		pbit[numTestPlanes] = _mm256_set1_epi32( 1 << p );
+		numTestPlanes++;
+	}
+
+	const __m256i offsets = AVX2_DrawVertOffsets();
+	const __m256 vEpsilon = _mm256_set1_ps( epsilon );
+	const __m256 vNegEpsilon = _mm256_set1_ps( -epsilon );
+	const __m256i vFrontBits = _mm256_set1_epi32( frontBits );
+
+	for ( i = 0; i + 8 <= numVerts; i += 8 ) {
+		const float *v = verts[i].xyz.ToFloatPtr();
+		const __m256 x = _mm256_i32gather_ps( v + 0, offsets, 4 );
+		const __m256 y = _mm256_i32gather_ps( v + 1, offsets, 4 );
+		const __m256 z = _mm256_i32gather_ps( v + 2, offsets, 4 );
+
+		__m256i side1 = _mm256_setzero_si256();
+		__m256i side2 = _mm256_setzero_si256();
+		for ( p = 0; p < numTestPlanes; p++ ) {
+			const __m256 d = _mm256_fmadd_ps( pa[p], x, _mm256_fmadd_ps( pb[p], y, _mm256_fmadd_ps( pc[p], z, pd[p] ) ) );
+			const __m256i lt = _mm256_castps_si256( _mm256_cmp_ps( d, vEpsilon, _CMP_LT_OQ ) );
+			const __m256i gt = _mm256_castps_si256( _mm256_cmp_ps( d, vNegEpsilon, _CMP_GT_OQ ) );
+			side1 = _mm256_or_si256( side1, _mm256_and_si256( lt, pbit[p] ) );
+			side2 = _mm256_or_si256( side2, _mm256_and_si256( gt, pbit[p] ) );
+		}
+
+		const __m256i bits = _mm256_or_si256( vFrontBits, _mm256_or_si256( side1, _mm256_slli_epi32( side2, 6 ) ) );
+		AVX2_StoreShorts( pointCull + i, bits );
+	}
+
+	if ( i < numVerts ) {
+		idSIMD_Generic::ShadowPointCull( pointCull + i, planes, frontBits, epsilon, verts + i, numVerts - i );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::ShadowSilEdgeCull
+============
+*/
+int VPCALL idSIMD_AVX2::ShadowSilEdgeCull( int *silIndexes, const silEdge_s *silEdges, const int numSilEdges, const byte *faceCastsShadow, const unsigned short *pointCull ) {
+	int i, j, num;
+
+	assert( sizeof( silEdge_t ) == 4 * sizeof( int ) );
+
+	const __m256i offsets = _mm256_mullo_epi32( _mm256_setr_epi32( 0, 1, 2, 3, 4, 5, 6, 7 ), _mm256_set1_epi32( 4 ) );
+	const __m256i vInside = _mm256_set1_epi32( 0xfc0 );
+	const __m256i vZero = _mm256_setzero_si256();
+
+	for ( num = 0, i = 0; i + 8 <= numSilEdges; i += 8 ) {
+		const int *e = (const int *)( silEdges + i );
+		const __m256i p1 = _mm256_i32gather_epi32( e + 0, offsets, 4 );
+		const __m256i p2 = _mm256_i32gather_epi32( e + 1, offsets, 4 );
+		const __m256i v1 = _mm256_i32gather_epi32( e + 2, offsets, 4 );
+		const __m256i v2 = _mm256_i32gather_epi32( e + 3, offsets, 4 );
+
+		// the faces on both sides either cast a shadow or both don't
+		const __m256i sameFacing = _mm256_cmpeq_epi32( AVX2_GatherBytes( faceCastsShadow, p1 ), AVX2_GatherBytes( faceCastsShadow, p2 ) );
+
+		// EDGE_CULLED: both points on the negative side of the same plane
+		const __m256i c1 = _mm256_andnot_si256( AVX2_GatherShorts( pointCull, v1 ), vInside );
+		const __m256i c2 = _mm256_andnot_si256( AVX2_GatherShorts( pointCull, v2 ), vInside );
+		const __m256i culled = _mm256_xor_si256( _mm256_cmpeq_epi32( _mm256_and_si256( c1, c2 ), vZero ), _mm256_set1_epi32( -1 ) );
+
+		const int mask = ~_mm256_movemask_ps( _mm256_castsi256_ps( _mm256_or_si256( sameFacing, culled ) ) ) & 0xFF;
+		if ( mask == 0 ) {
+			continue;
+		}
+		for ( j = 0; j < 8; j++ ) {
+			silIndexes[num] = i + j;
+			num += ( mask >> j ) & 1;
+		}
+	}
+
+	if ( i < numSilEdges ) {
+		const int tail = idSIMD_Generic::ShadowSilEdgeCull( silIndexes + num, silEdges + i, numSilEdges - i, faceCastsShadow, pointCull );
+		for ( j = 0; j < tail; j++ ) {
+			silIndexes[num + j] += i;
+		}
+		num += tail;
+	}
+	return num;
+}
+
+/*
+============
+idSIMD_AVX2::DeriveTangents
+
+  Derives the normal and orthogonal tangent vectors for the triangle vertices.
+  The triangle planes and tangents are calculated for eight triangles at a time,
+  the results are then accumulated onto the vertices in the original order.
+============
+*/
+void VPCALL idSIMD_AVX2::DeriveTangents( idPlane *planes, idDrawVert *verts, const int numVerts, const int *indexes, const int numIndexes ) {
+	int i, k;
+
+	bool *used = (bool *)_alloca16( numVerts * sizeof( used[0] ) );
+	memset( used, 0, numVerts * sizeof( used[0] ) );
+
+	const float *vertsPtr = verts[0].xyz.ToFloatPtr();
+	const __m256i triOffsets = _mm256_setr_epi32( 0, 3, 6, 9, 12, 15, 18, 21 );
+	const __m256i vStride = _mm256_set1_epi32( DRAWVERT_STRIDE );
+	const __m256 vSignBit = _mm256_castsi256_ps( _mm256_set1_epi32( 0x80000000 ) );
+
+	ALIGN16( float result[10][8] );
+	ALIGN16( int tailIndexes[3*8] );
+
+	idPlane *planesPtr = planes;
+	for ( i = 0; i < numIndexes; i += 3*8 ) {
+		const int *batchIndexes = indexes + i;
+		const int numBatch = Min( ( numIndexes - i ) / 3, 8 );
+
+		// pad the last batch by repeating the last triangle
+		if ( numBatch < 8 ) {
+			for ( k = 0; k < 8; k++ ) {
+				const int t = Min( k, numBatch - 1 );
+				tailIndexes[k*3+0] = batchIndexes[t*3+0];
+				tailIndexes[k*3+1] = batchIndexes[t*3+1];
+				tailIndexes[k*3+2] = batchIndexes[t*3+2];
+			}
+			batchIndexes = tailIndexes;
+		}
+
+		const __m256i o0 = _mm256_mullo_epi32( _mm256_i32gather_epi32( batchIndexes + 0, triOffsets, 4 ), vStride );
+		const __m256i o1 = _mm256_mullo_epi32( _mm256_i32gather_epi32( batchIndexes + 1, triOffsets, 4 ), vStride );
+		const __m256i o2 = _mm256_mullo_epi32( _mm256_i32gather_epi32( batchIndexes + 2, triOffsets, 4 ), vStride );
+
+		const __m256 ax = _mm256_i32gather_ps( vertsPtr + 0, o0, 4 );
+		const __m256 ay = _mm256_i32gather_ps( vertsPtr + 1, o0, 4 );
+		const __m256 az = _mm256_i32gather_ps( vertsPtr + 2, o0, 4 );
+		const __m256 as = _mm256_i32gather_ps( vertsPtr + 3, o0, 4 );
+		const __m256 at = _mm256_i32gather_ps( vertsPtr + 4, o0, 4 );
+
+		const __m256 d0x = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 0, o1, 4 ), ax );
+		const __m256 d0y = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 1, o1, 4 ), ay );
+		const __m256 d0z = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 2, o1, 4 ), az );
+		const __m256 d0s = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 3, o1, 4 ), as );
+		const __m256 d0t = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 4, o1, 4 ), at );
+
+		const __m256 d1x = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 0, o2, 4 ), ax );
+		const __m256 d1y = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 1, o2, 4 ), ay );
+		const __m256 d1z = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 2, o2, 4 ), az );
+		const __m256 d1s = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 3, o2, 4 ), as );
+		const __m256 d1t = _mm256_sub_ps( _mm256_i32gather_ps( vertsPtr + 4, o2, 4 ), at );
+
+		// normal
+		__m256 nx = _mm256_fmsub_ps( d1y, d0z, _mm256_mul_ps( d1z, d0y ) );
+		__m256 ny = _mm256_fmsub_ps( d1z, d0x, _mm256_mul_ps( d1x, d0z ) );
+		__m256 nz = _mm256_fmsub_ps( d1x, d0y, _mm256_mul_ps( d1y, d0x ) );
+
+		__m256 f = AVX2_RSqrt( _mm256_fmadd_ps( nx, nx, _mm256_fmadd_ps( ny, ny, _mm256_mul_ps( nz, nz ) ) ) );
+		nx = _mm256_mul_ps( nx, f );
+		ny = _mm256_mul_ps( ny, f );
+		nz = _mm256_mul_ps( nz, f );
+
+		_mm256_store_ps( result[0], nx );
+		_mm256_store_ps( result[1], ny );
+		_mm256_store_ps( result[2], nz );
+		_mm256_store_ps( result[3], _mm256_fmadd_ps( nx, ax, _mm256_fmadd_ps( ny, ay, _mm256_mul_ps( nz, az ) ) ) );
+
+		// area sign bit
+		const __m256 signBit = _mm256_and_ps( _mm256_fmsub_ps( d0s, d1t, _mm256_mul_ps( d0t, d1s ) ), vSignBit );
+
+		// first tangent
+		__m256 tx = _mm256_fmsub_ps( d0x, d1t, _mm256_mul_ps( d0t, d1x ) );
+		__m256 ty = _mm256_fmsub_ps( d0y, d1t, _mm256_mul_ps( d0t, d1y ) );
+		__m256 tz = _mm256_fmsub_ps( d0z, d1t, _mm256_mul_ps( d0t, d1z ) );
+
+		f = _mm256_xor_ps( AVX2_RSqrt( _mm256_fmadd_ps( tx, tx, _mm256_fmadd_ps( ty, ty, _mm256_mul_ps( tz, tz ) ) ) ), signBit );
+		_mm256_store_ps( result[4], _mm256_mul_ps( tx, f ) );
+		_mm256_store_ps( result[5], _mm256_mul_ps( ty, f ) );
+		_mm256_store_ps( result[6], _mm256_mul_ps( tz, f ) );
+
+		// second tangent
+		tx = _mm256_fmsub_ps( d0s, d1x, _mm256_mul_ps( d0x, d1s ) );
+		ty = _mm256_fmsub_ps( d0s, d1y, _mm256_mul_ps( d0y, d1s ) );
+		tz = _mm256_fmsub_ps( d0s, d1z, _mm256_mul_ps( d0z, d1s ) );
+
+		f = _mm256_xor_ps( AVX2_RSqrt( _mm256_fmadd_ps( tx, tx, _mm256_fmadd_ps( ty, ty, _mm256_mul_ps( tz, tz ) ) ) ), signBit );
+		_mm256_store_ps( result[7], _mm256_mul_ps( tx, f ) );
+		_mm256_store_ps( result[8], _mm256_mul_ps( ty, f ) );
+		_mm256_store_ps( result[9], _mm256_mul_ps( tz, f ) );
+
+		for ( k = 0; k < numBatch; k++ ) {
+			const idVec3 n( result[0][k], result[1][k], result[2][k] );
+			const idVec3 t0( result[4][k], result[5][k], result[6][k] );
+			const idVec3 t1( result[7][k], result[8][k], result[9][k] );
+
+			planesPtr->SetNormal( n );
+			planesPtr->SetDist( result[3][k] );		// same as FitThroughPoint on the first vertex
+			planesPtr++;
+
+			for ( int v = 0; v < 3; v++ ) {
+				const int vertNum = batchIndexes[k*3+v];
+				idDrawVert *a = verts + vertNum;
+
+				if ( used[vertNum] ) {
+					a->normal += n;
+					a->tangents[0] += t0;
+					a->tangents[1] += t1;
+				} else {
+					a->normal = n;
+					a->tangents[0] = t0;
+					a->tangents[1] = t1;
+					used[vertNum] = true;
+				}
+			}
+		}
+	}
+}
+
+/*
+============
+idSIMD_AVX2::CreateShadowCache
+============
+*/
+int VPCALL idSIMD_AVX2::CreateShadowCache( idVec4 *vertexCache, int *vertRemap, const idVec3 &lightOrigin, const idDrawVert *verts, const int numVerts ) {
+	int outVerts = 0;
+	int i = 0;
+
+	const __m128 vLight = _mm_setr_ps( lightOrigin[0], lightOrigin[1], lightOrigin[2], 0.0f );
+	const __m128 vOne = _mm_set1_ps( 1.0f );
+	const __m128 vZero = _mm_setzero_ps();
+
+	while ( i < numVerts ) {
+		// skip runs of vertices that already have been remapped
+		if ( i + 8 <= numVerts ) {
+			const __m256i remap = _mm256_loadu_si256( (const __m256i *) ( vertRemap + i ) );
+			if ( _mm256_testz_si256( _mm256_cmpeq_epi32( remap, _mm256_setzero_si256() ), _mm256_set1_epi32( -1 ) ) ) {
+				i += 8;
+				continue;
+			}
+		}
+
+		const int end = Min( i + 8, numVerts );
+		for ( ; i < end; i++ ) {
+			if ( vertRemap[i] ) {
+				continue;
+			}
+			// the fourth lane is the first texture coordinate and gets replaced
+			const __m128 v = _mm_loadu_ps( verts[i].xyz.ToFloatPtr() );
+			const __m128 v0 = _mm_blend_ps( v, vOne, 0x8 );
+			const __m128 v1 = _mm_blend_ps( _mm_sub_ps( v, vLight ), vZero, 0x8 );
+			_mm256_storeu_ps( vertexCache[outVerts].ToFloatPtr(), _mm256_insertf128_ps( _mm256_castps128_ps256( v0 ), v1, 1 ) );
+			vertRemap[i] = outVerts;
+			outVerts += 2;
+		}
+	}
+	return outVerts;
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerMono
+============
+*/
+void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	const float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	const float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	// four samples per iteration, each sample goes to both speakers
+	const __m256i spread = _mm256_setr_epi32( 0, 0, 1, 1, 2, 2, 3, 3 );
+	const __m256 inc = _mm256_setr_ps( incL, incR, incL, incR, incL, incR, incL, incR );
+	const __m256 step = _mm256_mul_ps( inc, _mm256_set1_ps( 4.0f ) );
+	__m256 gain = _mm256_fmadd_ps( _mm256_cvtepi32_ps( spread ), inc, _mm256_setr_ps( lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1] ) );
+
+	for( int j = 0; j < numSamples; j += 4 ) {
+		const __m256 s = _mm256_permutevar8x32_ps( _mm256_castps128_ps256( _mm_loadu_ps( samples + j ) ), spread );
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( s, gain, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		gain = _mm256_add_ps( gain, step );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundTwoSpeakerStereo
+============
+*/
+void VPCALL idSIMD_AVX2::MixSoundTwoSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[2], const float currentV[2] ) {
+	const float incL = ( currentV[0] - lastV[0] ) / MIXBUFFER_SAMPLES;
+	const float incR = ( currentV[1] - lastV[1] ) / MIXBUFFER_SAMPLES;
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	const __m256 inc = _mm256_setr_ps( incL, incR, incL, incR, incL, incR, incL, incR );
+	const __m256 step = _mm256_mul_ps( inc, _mm256_set1_ps( 4.0f ) );
+	__m256 gain = _mm256_fmadd_ps( _mm256_setr_ps( 0, 0, 1, 1, 2, 2, 3, 3 ), inc, _mm256_setr_ps( lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1], lastV[0], lastV[1] ) );
+
+	for( int j = 0; j < numSamples; j += 4 ) {
+		const __m256 s = _mm256_loadu_ps( samples + j*2 );
+		_mm256_storeu_ps( mixBuffer + j*2, _mm256_fmadd_ps( s, gain, _mm256_loadu_ps( mixBuffer + j*2 ) ) );
+		gain = _mm256_add_ps( gain, step );
+	}
+}
+
+/*
+============
+AVX2_MixSoundSixSpeaker
+
+  Four samples are mixed into 24 output floats per iteration. The sample
+  feeding each output float is selected with a permute of the eight input floats.
+============
+*/
+static ID_INLINE void AVX2_MixSoundSixSpeaker( float *mixBuffer, const float *samples, const int numSamples, const int samplesPerFrame, const int sampleMap[24], const float lastV[6], const float currentV[6] ) {
+	ALIGN16( float gains[24] );
+	ALIGN16( float steps[24] );
+
+	for ( int k = 0; k < 24; k++ ) {
+		const int c = k % 6;
+		const float inc = ( currentV[c] - lastV[c] ) / MIXBUFFER_SAMPLES;
+		gains[k] = lastV[c] + ( k / 6 ) * inc;
+		steps[k] = 4.0f * inc;
+	}
+
+	const __m256i map0 = _mm256_loadu_si256( (const __m256i *) ( sampleMap + 0 ) );
+	const __m256i map1 = _mm256_loadu_si256( (const __m256i *) ( sampleMap + 8 ) );
+	const __m256i map2 = _mm256_loadu_si256( (const __m256i *) ( sampleMap + 16 ) );
+	const __m256 step0 = _mm256_loadu_ps( steps + 0 );
+	const __m256 step1 = _mm256_loadu_ps( steps + 8 );
+	const __m256 step2 = _mm256_loadu_ps( steps + 16 );
+	__m256 gain0 = _mm256_loadu_ps( gains + 0 );
+	__m256 gain1 = _mm256_loadu_ps( gains + 8 );
+	__m256 gain2 = _mm256_loadu_ps( gains + 16 );
+
+	for( int i = 0; i < numSamples; i += 4 ) {
+		__m256 s;
+		if ( samplesPerFrame == 1 ) {
+			s = _mm256_castps128_ps256( _mm_loadu_ps( samples + i ) );
+		} else {
+			s = _mm256_loadu_ps( samples + i*2 );
+		}
+		float *m = mixBuffer + i*6;
+		_mm256_storeu_ps( m + 0, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, map0 ), gain0, _mm256_loadu_ps( m + 0 ) ) );
+		_mm256_storeu_ps( m + 8, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, map1 ), gain1, _mm256_loadu_ps( m + 8 ) ) );
+		_mm256_storeu_ps( m + 16, _mm256_fmadd_ps( _mm256_permutevar8x32_ps( s, map2 ), gain2, _mm256_loadu_ps( m + 16 ) ) );
+		gain0 = _mm256_add_ps( gain0, step0 );
+		gain1 = _mm256_add_ps( gain1, step1 );
+		gain2 = _mm256_add_ps( gain2, step2 );
+	}
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerMono
+============
+*/
+void VPCALL idSIMD_AVX2::MixSoundSixSpeakerMono( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	static const int sampleMap[24] = {
+		0, 0, 0, 0, 0, 0,
+		1, 1, 1, 1, 1, 1,
+		2, 2, 2, 2, 2, 2,
+		3, 3, 3, 3, 3, 3
+	};
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, numSamples, 1, sampleMap, lastV, currentV );
+}
+
+/*
+============
+idSIMD_AVX2::MixSoundSixSpeakerStereo
+============
+*/
+void VPCALL idSIMD_AVX2::MixSoundSixSpeakerStereo( float *mixBuffer, const float *samples, const int numSamples, const float lastV[6], const float currentV[6] ) {
+	// left goes to speakers 0, 2, 3, 4 and right to speakers 1, 5
+	static const int sampleMap[24] = {
+		0, 1, 0, 0, 0, 1,
+		2, 3, 2, 2, 2, 3,
+		4, 5, 4, 4, 4, 5,
+		6, 7, 6, 6, 6, 7
+	};
+
+	assert( numSamples == MIXBUFFER_SAMPLES );
+
+	AVX2_MixSoundSixSpeaker( mixBuffer, samples, numSamples, 2, sampleMap, lastV, currentV );
+}
+
+/*
+============
+idSIMD_AVX2::MixedSoundToSamples
+============
+*/
+void VPCALL idSIMD_AVX2::MixedSoundToSamples( short *samples, const float *mixBuffer, const int numSamples ) {
+	const __m256 vMin = _mm256_set1_ps( -32768.0f );
+	const __m256 vMax = _mm256_set1_ps( 32767.0f );
+	int i;
+
+	for ( i = 0; i + 16 <= numSamples; i += 16 ) {
+		const __m256 f0 = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( mixBuffer + i + 0 ), vMin ), vMax );
+		const __m256 f1 = _mm256_min_ps( _mm256_max_ps( _mm256_loadu_ps( mixBuffer + i + 8 ), vMin ), vMax );
+		// the pack works on 128 bit lanes so the result has to be reordered
+		const __m256i s = _mm256_packs_epi32( _mm256_cvttps_epi32( f0 ), _mm256_cvttps_epi32( f1 ) );
+		_mm256_storeu_si256( (__m256i *) ( samples + i ), _mm256_permute4x64_epi64( s, _MM_SHUFFLE( 3, 1, 2, 0 ) ) );
+	}
+
+	if ( i < numSamples ) {
+		idSIMD_Generic::MixedSoundToSamples( samples + i, mixBuffer + i, numSamples - i );
+	}
+}
+
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+#endif /* ID_SIMD_AVX2 */
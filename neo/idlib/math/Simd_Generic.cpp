@@ -2238,6 +2238,21 @@ bool VPCALL idSIMD_Generic::MatX_LDLTFactor( idMatX &mat, idVecX &invDiag, const
 #endif
 }
 
+/*
+============
+idSIMD_Generic::DequantizeComponents
+
+	dst[i] = bias[i] + src[i] * scale[i]
+============
+*/
+void VPCALL idSIMD_Generic::DequantizeComponents( float *dst, const unsigned short *src, const float *scale, const float *bias, const int count ) {
+	int i;
+
+	for ( i = 0; i < count; i++ ) {
+		dst[i] = bias[i] + (float) src[i] * scale[i];
+	}
+}
+
 /*
 ============
 idSIMD_Generic::BlendJoints
@@ -2437,6 +2452,98 @@ void VPCALL idSIMD_Generic::OverlayPointCull( byte *cullBits, idVec2 *texCoords,
 	}
 }
 
+/*
+============
+idSIMD_Generic::LightPointCull
+
+	Sets bit n in cullBits when the vertex is less than epsilon in front of plane n.
+	Planes with their bit set in frontBits are skipped, their bits are always zero.
+============
+*/
+void VPCALL idSIMD_Generic::LightPointCull( byte *cullBits, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) {
+	int i, j, numTestPlanes;
+	int testPlanes[6];
+
+	for ( numTestPlanes = 0, j = 0; j < 6; j++ ) {
+		if ( !( frontBits & ( 1 << j ) ) ) {
+			testPlanes[numTestPlanes++] = j;
+		}
+	}
+
+	for ( i = 0; i < numVerts; i++ ) {
+		byte bits = 0;
+		const idVec3 &v = verts[i].xyz;
+
+		for ( j = 0; j < numTestPlanes; j++ ) {
+			const int p = testPlanes[j];
+			const float d = planes[p].Normal() * v + planes[p][3];
+			bits |= ( d < epsilon ) << p;
+		}
+
+		cullBits[i] = bits;
+	}
+}
+
+/*
+============
+idSIMD_Generic::ShadowPointCull
+
+	Sets bit n in pointCull when the vertex is less than epsilon in front of plane n
+	and bit n+6 when it is less than epsilon behind plane n.
+	Planes with bit n+6 set in frontBits are skipped, frontBits is or'ed into every result.
+============
+*/
+void VPCALL idSIMD_Generic::ShadowPointCull( unsigned short *pointCull, const idPlane *planes, const int frontBits, const float epsilon, const idDrawVert *verts, const int numVerts ) {
+	int i, j, numTestPlanes;
+	int testPlanes[6];
+
+	for ( numTestPlanes = 0, j = 0; j < 6; j++ ) {
+		if ( !( frontBits & ( 1 << ( j + 6 ) ) ) ) {
+			testPlanes[numTestPlanes++] = j;
+		}
+	}
+
+	for ( i = 0; i < numVerts; i++ ) {
+		int bits = frontBits;
+		const idVec3 &v = verts[i].xyz;
+
+		for ( j = 0; j < numTestPlanes; j++ ) {
+			const int p = testPlanes[j];
+			const float d = planes[p].Normal() * v + planes[p][3];
+			bits |= ( d < epsilon ) << p;
+			bits |= ( d > -epsilon ) << ( p + 6 );
+		}
+
+		pointCull[i] = bits;
+	}
+}
+
+/*
+============
+idSIMD_Generic::ShadowSilEdgeCull
+
+	Writes the index of every silhouette edge that has a shadow casting face on exactly
+	one side and is not completely behind any frustum plane according to pointCull.
+	Returns the number of indexes written.
+============
+*/
+int VPCALL idSIMD_Generic::ShadowSilEdgeCull( int *silIndexes, const silEdge_s *silEdges, const int numSilEdges, const byte *faceCastsShadow, const unsigned short *pointCull ) {
+	int i, num;
+
+	for ( num = 0, i = 0; i < numSilEdges; i++ ) {
+		const silEdge_t &sil = silEdges[i];
+
+		if ( !( faceCastsShadow[sil.p1] ^ faceCastsShadow[sil.p2] ) ) {
+			continue;
+		}
+		if ( ( pointCull[sil.v1] ^ 0xfc0 ) & ( pointCull[sil.v2] ^ 0xfc0 ) & 0xfc0 ) {
+			continue;
+		}
+		silIndexes[num++] = i;
+	}
+	return num;
+}
+
 /*
 ============
 idSIMD_Generic::DeriveTriPlanes
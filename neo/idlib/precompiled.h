@@ -119,6 +119,7 @@ If you have questions concerning this license or the applicable additional terms
 #include "../framework/CmdSystem.h"
 #include "../framework/CVarSystem.h"
 #include "../framework/Common.h"
+#include "../framework/Profiler.h"
 #include "../framework/File.h"
 #include "../framework/FileSystem.h"
 #include "../framework/UsercmdGen.h"
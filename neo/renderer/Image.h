@@ -199,6 +199,7 @@ public:
 	void		UploadPrecompressedImage( byte *data, int len );
 	void		ActuallyLoadImage( bool checkForPrecompressed, bool fromBackEnd );
 	void		StartBackgroundImageLoad();
+	void		QueueLoad();
 	int			BitsForInternalFormat( int internalFormat ) const;
 	GLenum		SelectInternalFormat( const byte **dataPtrs, int numDataPtrs, int width, int height, textureDepth_t minimumDepth ) const;
 	void		ImageProgramStringToCompressedFileName( const char *imageProg, char *fileName ) const;
@@ -217,6 +218,8 @@ public:
 	bool				backgroundLoadInProgress;	// true if another thread is reading the complete d3t file
 	backgroundDownload_t	bgl;
 	idImage *			bglNext;				// linked from tr.backgroundImageLoads
+	bool				loadQueued;				// the render thread asked the front end to load this image
+	idImage *			queuedLoadNext;			// linked from globalImages->queuedImageLoads
 
 	// parameters that define this image
 	idStr				imgName;				// game path, including extension (except for cube maps), may be an image program
@@ -260,6 +263,8 @@ ID_INLINE idImage::idImage() {
 	bgl.opcode = DLTYPE_FILE;
 	bgl.f = NULL;
 	bglNext = NULL;
+	loadQueued = false;
+	queuedLoadNext = NULL;
 	imgName[0] = '\0';
 	generatorFunction = NULL;
 	allowDownSize = false;
@@ -313,6 +318,10 @@ public:
 	// to turn into textures.
 	void				CompleteBackgroundImageLoads();
 
+	// loads the images the render thread couldn't, called by the front
+	// end each frame while the back end is idle
+	void				LoadQueuedImages();
+
 	// returns the number of bytes of image data bound in the previous frame
 	int					SumOfUsedImages();
 
@@ -420,6 +429,7 @@ public:
 	idImage *			imageHashTable[FILE_HASH_SIZE];
 
 	idImage *			backgroundImageLoads;		// chain of images that have background file loads active
+	idImage *			queuedImageLoads;			// chain of images the render thread found unloaded
 	idImage				cacheLRU;					// head/tail of doubly linked list
 	int					totalCachedImageSize;		// for determining when something should be purged
 
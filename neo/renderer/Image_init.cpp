@@ -1282,6 +1282,7 @@ idImage *idImageManager::ImageFromFunction( const char *_name, void (*generatorF
 
 	if ( image_preload.GetBool() ) {
 		// check for precompressed, load is from the front end
+		R_SyncRenderThread();
 		image->referencedOutsideLevelLoad = true;
 		image->ActuallyLoadImage( true, false );
 	}
@@ -1367,6 +1368,7 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 				image->partialImage->levelLoadReferenced = true;
 			}
 			if ( image_preload.GetBool() && !insideLevelLoad ) {
+				R_SyncRenderThread();
 				image->referencedOutsideLevelLoad = true;
 				image->ActuallyLoadImage( true, false );	// check for precompressed, load is from front end
 				declManager->MediaPrint( "%ix%i %s (reload for mixed referneces)\n", image->uploadWidth, image->uploadHeight, image->imgName.c_str() );
@@ -1419,6 +1421,7 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 		image->precompressedFile = true;
 
 		if ( image_preload.GetBool() && !insideLevelLoad ) {
+			R_SyncRenderThread();
 			image->partialImage->ActuallyLoadImage( true, false );	// check for precompressed, load is from front end
 			declManager->MediaPrint( "%ix%i %s\n", image->partialImage->uploadWidth, image->partialImage->uploadHeight, image->imgName.c_str() );
 		} else {
@@ -1429,6 +1432,7 @@ idImage	*idImageManager::ImageFromFile( const char *_name, textureFilter_t filte
 
 	// load it if we aren't in a level preload
 	if ( image_preload.GetBool() && !insideLevelLoad ) {
+		R_SyncRenderThread();
 		image->referencedOutsideLevelLoad = true;
 		image->ActuallyLoadImage( true, false );	// check for precompressed, load is from front end
 		declManager->MediaPrint( "%ix%i %s\n", image->uploadWidth, image->uploadHeight, image->imgName.c_str() );
@@ -1690,6 +1694,42 @@ void idImageManager::CompleteBackgroundImageLoads() {
 	backgroundImageLoads = remainingList;
 }
 
+/*
+==================
+LoadQueuedImages
+
+The render thread queues images it found unloaded, the front end
+loads them here after R_SyncRenderThread so the next frame has them
+==================
+*/
+void idImageManager::LoadQueuedImages() {
+	idImage	*next;
+
+	if ( tr.smpActive ) {
+		// the back end leaves completed background loads to us as well
+		CompleteBackgroundImageLoads();
+	}
+
+	for ( idImage *image = queuedImageLoads ; image ; image = next ) {
+		next = image->queuedLoadNext;
+		image->queuedLoadNext = NULL;
+		image->loadQueued = false;
+
+		if ( image->texnum != idImage::TEXTURE_NOT_LOADED ) {
+			continue;
+		}
+		if ( image->partialImage ) {
+			if ( !image->backgroundLoadInProgress ) {
+				image->StartBackgroundImageLoad();
+			}
+			continue;
+		}
+		image->ActuallyLoadImage( true, false );	// check for precompressed, load is from front end
+	}
+
+	queuedImageLoads = NULL;
+}
+
 /*
 ===============
 CheckCvars
@@ -1759,6 +1799,8 @@ void idImageManager::Init() {
 	cacheLRU.cacheUsageNext = &cacheLRU;
 	cacheLRU.cacheUsagePrev = &cacheLRU;
 
+	queuedImageLoads = NULL;
+
 	// set default texture filter modes
 	ChangeTextureFilter();
 
@@ -1799,6 +1841,7 @@ Shutdown
 ===============
 */
 void idImageManager::Shutdown() {
+	queuedImageLoads = NULL;
 	images.DeleteContents( true );
 }
 
@@ -1383,6 +1383,23 @@ void idImage::PurgeImage() {
 	}
 }
 
+/*
+==============
+QueueLoad
+
+The render thread can't load images, it neither owns the file system nor
+the image manager, so it links the image for LoadQueuedImages instead
+==============
+*/
+void idImage::QueueLoad() {
+	if ( loadQueued ) {
+		return;
+	}
+	loadQueued = true;
+	queuedLoadNext = globalImages->queuedImageLoads;
+	globalImages->queuedImageLoads = this;
+}
+
 /*
 ==============
 Bind
@@ -1406,7 +1423,7 @@ void idImage::Bind() {
 		cacheUsagePrev->cacheUsageNext = this;
 	}
 
-	// load the image if necessary (FIXME: not SMP safe!)
+	// load the image if necessary, the render thread leaves that to the front end
 	if ( texnum == TEXTURE_NOT_LOADED ) {
 		if ( partialImage ) {
 			// if we have a partial image, go ahead and use that
@@ -1414,11 +1431,22 @@ void idImage::Bind() {
 
 			// start a background load of the full thing if it isn't already in the queue
 			if ( !backgroundLoadInProgress ) {
-				StartBackgroundImageLoad();
+				if ( tr.smpActive ) {
+					QueueLoad();
+				} else {
+					StartBackgroundImageLoad();
+				}
 			}
 			return;
 		}
 
+		if ( tr.smpActive ) {
+			// the default image stands in until the front end has loaded it
+			QueueLoad();
+			globalImages->defaultImage->Bind();
+			return;
+		}
+
 		// load the image on demand here, which isn't our normal game operating mode
 		ActuallyLoadImage( true, true );	// check for precompressed, load is from back end
 	}
@@ -1488,7 +1516,7 @@ void idImage::BindFragment() {
 		cacheUsagePrev->cacheUsageNext = this;
 	}
 
-	// load the image if necessary (FIXME: not SMP safe!)
+	// load the image if necessary, the render thread leaves that to the front end
 	if ( texnum == TEXTURE_NOT_LOADED ) {
 		if ( partialImage ) {
 			// if we have a partial image, go ahead and use that
@@ -1496,11 +1524,22 @@ void idImage::BindFragment() {
 
 			// start a background load of the full thing if it isn't already in the queue
 			if ( !backgroundLoadInProgress ) {
-				StartBackgroundImageLoad();
+				if ( tr.smpActive ) {
+					QueueLoad();
+				} else {
+					StartBackgroundImageLoad();
+				}
 			}
 			return;
 		}
 
+		if ( tr.smpActive ) {
+			// the default image stands in until the front end has loaded it
+			QueueLoad();
+			globalImages->defaultImage->BindFragment();
+			return;
+		}
+
 		// load the image on demand here, which isn't our normal game operating mode
 		ActuallyLoadImage( true, true );	// check for precompressed, load is from back end
 	}
@@ -116,18 +116,9 @@ void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangl
 	}
 
 	cullInfo.cullBits = (byte *) R_StaticAlloc( tri->numVerts * sizeof( cullInfo.cullBits[0] ) );
-	SIMDProcessor->Memset( cullInfo.cullBits, 0, tri->numVerts * sizeof( cullInfo.cullBits[0] ) );
 
-	float *planeSide = (float *) _alloca16( tri->numVerts * sizeof( float ) );
-
-	for ( i = 0; i < 6; i++ ) {
-		// if completely infront of this clipping plane
-		if ( frontBits & ( 1 << i ) ) {
-			continue;
-		}
-		SIMDProcessor->Dot( planeSide, cullInfo.localClipPlanes[i], tri->verts, tri->numVerts );
-		SIMDProcessor->CmpLT( cullInfo.cullBits, i, planeSide, LIGHT_CLIP_EPSILON, tri->numVerts );
-	}
+	// test the planes the surface is not completely infront of in a single pass over the vertices
+	SIMDProcessor->LightPointCull( cullInfo.cullBits, cullInfo.localClipPlanes, frontBits, LIGHT_CLIP_EPSILON, tri->verts, tri->numVerts );
 }
 
 /*
@@ -316,6 +307,15 @@ static srfTriangles_t *R_CreateLightTris( const idRenderEntityLocal *ent,
 	newTri->numVerts = tri->numVerts;
 	R_ReferenceStaticTriSurfVerts( newTri, tri );
 
+	// a GPU skinned surface without CPU positions can't be culled per triangle,
+	// so the whole surface is lit and the light bounds are the surface bounds
+	if ( tri->skinnedDeformInfo != NULL && !tri->skinnedVertsValid ) {
+		R_ReferenceStaticTriSurfIndexes( newTri, tri );
+		newTri->numIndexes = tri->numIndexes;
+		newTri->bounds = tri->bounds;
+		return newTri;
+	}
+
 	// calculate cull information
 	if ( !includeBackFaces ) {
 		R_CalcInteractionFacing( ent, tri, light, cullInfo );
@@ -499,13 +499,7 @@ idInteraction *idInteraction::AllocAndLink( idRenderEntityLocal *edef, idRenderL
 	}
 
 	// update the interaction table
-	if ( renderWorld->interactionTable != NULL ) {
-		int index = ldef->index * renderWorld->interactionTableWidth + edef->index;
-		if ( renderWorld->interactionTable[index] != NULL ) {
-			common->Error( "idInteraction::AllocAndLink: non NULL table entry" );
-		}
-		renderWorld->interactionTable[ index ] = interaction;
-	}
+	renderWorld->interactionTable.Add( interaction );
 
 	return interaction;
 }
@@ -533,7 +527,12 @@ void idInteraction::FreeSurfaces( void ) {
 				// if it doesn't have an entityDef, it is part of a prelight
 				// model, not a generated interaction
 				if ( this->entityDef ) {
-					R_FreeStaticTriSurf( sint->shadowTris );
+					if ( sint->shadowCacheKey != 0 && r_useShadowCache.GetBool() ) {
+						// the interaction may be created again with the same shadow
+						this->entityDef->world->shadowCache.Store( this->entityDef->index, this->lightDef->index, i, sint->shadowCacheKey, sint->shadowTris );
+					} else {
+						R_FreeStaticTriSurf( sint->shadowTris );
+					}
 					sint->shadowTris = NULL;
 				}
 			}
@@ -591,13 +590,7 @@ void idInteraction::UnlinkAndFree( void ) {
 
 	// clear the table pointer
 	idRenderWorldLocal *renderWorld = this->lightDef->world;
-	if ( renderWorld->interactionTable ) {
-		int index = this->lightDef->index * renderWorld->interactionTableWidth + this->entityDef->index;
-		if ( renderWorld->interactionTable[index] != this ) {
-			common->Error( "idInteraction::UnlinkAndFree: interactionTable wasn't set" );
-		}
-		renderWorld->interactionTable[index] = NULL;
-	}
+	renderWorld->interactionTable.Remove( this );
 
 	Unlink();
 
@@ -807,6 +800,50 @@ bool idInteraction::CullInteractionByViewFrustum( const idFrustum &viewFrustum )
 	return false;
 }
 
+/*
+====================
+R_ShadowVolumeCacheKey
+
+Hashes everything R_CreateShadowVolume() and the fix ups after it depend on:
+the surface geometry, the entity placement, the light shape and the settings
+that select the shadow generation path.  Never returns 0.
+====================
+*/
+static ID_INLINE uint64 R_HashShadowCacheData( uint64 hash, const void *data, const int numBytes ) {
+	const unsigned int *words = (const unsigned int *)data;
+	for ( int i = 0; i < numBytes / 4; i++ ) {
+		hash = ( hash ^ words[i] ) * 0x100000001B3ULL;
+	}
+	return hash;
+}
+
+static uint64 R_ShadowVolumeCacheKey( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, const idMaterial *shader, shadowGen_t shadowGen ) {
+	uint64 hash = 0xCBF29CE484222325ULL;
+
+	int settings[8];
+	settings[0] = tri->numVerts;
+	settings[1] = tri->numIndexes;
+	settings[2] = tri->numSilEdges;
+	settings[3] = shadowGen;
+	settings[4] = r_useTurboShadow.GetBool();
+	settings[5] = r_useShadowProjectedCull.GetBool();
+	settings[6] = ( !r_skipSuppress.GetBool() && ent->parms.suppressSurfaceInViewID );
+	settings[7] = shader->Coverage();
+	hash = R_HashShadowCacheData( hash, settings, sizeof( settings ) );
+
+	hash = R_HashShadowCacheData( hash, ent->modelMatrix, sizeof( ent->modelMatrix ) );
+	hash = R_HashShadowCacheData( hash, &light->globalLightOrigin, sizeof( light->globalLightOrigin ) );
+	hash = R_HashShadowCacheData( hash, light->frustum, sizeof( light->frustum ) );
+	hash = R_HashShadowCacheData( hash, &light->numShadowFrustums, sizeof( light->numShadowFrustums ) );
+
+	// deformed surfaces reuse the same memory, so the positions have to be compared
+	for ( int i = 0; i < tri->numVerts; i++ ) {
+		hash = R_HashShadowCacheData( hash, &tri->verts[i].xyz, sizeof( tri->verts[i].xyz ) );
+	}
+
+	return hash ? hash : 1;
+}
+
 /*
 ====================
 idInteraction::CreateInteraction
@@ -894,6 +931,14 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 			continue;
 		}
 
+		// GPU skinned surfaces only get CPU positions for shadow volumes and
+		// for the fixed function passes of fog and blend lights
+		if ( tri->skinnedDeformInfo != NULL ) {
+			if ( lightShader->IsFogLight() || lightShader->IsBlendLight() || ( HasShadows() && shader->SurfaceCastsShadow() && tri->silEdges != NULL ) ) {
+				R_SkinTriSurfVerts( tri );
+			}
+		}
+
 		// generate a lighted surface and add it
 		if ( shader->ReceivesLighting() ) {
 			if ( tri->ambientViewCount == tr.viewCount ) {
@@ -911,15 +956,25 @@ void idInteraction::CreateInteraction( const idRenderModel *model ) {
 			// if the light has an optimized shadow volume, don't create shadows for any models that are part of the base areas
 			if ( lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool() ) {
 
-				// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
-				sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
-				if ( sint->shadowTris ) {
-					if ( shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
-						// if any surface is a shadow-casting perforated or translucent surface, or the
-						// base surface is suppressed in the view (world weapon shadows) we can't use
-						// the external shadow optimizations because we can see through some of the faces
-						sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
-						sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
+				// reuse the shadow of a freed interaction if nothing it depends on has changed
+				if ( r_useShadowCache.GetBool() ) {
+					sint->shadowCacheKey = R_ShadowVolumeCacheKey( entityDef, tri, lightDef, shader, shadowGen );
+					sint->shadowTris = entityDef->world->shadowCache.Take( entityDef->index, lightDef->index, c, sint->shadowCacheKey );
+				}
+
+				if ( !sint->shadowTris ) {
+					// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
+					double shadowStart = R_BeginFrontEndPhase();
+					sint->shadowTris = R_CreateShadowVolume( entityDef, tri, lightDef, shadowGen, sint->cullInfo );
+					R_EndFrontEndPhase( FE_PHASE_SHADOWS, shadowStart );
+					if ( sint->shadowTris ) {
+						if ( shader->Coverage() != MC_OPAQUE || ( !r_skipSuppress.GetBool() && entityDef->parms.suppressSurfaceInViewID ) ) {
+							// if any surface is a shadow-casting perforated or translucent surface, or the
+							// base surface is suppressed in the view (world weapon shadows) we can't use
+							// the external shadow optimizations because we can see through some of the faces
+							sint->shadowTris->numShadowIndexesNoCaps = sint->shadowTris->numIndexes;
+							sint->shadowTris->numShadowIndexesNoFrontCaps = sint->shadowTris->numIndexes;
+						}
 					}
 				}
 				interactionGenerated = true;
@@ -1117,7 +1172,7 @@ void idInteraction::AddActiveInteraction( void ) {
 
 					// make sure the original surface has its ambient cache created
 					srfTriangles_t *tri = sint->ambientTris;
-					if ( !tri->ambientCache ) {
+					if ( !tri->ambientCache || tri->skinnedDeformInfo ) {
 						if ( !R_CreateAmbientCache( tri, sint->shader->ReceivesLighting() ) ) {
 							// skip if we were out of vertex memory
 							continue;
@@ -1231,6 +1286,334 @@ void idInteraction::AddActiveInteraction( void ) {
 	}
 }
 
+/*
+===========================================================================
+
+idInteractionTable implementation
+
+===========================================================================
+*/
+
+/*
+===============
+idInteractionTable::idInteractionTable
+===============
+*/
+idInteractionTable::idInteractionTable( void ) {
+	numInteractions = 0;
+}
+
+/*
+===============
+idInteractionTable::~idInteractionTable
+===============
+*/
+idInteractionTable::~idInteractionTable( void ) {
+	Clear();
+}
+
+/*
+===============
+idInteractionTable::Clear
+===============
+*/
+void idInteractionTable::Clear( void ) {
+	for ( int i = 0; i < lightTables.Num(); i++ ) {
+		if ( lightTables[i].entries != NULL ) {
+			R_StaticFree( lightTables[i].entries );
+		}
+	}
+	lightTables.Clear();
+	numInteractions = 0;
+}
+
+/*
+===============
+idInteractionTable::Resize
+===============
+*/
+void idInteractionTable::Resize( lightTable_t &table, const int newSize ) {
+	interactionTableEntry_t *oldEntries = table.entries;
+	const int oldSize = table.tableSize;
+
+	table.tableSize = newSize;
+	table.entries = (interactionTableEntry_t *)R_ClearedStaticAlloc( newSize * sizeof( table.entries[0] ) );
+
+	const int mask = newSize - 1;
+	for ( int i = 0; i < oldSize; i++ ) {
+		if ( oldEntries[i].interaction == NULL ) {
+			continue;
+		}
+		int j = Hash( oldEntries[i].entityIndex ) & mask;
+		while ( table.entries[j].interaction != NULL ) {
+			j = ( j + 1 ) & mask;
+		}
+		table.entries[j] = oldEntries[i];
+	}
+
+	if ( oldEntries != NULL ) {
+		R_StaticFree( oldEntries );
+	}
+}
+
+/*
+===============
+idInteractionTable::Add
+===============
+*/
+void idInteractionTable::Add( idInteraction *interaction ) {
+	const int lightIndex = interaction->lightDef->index;
+	const int entityIndex = interaction->entityDef->index;
+
+	if ( lightIndex >= lightTables.Num() ) {
+		lightTable_t empty;
+		empty.numEntries = 0;
+		empty.tableSize = 0;
+		empty.entries = NULL;
+		lightTables.AssureSize( lightIndex + 1, empty );
+	}
+
+	lightTable_t &table = lightTables[lightIndex];
+
+	// keep the load factor below 3/4
+	if ( ( table.numEntries + 1 ) * 4 > table.tableSize * 3 ) {
+		Resize( table, table.tableSize ? table.tableSize * 2 : 16 );
+	}
+
+	const int mask = table.tableSize - 1;
+	int i = Hash( entityIndex ) & mask;
+	while ( table.entries[i].interaction != NULL ) {
+		if ( table.entries[i].entityIndex == entityIndex ) {
+			common->Error( "idInteractionTable::Add: light %i already has an interaction with entity %i", lightIndex, entityIndex );
+		}
+		i = ( i + 1 ) & mask;
+	}
+	table.entries[i].entityIndex = entityIndex;
+	table.entries[i].interaction = interaction;
+	table.numEntries++;
+	numInteractions++;
+}
+
+/*
+===============
+idInteractionTable::Remove
+
+Uses backward shift deletion so lookups never need tombstones.
+===============
+*/
+void idInteractionTable::Remove( idInteraction *interaction ) {
+	const int lightIndex = interaction->lightDef->index;
+	const int entityIndex = interaction->entityDef->index;
+
+	if ( lightIndex >= lightTables.Num() || lightTables[lightIndex].numEntries == 0 ) {
+		common->Error( "idInteractionTable::Remove: interaction not in table" );
+	}
+
+	lightTable_t &table = lightTables[lightIndex];
+	const int mask = table.tableSize - 1;
+
+	int i = Hash( entityIndex ) & mask;
+	while ( table.entries[i].interaction != interaction ) {
+		if ( table.entries[i].interaction == NULL ) {
+			common->Error( "idInteractionTable::Remove: interaction not in table" );
+		}
+		i = ( i + 1 ) & mask;
+	}
+
+	// move following entries of the same probe sequence back into the hole
+	for ( int j = ( i + 1 ) & mask; table.entries[j].interaction != NULL; j = ( j + 1 ) & mask ) {
+		const int home = Hash( table.entries[j].entityIndex ) & mask;
+		// the entry can only move if its home slot is not cyclically within ( i, j ]
+		if ( ( ( j - home ) & mask ) >= ( ( j - i ) & mask ) ) {
+			table.entries[i] = table.entries[j];
+			i = j;
+		}
+	}
+	table.entries[i].interaction = NULL;
+	table.numEntries--;
+	numInteractions--;
+
+	// lights that lost all interactions are usually being freed
+	if ( table.numEntries == 0 ) {
+		R_StaticFree( table.entries );
+		table.entries = NULL;
+		table.tableSize = 0;
+	}
+}
+
+/*
+===============
+idInteractionTable::MemoryUsed
+===============
+*/
+int idInteractionTable::MemoryUsed( void ) const {
+	int total = lightTables.Allocated();
+	for ( int i = 0; i < lightTables.Num(); i++ ) {
+		total += lightTables[i].tableSize * sizeof( interactionTableEntry_t );
+	}
+	return total;
+}
+
+/*
+===========================================================================
+
+idShadowVolumeCache implementation
+
+===========================================================================
+*/
+
+// frames a shadow volume is kept after its interaction was freed
+static const int SHADOW_CACHE_FRAMES = 16;
+
+/*
+===============
+idShadowVolumeCache::idShadowVolumeCache
+===============
+*/
+idShadowVolumeCache::idShadowVolumeCache( void ) {
+	lastAgedFrame = -1;
+}
+
+/*
+===============
+idShadowVolumeCache::~idShadowVolumeCache
+===============
+*/
+idShadowVolumeCache::~idShadowVolumeCache( void ) {
+	Clear();
+}
+
+/*
+===============
+idShadowVolumeCache::Clear
+===============
+*/
+void idShadowVolumeCache::Clear( void ) {
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		R_FreeStaticTriSurf( entries[i].shadowTris );
+	}
+	entries.Clear();
+	hash.Free();
+}
+
+/*
+===============
+idShadowVolumeCache::FindEntry
+===============
+*/
+int idShadowVolumeCache::FindEntry( const int entityIndex, const int lightIndex, const int surfaceIndex ) const {
+	const int key = HashKey( entityIndex, lightIndex, surfaceIndex );
+	for ( int i = hash.First( key ); i != -1; i = hash.Next( i ) ) {
+		const shadowCacheEntry_t &entry = entries[i];
+		if ( entry.entityIndex == entityIndex && entry.lightIndex == lightIndex && entry.surfaceIndex == surfaceIndex ) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+/*
+===============
+idShadowVolumeCache::RemoveEntry
+
+Moves the last entry into the hole, the shadow volume is not freed.
+===============
+*/
+void idShadowVolumeCache::RemoveEntry( const int index ) {
+	const int last = entries.Num() - 1;
+
+	hash.Remove( HashKey( entries[index].entityIndex, entries[index].lightIndex, entries[index].surfaceIndex ), index );
+	if ( index != last ) {
+		const int lastKey = HashKey( entries[last].entityIndex, entries[last].lightIndex, entries[last].surfaceIndex );
+		hash.Remove( lastKey, last );
+		entries[index] = entries[last];
+		hash.Add( lastKey, index );
+	}
+	entries.SetNum( last, false );
+}
+
+/*
+===============
+idShadowVolumeCache::Take
+===============
+*/
+srfTriangles_t *idShadowVolumeCache::Take( const int entityIndex, const int lightIndex, const int surfaceIndex, const uint64 key ) {
+	const int index = FindEntry( entityIndex, lightIndex, surfaceIndex );
+	if ( index == -1 ) {
+		tr.pc.c_shadowCacheMisses++;
+		return NULL;
+	}
+
+	srfTriangles_t *shadowTris = entries[index].shadowTris;
+	const bool hit = ( entries[index].key == key );
+	RemoveEntry( index );
+
+	if ( !hit ) {
+		// the entity or light changed, so it won't be needed again
+		R_FreeStaticTriSurf( shadowTris );
+		tr.pc.c_shadowCacheMisses++;
+		return NULL;
+	}
+
+	tr.pc.c_shadowCacheHits++;
+	return shadowTris;
+}
+
+/*
+===============
+idShadowVolumeCache::Store
+===============
+*/
+void idShadowVolumeCache::Store( const int entityIndex, const int lightIndex, const int surfaceIndex, const uint64 key, srfTriangles_t *shadowTris ) {
+	int index = FindEntry( entityIndex, lightIndex, surfaceIndex );
+	if ( index != -1 ) {
+		R_FreeStaticTriSurf( entries[index].shadowTris );
+	} else {
+		index = entries.Append( shadowCacheEntry_t() );
+		hash.Add( HashKey( entityIndex, lightIndex, surfaceIndex ), index );
+	}
+
+	shadowCacheEntry_t &entry = entries[index];
+	entry.entityIndex = entityIndex;
+	entry.lightIndex = lightIndex;
+	entry.surfaceIndex = surfaceIndex;
+	entry.key = key;
+	entry.shadowTris = shadowTris;
+	entry.storedFrame = tr.frameCount;
+}
+
+/*
+===============
+idShadowVolumeCache::Age
+===============
+*/
+void idShadowVolumeCache::Age( void ) {
+	if ( lastAgedFrame == tr.frameCount ) {
+		return;
+	}
+	lastAgedFrame = tr.frameCount;
+
+	for ( int i = entries.Num() - 1; i >= 0; i-- ) {
+		if ( tr.frameCount - entries[i].storedFrame > SHADOW_CACHE_FRAMES ) {
+			R_FreeStaticTriSurf( entries[i].shadowTris );
+			RemoveEntry( i );
+		}
+	}
+}
+
+/*
+===============
+idShadowVolumeCache::MemoryUsed
+===============
+*/
+int idShadowVolumeCache::MemoryUsed( void ) const {
+	int total = entries.Allocated() + hash.Allocated();
+	for ( int i = 0; i < entries.Num(); i++ ) {
+		total += R_TriSurfMemory( entries[i].shadowTris );
+	}
+	return total;
+}
+
 /*
 ===================
 R_ShowInteractionMemory_f
@@ -1293,4 +1676,8 @@ void R_ShowInteractionMemory_f( const idCmdArgs &args ) {
 	common->Printf( "%i deferred interactions, %i empty interactions\n", deferredInteractions, emptyInteractions );
 	common->Printf( "%5i indexes %5i verts in %5i light tris\n", lightTriIndexes, lightTriVerts, lightTris );
 	common->Printf( "%5i indexes %5i verts in %5i shadow tris\n", shadowTriIndexes, shadowTriVerts, shadowTris );
+	common->Printf( "%i interactions in the interaction table totalling %ik\n", tr.primaryWorld->interactionTable.NumInteractions(),
+																				tr.primaryWorld->interactionTable.MemoryUsed() / 1024 );
+	common->Printf( "%i shadow volumes in the shadow cache totalling %ik\n", tr.primaryWorld->shadowCache.NumEntries(),
+																			tr.primaryWorld->shadowCache.MemoryUsed() / 1024 );
 }
@@ -69,6 +69,9 @@ typedef struct {
 	// shadow volume triangle surface
 	srfTriangles_t *		shadowTris;
 
+	// key of shadowTris in the idShadowVolumeCache, 0 if it isn't cached when freed
+	uint64					shadowCacheKey;
+
 	// so we can check ambientViewCount before adding lightTris, and get
 	// at the shared vertex and possibly shadowVertex caches
 	srfTriangles_t *		ambientTris;
@@ -175,6 +178,129 @@ private:
 };
 
 
+/*
+===============================================================================
+
+	Sparse lightDef / entityDef interaction table.
+
+	Every lightDef has a small open addressing hash table keyed on the
+	entityDef index, so memory grows with the number of interactions
+	instead of with lightDefs * entityDefs, and adding defs never requires
+	rebuilding the table.  The table is updated by idInteraction::AllocAndLink()
+	and idInteraction::UnlinkAndFree().
+
+===============================================================================
+*/
+
+typedef struct {
+	int						entityIndex;
+	idInteraction *			interaction;	// NULL for an empty slot
+} interactionTableEntry_t;
+
+class idInteractionTable {
+public:
+							idInteractionTable( void );
+							~idInteractionTable( void );
+
+							// frees the tables of all lights
+	void					Clear( void );
+
+	idInteraction *			Find( const int lightIndex, const int entityIndex ) const;
+	void					Add( idInteraction *interaction );
+	void					Remove( idInteraction *interaction );
+
+	int						NumInteractions( void ) const { return numInteractions; }
+	int						MemoryUsed( void ) const;
+
+private:
+	typedef struct {
+		int					numEntries;
+		int					tableSize;		// power of two, 0 if nothing is allocated
+		interactionTableEntry_t *entries;
+	} lightTable_t;
+
+	idList<lightTable_t>	lightTables;	// indexed by lightDef index
+	int						numInteractions;
+
+	static int				Hash( const int entityIndex ) { return (int)( ( (unsigned int)entityIndex * 0x9E3779B1u ) >> 8 ); }
+	void					Resize( lightTable_t &table, const int newSize );
+};
+
+ID_INLINE idInteraction *idInteractionTable::Find( const int lightIndex, const int entityIndex ) const {
+	if ( lightIndex >= lightTables.Num() ) {
+		return NULL;
+	}
+	const lightTable_t &table = lightTables[lightIndex];
+	if ( table.numEntries == 0 ) {
+		return NULL;
+	}
+	// the table is never full, so there always is an empty slot to stop at
+	const int mask = table.tableSize - 1;
+	for ( int i = Hash( entityIndex ) & mask; ; i = ( i + 1 ) & mask ) {
+		const interactionTableEntry_t &entry = table.entries[i];
+		if ( entry.interaction == NULL ) {
+			return NULL;
+		}
+		if ( entry.entityIndex == entityIndex ) {
+			return entry.interaction;
+		}
+	}
+}
+
+
+/*
+===============================================================================
+
+	Shadow volume cache.
+
+	Interactions are freed every time the game updates an entity with joints
+	or changes the shape of a light, even if nothing moved.  Their shadow
+	volumes are kept here for a few frames, keyed on the entityDef, lightDef and
+	model surface, and idInteraction::CreateInteraction() takes them back instead
+	of calling R_CreateShadowVolume() if the geometry, the entity placement and
+	the light shape are still the same.
+
+===============================================================================
+*/
+
+typedef struct {
+	int						entityIndex;
+	int						lightIndex;
+	int						surfaceIndex;
+	uint64					key;			// hash of everything the shadow volume depends on
+	srfTriangles_t *		shadowTris;
+	int						storedFrame;	// tr.frameCount when the interaction was freed
+} shadowCacheEntry_t;
+
+class idShadowVolumeCache {
+public:
+							idShadowVolumeCache( void );
+							~idShadowVolumeCache( void );
+
+							// frees all cached shadow volumes
+	void					Clear( void );
+
+							// returns the shadow volume and removes it from the cache, NULL if it isn't cached or the key changed
+	srfTriangles_t *		Take( const int entityIndex, const int lightIndex, const int surfaceIndex, const uint64 key );
+							// takes ownership of the shadow volume of a freed interaction
+	void					Store( const int entityIndex, const int lightIndex, const int surfaceIndex, const uint64 key, srfTriangles_t *shadowTris );
+							// frees the shadow volumes that were not taken back in time, does nothing if already called this frame
+	void					Age( void );
+
+	int						NumEntries( void ) const { return entries.Num(); }
+	int						MemoryUsed( void ) const;
+
+private:
+	idList<shadowCacheEntry_t>	entries;
+	idHashIndex				hash;
+	int						lastAgedFrame;
+
+	static int				HashKey( const int entityIndex, const int lightIndex, const int surfaceIndex ) { return entityIndex * 2971 + lightIndex * 113 + surfaceIndex; }
+	int						FindEntry( const int entityIndex, const int lightIndex, const int surfaceIndex ) const;
+	void					RemoveEntry( const int index );
+};
+
+
 void R_CalcInteractionFacing( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
 void R_CalcInteractionCullBits( const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo );
 void R_FreeInteractionCullInfo( srfCullInfo_t &cullInfo );
@@ -89,6 +89,7 @@ void idMaterial::CommonInit() {
 	numRegisters = 0;
 	expressionRegisters = NULL;
 	constantRegisters = NULL;
+	referencesSound = false;
 	numStages = 0;
 	numAmbientStages = 0;
 	stages = NULL;
@@ -607,6 +608,7 @@ int idMaterial::ParseTerm( idLexer &src ) {
 
 	if ( !token.Icmp( "sound" ) ) {
 		pd->registersAreConstant = false;
+		referencesSound = true;
 		return EmitOp( 0, 0, OP_TYPE_SOUND );
 	}
 
@@ -584,6 +584,10 @@ public:
 						// to be called.  If NULL is returned, EvaluateRegisters must be used.
 	const float *		ConstantRegisters() const;
 
+						// true if any expression uses the sound amplitude, which can only be
+						// evaluated on the main thread
+	bool				ReferencesSound() const					{ return referencesSound; }
+
 	bool				SuppressInSubview() const				{ return suppressInSubview; };
 	bool				IsPortalSky() const						{ return portalSky; };
 	void				AddReference();
@@ -666,6 +670,7 @@ private:
 	float *				expressionRegisters;
 
 	float *				constantRegisters;	// NULL if ops ever reference globalParms or entityParms
+	bool				referencesSound;	// an expression uses the sound amplitude
 
 	int					numStages;
 	int					numAmbientStages;
@@ -39,6 +39,17 @@ idCVar idRenderModelStatic::r_mergeModelSurfaces( "r_mergeModelSurfaces", "1", C
 idCVar idRenderModelStatic::r_slopVertex( "r_slopVertex", "0.01", CVAR_RENDERER, "merge xyz coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopTexCoord( "r_slopTexCoord", "0.001", CVAR_RENDERER, "merge texture coordinates this far apart" );
 idCVar idRenderModelStatic::r_slopNormal( "r_slopNormal", "0.02", CVAR_RENDERER, "merge normals that dot less than this" );
+idCVar idRenderModelStatic::r_useCachedModels( "r_useCachedModels", "1", CVAR_BOOL|CVAR_RENDERER, "load the finished surfaces of ase, lwo, ma and flt models and the meshes of md5 models from generated/ when the source is unchanged" );
+
+static const int BMODEL_MAGIC		= ( 'B' << 24 ) | ( 'M' << 16 ) | ( 'D' << 8 ) | 'L';
+static const int BMODEL_VERSION		= 2;		// bump when the conversion or FinishSurfaces changes
+
+// material properties that change the conversion or FinishSurfaces
+static const int BMODEL_DISCRETE			= BIT( 0 );
+static const int BMODEL_RENDERBUMP			= BIT( 1 );
+static const int BMODEL_BACKSIDES			= BIT( 2 );
+static const int BMODEL_UNSMOOTHED_TANGENTS	= BIT( 3 );
+static const int BMODEL_DEFORM				= BIT( 4 );
 
 /*
 ================
@@ -277,6 +288,9 @@ idRenderModelStatic::InitFromFile
 void idRenderModelStatic::InitFromFile( const char *fileName ) {
 	bool loaded;
 	idStr extension;
+	ID_TIME_T sourceTimeStamp = FILE_NOT_FOUND_TIMESTAMP;
+	int sourceLength = -1;
+	bool useCache;
 
 	InitEmpty( fileName );
 
@@ -284,6 +298,20 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	name.ExtractFileExtension( extension );
 
+	// renderBump loads without finishing the surfaces, so it can't use the cache
+	useCache = r_useCachedModels.GetBool() && !fastLoad &&
+				( extension.Icmp( "ase" ) == 0 || extension.Icmp( "lwo" ) == 0 ||
+				extension.Icmp( "flt" ) == 0 || extension.Icmp( "ma" ) == 0 );
+	if ( useCache ) {
+		sourceLength = fileSystem->ReadFile( name, NULL, &sourceTimeStamp );
+		if ( sourceLength > 0 && LoadBinaryModel( sourceTimeStamp, sourceLength ) ) {
+			timeStamp = sourceTimeStamp;
+			reloadable = true;
+			purged = false;
+			return;
+		}
+	}
+
 	if ( extension.Icmp( "ase" ) == 0 ) {
 		loaded		= LoadASE( name );
 		reloadable	= true;
@@ -312,6 +340,246 @@ void idRenderModelStatic::InitFromFile( const char *fileName ) {
 
 	// create the bounds for culling and dynamic surface creation
 	FinishSurfaces();
+
+	if ( useCache && sourceLength > 0 && surfaces.Num() > 0 ) {
+		WriteBinaryModel( sourceTimeStamp, sourceLength );
+	}
+}
+
+/*
+================
+R_BinaryModelFileName
+================
+*/
+static void R_BinaryModelFileName( const char *modelName, idStr &fileName ) {
+	fileName = "generated/";
+	fileName += modelName;
+	fileName += ".bmodel";
+}
+
+/*
+================
+idRenderModelStatic::BinaryModelOptions
+
+Checksum of the cvars that change the conversion
+================
+*/
+unsigned int idRenderModelStatic::BinaryModelOptions( void ) {
+	const float options[] = {
+		r_mergeModelSurfaces.GetBool() ? 1.0f : 0.0f,
+		r_slopVertex.GetFloat(),
+		r_slopTexCoord.GetFloat(),
+		r_slopNormal.GetFloat()
+	};
+	unsigned long crc;
+
+	CRC32_InitChecksum( crc );
+	CRC32_UpdateChecksum( crc, options, sizeof( options ) );
+	CRC32_FinishChecksum( crc );
+	return (unsigned int)crc;
+}
+
+/*
+================
+R_BinaryModelMaterialFlags
+================
+*/
+static int R_BinaryModelMaterialFlags( const idMaterial *shader ) {
+	int flags = 0;
+	const char *renderBump = shader->GetRenderBump();
+
+	if ( shader->IsDiscrete() ) {
+		flags |= BMODEL_DISCRETE;
+	}
+	if ( renderBump && renderBump[0] ) {
+		flags |= BMODEL_RENDERBUMP;
+	}
+	if ( shader->ShouldCreateBackSides() ) {
+		flags |= BMODEL_BACKSIDES;
+	}
+	if ( shader->UseUnsmoothedTangents() ) {
+		flags |= BMODEL_UNSMOOTHED_TANGENTS;
+	}
+	if ( shader->Deform() != DFRM_NONE ) {
+		flags |= BMODEL_DEFORM;
+	}
+	return flags;
+}
+
+/*
+================
+idRenderModelStatic::LoadBinaryModel
+
+The finished surfaces of a text model are read from generated/<model>.bmodel with a
+single file read, the cache is only used if the source file has the same timestamp and
+length, the conversion cvars are unchanged and the materials still have the properties
+the surfaces were built with.
+================
+*/
+bool idRenderModelStatic::LoadBinaryModel( ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	idStr fileName;
+	void *buffer;
+
+	R_BinaryModelFileName( name, fileName );
+
+	int length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( fileName, (const char *)buffer, length );
+	bool valid = ReadBinaryModel( &file, sourceTimeStamp, sourceLength );
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		common->DPrintf( "%s is out of date\n", fileName.c_str() );
+		PurgeModel();
+		bounds.Zero();
+	}
+	return valid;
+}
+
+/*
+================
+idRenderModelStatic::ReadBinaryModel
+================
+*/
+bool idRenderModelStatic::ReadBinaryModel( idFile *file, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	int				magic, version, byteOrder, vertSize, indexSize;
+	unsigned int	cachedTimeStamp, options;
+	int				cachedLength;
+
+	file->ReadInt( magic );
+	file->ReadInt( version );
+	file->Read( &byteOrder, sizeof( byteOrder ) );
+	file->ReadInt( vertSize );
+	file->ReadInt( indexSize );
+	if ( magic != BMODEL_MAGIC || version != BMODEL_VERSION || byteOrder != 1 ||
+			vertSize != sizeof( idDrawVert ) || indexSize != sizeof( glIndex_t ) ) {
+		return false;
+	}
+
+	file->ReadUnsignedInt( cachedTimeStamp );
+	file->ReadInt( cachedLength );
+	file->ReadUnsignedInt( options );
+	if ( cachedTimeStamp != (unsigned int)sourceTimeStamp || cachedLength != sourceLength || options != BinaryModelOptions() ) {
+		return false;
+	}
+
+	return ReadBinarySurfaces( file );
+}
+
+/*
+================
+idRenderModelStatic::ReadBinarySurfaces
+
+Reads the finished surfaces written by WriteBinarySurfaces, also used for
+the area and shadow models of the binary world cache
+================
+*/
+bool idRenderModelStatic::ReadBinarySurfaces( idFile *file ) {
+	int numSurfaces;
+
+	file->ReadVec3( bounds[0] );
+	file->ReadVec3( bounds[1] );
+	file->ReadInt( numSurfaces );
+	if ( numSurfaces < 0 || numSurfaces > file->Length() - file->Tell() ) {
+		return false;
+	}
+
+	surfaces.SetNum( 0, false );
+	surfaces.Resize( numSurfaces );
+	for ( int i = 0 ; i < numSurfaces ; i++ ) {
+		modelSurface_t	surf;
+		idStr			shaderName;
+		int				flags;
+
+		file->ReadInt( surf.id );
+		file->ReadString( shaderName );
+		file->ReadInt( flags );
+
+		surf.shader = declManager->FindMaterial( shaderName );
+		if ( R_BinaryModelMaterialFlags( surf.shader ) != flags ) {
+			return false;
+		}
+
+		surf.geometry = R_ReadStaticTriSurf( file );
+		if ( surf.geometry == NULL ) {
+			return false;
+		}
+		surfaces.Append( surf );
+	}
+
+	// add up the total surface area for development information, as FinishSurfaces does
+	for ( int i = 0 ; i < surfaces.Num() ; i++ ) {
+		const modelSurface_t	*surf = &surfaces[i];
+		const srfTriangles_t	*tri = surf->geometry;
+
+		if ( tri->verts == NULL ) {
+			continue;
+		}
+		for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
+			float	area = idWinding::TriangleArea( tri->verts[tri->indexes[j]].xyz,
+				 tri->verts[tri->indexes[j+1]].xyz,  tri->verts[tri->indexes[j+2]].xyz );
+			const_cast<idMaterial *>(surf->shader)->AddToSurfaceArea( area );
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderModelStatic::WriteBinaryModel
+
+The arrays are written in native byte order, the byte order marker makes
+a cache written on a machine with the other order invalid
+================
+*/
+void idRenderModelStatic::WriteBinaryModel( ID_TIME_T sourceTimeStamp, int sourceLength ) const {
+	idStr fileName;
+	const int byteOrder = 1;
+
+	R_BinaryModelFileName( name, fileName );
+
+	idFile *file = fileSystem->OpenFileWrite( fileName, "fs_basepath" );
+	if ( file == NULL ) {
+		// the base path may be read only, the model is simply parsed every time
+		common->DPrintf( "couldn't write model cache file %s\n", fileName.c_str() );
+		return;
+	}
+
+	file->WriteInt( BMODEL_MAGIC );
+	file->WriteInt( BMODEL_VERSION );
+	file->Write( &byteOrder, sizeof( byteOrder ) );
+	file->WriteInt( sizeof( idDrawVert ) );
+	file->WriteInt( sizeof( glIndex_t ) );
+	file->WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+	file->WriteInt( sourceLength );
+	file->WriteUnsignedInt( BinaryModelOptions() );
+	WriteBinarySurfaces( file );
+
+	fileSystem->CloseFile( file );
+}
+
+/*
+================
+idRenderModelStatic::WriteBinarySurfaces
+================
+*/
+void idRenderModelStatic::WriteBinarySurfaces( idFile *file ) const {
+	file->WriteVec3( bounds[0] );
+	file->WriteVec3( bounds[1] );
+	file->WriteInt( surfaces.Num() );
+
+	for ( int i = 0 ; i < surfaces.Num() ; i++ ) {
+		const modelSurface_t *surf = &surfaces[i];
+
+		file->WriteInt( surf->id );
+		file->WriteString( surf->shader->GetName() );
+		file->WriteInt( R_BinaryModelMaterialFlags( surf->shader ) );
+		R_WriteStaticTriSurf( file, surf->geometry );
+	}
 }
 
 /*
@@ -2133,10 +2401,11 @@ void idRenderModelStatic::FreeVertexCache( void ) {
 		if ( !tri ) {
 			continue;
 		}
-		if ( tri->ambientCache ) {
+		// GPU skinned surfaces reference the cache of their deformInfo
+		if ( tri->ambientCache && !tri->skinnedDeformInfo ) {
 			vertexCache.Free( tri->ambientCache );
-			tri->ambientCache = NULL;
 		}
+		tri->ambientCache = NULL;
 		// static shadows may be present
 		if ( tri->shadowCache ) {
 			vertexCache.Free( tri->shadowCache );
@@ -59,7 +59,7 @@ typedef short glIndex_t;
 #endif
 
 
-typedef struct {
+typedef struct silEdge_s {
 	// NOTE: making this a glIndex is dubious, as there can be 2x the faces as verts
 	glIndex_t					p1, p2;					// planes defining the edge
 	glIndex_t					v1, v2;					// verts defining the edge
@@ -125,12 +125,20 @@ typedef struct srfTriangles_s {
 	struct srfTriangles_s *		ambientSurface;			// for light interactions, point back at the original surface that generated
 														// the interaction, which we will get the ambientCache from
 
+	const struct deformInfo_s *	skinnedDeformInfo;		// if set, the ambientCache holds the bind pose vertexes and joint weights
+														// that the vertex program blends with the skinnedJoints palette
+	int							numSkinnedJoints;
+	idJointMat *				skinnedJoints;			// [MAX_SKINNING_JOINTS] allocated with Mem_Alloc16, the first numSkinnedJoints are used
+	int							jointCacheFrame;		// tr.frameCount when skinnedJoints was copied to the jointCache
+	bool						skinnedVertsValid;		// verts hold the positions of skinnedJoints, see R_SkinTriSurfVerts
+
 	struct srfTriangles_s *		nextDeferredFree;		// chain of tris to free next frame
 
 	// data in vertex object space, not directly readable by the CPU
 	struct vertCache_s *		indexCache;				// int
 	struct vertCache_s *		ambientCache;			// idDrawVert
 	struct vertCache_s *		shadowCache;			// shadowCache_t
+	struct vertCache_s *		jointCache;				// idJointMat, bound to the matrices_ubo uniform block
 } srfTriangles_t;
 
 typedef idList<srfTriangles_t *> idTriList;
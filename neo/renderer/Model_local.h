@@ -86,6 +86,10 @@ public:
 	virtual float				DepthHack() const;
 
 	void						MakeDefaultModel();
+
+	bool						ReadBinarySurfaces( idFile *file );
+	void						WriteBinarySurfaces( idFile *file ) const;
+	static unsigned int			BinaryModelOptions( void );
 	
 	bool						LoadASE( const char *fileName );
 	bool						LoadLWO( const char *fileName );
@@ -98,6 +102,10 @@ public:
 
 	struct aseModel_s *			ConvertLWOToASE( const struct st_lwObject *obj, const char *fileName );
 
+	bool						LoadBinaryModel( ID_TIME_T sourceTimeStamp, int sourceLength );
+	bool						ReadBinaryModel( idFile *file, ID_TIME_T sourceTimeStamp, int sourceLength );
+	void						WriteBinaryModel( ID_TIME_T sourceTimeStamp, int sourceLength ) const;
+
 	bool						DeleteSurfaceWithId( int id );
 	void						DeleteSurfacesWithNegativeId( void );
 	bool						FindSurfaceWithId( int id, int &surfaceNum );
@@ -125,6 +133,7 @@ protected:
 	static idCVar				r_slopVertex;			// merge xyz coordinates this far apart
 	static idCVar				r_slopTexCoord;			// merge texture coordinates this far apart
 	static idCVar				r_slopNormal;			// merge normals that dot less than this
+	static idCVar				r_useCachedModels;		// load finished surfaces and md5 meshes from generated/
 };
 
 /*
@@ -143,12 +152,16 @@ public:
 								~idMD5Mesh();
 
  	void						ParseMesh( idLexer &parser, int numJoints, const idJointMat *joints );
-	void						UpdateSurface( const struct renderEntity_s *ent, const idJointMat *joints, modelSurface_t *surf );
+	bool						ReadBinary( idFile *file, int numJoints );
+	void						WriteBinary( idFile *file ) const;
+	void						UpdateSurface( const struct renderEntity_s *ent, modelSurface_t *surf );
+	void						SkinSurface( const struct renderEntity_s *ent, const idJointMat *joints, srfTriangles_t *tri, frontEndJobCounters_t *counters );
 	idBounds					CalcBounds( const idJointMat *joints );
 	int							NearestJoint( int a, int b, int c ) const;
 	int							NumVerts( void ) const;
 	int							NumTris( void ) const;
 	int							NumWeights( void ) const;
+	float						SkinningError( const idJointMat *joints );
 
 private:
 	idList<idVec2>				texCoords;			// texture coordinates
@@ -159,9 +172,17 @@ private:
 	int							numTris;			// number of triangles
 	struct deformInfo_s *		deformInfo;			// used to create srfTriangles_t from base frames and new vertexes
 	int							surfaceNum;			// number of the static surface created for this mesh
+	idList<int>					skinnedJoints;		// model joint for each entry of the GPU skinning palette
+	idList<idJointMat>			invertedBindPose;	// inverse of the bind pose of each palette joint
+	idList<idBounds>			skinnedJointBounds;	// bind pose bounds of the vertexes each palette joint influences
 
 	void						TransformVerts( idDrawVert *verts, const idJointMat *joints );
 	void						TransformScaledVerts( idDrawVert *verts, const idJointMat *joints, float scale );
+	void						BuildSkinning( int numJoints, const idJointMat *joints, const idDrawVert *bindVerts );
+	bool						UseGPUSkinning( const struct renderEntity_s *ent ) const;
+	void						BuildSkinnedJoints( const idJointMat *joints, idJointMat *palette ) const;
+	void						BuildSkinnedJointBounds( void );
+	idBounds					SkinnedBounds( const idJointMat *palette ) const;
 };
 
 class idRenderModelMD5 : public idRenderModelStatic {
@@ -183,6 +204,8 @@ public:
 	virtual const idJointQuat *	GetDefaultPose( void ) const;
 	virtual int					NearestJoint( int surfaceNum, int a, int b, int c ) const;
 
+	void						TestGPUSkinning( const idJointMat *joints );
+
 private:
 	idList<idMD5Joint>			joints;
 	idList<idJointQuat>			defaultPose;
@@ -192,6 +215,9 @@ private:
 	void						GetFrameBounds( const renderEntity_t *ent, idBounds &bounds ) const;
 	void						DrawJoints( const renderEntity_t *ent, const struct viewDef_s *view ) const;
 	void						ParseJoint( idLexer &parser, idMD5Joint *joint, idJointQuat *defaultPose );
+	bool						LoadBinaryMD5( unsigned int sourceChecksum, int sourceLength );
+	bool						ReadBinaryMD5( idFile *file, unsigned int sourceChecksum, int sourceLength );
+	void						WriteBinaryMD5( unsigned int sourceChecksum, int sourceLength ) const;
 };
 
 /*
@@ -34,6 +34,9 @@ If you have questions concerning this license or the applicable additional terms
 
 static const char *MD5_SnapshotName = "_MD5_Snapshot_";
 
+static const int BMD5MESH_MAGIC		= ( 'B' << 24 ) | ( 'M' << 16 ) | ( 'D' << 8 ) | '5';
+static const int BMD5MESH_VERSION	= 1;		// bump when ParseMesh, BuildSkinning or R_BuildDeformInfo change
+
 
 /***********************************************************************
 
@@ -243,6 +246,373 @@ void idMD5Mesh::ParseMesh( idLexer &parser, int numJoints, const idJointMat *joi
 	}
 	TransformVerts( verts, joints );
 	deformInfo = R_BuildDeformInfo( texCoords.Num(), verts, tris.Num(), tris.Ptr(), shader->UseUnsmoothedTangents() );
+
+	BuildSkinning( numJoints, joints, verts );
+}
+
+/*
+====================
+idMD5Mesh::WriteBinary
+
+Everything ParseMesh and BuildSkinning derive from the text, in native byte order
+====================
+*/
+void idMD5Mesh::WriteBinary( idFile *file ) const {
+	file->WriteString( shader->GetName() );
+	file->WriteBool( shader->UseUnsmoothedTangents() );
+
+	file->WriteInt( texCoords.Num() );
+	file->Write( texCoords.Ptr(), texCoords.Num() * sizeof( texCoords[0] ) );
+
+	file->WriteInt( numWeights );
+	file->Write( scaledWeights, numWeights * sizeof( scaledWeights[0] ) );
+	file->Write( weightIndex, numWeights * 2 * sizeof( weightIndex[0] ) );
+
+	file->WriteInt( numTris );
+	R_WriteDeformInfo( file, deformInfo );
+
+	file->WriteInt( skinnedJoints.Num() );
+	file->Write( skinnedJoints.Ptr(), skinnedJoints.Num() * sizeof( skinnedJoints[0] ) );
+	file->Write( invertedBindPose.Ptr(), invertedBindPose.Num() * sizeof( invertedBindPose[0] ) );
+}
+
+/*
+====================
+idMD5Mesh::ReadBinary
+
+Returns false if the data is truncated, corrupt or the material changed in a way
+that affects the deform info.  Whatever was allocated is freed by the destructor.
+====================
+*/
+bool idMD5Mesh::ReadBinary( idFile *file, int numJoints ) {
+	idStr	shaderName;
+	bool	unsmoothedTangents;
+	int		i, num, numVertexes;
+
+	file->ReadString( shaderName );
+	file->ReadBool( unsmoothedTangents );
+
+	shader = declManager->FindMaterial( shaderName );
+	if ( shader->UseUnsmoothedTangents() != unsmoothedTangents ) {
+		return false;
+	}
+
+	if ( file->ReadInt( num ) != sizeof( num ) || num < 0 || num > file->Length() / (int)sizeof( texCoords[0] ) ) {
+		return false;
+	}
+	texCoords.SetNum( num );
+	if ( file->Read( texCoords.Ptr(), num * sizeof( texCoords[0] ) ) != num * (int)sizeof( texCoords[0] ) ) {
+		return false;
+	}
+
+	if ( file->ReadInt( numWeights ) != sizeof( numWeights ) || numWeights <= 0 || numWeights > file->Length() / (int)sizeof( scaledWeights[0] ) ) {
+		return false;
+	}
+	scaledWeights = (idVec4 *) Mem_Alloc16( numWeights * sizeof( scaledWeights[0] ) );
+	weightIndex = (int *) Mem_Alloc16( numWeights * 2 * sizeof( weightIndex[0] ) );
+	if ( file->Read( scaledWeights, numWeights * sizeof( scaledWeights[0] ) ) != numWeights * (int)sizeof( scaledWeights[0] ) ) {
+		return false;
+	}
+	if ( file->Read( weightIndex, numWeights * 2 * sizeof( weightIndex[0] ) ) != numWeights * 2 * (int)sizeof( weightIndex[0] ) ) {
+		return false;
+	}
+
+	// the weight index is used directly as a byte offset into the joints and
+	// the vertex count, so it has to be checked before the mesh is transformed
+	numVertexes = 0;
+	for ( i = 0; i < numWeights; i++ ) {
+		const int offset = weightIndex[i * 2 + 0];
+		if ( offset < 0 || offset >= numJoints * (int)sizeof( idJointMat ) || ( offset % sizeof( idJointMat ) ) != 0 ) {
+			return false;
+		}
+		numVertexes += weightIndex[i * 2 + 1];
+	}
+	if ( numVertexes != texCoords.Num() || weightIndex[numWeights * 2 - 1] != 1 ) {
+		return false;
+	}
+
+	file->ReadInt( numTris );
+	deformInfo = R_ReadDeformInfo( file );
+	if ( deformInfo == NULL || deformInfo->numSourceVerts != texCoords.Num() || deformInfo->numIndexes != numTris * 3 ) {
+		return false;
+	}
+
+	if ( file->ReadInt( num ) != sizeof( num ) || num < 0 || num > MAX_SKINNING_JOINTS ) {
+		return false;
+	}
+	skinnedJoints.SetNum( num );
+	invertedBindPose.SetNum( num );
+	if ( file->Read( skinnedJoints.Ptr(), num * sizeof( skinnedJoints[0] ) ) != num * (int)sizeof( skinnedJoints[0] ) ) {
+		return false;
+	}
+	if ( file->Read( invertedBindPose.Ptr(), num * sizeof( invertedBindPose[0] ) ) != num * (int)sizeof( invertedBindPose[0] ) ) {
+		return false;
+	}
+	for ( i = 0; i < num; i++ ) {
+		if ( skinnedJoints[i] < 0 || skinnedJoints[i] >= numJoints ) {
+			return false;
+		}
+	}
+	if ( ( num > 0 ) != ( deformInfo->skinnedVerts != NULL ) ) {
+		return false;
+	}
+	for ( i = 0; i < deformInfo->numSourceVerts && num > 0; i++ ) {
+		const skinnedWeight_t &weight = deformInfo->skinnedWeights[i];
+		if ( weight.jointIndexes[0] >= num || weight.jointIndexes[1] >= num || weight.jointIndexes[2] >= num || weight.jointIndexes[3] >= num ) {
+			return false;
+		}
+	}
+
+	BuildSkinnedJointBounds();
+
+	// update counters
+	c_numVerts += texCoords.Num();
+	c_numWeights += numWeights;
+	c_numWeightJoints++;
+	for ( i = 0; i < numWeights; i++ ) {
+		c_numWeightJoints += weightIndex[i*2+1];
+	}
+
+	return true;
+}
+
+/*
+====================
+idMD5Mesh::BuildSkinning
+
+Packs the four most influential joints of each vertex for the vertex programs
+and keeps the inverted bind pose of the joints referenced by the mesh, so the
+skinning palette only holds the joints the mesh actually uses
+====================
+*/
+void idMD5Mesh::BuildSkinning( int numJoints, const idJointMat *joints, const idDrawVert *bindVerts ) {
+	int		i, j, k, w;
+
+	skinnedJoints.Clear();
+	invertedBindPose.Clear();
+
+	int *paletteIndex = (int *) _alloca16( numJoints * sizeof( paletteIndex[0] ) );
+	memset( paletteIndex, -1, numJoints * sizeof( paletteIndex[0] ) );
+
+	skinnedWeight_t *weights = (skinnedWeight_t *) Mem_Alloc( texCoords.Num() * sizeof( weights[0] ) );
+
+	for ( i = 0, w = 0; i < texCoords.Num(); i++ ) {
+		int		bestJoint[4] = { 0, 0, 0, 0 };
+		float	bestWeight[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+		// keep the largest weights, anything past four influences is dropped
+		do {
+			int joint = weightIndex[w * 2 + 0] / sizeof( idJointMat );
+			float weight = scaledWeights[w].w;
+			for ( j = 0; j < 4; j++ ) {
+				if ( weight > bestWeight[j] ) {
+					for ( k = 3; k > j; k-- ) {
+						bestJoint[k] = bestJoint[k - 1];
+						bestWeight[k] = bestWeight[k - 1];
+					}
+					bestJoint[j] = joint;
+					bestWeight[j] = weight;
+					break;
+				}
+			}
+		} while ( !weightIndex[w++ * 2 + 1] );
+
+		float total = bestWeight[0] + bestWeight[1] + bestWeight[2] + bestWeight[3];
+		if ( total <= 0.0f ) {
+			// can't be normalized, so leave it on the CPU
+			skinnedJoints.Clear();
+			break;
+		}
+
+		int sum = 0;
+		for ( j = 0; j < 4; j++ ) {
+			weights[i].jointIndexes[j] = 0;
+			weights[i].jointWeights[j] = 0;
+			if ( bestWeight[j] <= 0.0f ) {
+				continue;
+			}
+			if ( paletteIndex[bestJoint[j]] == -1 ) {
+				paletteIndex[bestJoint[j]] = skinnedJoints.Append( bestJoint[j] );
+			}
+			weights[i].jointIndexes[j] = (byte) Min( paletteIndex[bestJoint[j]], 255 );
+			weights[i].jointWeights[j] = (byte) idMath::FtoiFast( bestWeight[j] / total * 255.0f );
+			sum += weights[i].jointWeights[j];
+		}
+
+		// the largest weight takes the rounding error so the weights sum to one
+		weights[i].jointWeights[0] = (byte)( weights[i].jointWeights[0] + 255 - sum );
+	}
+
+	if ( skinnedJoints.Num() > 0 && skinnedJoints.Num() <= MAX_SKINNING_JOINTS ) {
+		invertedBindPose.SetNum( skinnedJoints.Num() );
+		for ( i = 0; i < skinnedJoints.Num(); i++ ) {
+			invertedBindPose[i].SetRotation( mat3_identity );
+			invertedBindPose[i].SetTranslation( vec3_origin );
+			invertedBindPose[i] /= joints[skinnedJoints[i]];
+		}
+		R_BuildDeformInfoSkinning( deformInfo, bindVerts, weights );
+	} else {
+		skinnedJoints.Clear();
+	}
+
+	Mem_Free( weights );
+
+	BuildSkinnedJointBounds();
+}
+
+/*
+====================
+idMD5Mesh::BuildSkinnedJointBounds
+
+A skinned vertex is a weighted average of its bind pose position taken through
+each influencing joint, so the union of these bounds transformed by the palette
+contains the skinned surface
+====================
+*/
+void idMD5Mesh::BuildSkinnedJointBounds( void ) {
+	int		i, j;
+
+	skinnedJointBounds.SetNum( skinnedJoints.Num() );
+	for ( i = 0; i < skinnedJointBounds.Num(); i++ ) {
+		skinnedJointBounds[i].Clear();
+	}
+
+	if ( deformInfo == NULL || deformInfo->skinnedVerts == NULL ) {
+		return;
+	}
+
+	for ( i = 0; i < deformInfo->numSourceVerts; i++ ) {
+		const skinnedWeight_t &weight = deformInfo->skinnedWeights[i];
+		for ( j = 0; j < 4; j++ ) {
+			if ( weight.jointWeights[j] != 0 ) {
+				skinnedJointBounds[weight.jointIndexes[j]].AddPoint( deformInfo->skinnedVerts[i].xyz );
+			}
+		}
+	}
+}
+
+/*
+====================
+idMD5Mesh::SkinnedBounds
+
+Conservative bounds of the surface skinned with the palette, without transforming the vertexes
+====================
+*/
+idBounds idMD5Mesh::SkinnedBounds( const idJointMat *palette ) const {
+	idBounds	bounds;
+
+	bounds.Clear();
+	for ( int i = 0; i < skinnedJointBounds.Num(); i++ ) {
+		const idBounds &jointBounds = skinnedJointBounds[i];
+		if ( jointBounds.IsCleared() ) {
+			continue;
+		}
+
+		const idVec3 center = jointBounds.GetCenter();
+		const idVec3 extents = jointBounds[1] - center;
+		const float *m = palette[i].ToFloatPtr();
+
+		const idVec3 origin = palette[i] * idVec4( center.x, center.y, center.z, 1.0f );
+		const idVec3 rotatedExtents(	idMath::Fabs( m[0 * 4 + 0] ) * extents[0] + idMath::Fabs( m[0 * 4 + 1] ) * extents[1] + idMath::Fabs( m[0 * 4 + 2] ) * extents[2],
+										idMath::Fabs( m[1 * 4 + 0] ) * extents[0] + idMath::Fabs( m[1 * 4 + 1] ) * extents[1] + idMath::Fabs( m[1 * 4 + 2] ) * extents[2],
+										idMath::Fabs( m[2 * 4 + 0] ) * extents[0] + idMath::Fabs( m[2 * 4 + 1] ) * extents[1] + idMath::Fabs( m[2 * 4 + 2] ) * extents[2] );
+
+		bounds.AddPoint( origin - rotatedExtents );
+		bounds.AddPoint( origin + rotatedExtents );
+	}
+	return bounds;
+}
+
+/*
+====================
+idMD5Mesh::BuildSkinnedJoints
+
+The palette takes the bind pose vertexes to the entity joints
+====================
+*/
+void idMD5Mesh::BuildSkinnedJoints( const idJointMat *entJoints, idJointMat *palette ) const {
+	for ( int i = 0; i < skinnedJoints.Num(); i++ ) {
+		palette[i] = invertedBindPose[i];
+		palette[i] *= entJoints[skinnedJoints[i]];
+	}
+}
+
+/*
+====================
+idMD5Mesh::UseGPUSkinning
+
+Only the builtin programs blend joints, and they take the joint indexes
+in place of the vertex color
+====================
+*/
+bool idMD5Mesh::UseGPUSkinning( const struct renderEntity_s *ent ) const {
+	if ( !r_useGPUSkinning.GetBool() || !glConfig.uniformBufferAvailable ) {
+		return false;
+	}
+	if ( deformInfo == NULL || deformInfo->skinnedVerts == NULL ) {
+		return false;
+	}
+
+	// the fat / skinny transform is only done on the CPU
+	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
+		return false;
+	}
+
+	// gui surfaces need the positions to find the gui axis
+	const idMaterial *remapped = R_RemapShaderBySkin( shader, ent->customSkin, ent->customShader );
+	if ( remapped == NULL || remapped->Deform() != DFRM_NONE || remapped->HasGui() ) {
+		return false;
+	}
+
+	for ( int i = 0; i < remapped->GetNumStages(); i++ ) {
+		const shaderStage_t *stage = remapped->GetStage( i );
+		if ( stage->newStage != NULL || stage->vertexColor != SVC_IGNORE ) {
+			return false;
+		}
+		if ( stage->texture.texgen == TG_REFLECT_CUBE || stage->texture.texgen == TG_SKYBOX_CUBE || stage->texture.texgen == TG_WOBBLESKY_CUBE ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+====================
+idMD5Mesh::SkinningError
+
+Returns the largest distance between the CPU deformed vertexes and the same
+pose blended the way the vertex programs do it, or -1 if the mesh can't be
+skinned on the GPU
+====================
+*/
+float idMD5Mesh::SkinningError( const idJointMat *entJoints ) {
+	int		i, j;
+
+	if ( deformInfo == NULL || deformInfo->skinnedVerts == NULL ) {
+		return -1.0f;
+	}
+
+	idDrawVert *verts = (idDrawVert *) Mem_Alloc16( texCoords.Num() * sizeof( verts[0] ) );
+	idJointMat *palette = (idJointMat *) _alloca16( skinnedJoints.Num() * sizeof( palette[0] ) );
+
+	TransformVerts( verts, entJoints );
+	BuildSkinnedJoints( entJoints, palette );
+
+	float maxError = 0.0f;
+	for ( i = 0; i < texCoords.Num(); i++ ) {
+		const idVec4 bindPos( deformInfo->skinnedVerts[i].xyz.x, deformInfo->skinnedVerts[i].xyz.y, deformInfo->skinnedVerts[i].xyz.z, 1.0f );
+		const skinnedWeight_t &weight = deformInfo->skinnedWeights[i];
+
+		idVec3 pos = vec3_origin;
+		for ( j = 0; j < 4; j++ ) {
+			pos += ( palette[weight.jointIndexes[j]] * bindPos ) * ( weight.jointWeights[j] * ( 1.0f / 255.0f ) );
+		}
+		maxError = Max( maxError, ( pos - verts[i].xyz ).Length() );
+	}
+
+	Mem_Free16( verts );
+
+	return maxError;
 }
 
 /*
@@ -270,10 +640,14 @@ void idMD5Mesh::TransformScaledVerts( idDrawVert *verts, const idJointMat *entJo
 /*
 ====================
 idMD5Mesh::UpdateSurface
+
+Allocates the triangle surface for the mesh, SkinSurface fills in the
+vertexes.  All the allocations are done here, so SkinSurface can run
+as a front end job.
 ====================
 */
-void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, modelSurface_t *surf ) {
-	int i, base;
+void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, modelSurface_t *surf ) {
+	int i;
 	srfTriangles_t *tri;
 
 	tr.pc.c_deformedSurfaces++;
@@ -322,6 +696,47 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 		}
 	}
 
+	if ( UseGPUSkinning( ent ) ) {
+		// the vertex programs blend the bind pose, so nothing is transformed on the CPU here.
+		// R_SkinTriSurfVerts fills in the positions only when a shadow volume, an overlay, a trace
+		// or a fixed function light pass needs them, and the bounds come from the joints
+		tri->skinnedDeformInfo = deformInfo;
+		if ( tri->skinnedJoints == NULL ) {
+			// the whole matrices_ubo block is uploaded and bound, the unused joints stay zero
+			tri->skinnedJoints = (idJointMat *) Mem_Alloc16( MAX_SKINNING_JOINTS * sizeof( tri->skinnedJoints[0] ) );
+			memset( tri->skinnedJoints, 0, MAX_SKINNING_JOINTS * sizeof( tri->skinnedJoints[0] ) );
+		}
+		tri->numSkinnedJoints = skinnedJoints.Num();
+		tri->skinnedVertsValid = false;
+		return;
+	}
+	tri->skinnedDeformInfo = NULL;
+	tri->skinnedVertsValid = false;
+
+	// R_DeriveTangents would allocate the face planes
+	if ( !r_useDeferredTangents.GetBool() && tri->dominantTris == NULL && tri->facePlanes == NULL ) {
+		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
+	}
+}
+
+/*
+====================
+idMD5Mesh::SkinSurface
+
+Transforms the vertexes of a surface set up by UpdateSurface.
+Doesn't allocate or touch anything shared, so different surfaces can be
+skinned at the same time.  The tangent counter goes to counters if it isn't NULL.
+====================
+*/
+void idMD5Mesh::SkinSurface( const struct renderEntity_s *ent, const idJointMat *entJoints, srfTriangles_t *tri, frontEndJobCounters_t *counters ) {
+	int i, base;
+
+	if ( tri->skinnedDeformInfo != NULL ) {
+		BuildSkinnedJoints( entJoints, tri->skinnedJoints );
+		tri->bounds = SkinnedBounds( tri->skinnedJoints );
+		return;
+	}
+
 	if ( ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] != 0.0f ) {
 		TransformScaledVerts( tri->verts, entJoints, ent->shaderParms[ SHADERPARM_MD5_SKINSCALE ] );
 	} else {
@@ -342,7 +757,7 @@ void idMD5Mesh::UpdateSurface( const struct renderEntity_s *ent, const idJointMa
 	// has ambient drawing, or is culled, no additional work will be necessary
 	if ( !r_useDeferredTangents.GetBool() ) {
 		// set face planes, vertex normals, tangents
-		R_DeriveTangents( tri );
+		R_DeriveTangents( tri, true, counters );
 	}
 }
 
@@ -498,13 +913,29 @@ void idRenderModelMD5::LoadModel() {
 	idJointQuat	*pose;
 	idMD5Joint	*joint;
 	idJointMat *poseMat3;
+	void		*buffer;
+	int			length;
 
 	if ( !purged ) {
 		PurgeModel();
 	}
 	purged = false;
 
-	if ( !parser.LoadFile( name ) ) {
+	// set the timestamp for reloadmodels
+	length = fileSystem->ReadFile( name, &buffer, &timeStamp );
+	if ( length < 0 ) {
+		MakeDefaultModel();
+		return;
+	}
+
+	const unsigned int checksum = (unsigned int)CRC32_BlockChecksum( buffer, length );
+	if ( r_useCachedModels.GetBool() && LoadBinaryMD5( checksum, length ) ) {
+		fileSystem->FreeFile( buffer );
+		return;
+	}
+
+	if ( !parser.LoadMemory( (const char *)buffer, length, name ) ) {
+		fileSystem->FreeFile( buffer );
 		MakeDefaultModel();
 		return;
 	}
@@ -569,8 +1000,169 @@ void idRenderModelMD5::LoadModel() {
 	//
 	CalculateBounds( poseMat3 );
 
-	// set the timestamp for reloadmodels
-	fileSystem->ReadFile( name, NULL, &timeStamp );
+	parser.FreeSource();
+	fileSystem->FreeFile( buffer );
+
+	if ( r_useCachedModels.GetBool() ) {
+		WriteBinaryMD5( checksum, length );
+	}
+}
+
+/*
+====================
+R_BinaryMD5FileName
+====================
+*/
+static void R_BinaryMD5FileName( const char *modelName, idStr &fileName ) {
+	fileName = "generated/";
+	fileName += modelName;
+	fileName.SetFileExtension( "bmd5mesh" );
+}
+
+/*
+====================
+idRenderModelMD5::LoadBinaryMD5
+
+The joints and meshes are read from generated/<model>.bmd5mesh with a single file
+read.  The cache is keyed on a checksum of the md5mesh text, so it stays valid when
+a pk4 is repacked and is rejected as soon as the text is edited.
+====================
+*/
+bool idRenderModelMD5::LoadBinaryMD5( unsigned int sourceChecksum, int sourceLength ) {
+	idStr fileName;
+	void *buffer;
+
+	R_BinaryMD5FileName( name, fileName );
+
+	int length = fileSystem->ReadFile( fileName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( fileName, (const char *)buffer, length );
+	bool valid = ReadBinaryMD5( &file, sourceChecksum, sourceLength );
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		common->DPrintf( "%s is out of date\n", fileName.c_str() );
+		PurgeModel();
+		purged = false;
+	}
+	return valid;
+}
+
+/*
+====================
+idRenderModelMD5::ReadBinaryMD5
+====================
+*/
+bool idRenderModelMD5::ReadBinaryMD5( idFile *file, unsigned int sourceChecksum, int sourceLength ) {
+	int				magic, version, byteOrder, vertSize, indexSize, jointSize;
+	unsigned int	cachedChecksum;
+	int				cachedLength, num, i;
+
+	file->ReadInt( magic );
+	file->ReadInt( version );
+	file->Read( &byteOrder, sizeof( byteOrder ) );
+	file->ReadInt( vertSize );
+	file->ReadInt( indexSize );
+	file->ReadInt( jointSize );
+	if ( magic != BMD5MESH_MAGIC || version != BMD5MESH_VERSION || byteOrder != 1 || vertSize != sizeof( idDrawVert ) ||
+			indexSize != sizeof( glIndex_t ) || jointSize != sizeof( idJointMat ) ) {
+		return false;
+	}
+
+	file->ReadUnsignedInt( cachedChecksum );
+	file->ReadInt( cachedLength );
+	if ( cachedChecksum != sourceChecksum || cachedLength != sourceLength ) {
+		return false;
+	}
+
+	if ( file->ReadInt( num ) != sizeof( num ) || num <= 0 || num > file->Length() / (int)sizeof( idJointQuat ) ) {
+		return false;
+	}
+	joints.SetGranularity( 1 );
+	joints.SetNum( num );
+	defaultPose.SetGranularity( 1 );
+	defaultPose.SetNum( num );
+	for ( i = 0; i < joints.Num(); i++ ) {
+		int parentNum;
+
+		file->ReadString( joints[i].name );
+		file->ReadInt( parentNum );
+		if ( parentNum >= i ) {
+			return false;
+		}
+		joints[i].parent = ( parentNum < 0 ) ? NULL : &joints[parentNum];
+	}
+	if ( file->Read( defaultPose.Ptr(), num * sizeof( defaultPose[0] ) ) != num * (int)sizeof( defaultPose[0] ) ) {
+		return false;
+	}
+
+	file->ReadVec3( bounds[0] );
+	file->ReadVec3( bounds[1] );
+
+	if ( file->ReadInt( num ) != sizeof( num ) || num < 0 || num > file->Length() ) {
+		return false;
+	}
+	meshes.SetGranularity( 1 );
+	meshes.SetNum( num );
+	for ( i = 0; i < meshes.Num(); i++ ) {
+		if ( !meshes[i].ReadBinary( file, joints.Num() ) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+====================
+idRenderModelMD5::WriteBinaryMD5
+
+The arrays are written in native byte order, the byte order marker makes
+a cache written on a machine with the other order invalid
+====================
+*/
+void idRenderModelMD5::WriteBinaryMD5( unsigned int sourceChecksum, int sourceLength ) const {
+	idStr fileName;
+	const int byteOrder = 1;
+	int i;
+
+	R_BinaryMD5FileName( name, fileName );
+
+	idFile *file = fileSystem->OpenFileWrite( fileName, "fs_basepath" );
+	if ( file == NULL ) {
+		// the base path may be read only, the model is simply parsed every time
+		common->DPrintf( "couldn't write md5 cache file %s\n", fileName.c_str() );
+		return;
+	}
+
+	file->WriteInt( BMD5MESH_MAGIC );
+	file->WriteInt( BMD5MESH_VERSION );
+	file->Write( &byteOrder, sizeof( byteOrder ) );
+	file->WriteInt( sizeof( idDrawVert ) );
+	file->WriteInt( sizeof( glIndex_t ) );
+	file->WriteInt( sizeof( idJointMat ) );
+	file->WriteUnsignedInt( sourceChecksum );
+	file->WriteInt( sourceLength );
+
+	file->WriteInt( joints.Num() );
+	for ( i = 0; i < joints.Num(); i++ ) {
+		file->WriteString( joints[i].name );
+		file->WriteInt( joints[i].parent ? joints[i].parent - joints.Ptr() : -1 );
+	}
+	file->Write( defaultPose.Ptr(), defaultPose.Num() * sizeof( defaultPose[0] ) );
+
+	file->WriteVec3( bounds[0] );
+	file->WriteVec3( bounds[1] );
+
+	file->WriteInt( meshes.Num() );
+	for ( i = 0; i < meshes.Num(); i++ ) {
+		meshes[i].WriteBinary( file );
+	}
+
+	fileSystem->CloseFile( file );
 }
 
 /*
@@ -626,6 +1218,184 @@ void idRenderModelMD5::List() const {
 	common->Printf( "\n" );
 }
 
+/*
+====================
+idRenderModelMD5::TestGPUSkinning
+====================
+*/
+void idRenderModelMD5::TestGPUSkinning( const idJointMat *entJoints ) {
+	int		i, numSkinned = 0;
+	float	maxError = 0.0f;
+
+	for ( i = 0; i < meshes.Num(); i++ ) {
+		float error = meshes[i].SkinningError( entJoints );
+		if ( error < 0.0f ) {
+			common->Printf( "%2i: %4i verts, CPU only, %s\n", i, meshes[i].NumVerts(), meshes[i].shader->GetName() );
+			continue;
+		}
+		common->Printf( "%2i: %4i verts, %3i joints, max error %.4f, %s\n", i, meshes[i].NumVerts(), meshes[i].skinnedJoints.Num(), error, meshes[i].shader->GetName() );
+		maxError = Max( maxError, error );
+		numSkinned++;
+	}
+	common->Printf( "%i of %i meshes GPU skinned, max error %.4f\n", numSkinned, meshes.Num(), maxError );
+}
+
+/*
+====================
+R_TestSkinTriSurfVerts
+
+Builds a bind pose and an entity pose from random joints and up to four
+random byte weights per vertex, the same way BuildSkinning packs them, and
+compares R_SkinTriSurfVerts with the TransformVerts result of the CPU path.
+Like an exported md5mesh, every weight of a vertex puts it at the same bind
+pose position, so both paths have to agree up to float precision
+====================
+*/
+static void R_TestSkinTriSurfVerts( void ) {
+	const int		NUM_TEST_JOINTS = 64;
+	const int		NUM_TEST_VERTS = 1024;
+	int				i, j, numWeights;
+	srfTriangles_t	tri;
+	deformInfo_t	deform;
+
+	idRandom random( 0 );
+
+	idJointMat *bindJoints = (idJointMat *) Mem_Alloc16( NUM_TEST_JOINTS * sizeof( bindJoints[0] ) );
+	idJointMat *entJoints = (idJointMat *) Mem_Alloc16( NUM_TEST_JOINTS * sizeof( entJoints[0] ) );
+	idJointMat *invertedBindPose = (idJointMat *) Mem_Alloc16( NUM_TEST_JOINTS * sizeof( invertedBindPose[0] ) );
+	idJointMat *palette = (idJointMat *) Mem_Alloc16( MAX_SKINNING_JOINTS * sizeof( palette[0] ) );
+	idVec4 *scaledWeights = (idVec4 *) Mem_Alloc16( NUM_TEST_VERTS * 4 * sizeof( scaledWeights[0] ) );
+	int *weightIndex = (int *) Mem_Alloc16( NUM_TEST_VERTS * 4 * 2 * sizeof( weightIndex[0] ) );
+	idDrawVert *bindVerts = (idDrawVert *) Mem_Alloc16( NUM_TEST_VERTS * sizeof( bindVerts[0] ) );
+	idDrawVert *posedVerts = (idDrawVert *) Mem_Alloc16( NUM_TEST_VERTS * sizeof( posedVerts[0] ) );
+	idDrawVert *skinnedVerts = (idDrawVert *) Mem_Alloc16( NUM_TEST_VERTS * sizeof( skinnedVerts[0] ) );
+	skinnedWeight_t *skinnedWeights = (skinnedWeight_t *) Mem_Alloc16( NUM_TEST_VERTS * sizeof( skinnedWeights[0] ) );
+
+	for ( i = 0; i < NUM_TEST_JOINTS; i++ ) {
+		idAngles angles( random.CRandomFloat() * 180.0f, random.CRandomFloat() * 180.0f, random.CRandomFloat() * 180.0f );
+		bindJoints[i].SetRotation( angles.ToMat3() );
+		bindJoints[i].SetTranslation( idVec3( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() ) * 64.0f );
+
+		angles.Set( random.CRandomFloat() * 180.0f, random.CRandomFloat() * 180.0f, random.CRandomFloat() * 180.0f );
+		entJoints[i].SetRotation( angles.ToMat3() );
+		entJoints[i].SetTranslation( idVec3( random.CRandomFloat(), random.CRandomFloat(), random.CRandomFloat() ) * 64.0f );
+
+		invertedBindPose[i].SetRotation( mat3_identity );
+		invertedBindPose[i].SetTranslation( vec3_origin );
+		invertedBindPose[i] /= bindJoints[i];
+		palette[i] = invertedBindPose[i];
+		palette[i] *= entJoints[i];
+	}
+
+	for ( i = 0, numWeights = 0; i < NUM_TEST_VERTS; i++ ) {
+		int numInfluences = 1 + random.RandomInt( 4 );
+		int remaining = 255;
+		idVec4 bindPos( random.CRandomFloat() * 64.0f, random.CRandomFloat() * 64.0f, random.CRandomFloat() * 64.0f, 1.0f );
+
+		memset( &skinnedWeights[i], 0, sizeof( skinnedWeights[i] ) );
+		for ( j = 0; j < numInfluences; j++ ) {
+			int weight = ( j == numInfluences - 1 ) ? remaining : random.RandomInt( remaining + 1 );
+			remaining -= weight;
+
+			int joint = random.RandomInt( NUM_TEST_JOINTS );
+			float scale = weight * ( 1.0f / 255.0f );
+			idVec3 offset = invertedBindPose[joint] * bindPos;
+
+			skinnedWeights[i].jointIndexes[j] = (byte)joint;
+			skinnedWeights[i].jointWeights[j] = (byte)weight;
+
+			scaledWeights[numWeights].ToVec3() = offset * scale;
+			scaledWeights[numWeights].w = scale;
+			weightIndex[numWeights * 2 + 0] = joint * sizeof( idJointMat );
+			weightIndex[numWeights * 2 + 1] = ( j == numInfluences - 1 );
+			numWeights++;
+		}
+	}
+
+	memset( bindVerts, 0, NUM_TEST_VERTS * sizeof( bindVerts[0] ) );
+	SIMDProcessor->TransformVerts( bindVerts, NUM_TEST_VERTS, bindJoints, scaledWeights, weightIndex, numWeights );
+	SIMDProcessor->TransformVerts( posedVerts, NUM_TEST_VERTS, entJoints, scaledWeights, weightIndex, numWeights );
+
+	memset( &deform, 0, sizeof( deform ) );
+	deform.numSourceVerts = NUM_TEST_VERTS;
+	deform.numOutputVerts = NUM_TEST_VERTS;
+	deform.skinnedVerts = bindVerts;
+	deform.skinnedWeights = skinnedWeights;
+
+	memset( &tri, 0, sizeof( tri ) );
+	tri.numVerts = NUM_TEST_VERTS;
+	tri.verts = skinnedVerts;
+	tri.skinnedDeformInfo = &deform;
+	tri.numSkinnedJoints = NUM_TEST_JOINTS;
+	tri.skinnedJoints = palette;
+
+	R_SkinTriSurfVerts( &tri );
+
+	float maxError = 0.0f;
+	for ( i = 0; i < NUM_TEST_VERTS; i++ ) {
+		maxError = Max( maxError, ( skinnedVerts[i].xyz - posedVerts[i].xyz ).Length() );
+	}
+	const char *result = ( tri.skinnedVertsValid && maxError < 0.01f ) ? "ok" : S_COLOR_RED"X";
+	common->Printf( "R_SkinTriSurfVerts() %s, %i verts, max error %.5f\n", result, NUM_TEST_VERTS, maxError );
+
+	Mem_Free16( bindJoints );
+	Mem_Free16( entJoints );
+	Mem_Free16( invertedBindPose );
+	Mem_Free16( palette );
+	Mem_Free16( scaledWeights );
+	Mem_Free16( weightIndex );
+	Mem_Free16( bindVerts );
+	Mem_Free16( posedVerts );
+	Mem_Free16( skinnedVerts );
+	Mem_Free16( skinnedWeights );
+}
+
+/*
+====================
+R_TestGPUSkinning_f
+
+Without arguments the CPU skinning of the GPU path is checked against
+TransformVerts on synthetic weights.  With a model, it is posed with random
+joint rotations and the CPU deformed vertexes are compared with the GPU
+skinning path emulated on the CPU
+====================
+*/
+void R_TestGPUSkinning_f( const idCmdArgs &args ) {
+	int		i;
+
+	if ( args.Argc() < 2 ) {
+		R_TestSkinTriSurfVerts();
+		common->Printf( "usage: testGPUSkinning [md5mesh] [degrees]\n" );
+		return;
+	}
+
+	idRenderModelMD5 *model = dynamic_cast<idRenderModelMD5 *>( renderModelManager->FindModel( args.Argv( 1 ) ) );
+	if ( model == NULL || model->IsDefaultModel() ) {
+		common->Printf( "'%s' is not an md5 model\n", args.Argv( 1 ) );
+		return;
+	}
+
+	float degrees = ( args.Argc() > 2 ) ? atof( args.Argv( 2 ) ) : 30.0f;
+
+	const idMD5Joint *md5Joints = model->GetJoints();
+	const idJointQuat *pose = model->GetDefaultPose();
+	idJointMat *joints = (idJointMat *) Mem_Alloc16( model->NumJoints() * sizeof( joints[0] ) );
+	idRandom random( 0 );
+
+	for ( i = 0; i < model->NumJoints(); i++ ) {
+		idAngles angles( random.CRandomFloat() * degrees, random.CRandomFloat() * degrees, random.CRandomFloat() * degrees );
+		joints[i].SetRotation( angles.ToMat3() * pose[i].q.ToMat3() );
+		joints[i].SetTranslation( pose[i].t );
+		if ( md5Joints[i].parent ) {
+			joints[i] *= joints[ md5Joints[i].parent - md5Joints ];
+		}
+	}
+
+	model->TestGPUSkinning( joints );
+
+	Mem_Free16( joints );
+}
+
 /*
 ====================
 idRenderModelMD5::CalculateBounds
@@ -801,7 +1571,20 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 			surf->id = i;
 		}
 
-		mesh->UpdateSurface( ent, ent->joints, surf );
+		mesh->UpdateSurface( ent, surf );
+
+		if ( tr.deferSkinning ) {
+			// R_AddModelSurfaces skins the surface in a job and grows the bounds afterwards
+			deferredSkin_t &skin = tr.deferredSkins.Alloc();
+			skin.mesh = mesh;
+			skin.ent = ent;
+			skin.tri = surf->geometry;
+			skin.modelBounds = &staticModel->bounds;
+			memset( &skin.counters, 0, sizeof( skin.counters ) );
+			continue;
+		}
+
+		mesh->SkinSurface( ent, ent->joints, surf->geometry, NULL );
 
 		staticModel->bounds.AddPoint( surf->geometry->bounds[0] );
 		staticModel->bounds.AddPoint( surf->geometry->bounds[1] );
@@ -810,6 +1593,15 @@ idRenderModel *idRenderModelMD5::InstantiateDynamicModel( const struct renderEnt
 	return staticModel;
 }
 
+/*
+====================
+R_SkinDeferredSurface
+====================
+*/
+void R_SkinDeferredSurface( deferredSkin_t *skin ) {
+	skin->mesh->SkinSurface( skin->ent, skin->ent->joints, skin->tri, &skin->counters );
+}
+
 /*
 ====================
 idRenderModelMD5::IsDynamicModel
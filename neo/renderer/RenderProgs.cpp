@@ -36,6 +36,10 @@
 
 idRenderProgManager renderProgManager;
 
+// a range is written for every draw after a renderparm changed, at 256 byte alignment
+// this is several thousand draws before the buffer is orphaned
+static const int RENDERPARM_RING_SIZE = 4 * 1024 * 1024;
+
 /*
 ================================================================================================
 idRenderProgManager::idRenderProgManager()
@@ -43,6 +47,9 @@ idRenderProgManager::idRenderProgManager()
 */
 idRenderProgManager::idRenderProgManager()
 {
+    renderParmBuffer = 0;
+    renderParmBlockSerial = -1;
+    renderParmBlockOffset = 0;
 }
 
 /*
@@ -65,6 +72,76 @@ static void R_ReloadShaders( const idCmdArgs& args )
     renderProgManager.LoadAllShaders();
 }
 
+/*
+================================================================================================
+R_TestRenderParmBlock
+
+Checks the parts of the renderparm block that make no GL calls, like testSIMD does for the
+SIMD functions. Every renderparm has to get its own vector of the block, and the ring has
+to hand out aligned ranges that never overlap the previous range until it wraps.
+================================================================================================
+*/
+static void R_TestRenderParmBlock( const idCmdArgs& args )
+{
+    bool used[RENDERPARM_BLOCK_VECTORS];
+    memset( used, 0, sizeof( used ) );
+    
+    bool packed = true;
+    for( int rp = 0; rp < RENDERPARM_USER + idRenderProgManager::MAX_GLSL_USER_PARMS; rp++ )
+    {
+        if( rp >= RENDERPARM_TOTAL && rp < RENDERPARM_USER )
+        {
+            continue;
+        }
+        const int index = RenderParmBlockIndex( rp );
+        if( index < 0 || index >= RENDERPARM_BLOCK_VECTORS || used[index] )
+        {
+            packed = false;
+            break;
+        }
+        used[index] = true;
+    }
+    for( int i = 0; i < RENDERPARM_BLOCK_VECTORS; i++ )
+    {
+        packed &= used[i];
+    }
+    common->Printf( "RenderParmBlockIndex() %s, %d vectors\n", packed ? "ok" : S_COLOR_RED"X", RENDERPARM_BLOCK_VECTORS );
+    
+    const int alignment = 256;
+    const int ringSize = 16 * 1024 + 100;
+    const int blockBytes = RENDERPARM_BLOCK_VECTORS * sizeof( idVec4 );
+    idUniformRing ring;
+    ring.Init( ringSize, alignment );
+    
+    bool wrapped;
+    bool valid = ( ring.Alloc( ringSize + 1, wrapped ) == -1 );
+    int numWraps = 0;
+    int previousEnd = 0;
+    for( int i = 0; i < 1000 && valid; i++ )
+    {
+        // odd sizes, so the next offset has to be rounded up
+        const int bytes = ( i & 1 ) ? blockBytes : ( 1 + i % 7 ) * 48;
+        const int offset = ring.Alloc( bytes, wrapped );
+        if( offset < 0 || offset % alignment != 0 || offset + bytes > ringSize )
+        {
+            valid = false;
+        }
+        else if( wrapped )
+        {
+            // only wraps when the range didn't fit after the previous one
+            valid = ( offset == 0 && ( previousEnd + alignment - 1 ) / alignment * alignment + bytes > ringSize );
+            numWraps++;
+        }
+        else
+        {
+            valid = ( offset >= previousEnd );
+        }
+        previousEnd = offset + bytes;
+    }
+    valid &= ( numWraps > 0 );
+    common->Printf( "idUniformRing::Alloc() %s, %d wraps\n", valid ? "ok" : S_COLOR_RED"X", numWraps );
+}
+
 /*
 ================================================================================================
 idRenderProgManager::Init()
@@ -121,14 +198,29 @@ void idRenderProgManager::Init()
         vertexShaders[i].name = builtins[i].name;
         fragmentShaders[i].name = builtins[i].name;
         builtinShaders[builtins[i].index] = i;
-        LoadVertexShader( i );
-        LoadFragmentShader( i );
+    }
+    
+    LoadGLSLShaders();
+    for( int i = 0; i < numBuiltins; i++ )
+    {
         LoadGLSLProgram( i, i, i );
     }
 
     glslUniforms.SetNum( RENDERPARM_USER + MAX_GLSL_USER_PARMS, vec4_zero );
+    glslUniformSerials.SetNum( RENDERPARM_USER + MAX_GLSL_USER_PARMS );
+    ResetUniformSerials();
+    
+    if( glConfig.uniformBufferAvailable )
+    {
+        glGenBuffers( 1, &renderParmBuffer );
+        glBindBuffer( GL_UNIFORM_BUFFER, renderParmBuffer );
+        glBufferData( GL_UNIFORM_BUFFER, RENDERPARM_RING_SIZE, NULL, GL_STREAM_DRAW );
+        glBindBuffer( GL_UNIFORM_BUFFER, 0 );
+        renderParmRing.Init( RENDERPARM_RING_SIZE, glConfig.uniformBufferOffsetAlignment );
+    }
     
     cmdSystem->AddCommand( "reloadShaders", R_ReloadShaders, CMD_FL_RENDERER, "reloads shaders" );
+    cmdSystem->AddCommand( "testRenderParmBlock", R_TestRenderParmBlock, CMD_FL_RENDERER, "tests the renderparm block packing and the uniform ring" );
 }
 
 /*
@@ -138,14 +230,7 @@ idRenderProgManager::LoadAllShaders()
 */
 void idRenderProgManager::LoadAllShaders()
 {
-    for( int i = 0; i < vertexShaders.Num(); i++ )
-    {
-        LoadVertexShader( i );
-    }
-    for( int i = 0; i < fragmentShaders.Num(); i++ )
-    {
-        LoadFragmentShader( i );
-    }
+    LoadGLSLShaders();
     
     for( int i = 0; i < glslPrograms.Num(); ++i )
     {
@@ -195,6 +280,12 @@ idRenderProgManager::Shutdown()
 void idRenderProgManager::Shutdown()
 {
     KillAllShaders();
+    
+    if( renderParmBuffer != 0 )
+    {
+        glDeleteBuffers( 1, &renderParmBuffer );
+        renderParmBuffer = 0;
+    }
 }
 
 /*
@@ -32,6 +32,7 @@
 
 static const int PC_ATTRIB_INDEX_VERTEX		= 0;
 static const int PC_ATTRIB_INDEX_COLOR		= 3;
+static const int PC_ATTRIB_INDEX_COLOR2		= 4;
 static const int PC_ATTRIB_INDEX_ST			= 8;
 static const int PC_ATTRIB_INDEX_TANGENT	= 9;
 static const int PC_ATTRIB_INDEX_BITANGENT	= 10;
@@ -126,6 +127,65 @@ struct glslUniformLocation_t
     GLint	uniformIndex;
 };
 
+// with uniform buffers all renderparms live in one std140 block, the user parms follow
+// the others, see RENDERPARM_BLOCK_VECTORS after idRenderProgManager for its size
+static const int RENDERPARM_BLOCK_BINDING	= 1;	// 0 is the matrices_ubo block for GPU skinning
+
+ID_INLINE int RenderParmBlockIndex( int rp )
+{
+    return ( rp < RENDERPARM_USER ) ? rp : RENDERPARM_TOTAL + ( rp - RENDERPARM_USER );
+}
+
+/*
+================================================================================================
+idUniformRing
+
+Hands out aligned ranges of a uniform buffer one after another. When the end is reached it
+starts over at zero and reports the wrap, so the caller orphans the buffer before writing
+over ranges the GPU may still read. Makes no GL calls.
+================================================================================================
+*/
+class idUniformRing
+{
+public:
+    idUniformRing() : size( 0 ), alignment( 1 ), offset( 0 ) {}
+    
+    void	Init( int ringSize, int rangeAlignment )
+    {
+        size = ringSize;
+        alignment = rangeAlignment;
+        offset = 0;
+    }
+    
+    // returns the offset of the range or -1 if bytes can never fit
+    int		Alloc( int bytes, bool& wrapped )
+    {
+        wrapped = false;
+        if( bytes > size )
+        {
+            return -1;
+        }
+        if( offset + bytes > size )
+        {
+            offset = 0;
+            wrapped = true;
+        }
+        const int rangeOffset = offset;
+        offset = ( offset + bytes + alignment - 1 ) / alignment * alignment;
+        return rangeOffset;
+    }
+    
+    int		Size() const
+    {
+        return size;
+    }
+    
+private:
+    int		size;
+    int		alignment;
+    int		offset;
+};
+
 
 
 /*
@@ -144,6 +204,7 @@ public:
     
     void	SetRenderParm( renderParm_t rp, const float* value );
     void	SetRenderParms( renderParm_t rp, const float* values, int numValues );
+    const float*	GetRenderParm( renderParm_t rp ) const { return glslUniforms[ rp ].ToFloatPtr(); }
     
     int		FindVertexShader( const char* name );
     int		FindFragmentShader( const char* name );
@@ -189,6 +250,12 @@ public:
     bool	IsShaderBound() const;
     // RB end
     
+    // true if the bound program can blend the joints of a GPU skinned surface
+    bool	ShaderUsesJoints() const
+    {
+        return IsShaderBound() && currentRenderProgram >= 0 && currentRenderProgram < glslPrograms.Num() && glslPrograms[currentRenderProgram].usesJoints;
+    }
+    
     // this should only be called via the reload shader console command
     void	LoadAllShaders();
     void	KillAllShaders();
@@ -245,6 +312,7 @@ protected:
     
     bool	CompileGLSL( GLenum target, const char* name );
     GLuint	LoadGLSLShader( GLenum target, const char* name, idList<int>& uniforms );
+    void	LoadGLSLShaders();
     void	LoadGLSLProgram( const int programIndex, const int vertexShaderIndex, const int fragmentShaderIndex );
     
     static const GLuint INVALID_PROGID = 0xFFFFFFFF;
@@ -270,19 +338,43 @@ protected:
         vertexShaderIndex( -1 ),
         fragmentShaderIndex( -1 ),
         vertexUniformArray( -1 ),
-        fragmentUniformArray( -1 ) {}
+        fragmentUniformArray( -1 ),
+        usesJoints( false ),
+        usesRenderParmBlock( false ),
+        uniformSerial( -1 ) {}
         idStr		name;
         GLuint		progId;
         int			vertexShaderIndex;
         int			fragmentShaderIndex;
         GLint		vertexUniformArray;
         GLint		fragmentUniformArray;
+        bool		usesJoints;			// declares the matrices_ubo block for GPU skinning
+        bool		usesRenderParmBlock;	// reads the renderparms from the uniform buffer ring
         idList<glslUniformLocation_t> uniformLocations;
+        idList<GLint>	vertexUniformLocations;		// location of each uniform array element
+        idList<GLint>	fragmentUniformLocations;
+        int			uniformSerial;		// glslUniformSerial when the uniforms were last committed
     };
     int	currentRenderProgram;
     idList<glslProgram_t> glslPrograms;
     idStaticList < idVec4, RENDERPARM_USER + MAX_GLSL_USER_PARMS > glslUniforms;
     
+    // every uniform value change gets a new serial, so CommitUniforms only
+    // uploads the vectors that changed since the program last committed them
+    idStaticList < int, RENDERPARM_USER + MAX_GLSL_USER_PARMS > glslUniformSerials;
+    int				glslUniformSerial;
+    
+    void			ResetUniformSerials();
+    
+    // ring of renderparm block ranges, a new range is written when a program
+    // that reads the block is drawn after any renderparm changed
+    GLuint			renderParmBuffer;
+    idUniformRing	renderParmRing;
+    int				renderParmBlockSerial;		// glslUniformSerial of the bound range, -1 if none
+    int				renderParmBlockOffset;		// offset of the bound range in renderParmBuffer
+    
+    void			CommitRenderParmBlock();
+    
     int				currentVertexShader;
     int				currentFragmentShader;
     idList<vertexShader_t> vertexShaders;
@@ -291,4 +383,6 @@ protected:
 
 extern idRenderProgManager renderProgManager;
 
+static const int RENDERPARM_BLOCK_VECTORS	= RENDERPARM_TOTAL + idRenderProgManager::MAX_GLSL_USER_PARMS;
+
 #endif
\ No newline at end of file
@@ -42,8 +42,14 @@ idCVar r_displayGLSLCompilerMessages( "r_displayGLSLCompilerMessages", "1", CVAR
 idCVar r_alwaysExportGLSL( "r_alwaysExportGLSL", "1", CVAR_BOOL, "" );
 // RB end
 
+idCVar r_useGLSLCache( "r_useGLSLCache", "1", CVAR_BOOL, "reuse converted GLSL from the on-disk cache when the renderprog source and conversion options are unchanged" );
+idCVar r_useUniformBuffers( "r_useUniformBuffers", "0", CVAR_BOOL, "read the renderparms from a uniform buffer block instead of uniform arrays, needs reloadShaders" );
+idCVar r_useParallelShaderLoading( "r_useParallelShaderLoading", "1", CVAR_BOOL, "convert the renderprogs as jobs when loading all shaders" );
+
 #define VERTEX_UNIFORM_ARRAY_NAME				"_va_"
 #define FRAGMENT_UNIFORM_ARRAY_NAME				"_fa_"
+#define RENDERPARM_BLOCK_NAME					"renderparms_ubo"
+#define RENDERPARM_BLOCK_ARRAY_NAME				"_rp_"
 
 static const int AT_VS_IN  = BIT( 1 );
 static const int AT_VS_OUT = BIT( 2 );
@@ -90,6 +96,7 @@ enum vertexMask_t
     VERTEX_MASK_ST			= BIT( PC_ATTRIB_INDEX_ST ),
     VERTEX_MASK_NORMAL		= BIT( PC_ATTRIB_INDEX_NORMAL ),
     VERTEX_MASK_COLOR		= BIT( PC_ATTRIB_INDEX_COLOR ),
+    VERTEX_MASK_COLOR2		= BIT( PC_ATTRIB_INDEX_COLOR2 ),
     VERTEX_MASK_TANGENT		= BIT( PC_ATTRIB_INDEX_TANGENT ),
 	VERTEX_MASK_BITANGENT	= BIT( PC_ATTRIB_INDEX_BITANGENT ),
 };
@@ -103,6 +110,7 @@ attribInfo_t attribsPC[] =
 	{ "float3",		"tangent",		"TANGENT",		"in_Tangent",			PC_ATTRIB_INDEX_TANGENT,		AT_VS_IN,		VERTEX_MASK_TANGENT },
 	{ "float3",		"bitangent",	"BITANGENT",	"in_Bitangent",			PC_ATTRIB_INDEX_BITANGENT,		AT_VS_IN,		VERTEX_MASK_BITANGENT },
     { "float4",		"color",		"COLOR0",		"in_Color",				PC_ATTRIB_INDEX_COLOR,			AT_VS_IN,		VERTEX_MASK_COLOR },
+    { "float4",		"color2",		"COLOR1",		"in_Color2",			PC_ATTRIB_INDEX_COLOR2,			AT_VS_IN,		VERTEX_MASK_COLOR2 },
     
     // pre-defined vertex program output
     { "float4",		"position",		"POSITION",		"gl_Position",			0,	AT_VS_OUT | AT_VS_OUT_RESERVED, 0 },
@@ -297,6 +305,50 @@ static const char* GLSLParmNames[] =
     "rpAlphaTest"
 };
 
+/*
+ ========================
+ FindGLSLParmIndex
+
+ Same as comparing against idRenderProgManager::GetGLSLParmName but without va() so it can
+ run in a job.
+ ========================
+ */
+static int FindGLSLParmIndex( const char* name )
+{
+    for( int i = 0; i < RENDERPARM_TOTAL; i++ )
+    {
+        if( idStr::Cmp( name, GLSLParmNames[i] ) == 0 )
+        {
+            return i;
+        }
+    }
+    if( idStr::Cmpn( name, "rpUser", 6 ) == 0 )
+    {
+        for( int i = 0; i < idRenderProgManager::MAX_GLSL_USER_PARMS; i++ )
+        {
+            char userParmName[16];
+            idStr::snPrintf( userParmName, sizeof( userParmName ), "rpUser%d", i );
+            if( idStr::Cmp( name, userParmName ) == 0 )
+            {
+                return RENDERPARM_USER + i;
+            }
+        }
+    }
+    return -1;
+}
+
+/*
+ ========================
+ UseRenderParmBlock
+
+ True if converted renderprogs read the renderparms from the uniform buffer block.
+ ========================
+ */
+static bool UseRenderParmBlock()
+{
+    return r_useUniformBuffers.GetBool() && r_useUniformArrays.GetBool() && glConfig.uniformBufferAvailable;
+}
+
 /*
  ========================
  StripDeadCode
@@ -558,6 +610,7 @@ const char* vertexInsert_GLSL_1_20 =
     "#version 120\n"
     "#define PC\n"
     "#extension GL_EXT_gpu_shader4 : enable\n"
+    "#extension GL_ARB_uniform_buffer_object : enable\n"
     "\n"
     "float saturate( float v ) { return clamp( v, 0.0, 1.0 ); }\n"
     "vec2 saturate( vec2 v ) { return clamp( v, 0.0, 1.0 ); }\n"
@@ -585,6 +638,7 @@ const char* fragmentInsert_GLSL_1_20 =
     "#version 120\n"
     "#define PC\n"
     "#extension GL_EXT_gpu_shader4 : enable\n"
+    "#extension GL_ARB_uniform_buffer_object : enable\n"
     "\n"
     "void clip( float v ) { if ( v < 0.0 ) { discard; } }\n"
     "void clip( vec2 v ) { if ( any( lessThan( v, vec2( 0.0 ) ) ) ) { discard; } }\n"
@@ -798,6 +852,7 @@ idStr ConvertCG2GLSL( const idStr& in, const char* name, bool isVertexProgram, i
     
     bool inMain = false;
     const char* uniformArrayName = isVertexProgram ? VERTEX_UNIFORM_ARRAY_NAME : FRAGMENT_UNIFORM_ARRAY_NAME;
+    const bool useRenderParmBlock = UseRenderParmBlock();
     char newline[128] = { "\n" };
     
     idToken token;
@@ -1039,7 +1094,26 @@ idStr ConvertCG2GLSL( const idStr& in, const char* name, bool isVertexProgram, i
                 if( token == uniformList[i] )
                 {
                     program += ( token.linesCrossed > 0 ) ? newline : ( token.WhiteSpaceBeforeToken() > 0 ? " " : "" );
-                    program += va( "%s[%d /* %s */]", uniformArrayName, i, uniformList[i].c_str() );
+                    // no va() here, this runs in a job when loading all shaders
+                    idStr uniformArray;
+                    if( useRenderParmBlock )
+                    {
+                        // unknown names are left alone and reported when the uniform list is read
+                        const int parm = FindGLSLParmIndex( uniformList[i] );
+                        if( parm == -1 )
+                        {
+                            uniformArray = uniformList[i];
+                        }
+                        else
+                        {
+                            uniformArray.Format( "%s[%d /* %s */]", RENDERPARM_BLOCK_ARRAY_NAME, RenderParmBlockIndex( parm ), uniformList[i].c_str() );
+                        }
+                    }
+                    else
+                    {
+                        uniformArray.Format( "%s[%d /* %s */]", uniformArrayName, i, uniformList[i].c_str() );
+                    }
+                    program += uniformArray;
                     isUniform = true;
                     break;
                 }
@@ -1181,9 +1255,17 @@ idStr ConvertCG2GLSL( const idStr& in, const char* name, bool isVertexProgram, i
     
     if( uniformList.Num() > 0 )
     {
-        if( r_useUniformArrays.GetBool() )
+        if( useRenderParmBlock )
+        {
+            idStr uniformBlock;
+            uniformBlock.Format( "\nlayout( std140 ) uniform %s { vec4 %s[%d]; };\n", RENDERPARM_BLOCK_NAME, RENDERPARM_BLOCK_ARRAY_NAME, RENDERPARM_BLOCK_VECTORS );
+            out += uniformBlock;
+        }
+        else if( r_useUniformArrays.GetBool() )
         {
-            out += va( "\nuniform vec4 %s[%d];\n", uniformArrayName, uniformList.Num() );
+            idStr uniformArray;
+            uniformArray.Format( "\nuniform vec4 %s[%d];\n", uniformArrayName, uniformList.Num() );
+            out += uniformArray;
         }
         else
         {
@@ -1211,68 +1293,288 @@ idStr ConvertCG2GLSL( const idStr& in, const char* name, bool isVertexProgram, i
 
 /*
  ================================================================================================
- idRenderProgManager::LoadGLSLShader
+ GLSL cache
+
+ The converted GLSL source and uniform list of every renderprog is cached on disk and
+ keyed by a checksum of the renderprog source with all its includes expanded and the
+ options that change the conversion, so StripDeadCode and ConvertCG2GLSL only run when
+ one of them changed.
  ================================================================================================
  */
-GLuint idRenderProgManager::LoadGLSLShader( GLenum target, const char* name, idList<int>& uniforms )
+static const int GLSL_CACHE_MAGIC			= ( 'G' << 24 ) | ( 'L' << 16 ) | ( 'S' << 8 ) | 'C';
+static const int GLSL_CACHE_VERSION			= 1;		// bump when the conversion itself changes
+static const int GLSL_MAX_INCLUDE_DEPTH		= 8;
+
+/*
+ ========================
+ GetGLSLCacheKey
+ ========================
+ */
+static void GetGLSLCacheKey( const idStr& source, GLenum target, unsigned long& key, int& length )
+{
+    const int options[] =
+    {
+        GLSL_CACHE_VERSION,
+        ( int ) target,
+        ( int ) glConfig.driverType,
+        r_skipStripDeadCode.GetBool(),
+        r_useUniformArrays.GetBool(),
+        UseRenderParmBlock()
+    };
+    
+    length = source.Length();
+    CRC32_InitChecksum( key );
+    CRC32_UpdateChecksum( key, options, sizeof( options ) );
+    CRC32_UpdateChecksum( key, source.c_str(), source.Length() );
+    CRC32_FinishChecksum( key );
+}
+
+/*
+ ========================
+ LoadGLSLCache
+
+ Returns false if there is no cache file or it was made from different source or options.
+ ========================
+ */
+static bool LoadGLSLCache( const char* fileName, unsigned long key, int length, idStr& programGLSL, idStr& programUniforms )
 {
+    idFile* file = fileSystem->OpenFileRead( fileName );
+    if( file == NULL )
+    {
+        return false;
+    }
     
-    idStr inFile;
-    idStr outFileHLSL;
-    idStr outFileGLSL;
-    idStr outFileUniforms;
+    int magic = 0;
+    int version = 0;
+    unsigned int cachedKey = 0;
+    int cachedLength = 0;
+    
+    file->ReadInt( magic );
+    file->ReadInt( version );
+    file->ReadUnsignedInt( cachedKey );
+    file->ReadInt( cachedLength );
+    
+    bool valid = ( magic == GLSL_CACHE_MAGIC && version == GLSL_CACHE_VERSION && cachedKey == ( unsigned int ) key && cachedLength == length );
+    if( valid )
+    {
+        file->ReadString( programGLSL );
+        file->ReadString( programUniforms );
+        valid = ( programGLSL.Length() > 0 );
+    }
+    
+    fileSystem->CloseFile( file );
+    
+    return valid;
+}
+
+/*
+ ========================
+ WriteGLSLCache
+ ========================
+ */
+static void WriteGLSLCache( const char* fileName, unsigned long key, int length, const idStr& programGLSL, const idStr& programUniforms )
+{
+    idFile* file = fileSystem->OpenFileWrite( fileName, "fs_basepath" );
+    if( file == NULL )
+    {
+        common->Warning( "couldn't write GLSL cache file %s", fileName );
+        return;
+    }
+    
+    file->WriteInt( GLSL_CACHE_MAGIC );
+    file->WriteInt( GLSL_CACHE_VERSION );
+    file->WriteUnsignedInt( ( unsigned int ) key );
+    file->WriteInt( length );
+    file->WriteString( programGLSL.c_str() );
+    file->WriteString( programUniforms.c_str() );
+    
+    fileSystem->CloseFile( file );
+}
+
+/*
+ ========================
+ ExpandGLSLIncludes
+
+ Copies the source text and replaces every #include line with the contents of the file.
+ Includes are resolved relative to the including file the same way idParser does, with
+ them expanded StripDeadCode never touches the file system.
+ ========================
+ */
+static void ExpandGLSLIncludes( idStr& out, const char* text, const char* fileName, int depth )
+{
+    const char* s = text;
+    while( *s != '\0' )
+    {
+        const char* lineEnd = strchr( s, '\n' );
+        if( lineEnd == NULL )
+        {
+            lineEnd = s + strlen( s );
+        }
+        const char* next = ( *lineEnd == '\n' ) ? lineEnd + 1 : lineEnd;
+        
+        const char* p = s;
+        while( *p == ' ' || *p == '\t' )
+        {
+            p++;
+        }
+        
+        if( depth < GLSL_MAX_INCLUDE_DEPTH && idStr::Cmpn( p, "#include", 8 ) == 0 )
+        {
+            p += 8;
+            while( *p == ' ' || *p == '\t' )
+            {
+                p++;
+            }
+            const char* end = NULL;
+            if( *p == '\"' || *p == '<' )
+            {
+                end = strchr( p + 1, ( *p == '\"' ) ? '\"' : '>' );
+            }
+            if( end != NULL && end < lineEnd )
+            {
+                idStr includeName;
+                includeName.Append( p + 1, end - p - 1 );
+                
+                idStr path = fileName;
+                path.StripFilename();
+                path += "/";
+                path += includeName;
+                
+                void* buffer = NULL;
+                if( fileSystem->ReadFile( path.c_str(), &buffer ) > 0 )
+                {
+                    ExpandGLSLIncludes( out, ( const char* ) buffer, path.c_str(), depth + 1 );
+                    fileSystem->FreeFile( buffer );
+                    out += "\n";
+                }
+                else
+                {
+                    common->Warning( "couldn't find include file %s for %s", includeName.c_str(), fileName );
+                }
+                s = next;
+                continue;
+            }
+        }
+        
+        out.Append( s, next - s );
+        s = next;
+    }
+}
+
+/*
+ ================================================================================================
+ GLSL shader loading
+
+ Loading a shader is split in three steps so the text processing of all renderprogs can run
+ as jobs: PrepareGLSLShader reads the files and checks the cache, ConvertGLSLShader only does
+ CPU work and FinishGLSLShader writes the results and makes the GL calls.
+ ================================================================================================
+ */
+struct glslShaderSource_t
+{
+    glslShaderSource_t() : target( GL_VERTEX_SHADER ), shaderIndex( -1 ), cacheKey( 0 ), cacheLength( 0 ), convert( false ), shader( 0 ) {}
+    
+    GLenum			target;
+    int				shaderIndex;			// vertex or fragment shader index in the manager
+    idStr			inFile;
+    idStr			outFileHLSL;
+    idStr			outFileGLSL;
+    idStr			outFileUniforms;
+    idStr			outFileCache;
+    
+    idStr			source;					// renderprog source with all includes expanded
+    unsigned long	cacheKey;
+    int				cacheLength;
+    bool			convert;				// StripDeadCode and ConvertCG2GLSL have to run
+    
+    idStr			programHLSL;
+    idStr			programGLSL;
+    idStr			programUniforms;
+    idList<int>		uniforms;
+    idStr			badUniform;				// uniform that doesn't match any render parm
+    
+    GLuint			shader;
+};
+
+/*
+ ========================
+ PrepareGLSLShader
+
+ Returns false if the renderprog source doesn't exist.
+ ========================
+ */
+static bool PrepareGLSLShader( glslShaderSource_t& shader, GLenum target, const char* name )
+{
+    shader.target = target;
     
     // RB: replaced backslashes
-    inFile.Format( "renderprogs/%s", name );
-    inFile.StripFileExtension();
-    outFileHLSL.Format( "renderprogs/hlsl/%s", name );
-    outFileHLSL.StripFileExtension();
+    shader.inFile.Format( "renderprogs/%s", name );
+    shader.inFile.StripFileExtension();
+    shader.outFileHLSL.Format( "renderprogs/hlsl/%s", name );
+    shader.outFileHLSL.StripFileExtension();
     
     switch( glConfig.driverType )
     {
         case GLDRV_OPENGL3X:
         {
-            outFileGLSL.Format( "renderprogs/glsl-1.20/%s", name );
-            outFileUniforms.Format( "renderprogs/glsl-1.20/%s", name );
+            shader.outFileGLSL.Format( "renderprogs/glsl-1.20/%s", name );
+            shader.outFileUniforms.Format( "renderprogs/glsl-1.20/%s", name );
             break;
         }
             
         default:
         {
-            outFileGLSL.Format( "renderprogs/glsl-1.50/%s", name );
-            outFileUniforms.Format( "renderprogs/glsl-1.50/%s", name );
+            shader.outFileGLSL.Format( "renderprogs/glsl-1.50/%s", name );
+            shader.outFileUniforms.Format( "renderprogs/glsl-1.50/%s", name );
         }
     }
     
-    outFileGLSL.StripFileExtension();
-    outFileUniforms.StripFileExtension();
+    shader.outFileGLSL.StripFileExtension();
+    shader.outFileUniforms.StripFileExtension();
     // RB end
     
     if( target == GL_FRAGMENT_SHADER )
     {
-        inFile += ".pixel";
-        outFileHLSL += "_fragment.hlsl";
-        outFileGLSL += "_fragment.glsl";
-        outFileUniforms += "_fragment.uniforms";
+        shader.inFile += ".pixel";
+        shader.outFileHLSL += "_fragment.hlsl";
+        shader.outFileGLSL += "_fragment.glsl";
+        shader.outFileUniforms += "_fragment.uniforms";
     }
     else
     {
-        inFile += ".vertex";
-        outFileHLSL += "_vertex.hlsl";
-        outFileGLSL += "_vertex.glsl";
-        outFileUniforms += "_vertex.uniforms";
+        shader.inFile += ".vertex";
+        shader.outFileHLSL += "_vertex.hlsl";
+        shader.outFileGLSL += "_vertex.glsl";
+        shader.outFileUniforms += "_vertex.uniforms";
     }
     
-    // first check whether we already have a valid GLSL file and compare it to the hlsl timestamp;
+    shader.outFileCache = shader.outFileGLSL;
+    shader.outFileCache.SetFileExtension( ".cache" );
+    
+    void* hlslFileBuffer = NULL;
     ID_TIME_T hlslTimeStamp;
-    int hlslFileLength = fileSystem->ReadFile( inFile.c_str(), NULL, &hlslTimeStamp );
+    int hlslFileLength = fileSystem->ReadFile( shader.inFile.c_str(), &hlslFileBuffer, &hlslTimeStamp );
+    if( hlslFileLength > 0 )
+    {
+        ExpandGLSLIncludes( shader.source, ( const char* ) hlslFileBuffer, shader.inFile, 0 );
+        fileSystem->FreeFile( hlslFileBuffer );
+        
+        // the cache is keyed by the source contents, so it is checked before any timestamps
+        if( r_useGLSLCache.GetBool() )
+        {
+            GetGLSLCacheKey( shader.source, target, shader.cacheKey, shader.cacheLength );
+            if( LoadGLSLCache( shader.outFileCache, shader.cacheKey, shader.cacheLength, shader.programGLSL, shader.programUniforms ) )
+            {
+                return true;
+            }
+        }
+    }
     
+    // first check whether we already have a valid GLSL file and compare it to the hlsl timestamp;
     ID_TIME_T glslTimeStamp;
-    int glslFileLength = fileSystem->ReadFile( outFileGLSL.c_str(), NULL, &glslTimeStamp );
+    int glslFileLength = fileSystem->ReadFile( shader.outFileGLSL.c_str(), NULL, &glslTimeStamp );
     
     // if the glsl file doesn't exist or we have a newer HLSL file we need to recreate the glsl file.
-    idStr programGLSL;
-    idStr programUniforms;
     if( ( glslFileLength <= 0 ) || ( hlslTimeStamp > glslTimeStamp ) || r_alwaysExportGLSL.GetBool() )
     {
         if( hlslFileLength <= 0 )
@@ -1280,100 +1582,136 @@ GLuint idRenderProgManager::LoadGLSLShader( GLenum target, const char* name, idL
             // hlsl file doesn't even exist bail out
             return false;
         }
-        
-        void* hlslFileBuffer = NULL;
-        int len = fileSystem->ReadFile( inFile.c_str(), &hlslFileBuffer );
-        if( len <= 0 )
-        {
-            return false;
-        }
-        idStr hlslCode( ( const char* ) hlslFileBuffer );
-        idStr programHLSL = StripDeadCode( hlslCode, inFile );
-        programGLSL = ConvertCG2GLSL( programHLSL, inFile, target == GL_VERTEX_SHADER, programUniforms );
-        
-        fileSystem->WriteFile( outFileHLSL, programHLSL.c_str(), programHLSL.Length(), "fs_basepath" );
-        fileSystem->WriteFile( outFileGLSL, programGLSL.c_str(), programGLSL.Length(), "fs_basepath" );
-        if( r_useUniformArrays.GetBool() )
-        {
-            fileSystem->WriteFile( outFileUniforms, programUniforms.c_str(), programUniforms.Length(), "fs_basepath" );
-        }
+        shader.convert = true;
     }
     else
     {
         // read in the glsl file
         void* fileBufferGLSL = NULL;
-        int lengthGLSL = fileSystem->ReadFile( outFileGLSL.c_str(), &fileBufferGLSL );
+        int lengthGLSL = fileSystem->ReadFile( shader.outFileGLSL.c_str(), &fileBufferGLSL );
         if( lengthGLSL <= 0 )
         {
-            common->Error( "GLSL file %s could not be loaded and may be corrupt", outFileGLSL.c_str() );
+            common->Error( "GLSL file %s could not be loaded and may be corrupt", shader.outFileGLSL.c_str() );
         }
-        programGLSL = ( const char* ) fileBufferGLSL;
+        shader.programGLSL = ( const char* ) fileBufferGLSL;
         Mem_Free( fileBufferGLSL );
         
         if( r_useUniformArrays.GetBool() )
         {
             // read in the uniform file
             void* fileBufferUniforms = NULL;
-            int lengthUniforms = fileSystem->ReadFile( outFileUniforms.c_str(), &fileBufferUniforms );
+            int lengthUniforms = fileSystem->ReadFile( shader.outFileUniforms.c_str(), &fileBufferUniforms );
             if( lengthUniforms <= 0 )
             {
-                common->Error( "uniform file %s could not be loaded and may be corrupt", outFileUniforms.c_str() );
+                common->Error( "uniform file %s could not be loaded and may be corrupt", shader.outFileUniforms.c_str() );
             }
-            programUniforms = ( const char* ) fileBufferUniforms;
+            shader.programUniforms = ( const char* ) fileBufferUniforms;
             Mem_Free( fileBufferUniforms );
         }
     }
     
+    return true;
+}
+
+/*
+ ========================
+ ConvertGLSLShader
+
+ Converts the source if needed and builds the uniform index list. Doesn't touch the file
+ system or GL and doesn't print, so it can run as a job while Mem_EnableThreadSafety is on.
+ ========================
+ */
+static void ConvertGLSLShader( glslShaderSource_t* shader )
+{
+    if( shader->convert )
+    {
+        shader->programHLSL = StripDeadCode( shader->source, shader->inFile );
+        shader->programGLSL = ConvertCG2GLSL( shader->programHLSL, shader->inFile, shader->target == GL_VERTEX_SHADER, shader->programUniforms );
+    }
+    
     // find the uniforms locations in either the vertex or fragment uniform array
     if( r_useUniformArrays.GetBool() )
     {
-        uniforms.Clear();
+        shader->uniforms.Clear();
         
-        idLexer src( programUniforms, programUniforms.Length(), "uniforms" );
+        idLexer src( shader->programUniforms, shader->programUniforms.Length(), "uniforms" );
         idToken token;
         while( src.ReadToken( &token ) )
         {
-            int index = -1;
-            for( int i = 0; i < RENDERPARM_TOTAL && index == -1; i++ )
-            {
-                const char* parmName = GetGLSLParmName( i );
-                if( token == parmName )
-                {
-                    index = i;
-                }
-            }
-            for( int i = 0; i < MAX_GLSL_USER_PARMS && index == -1; i++ )
-            {
-                const char* parmName = GetGLSLParmName( RENDERPARM_USER + i );
-                if( token == parmName )
-                {
-                    index = RENDERPARM_USER + i;
-                }
-            }
+            int index = FindGLSLParmIndex( token );
             if( index == -1 )
             {
-                common->Error( "couldn't find uniform %s for %s", token.c_str(), outFileGLSL.c_str() );
+                shader->badUniform = token;
+                break;
             }
-            uniforms.Append( index );
+            shader->uniforms.Append( index );
         }
     }
-    
-    // create and compile the shader
-    const GLuint shader = glCreateShader( target );
-    if( shader )
+}
+
+/*
+ ========================
+ FinishGLSLShader
+
+ Exports a freshly converted shader and starts compiling it.
+ ========================
+ */
+static void FinishGLSLShader( glslShaderSource_t& shader, idList<int>& uniforms )
+{
+    if( shader.convert )
     {
-        const char* source[1] = { programGLSL.c_str() };
+        fileSystem->WriteFile( shader.outFileHLSL, shader.programHLSL.c_str(), shader.programHLSL.Length(), "fs_basepath" );
+        fileSystem->WriteFile( shader.outFileGLSL, shader.programGLSL.c_str(), shader.programGLSL.Length(), "fs_basepath" );
+        if( r_useUniformArrays.GetBool() )
+        {
+            fileSystem->WriteFile( shader.outFileUniforms, shader.programUniforms.c_str(), shader.programUniforms.Length(), "fs_basepath" );
+        }
         
-        glShaderSource( shader, 1, source, NULL );
-        glCompileShader( shader );
+        if( r_useGLSLCache.GetBool() && shader.cacheLength > 0 )
+        {
+            WriteGLSLCache( shader.outFileCache, shader.cacheKey, shader.cacheLength, shader.programGLSL, shader.programUniforms );
+        }
+    }
+    
+    if( shader.badUniform.Length() )
+    {
+        common->Error( "couldn't find uniform %s for %s", shader.badUniform.c_str(), shader.outFileGLSL.c_str() );
+    }
+    if( r_useUniformArrays.GetBool() )
+    {
+        uniforms = shader.uniforms;
+    }
+    
+    // the compile status is not queried until CheckGLSLShader, so drivers that
+    // compile in the background can work on several shaders at once
+    shader.shader = glCreateShader( shader.target );
+    if( shader.shader )
+    {
+        const char* source[1] = { shader.programGLSL.c_str() };
         
+        glShaderSource( shader.shader, 1, source, NULL );
+        glCompileShader( shader.shader );
+    }
+}
+
+/*
+ ========================
+ CheckGLSLShader
+
+ Returns the compiled shader or INVALID_PROGID if it failed to compile.
+ ========================
+ */
+static GLuint CheckGLSLShader( const glslShaderSource_t& shader, GLuint invalidProgId )
+{
+    if( shader.shader )
+    {
         int infologLength = 0;
-        glGetShaderiv( shader, GL_INFO_LOG_LENGTH, &infologLength );
+        glGetShaderiv( shader.shader, GL_INFO_LOG_LENGTH, &infologLength );
         if( infologLength > 1 )
         {
             idTempArray<char> infoLog( infologLength );
             int charsWritten = 0;
-            glGetShaderInfoLog( shader, infologLength, &charsWritten, infoLog.Ptr() );
+            glGetShaderInfoLog( shader.shader, infologLength, &charsWritten, infoLog.Ptr() );
             
             // catch the strings the ATI and Intel drivers output on success
             if( strstr( infoLog.Ptr(), "successfully compiled to run on hardware" ) != NULL ||
@@ -1383,12 +1721,12 @@ GLuint idRenderProgManager::LoadGLSLShader( GLenum target, const char* name, idL
             }
             else if( r_displayGLSLCompilerMessages.GetBool() ) // DG:  check for the CVar I added above
             {
-                common->Printf( "While compiling %s program %s\n", ( target == GL_FRAGMENT_SHADER ) ? "fragment" : "vertex" , inFile.c_str() );
+                common->Printf( "While compiling %s program %s\n", ( shader.target == GL_FRAGMENT_SHADER ) ? "fragment" : "vertex" , shader.inFile.c_str() );
                 
                 const char separator = '\n';
                 idList<idStr> lines;
                 lines.Clear();
-                idStr source( programGLSL );
+                idStr source( shader.programGLSL );
                 lines.Append( source );
                 for( int index = 0, ofs = lines[index].Find( separator ); ofs != -1; index++, ofs = lines[index].Find( separator ) )
                 {
@@ -1408,16 +1746,130 @@ GLuint idRenderProgManager::LoadGLSLShader( GLenum target, const char* name, idL
         }
         
         GLint compiled = GL_FALSE;
-        glGetShaderiv( shader, GL_COMPILE_STATUS, &compiled );
+        glGetShaderiv( shader.shader, GL_COMPILE_STATUS, &compiled );
         if( compiled == GL_FALSE )
         {
-            glDeleteShader( shader );
-            return INVALID_PROGID;
+            glDeleteShader( shader.shader );
+            return invalidProgId;
         }
     }
     
-    return shader;
+    return shader.shader;
+}
+
+/*
+ ================================================================================================
+ idRenderProgManager::LoadGLSLShader
+ ================================================================================================
+ */
+GLuint idRenderProgManager::LoadGLSLShader( GLenum target, const char* name, idList<int>& uniforms )
+{
+    glslShaderSource_t shader;
+    
+    if( !PrepareGLSLShader( shader, target, name ) )
+    {
+        return false;
+    }
+    ConvertGLSLShader( &shader );
+    FinishGLSLShader( shader, uniforms );
+    
+    return CheckGLSLShader( shader, INVALID_PROGID );
 }
+
+/*
+ ================================================================================================
+ idRenderProgManager::LoadGLSLShaders
+
+ Loads every vertex and fragment shader that isn't loaded yet. The text processing of all
+ of them runs as jobs, the file system and GL work stays on this thread.
+ ================================================================================================
+ */
+void idRenderProgManager::LoadGLSLShaders()
+{
+    idList<glslShaderSource_t> shaders;
+    shaders.SetNum( vertexShaders.Num() + fragmentShaders.Num() );
+    
+    int numShaders = 0;
+    for( int i = 0; i < vertexShaders.Num() + fragmentShaders.Num(); i++ )
+    {
+        const bool isVertex = ( i < vertexShaders.Num() );
+        const int index = isVertex ? i : i - vertexShaders.Num();
+        const GLuint progId = isVertex ? vertexShaders[index].progId : fragmentShaders[index].progId;
+        if( progId != INVALID_PROGID )
+        {
+            continue; // Already loaded
+        }
+        
+        glslShaderSource_t& shader = shaders[numShaders];
+        if( !PrepareGLSLShader( shader, isVertex ? GL_VERTEX_SHADER : GL_FRAGMENT_SHADER, isVertex ? vertexShaders[index].name : fragmentShaders[index].name ) )
+        {
+            // same as LoadGLSLShader for a missing source
+            if( isVertex )
+            {
+                vertexShaders[index].progId = false;
+            }
+            else
+            {
+                fragmentShaders[index].progId = false;
+            }
+            shader = glslShaderSource_t();
+            continue;
+        }
+        shader.shaderIndex = index;
+        numShaders++;
+    }
+    
+    if( r_useParallelShaderLoading.GetBool() && numShaders > 1 )
+    {
+        // the default lexer punctuation table is set up lazily, do it before the jobs race for it
+        idLexer setupPunctuations;
+        
+        idParallelJobList* jobList = parallelJobManager->AllocJobList( "renderProgs" );
+        for( int i = 0; i < numShaders; i++ )
+        {
+            jobList->AddJob( ( jobRun_t ) ConvertGLSLShader, &shaders[i] );
+        }
+        Mem_EnableThreadSafety( true );
+        jobList->Submit();
+        jobList->Wait();
+        Mem_EnableThreadSafety( false );
+        parallelJobManager->FreeJobList( jobList );
+    }
+    else
+    {
+        for( int i = 0; i < numShaders; i++ )
+        {
+            ConvertGLSLShader( &shaders[i] );
+        }
+    }
+    
+    for( int i = 0; i < numShaders; i++ )
+    {
+        glslShaderSource_t& shader = shaders[i];
+        if( shader.target == GL_VERTEX_SHADER )
+        {
+            FinishGLSLShader( shader, vertexShaders[shader.shaderIndex].uniforms );
+        }
+        else
+        {
+            FinishGLSLShader( shader, fragmentShaders[shader.shaderIndex].uniforms );
+        }
+    }
+    
+    for( int i = 0; i < numShaders; i++ )
+    {
+        glslShaderSource_t& shader = shaders[i];
+        if( shader.target == GL_VERTEX_SHADER )
+        {
+            vertexShaders[shader.shaderIndex].progId = CheckGLSLShader( shader, INVALID_PROGID );
+        }
+        else
+        {
+            fragmentShaders[shader.shaderIndex].progId = CheckGLSLShader( shader, INVALID_PROGID );
+        }
+    }
+}
+
 /*
  ================================================================================================
  idRenderProgManager::FindGLSLProgram
@@ -1464,9 +1916,54 @@ const char* idRenderProgManager::GetGLSLParmName( int rp ) const
  */
 void idRenderProgManager::SetUniformValue( const renderParm_t rp, const float* value )
 {
+    idVec4& uniform = glslUniforms[rp];
+    if( uniform[0] == value[0] && uniform[1] == value[1] && uniform[2] == value[2] && uniform[3] == value[3] )
+    {
+        return;
+    }
+    
     for( int i = 0; i < 4; i++ )
     {
-        glslUniforms[rp][i] = value[i];
+        uniform[i] = value[i];
+    }
+    
+    if( ++glslUniformSerial >= ( 1 << 30 ) )
+    {
+        ResetUniformSerials();
+    }
+    glslUniformSerials[rp] = glslUniformSerial;
+}
+
+/*
+ ========================
+ CommitUniformArray
+
+ Uploads the runs of array elements whose render parm changed after serial.
+ ========================
+ */
+static void CommitUniformArray( const idList<int>& uniforms, const idList<GLint>& locations, const idVec4* values, const int* serials, int serial )
+{
+    idVec4 localVectors[RENDERPARM_USER + idRenderProgManager::MAX_GLSL_USER_PARMS];
+    
+    for( int i = 0; i < uniforms.Num(); )
+    {
+        if( serials[uniforms[i]] <= serial )
+        {
+            backEnd.pc.c_uniformVectorsSkipped++;
+            i++;
+            continue;
+        }
+        
+        int count = 0;
+        for( ; i + count < uniforms.Num() && serials[uniforms[i + count]] > serial; count++ )
+        {
+            localVectors[count] = values[uniforms[i + count]];
+        }
+        glUniform4fv( locations[i], count, localVectors->ToFloatPtr() );
+        
+        backEnd.pc.c_uniformUploads++;
+        backEnd.pc.c_uniformVectors += count;
+        i += count;
     }
 }
 
@@ -1478,36 +1975,22 @@ void idRenderProgManager::SetUniformValue( const renderParm_t rp, const float* v
 void idRenderProgManager::CommitUniforms()
 {
     const int progID = GetGLSLCurrentProgram();
-    const glslProgram_t& prog = glslPrograms[progID];
+    glslProgram_t& prog = glslPrograms[progID];
     
-    if( r_useUniformArrays.GetBool() )
+    if( prog.usesRenderParmBlock )
     {
-        idVec4 localVectors[RENDERPARM_USER + MAX_GLSL_USER_PARMS];
-        
-        if( prog.vertexShaderIndex >= 0 )
+        CommitRenderParmBlock();
+    }
+    else if( r_useUniformArrays.GetBool() )
+    {
+        if( prog.vertexShaderIndex >= 0 && prog.vertexUniformArray != -1 )
         {
-            const idList<int>& vertexUniforms = vertexShaders[prog.vertexShaderIndex].uniforms;
-            if( prog.vertexUniformArray != -1 && vertexUniforms.Num() > 0 )
-            {
-                for( int i = 0; i < vertexUniforms.Num(); i++ )
-                {
-                    localVectors[i] = glslUniforms[vertexUniforms[i]];
-                }
-                glUniform4fv( prog.vertexUniformArray, vertexUniforms.Num(), localVectors->ToFloatPtr() );
-            }
+            CommitUniformArray( vertexShaders[prog.vertexShaderIndex].uniforms, prog.vertexUniformLocations, glslUniforms.Ptr(), glslUniformSerials.Ptr(), prog.uniformSerial );
         }
         
-        if( prog.fragmentShaderIndex >= 0 )
+        if( prog.fragmentShaderIndex >= 0 && prog.fragmentUniformArray != -1 )
         {
-            const idList<int>& fragmentUniforms = fragmentShaders[prog.fragmentShaderIndex].uniforms;
-            if( prog.fragmentUniformArray != -1 && fragmentUniforms.Num() > 0 )
-            {
-                for( int i = 0; i < fragmentUniforms.Num(); i++ )
-                {
-                    localVectors[i] = glslUniforms[fragmentUniforms[i]];
-                }
-                glUniform4fv( prog.fragmentUniformArray, fragmentUniforms.Num(), localVectors->ToFloatPtr() );
-            }
+            CommitUniformArray( fragmentShaders[prog.fragmentShaderIndex].uniforms, prog.fragmentUniformLocations, glslUniforms.Ptr(), glslUniformSerials.Ptr(), prog.uniformSerial );
         }
     }
     else
@@ -1515,9 +1998,102 @@ void idRenderProgManager::CommitUniforms()
         for( int i = 0; i < prog.uniformLocations.Num(); i++ )
         {
             const glslUniformLocation_t& uniformLocation = prog.uniformLocations[i];
+            if( glslUniformSerials[uniformLocation.parmIndex] <= prog.uniformSerial )
+            {
+                backEnd.pc.c_uniformVectorsSkipped++;
+                continue;
+            }
             glUniform4fv( uniformLocation.uniformIndex, 1, glslUniforms[uniformLocation.parmIndex].ToFloatPtr() );
+            backEnd.pc.c_uniformUploads++;
+            backEnd.pc.c_uniformVectors++;
+        }
+    }
+    
+    prog.uniformSerial = glslUniformSerial;
+}
+
+/*
+ ================================================================================================
+ idRenderProgManager::CommitRenderParmBlock
+ 
+ Writes the renderparms to a new range of the ring if any of them changed since the
+ bound range was written. The range is shared by every program that reads the block.
+ The new range gets a GPU copy of the bound range, and only the vectors between the
+ first and the last changed one are uploaded over it. After the ring wrapped the old
+ ranges are gone with the orphaned storage, so the whole block is uploaded.
+ ================================================================================================
+ */
+void idRenderProgManager::CommitRenderParmBlock()
+{
+    if( renderParmBlockSerial == glslUniformSerial )
+    {
+        backEnd.pc.c_uniformVectorsSkipped += RENDERPARM_BLOCK_VECTORS;
+        return;
+    }
+    
+    int first = 0;
+    int last = RENDERPARM_BLOCK_VECTORS - 1;
+    if( renderParmBlockSerial >= 0 )
+    {
+        first = RENDERPARM_BLOCK_VECTORS;
+        last = -1;
+        for( int i = 0; i < RENDERPARM_TOTAL; i++ )
+        {
+            if( glslUniformSerials[i] > renderParmBlockSerial )
+            {
+                first = Min( first, i );
+                last = i;
+            }
+        }
+        for( int i = 0; i < MAX_GLSL_USER_PARMS; i++ )
+        {
+            if( glslUniformSerials[RENDERPARM_USER + i] > renderParmBlockSerial )
+            {
+                const int index = RenderParmBlockIndex( RENDERPARM_USER + i );
+                first = Min( first, index );
+                last = index;
+            }
         }
+        if( last < first )
+        {
+            renderParmBlockSerial = glslUniformSerial;
+            backEnd.pc.c_uniformVectorsSkipped += RENDERPARM_BLOCK_VECTORS;
+            return;
+        }
+    }
+    
+    ALIGN16( idVec4 block[RENDERPARM_BLOCK_VECTORS] );
+    SIMDProcessor->Memcpy( block, glslUniforms.Ptr(), RENDERPARM_TOTAL * sizeof( idVec4 ) );
+    SIMDProcessor->Memcpy( block + RenderParmBlockIndex( RENDERPARM_USER ), glslUniforms.Ptr() + RENDERPARM_USER, MAX_GLSL_USER_PARMS * sizeof( idVec4 ) );
+    
+    bool wrapped = false;
+    const int offset = renderParmRing.Alloc( sizeof( block ), wrapped );
+    if( wrapped )
+    {
+        first = 0;
+        last = RENDERPARM_BLOCK_VECTORS - 1;
     }
+    
+    glBindBuffer( GL_UNIFORM_BUFFER, renderParmBuffer );
+    if( wrapped )
+    {
+        // earlier ranges may still be read by queued draws
+        glBufferData( GL_UNIFORM_BUFFER, renderParmRing.Size(), NULL, GL_STREAM_DRAW );
+    }
+    else if( first > 0 || last < RENDERPARM_BLOCK_VECTORS - 1 )
+    {
+        glCopyBufferSubData( GL_UNIFORM_BUFFER, GL_UNIFORM_BUFFER, renderParmBlockOffset, offset, sizeof( block ) );
+    }
+    const int numVectors = last - first + 1;
+    glBufferSubData( GL_UNIFORM_BUFFER, offset + first * sizeof( idVec4 ), numVectors * sizeof( idVec4 ), block + first );
+    glBindBufferRange( GL_UNIFORM_BUFFER, RENDERPARM_BLOCK_BINDING, renderParmBuffer, offset, sizeof( block ) );
+    
+    renderParmBlockSerial = glslUniformSerial;
+    renderParmBlockOffset = offset;
+    
+    backEnd.pc.c_uniformUploads++;
+    backEnd.pc.c_uniformVectors += numVectors;
+    backEnd.pc.c_uniformVectorsSkipped += RENDERPARM_BLOCK_VECTORS - numVectors;
 }
 
 class idSort_QuickUniforms : public idSort_Quick< glslUniformLocation_t, idSort_QuickUniforms >
@@ -1614,8 +2190,37 @@ void idRenderProgManager::LoadGLSLProgram( const int programIndex, const int ver
         prog.vertexUniformArray = glGetUniformLocation( program, VERTEX_UNIFORM_ARRAY_NAME );
         prog.fragmentUniformArray = glGetUniformLocation( program, FRAGMENT_UNIFORM_ARRAY_NAME );
         
-        assert( prog.vertexUniformArray != -1 || vertexShaderIndex < 0 || vertexShaders[vertexShaderIndex].uniforms.Num() == 0 );
-        assert( prog.fragmentUniformArray != -1 || fragmentShaderIndex < 0 || fragmentShaders[fragmentShaderIndex].uniforms.Num() == 0 );
+        prog.usesRenderParmBlock = false;
+        if( renderParmBuffer != 0 )
+        {
+            GLint blockIndex = glGetUniformBlockIndex( program, RENDERPARM_BLOCK_NAME );
+            if( blockIndex != -1 )
+            {
+                glUniformBlockBinding( program, blockIndex, RENDERPARM_BLOCK_BINDING );
+                prog.usesRenderParmBlock = true;
+            }
+        }
+        
+        assert( prog.usesRenderParmBlock || prog.vertexUniformArray != -1 || vertexShaderIndex < 0 || vertexShaders[vertexShaderIndex].uniforms.Num() == 0 );
+        assert( prog.usesRenderParmBlock || prog.fragmentUniformArray != -1 || fragmentShaderIndex < 0 || fragmentShaders[fragmentShaderIndex].uniforms.Num() == 0 );
+        
+        // the elements are looked up one by one so partial uploads don't rely on consecutive locations
+        prog.vertexUniformLocations.Clear();
+        if( prog.vertexUniformArray != -1 )
+        {
+            for( int i = 0; i < vertexShaders[vertexShaderIndex].uniforms.Num(); i++ )
+            {
+                prog.vertexUniformLocations.Append( glGetUniformLocation( program, va( "%s[%d]", VERTEX_UNIFORM_ARRAY_NAME, i ) ) );
+            }
+        }
+        prog.fragmentUniformLocations.Clear();
+        if( prog.fragmentUniformArray != -1 )
+        {
+            for( int i = 0; i < fragmentShaders[fragmentShaderIndex].uniforms.Num(); i++ )
+            {
+                prog.fragmentUniformLocations.Append( glGetUniformLocation( program, va( "%s[%d]", FRAGMENT_UNIFORM_ARRAY_NAME, i ) ) );
+            }
+        }
     }
     else
     {
@@ -1659,6 +2264,7 @@ void idRenderProgManager::LoadGLSLProgram( const int programIndex, const int ver
         if( blockIndex != -1 )
         {
             glUniformBlockBinding( program, blockIndex, 0 );
+            prog.usesJoints = true;
         }
     }
     
@@ -1677,6 +2283,7 @@ void idRenderProgManager::LoadGLSLProgram( const int programIndex, const int ver
     programName.StripFileExtension();
     prog.name = programName;
     prog.progId = program;
+    prog.uniformSerial = -1;	// a new program has none of the current values
     prog.fragmentShaderIndex = fragmentShaderIndex;
     prog.vertexShaderIndex = vertexShaderIndex;
 }
@@ -1689,4 +2296,26 @@ void idRenderProgManager::LoadGLSLProgram( const int programIndex, const int ver
 void idRenderProgManager::ZeroUniforms()
 {
     memset( glslUniforms.Ptr(), 0, glslUniforms.Allocated() );
+    ResetUniformSerials();
+}
+
+/*
+ ================================================================================================
+ idRenderProgManager::ResetUniformSerials
+
+ Marks every uniform as changed for every program.
+ ================================================================================================
+ */
+void idRenderProgManager::ResetUniformSerials()
+{
+    for( int i = 0; i < glslUniformSerials.Num(); i++ )
+    {
+        glslUniformSerials[i] = 1;
+    }
+    for( int i = 0; i < glslPrograms.Num(); i++ )
+    {
+        glslPrograms[i].uniformSerial = 0;
+    }
+    glslUniformSerial = 1;
+    renderParmBlockSerial = -1;
 }
@@ -93,13 +93,22 @@ static void R_PerformanceCounters( void ) {
 	}
 
 	if ( r_showInteractions.GetBool() ) {
-		common->Printf( "createInteractions:%i createLightTris:%i createShadowVolumes:%i\n",
-			tr.pc.c_createInteractions, tr.pc.c_createLightTris, tr.pc.c_createShadowVolumes );
+		common->Printf( "createInteractions:%i createLightTris:%i createShadowVolumes:%i shadowCacheHits:%i shadowCacheMisses:%i\n",
+			tr.pc.c_createInteractions, tr.pc.c_createLightTris, tr.pc.c_createShadowVolumes,
+			tr.pc.c_shadowCacheHits, tr.pc.c_shadowCacheMisses );
  	}
 	if ( r_showDefs.GetBool() ) {
 		common->Printf( "viewEntities:%i  shadowEntities:%i  viewLights:%i\n", tr.pc.c_visibleViewEntities,
 			tr.pc.c_shadowViewEntities, tr.pc.c_viewLights );
 	}
+	if ( r_showOcclusionCulling.GetBool() ) {
+		common->Printf( "occluderTris:%i  occludedEntities:%i  occludedLights:%i\n", tr.pc.c_occluderTris,
+			tr.pc.c_occludedEntities, tr.pc.c_occludedLights );
+	}
+	if ( r_showUniforms.GetBool() ) {
+		common->Printf( "uniformUploads:%i  uniformVectors:%i  skippedVectors:%i\n", backEnd.pc.c_uniformUploads,
+			backEnd.pc.c_uniformVectors, backEnd.pc.c_uniformVectorsSkipped );
+	}
 	if ( r_showUpdates.GetBool() ) {
 		common->Printf( "entityUpdates:%i  entityRefs:%i  lightUpdates:%i  lightRefs:%i\n", 
 			tr.pc.c_entityUpdates, tr.pc.c_entityReferences,
@@ -110,38 +119,234 @@ static void R_PerformanceCounters( void ) {
 		common->Printf( "frameData: %i (%i)\n", R_CountFrameData(), m1 );
 	}
 
+	R_RecordPerfHistory();
+
 	memset( &tr.pc, 0, sizeof( tr.pc ) );
 	memset( &backEnd.pc, 0, sizeof( backEnd.pc ) );
 }
 
 
 
+/*
+===============================================================================
+
+	SMP render thread
+
+	With r_useSMP the back end of frame N runs on the render thread while
+	the main thread builds frame N+1 in the other frameData.  The GL context
+	belongs to whichever thread is drawing, R_SyncRenderThread hands it back.
+
+===============================================================================
+*/
+
+// wait time histogram bucket limits in milliseconds, the last bucket is open ended
+static const int	NUM_SYNC_BUCKETS = 8;
+static const float	syncBucketLimits[NUM_SYNC_BUCKETS - 1] = { 0.01f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f, 32.0f };
+
+typedef struct {
+	int				count[NUM_SYNC_BUCKETS];
+	int				numSyncs;
+	double			totalMsec;
+	double			maxMsec;
+} syncHistogram_t;
+
+static syncHistogram_t	syncEndFrame;		// the regular sync at the top of EndFrame
+static syncHistogram_t	syncMidFrame;		// everything else that needed the back end idle
+
+/*
+====================
+R_WaitRenderThread
+====================
+*/
+static void R_WaitRenderThread( syncHistogram_t &histogram ) {
+	if ( !tr.renderThreadBusy ) {
+		return;
+	}
+
+	double start = Sys_GetClockTicks();
+
+	GLimp_FrontEndSleep();
+	GLimp_ActivateContext();
+	tr.renderThreadBusy = false;
+
+	double msec = ( Sys_GetClockTicks() - start ) * 1000.0 / Sys_ClockTicksPerSecond();
+
+	int bucket;
+	for ( bucket = 0 ; bucket < NUM_SYNC_BUCKETS - 1 ; bucket++ ) {
+		if ( msec < syncBucketLimits[bucket] ) {
+			break;
+		}
+	}
+	histogram.count[bucket]++;
+	histogram.numSyncs++;
+	histogram.totalMsec += msec;
+	if ( msec > histogram.maxMsec ) {
+		histogram.maxMsec = msec;
+	}
+}
+
+/*
+====================
+R_SyncRenderThread
+====================
+*/
+void R_SyncRenderThread( void ) {
+	R_WaitRenderThread( syncMidFrame );
+}
+
+/*
+====================
+idRenderSystemLocal::SyncRenderThread
+====================
+*/
+void idRenderSystemLocal::SyncRenderThread( void ) {
+	R_SyncRenderThread();
+}
+
+/*
+====================
+R_StartRenderThread
+====================
+*/
+static void R_StartRenderThread( void ) {
+	// the debug tools read back into heap memory, and printing from the
+	// back end builds strings, so the heap is locked while the thread runs
+	Mem_EnableThreadSafety( true );
+
+	if ( !GLimp_SpawnRenderThread( RB_RenderThread ) ) {
+		common->Printf( "r_useSMP: no render thread available, executing the back end serially\n" );
+		Mem_EnableThreadSafety( false );
+		r_useSMP.SetBool( false );
+		r_useSMP.ClearModified();
+		return;
+	}
+
+	// wait for it to park in GLimp_BackEndSleep
+	GLimp_FrontEndSleep();
+
+	tr.smpActive = true;
+	vertexCache.SetDeferUploads( true );
+}
+
+/*
+====================
+R_ShutdownRenderThread
+
+The main thread keeps the context afterwards
+====================
+*/
+void R_ShutdownRenderThread( void ) {
+	if ( !tr.smpActive ) {
+		return;
+	}
+
+	R_SyncRenderThread();
+
+	// a NULL frame tells the render thread to exit
+	GLimp_WakeBackEnd( NULL );
+	GLimp_FrontEndSleep();
+
+	tr.smpActive = false;
+	vertexCache.SetDeferUploads( false );
+	Mem_EnableThreadSafety( false );
+}
+
+/*
+====================
+R_CheckRenderThread
+
+Starts or stops the render thread when r_useSMP changes, the back end must be idle
+====================
+*/
+static void R_CheckRenderThread( void ) {
+	// r_lockSurfaces keeps reissuing the same frameData, which can't overlap with itself
+	const bool wantThread = r_useSMP.GetBool() && !r_lockSurfaces.GetBool();
+	if ( wantThread == tr.smpActive ) {
+		return;
+	}
+	if ( wantThread ) {
+		R_StartRenderThread();
+	} else {
+		R_ShutdownRenderThread();
+	}
+}
+
+/*
+====================
+R_PrintSyncHistogram
+====================
+*/
+static void R_PrintSyncHistogram( const char *name, const syncHistogram_t &histogram ) {
+	common->Printf( "%s: %i syncs, %.2f msec average, %.2f msec max\n", name, histogram.numSyncs,
+		histogram.numSyncs ? histogram.totalMsec / histogram.numSyncs : 0.0, histogram.maxMsec );
+	for ( int i = 0 ; i < NUM_SYNC_BUCKETS ; i++ ) {
+		const float percent = histogram.numSyncs ? 100.0f * histogram.count[i] / histogram.numSyncs : 0.0f;
+		if ( i == 0 ) {
+			common->Printf( "  %16s", "no wait" );
+		} else if ( i == NUM_SYNC_BUCKETS - 1 ) {
+			common->Printf( "  %9s%4.0f ms", ">=", syncBucketLimits[i - 1] );
+		} else {
+			common->Printf( "  %4.0f - %4.0f ms", syncBucketLimits[i - 1] < 1.0f ? 0.0f : syncBucketLimits[i - 1], syncBucketLimits[i] );
+		}
+		common->Printf( " %7i %5.1f%%\n", histogram.count[i], percent );
+	}
+}
+
+/*
+====================
+R_RenderThreadStats_f
+
+prints how long the main thread had to wait for the render thread,
+"renderThreadStats clear" resets the counts
+====================
+*/
+void R_RenderThreadStats_f( const idCmdArgs &args ) {
+	if ( args.Argc() > 1 && !idStr::Icmp( args.Argv( 1 ), "clear" ) ) {
+		memset( &syncEndFrame, 0, sizeof( syncEndFrame ) );
+		memset( &syncMidFrame, 0, sizeof( syncMidFrame ) );
+		return;
+	}
+
+	common->Printf( "render thread %s\n", tr.smpActive ? "active" : "not running, back end executes serially" );
+	R_PrintSyncHistogram( "end of frame", syncEndFrame );
+	R_PrintSyncHistogram( "mid frame", syncMidFrame );
+}
+
 /*
 ====================
 R_IssueRenderCommands
 
-Called by R_EndFrame each frame
+Called by R_EndFrame each frame.  With the render thread active
+the commands are only handed off, the caller must R_SyncRenderThread
+before touching GL or reusing the command chain.
 ====================
 */
 static void R_IssueRenderCommands( void ) {
+	R_SyncRenderThread();
+
+	// images the render thread found unloaded, it can't use the file system
+	globalImages->LoadQueuedImages();
+
+	frameData->vertexCacheUploads = vertexCache.CloseUploads();
+
 	if ( frameData->cmdHead->commandId == RC_NOP
 		&& !frameData->cmdHead->next ) {
-		// nothing to issue
+		// nothing to issue, but anything the vertex cache staged
+		// lives in this frameData and has to go up now
+		vertexCache.FlushUploads( frameData->vertexCacheUploads );
 		return;
 	}
 
-	// r_skipBackEnd allows the entire time of the back end
-	// to be removed from performance measurements, although
-	// nothing will be drawn to the screen.  If the prints
-	// are going to a file, or r_skipBackEnd is later disabled,
-	// usefull data can be received.
-
-	// r_skipRender is usually more usefull, because it will still
-	// draw 2D graphics
-	if ( !r_skipBackEnd.GetBool() ) {
-		RB_ExecuteBackEndCommands( frameData->cmdHead );
+	if ( tr.smpActive ) {
+		// the context belongs to the render thread until R_SyncRenderThread
+		GLimp_DeactivateContext();
+		tr.renderThreadBusy = true;
+		GLimp_WakeBackEnd( frameData );
+		return;
 	}
 
+	RB_ExecuteFrame( frameData );
+
 	R_ClearCommandChain();
 }
 
@@ -210,6 +415,10 @@ void	R_AddDrawViewCmd( viewDef_t *parms ) {
 
 	cmd->viewDef = parms;
 
+	// the back end may run on the render thread, so the debug tools
+	// that need front end work get it done now
+	R_PrepareDebugTools( parms );
+
 	if ( parms->viewEntitys ) {
 		// save the command for r_lockSurfaces debugging
 		tr.lockSurfacesCmd = *cmd;
@@ -606,6 +815,8 @@ Returns the number of msec spent in the back end
 void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	emptyCommand_t *cmd;
 
+	PROFILE_SCOPE( "idRenderSystemLocal::EndFrame" );
+
 	if ( !glConfig.isInitialized ) {
 		return;
 	}
@@ -614,6 +825,11 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 	guiModel->EmitFullScreen();
 	guiModel->Clear();
 
+	// the previous frame has to be off the render thread before
+	// its counters are read and the frameData is reused
+	R_WaitRenderThread( syncEndFrame );
+	R_CheckRenderThread();
+
 	// save out timing information
 	if ( frontEndMsec ) {
 		*frontEndMsec = pc.frontEndMsec;
@@ -622,6 +838,8 @@ void idRenderSystemLocal::EndFrame( int *frontEndMsec, int *backEndMsec ) {
 		*backEndMsec = backEnd.pc.msec;
 	}
 
+	R_RecordFrontEndBenchmarkFrame();
+
 	// print any other statistics and clear all of them
 	R_PerformanceCounters();
 
@@ -857,6 +1075,8 @@ void idRenderSystemLocal::CaptureRenderToFile( const char *fileName, bool fixAlp
 	guiModel->EmitFullScreen();
 	guiModel->Clear();
 	R_IssueRenderCommands();
+	R_SyncRenderThread();
+	R_ClearCommandChain();
 
 	glReadBuffer( GL_BACK );
 
@@ -929,6 +1149,8 @@ idRenderSystemLocal::UploadImage
 ===============
 */
 bool idRenderSystemLocal::UploadImage( const char *imageName, const byte *data, int width, int height  ) {
+	R_SyncRenderThread();
+
 	idImage *image = globalImages->GetImage( imageName );
 	if ( !image ) {
 		return false;
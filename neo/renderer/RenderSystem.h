@@ -266,6 +266,15 @@ public:
 	// texture filter / mipmapping / repeat won't be modified by the upload
 	// returns false if the image wasn't found
 	virtual bool			UploadImage( const char *imageName, const byte *data, int width, int height ) = 0;
+
+	// with r_useSMP the back end runs on its own thread, this waits until it is idle
+	// so the caller can touch GL or renderer data, renderer commands do it automatically
+	virtual void			SyncRenderThread( void ) = 0;
+
+	// times the front end phases of every frame until EndFrontEndBenchmark, which
+	// prints percentiles and writes them to benchmarks/<demoName>_frontend.json
+	virtual void			BeginFrontEndBenchmark( void ) = 0;
+	virtual void			EndFrontEndBenchmark( const char *demoName ) = 0;
 };
 
 extern idRenderSystem *			renderSystem;
@@ -60,10 +60,11 @@ idCVar r_useSilRemap( "r_useSilRemap", "1", CVAR_RENDERER | CVAR_BOOL, "consider
 idCVar r_useNodeCommonChildren( "r_useNodeCommonChildren", "1", CVAR_RENDERER | CVAR_BOOL, "stop pushing reference bounds early when possible" );
 idCVar r_useShadowProjectedCull( "r_useShadowProjectedCull", "1", CVAR_RENDERER | CVAR_BOOL, "discard triangles outside light volume before shadowing" );
 idCVar r_useShadowSurfaceScissor( "r_useShadowSurfaceScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor shadows by the scissor rect of the interaction surfaces" );
-idCVar r_useInteractionTable( "r_useInteractionTable", "1", CVAR_RENDERER | CVAR_BOOL, "create a full entityDefs * lightDefs table to make finding interactions faster" );
+idCVar r_useInteractionTable( "r_useInteractionTable", "1", CVAR_RENDERER | CVAR_BOOL, "use the per light interaction hash tables instead of scanning the entity interaction lists" );
 idCVar r_useTurboShadow( "r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows" );
 idCVar r_useTwoSidedStencil( "r_useTwoSidedStencil", "1", CVAR_RENDERER | CVAR_BOOL, "do stencil shadows in one pass with different ops on each side" );
 idCVar r_useDeferredTangents( "r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform" );
+idCVar r_useGPUSkinning( "r_useGPUSkinning", "0", CVAR_RENDERER | CVAR_BOOL, "skin md5 meshes in the vertex programs instead of deriving tangents and uploading vertexes every frame" );
 idCVar r_useCachedDynamicModels( "r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models" );
 
 idCVar r_useStateCaching( "r_useStateCaching", "1", CVAR_RENDERER | CVAR_BOOL, "avoid redundant state changes in GL_*() calls" );
@@ -110,6 +111,9 @@ idCVar r_useLightScissors( "r_useLightScissors", "1", CVAR_RENDERER | CVAR_BOOL,
 idCVar r_useClippedLightScissors( "r_useClippedLightScissors", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar r_useEntityCulling( "r_useEntityCulling", "1", CVAR_RENDERER | CVAR_BOOL, "0 = none, 1 = box" );
 idCVar r_useEntityScissors( "r_useEntityScissors", "0", CVAR_RENDERER | CVAR_BOOL, "1 = use custom scissor rectangle for each entity" );
+idCVar r_useOcclusionCulling( "r_useOcclusionCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull entities and lights hidden behind the world with a software depth buffer" );
+idCVar r_useSMP( "r_useSMP", "0", CVAR_RENDERER | CVAR_BOOL | CVAR_ARCHIVE, "1 = run the back end on its own thread, 0 = execute the render commands serially on the main thread" );
+idCVar r_useParallelAddSurfaces( "r_useParallelAddSurfaces", "1", CVAR_RENDERER | CVAR_BOOL, "1 = run the per-light and per-entity setup of the front end as jobs" );
 idCVar r_useInteractionCulling( "r_useInteractionCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull interactions" );
 idCVar r_useInteractionScissors( "r_useInteractionScissors", "2", CVAR_RENDERER | CVAR_INTEGER, "1 = use a custom scissor rectangle for each shadow interaction, 2 = also crop using portal scissors", -2, 2, idCmdSystem::ArgCompletion_Integer<-2,2> );
 idCVar r_useShadowCulling( "r_useShadowCulling", "1", CVAR_RENDERER | CVAR_BOOL, "try to cull shadows from partially visible lights" );
@@ -135,12 +139,14 @@ idCVar r_flareSize( "r_flareSize", "1", CVAR_RENDERER | CVAR_FLOAT, "scale the f
 
 idCVar r_useExternalShadows( "r_useExternalShadows", "1", CVAR_RENDERER | CVAR_INTEGER, "1 = skip drawing caps when outside the light volume, 2 = force to no caps for testing", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar r_useOptimizedShadows( "r_useOptimizedShadows", "1", CVAR_RENDERER | CVAR_BOOL, "use the dmap generated static shadow volumes" );
+idCVar r_useShadowCache( "r_useShadowCache", "1", CVAR_RENDERER | CVAR_BOOL, "1 = reuse the shadow volumes of freed interactions if nothing they depend on changed" );
 idCVar r_useScissor( "r_useScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor clip as portals and lights are processed" );
 idCVar r_useDepthBoundsTest( "r_useDepthBoundsTest", "1", CVAR_RENDERER | CVAR_BOOL, "use depth bounds test to reduce shadow fill" );
 
 idCVar r_screenFraction( "r_screenFraction", "100", CVAR_RENDERER | CVAR_INTEGER, "for testing fill rate, the resolution of the entire screen can be changed" );
 idCVar r_demonstrateBug( "r_demonstrateBug", "0", CVAR_RENDERER | CVAR_BOOL, "used during development to show IHV's their problems" );
 idCVar r_usePortals( "r_usePortals", "1", CVAR_RENDERER | CVAR_BOOL, " 1 = use portals to perform area culling, otherwise draw everything" );
+idCVar r_useCachedWorld( "r_useCachedWorld", "1", CVAR_RENDERER | CVAR_BOOL, "1 = load the world from generated/<map>.bproc when the .proc is unchanged, writing it after a text load" );
 idCVar r_singleLight( "r_singleLight", "-1", CVAR_RENDERER | CVAR_INTEGER, "suppress all but one light" );
 idCVar r_singleEntity( "r_singleEntity", "-1", CVAR_RENDERER | CVAR_INTEGER, "suppress all but one entity" );
 idCVar r_singleSurface( "r_singleSurface", "-1", CVAR_RENDERER | CVAR_INTEGER, "suppress all but one surface on each entity" );
@@ -158,6 +164,8 @@ idCVar r_showUpdates( "r_showUpdates", "0", CVAR_RENDERER | CVAR_BOOL, "report e
 idCVar r_showDemo( "r_showDemo", "0", CVAR_RENDERER | CVAR_BOOL, "report reads and writes to the demo file" );
 idCVar r_showDynamic( "r_showDynamic", "0", CVAR_RENDERER | CVAR_BOOL, "report stats on dynamic surface generation" );
 idCVar r_showDefs( "r_showDefs", "0", CVAR_RENDERER | CVAR_BOOL, "report the number of modeDefs and lightDefs in view" );
+idCVar r_showOcclusionCulling( "r_showOcclusionCulling", "0", CVAR_RENDERER | CVAR_BOOL, "report the number of occluder triangles and occluded entities and lights" );
+idCVar r_showUniforms( "r_showUniforms", "0", CVAR_RENDERER | CVAR_BOOL, "report uniform uploads and the redundant ones that were skipped" );
 idCVar r_showTrace( "r_showTrace", "0", CVAR_RENDERER | CVAR_INTEGER, "show the intersection of an eye trace with the world", idCmdSystem::ArgCompletion_Integer<0,2> );
 idCVar r_showIntensity( "r_showIntensity", "0", CVAR_RENDERER | CVAR_BOOL, "draw the screen colors based on intensity, red = 0, green = 128, blue = 255" );
 idCVar r_showImages( "r_showImages", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = show all images instead of rendering, 2 = show in proportional size", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2> );
@@ -332,8 +340,9 @@ static void R_CheckPortableExtensions( void ) {
 	// GLSL, core in OpenGL > 2.0
 	glConfig.glslAvailable = ( glConfig.glVersion >= 2.0f );
 
-	// GL_ARB_uniform_buffer_object
-	glConfig.uniformBufferAvailable = GLEW_ARB_uniform_buffer_object != 0;
+	// GL_ARB_uniform_buffer_object, the renderparm block also copies ranges with GL_ARB_copy_buffer,
+	// both are core in OpenGL 3.1
+	glConfig.uniformBufferAvailable = GLEW_ARB_uniform_buffer_object != 0 && GLEW_ARB_copy_buffer != 0;
 	if ( glConfig.uniformBufferAvailable ) {
 		glGetIntegerv( GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, (GLint *)&glConfig.uniformBufferOffsetAlignment );
 		if ( glConfig.uniformBufferOffsetAlignment < 256 ) {
@@ -964,6 +973,9 @@ void R_ReadTiledPixels( int width, int height, byte *buffer, renderView_t *ref =
 				h = height - yo;
 			}
 
+			// the swap may still be pending on the render thread
+			R_SyncRenderThread();
+
 			glReadBuffer( GL_FRONT );
 			glReadPixels( 0, 0, w, h, GL_RGB, GL_UNSIGNED_BYTE, temp );
 
@@ -1621,6 +1633,9 @@ void R_VidRestart_f( const idCmdArgs &args ) {
 		return;
 	}
 
+	// the context is about to go away, the next EndFrame starts a new render thread
+	R_ShutdownRenderThread();
+
 	bool full = true;
 	bool forceWindow = false;
 	for ( int i = 1 ; i < args.Argc() ; i++ ) {
@@ -1804,8 +1819,13 @@ void R_InitCommands( void ) {
 	cmdSystem->AddCommand( "reportImageDuplication", R_ReportImageDuplication_f, CMD_FL_RENDERER, "checks all referenced images for duplications" );
 	cmdSystem->AddCommand( "regenerateWorld", R_RegenerateWorld_f, CMD_FL_RENDERER, "regenerates all interactions" );
 	cmdSystem->AddCommand( "showInteractionMemory", R_ShowInteractionMemory_f, CMD_FL_RENDERER, "shows memory used by interactions" );
+	cmdSystem->AddCommand( "frameAllocStats", R_FrameAllocStats_f, CMD_FL_RENDERER, "shows frame memory used by each thread" );
 	cmdSystem->AddCommand( "showTriSurfMemory", R_ShowTriSurfMemory_f, CMD_FL_RENDERER, "shows memory used by triangle surfaces" );
+	cmdSystem->AddCommand( "testGPUSkinning", R_TestGPUSkinning_f, CMD_FL_RENDERER, "compares CPU and GPU skinning, of an md5 model or of synthetic weights", idCmdSystem::ArgCompletion_ModelName );
 	cmdSystem->AddCommand( "vid_restart", R_VidRestart_f, CMD_FL_RENDERER, "restarts renderSystem" );
+	cmdSystem->AddCommand( "renderThreadStats", R_RenderThreadStats_f, CMD_FL_RENDERER, "shows how long the main thread waited for the render thread, 'clear' resets" );
+	cmdSystem->AddCommand( "perfHistoryDump", R_PerfHistoryDump_f, CMD_FL_RENDERER, "writes the recent per frame performance counters as csv or json, usage: perfHistoryDump [file] [frames]" );
+	cmdSystem->AddCommand( "perfHistoryStream", R_PerfHistoryStream_f, CMD_FL_RENDERER, "appends the performance counters of every frame to a csv or json file, no file closes the stream" );
 	cmdSystem->AddCommand( "listRenderEntityDefs", R_ListRenderEntityDefs_f, CMD_FL_RENDERER, "lists the entity defs" );
 	cmdSystem->AddCommand( "listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs" );
 	cmdSystem->AddCommand( "listModes", R_ListModes_f, CMD_FL_RENDERER, "lists all video modes" );
@@ -1828,7 +1848,13 @@ void idRenderSystemLocal::Clear( void ) {
 	tiledViewport[0] = 0;
 	tiledViewport[1] = 0;
 	ambientLightVector.Zero();
-	sortOffset = 0;
+	frontEndJobs = NULL;
+	frontEndJobsActive = false;
+	deferSkinning = false;
+	deferredSkins.Clear();
+	smpActive = false;
+	renderThreadBusy = false;
+	frontEndBenchmark = false;
 	worlds.Clear();
 	primaryWorld = NULL;
 	memset( &primaryRenderView, 0, sizeof( primaryRenderView ) );
@@ -1879,6 +1905,8 @@ void idRenderSystemLocal::Init( void ) {
 	guiModel = new idGuiModel;
 	guiModel->Clear();
 
+	frontEndJobs = parallelJobManager->AllocJobList( "frontEnd" );
+
 	demoGuiModel = new idGuiModel;
 	demoGuiModel->Clear();
 
@@ -1912,6 +1940,10 @@ idRenderSystemLocal::Shutdown
 void idRenderSystemLocal::Shutdown( void ) {	
 	common->Printf( "idRenderSystem::Shutdown()\n" );
 
+	R_ShutdownRenderThread();
+
+	R_ShutdownPerfHistory();
+
 	R_DoneFreeType( );
 
 	if ( glConfig.isInitialized ) {
@@ -1937,6 +1969,8 @@ void idRenderSystemLocal::Shutdown( void ) {
 	delete guiModel;
 	delete demoGuiModel;
 
+	parallelJobManager->FreeJobList( frontEndJobs );
+
 	Clear();
     
     renderLog.Close();
@@ -1950,6 +1984,8 @@ idRenderSystemLocal::BeginLevelLoad
 ========================
 */
 void idRenderSystemLocal::BeginLevelLoad( void ) {
+	R_SyncRenderThread();
+
 	renderModelManager->BeginLevelLoad();
 	globalImages->BeginLevelLoad();
 }
@@ -1960,6 +1996,8 @@ idRenderSystemLocal::EndLevelLoad
 ========================
 */
 void idRenderSystemLocal::EndLevelLoad( void ) {
+	R_SyncRenderThread();
+
 	renderModelManager->EndLevelLoad();
 	globalImages->EndLevelLoad();
 	if ( r_forceLoadImages.GetBool() ) {
@@ -1994,6 +2032,8 @@ idRenderSystemLocal::ShutdownOpenGL
 ========================
 */
 void idRenderSystemLocal::ShutdownOpenGL( void ) {
+	R_ShutdownRenderThread();
+
 	// free the context and close the window
 	R_ShutdownFrameData();
 	GLimp_Shutdown();
@@ -138,10 +138,6 @@ idRenderWorldLocal::idRenderWorldLocal() {
 
 	doublePortals = NULL;
 	numInterAreaPortals = 0;
-
-	interactionTable = 0;
-	interactionTableWidth = 0;
-	interactionTableHeight = 0;
 }
 
 /*
@@ -159,19 +155,6 @@ idRenderWorldLocal::~idRenderWorldLocal() {
 	RB_ClearDebugText( 0 );
 }
 
-/*
-===================
-ResizeInteractionTable
-===================
-*/
-void idRenderWorldLocal::ResizeInteractionTable() {
-	// we overflowed the interaction table, so dump it
-	// we may want to resize this in the future if it turns out to be common
-	common->Printf( "idRenderWorldLocal::ResizeInteractionTable: overflowed interactionTableWidth, dumping\n" );
-	R_StaticFree( interactionTable );
-	interactionTable = NULL;
-}
-
 /*
 ===================
 AddEntityDef
@@ -182,9 +165,6 @@ qhandle_t idRenderWorldLocal::AddEntityDef( const renderEntity_t *re ){
 	int entityHandle = entityDefs.FindNull();
 	if ( entityHandle == -1 ) {
 		entityHandle = entityDefs.Append( NULL );
-		if ( interactionTable && entityDefs.Num() > interactionTableWidth ) {
-			ResizeInteractionTable();
-		}
 	}
 
 	UpdateEntityDef( entityHandle, re );
@@ -361,9 +341,6 @@ qhandle_t idRenderWorldLocal::AddLightDef( const renderLight_t *rlight ) {
 
 	if ( lightHandle == -1 ) {
 		lightHandle = lightDefs.Append( NULL );
-		if ( interactionTable && lightDefs.Num() > interactionTableHeight ) {
-			ResizeInteractionTable();
-		}
 	}
 	UpdateLightDef( lightHandle, rlight );
 
@@ -629,6 +606,10 @@ void idRenderWorldLocal::ProjectOverlay( qhandle_t entityHandle, const idPlane l
 		return;
 	}
 	model = R_EntityDefDynamicModel( def );
+	if ( model == NULL ) {
+		return;
+	}
+	R_SkinModelVerts( model );
 
 	if ( def->overlay == NULL ) {
 		def->overlay = idRenderModelOverlay::Alloc();
@@ -682,6 +663,8 @@ void idRenderWorldLocal::RenderScene( const renderView_t *renderView ) {
 #ifndef	ID_DEDICATED
 	renderView_t	copy;
 
+	PROFILE_SCOPE( "idRenderWorldLocal::RenderScene" );
+
 	if ( !glConfig.isInitialized ) {
 		return;
 	}
@@ -754,11 +737,16 @@ void idRenderWorldLocal::RenderScene( const renderView_t *renderView ) {
 	tr.primaryRenderView = *renderView;
 	tr.primaryView = parms;
 
+	// drop the shadow volumes of interactions that weren't recreated recently
+	shadowCache.Age();
+
 	// rendering this view may cause other views to be rendered
 	// for mirrors / portals / shadows / environment maps
 	// this will also cause any necessary entities and lights to be
 	// updated to the demo file
+	double renderViewStart = R_BeginFrontEndPhase();
 	R_RenderView( parms );
+	R_EndFrontEndPhase( FE_PHASE_RENDER_VIEW, renderViewStart );
 
 	// now write delete commands for any modified-but-not-visible entities, and
 	// add the renderView command to the demo
@@ -1079,6 +1067,7 @@ bool idRenderWorldLocal::ModelTrace( modelTrace_t &trace, qhandle_t entityHandle
 	if ( !model ) {
 		return false;
 	}
+	R_SkinModelVerts( model );
 
 	// transform the points into local space
 	R_AxisToModelMatrix( refEnt->axis, refEnt->origin, modelMatrix );
@@ -1230,6 +1219,7 @@ bool idRenderWorldLocal::Trace( modelTrace_t &trace, const idVec3 &start, const
 			if ( !traceBounds.IntersectsBounds( bounds ) || !bounds.LineIntersection( start, trace.point ) ) {
 				continue;
 			}
+			R_SkinModelVerts( model );
 
 			// check all model surfaces
 			for ( j = 0; j < model->NumSurfaces(); j++ ) {
@@ -1440,8 +1430,7 @@ Force the generation of all light / surface interactions at the start of a level
 If this isn't called, they will all be dynamically generated
 
 This really isn't all that helpful anymore, because the calculation of shadows
-and light interactions is deferred from idRenderWorldLocal::CreateLightDefInteractions(), but we
-use it as an oportunity to size the interactionTable
+and light interactions is deferred from idRenderWorldLocal::CreateLightDefInteractions()
 ===================
 */
 void idRenderWorldLocal::GenerateAllInteractions() {
@@ -1474,32 +1463,10 @@ void idRenderWorldLocal::GenerateAllInteractions() {
 	common->Printf( "idRenderWorld::GenerateAllInteractions, msec = %i, staticAllocCount = %i.\n", msec, tr.staticAllocCount );
 
 
-	// build the interaction table
-	if ( r_useInteractionTable.GetBool() ) {
-		interactionTableWidth = entityDefs.Num() + 100;
-		interactionTableHeight = lightDefs.Num() + 100;
-		int	size =  interactionTableWidth * interactionTableHeight * sizeof( *interactionTable );
-		interactionTable = (idInteraction **)R_ClearedStaticAlloc( size );
-
-		int	count = 0;
-		for ( int i = 0 ; i < this->lightDefs.Num() ; i++ ) {
-			idRenderLightLocal	*ldef = this->lightDefs[i];
-			if ( !ldef ) {
-				continue;
-			}
-			idInteraction	*inter;
-			for ( inter = ldef->firstInteraction; inter != NULL; inter = inter->lightNext ) {
-				idRenderEntityLocal	*edef = inter->entityDef;
-				int index = ldef->index * interactionTableWidth + edef->index;
-
-				interactionTable[ index ] = inter;
-				count++;
-			}
-		}
-
-		common->Printf( "interactionTable size: %i bytes\n", size );
-		common->Printf( "%i interaction take %i bytes\n", count, count * sizeof( idInteraction ) );
-	}
+	// the interaction table is kept up to date as interactions are created
+	int count = interactionTable.NumInteractions();
+	common->Printf( "interactionTable size: %i bytes\n", interactionTable.MemoryUsed() );
+	common->Printf( "%i interaction take %i bytes\n", count, count * sizeof( idInteraction ) );
 
 	// entities flagged as noDynamicInteractions will no longer make any
 	generateAllInteractionsCalled = true;
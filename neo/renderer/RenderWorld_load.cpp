@@ -30,6 +30,10 @@ If you have questions concerning this license or the applicable additional terms
 #pragma hdrstop
 
 #include "tr_local.h"
+#include "Model_local.h"
+
+static const int BPROC_MAGIC		= ( 'B' << 24 ) | ( 'P' << 16 ) | ( 'R' << 8 ) | 'C';
+static const int BPROC_VERSION		= 1;
 
 
 /*
@@ -369,6 +373,291 @@ void idRenderWorldLocal::ParseNodes( idLexer *src ) {
 	src->ExpectTokenString( "}" );
 }
 
+/*
+================
+R_BinaryWorldFileName
+================
+*/
+static void R_BinaryWorldFileName( const char *procName, idStr &fileName ) {
+	fileName = "generated/";
+	fileName += procName;
+	fileName.SetFileExtension( "bproc" );
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryModel
+================
+*/
+idRenderModel *idRenderWorldLocal::ReadBinaryModel( idFile *file ) {
+	idStr					name;
+	idRenderModelStatic *	model;
+
+	file->ReadString( name );
+
+	model = static_cast<idRenderModelStatic *>( renderModelManager->AllocModel() );
+	model->InitEmpty( name );
+
+	if ( !model->ReadBinarySurfaces( file ) ) {
+		delete model;
+		return NULL;
+	}
+
+	for ( int i = 0 ; i < model->surfaces.Num() ; i++ ) {
+		const_cast<idMaterial *>( model->surfaces[i].shader )->AddReference();
+	}
+
+	return model;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryPortals
+================
+*/
+bool idRenderWorldLocal::ReadBinaryPortals( idFile *file ) {
+	file->ReadInt( numPortalAreas );
+	file->ReadInt( numInterAreaPortals );
+	if ( numPortalAreas < 0 || numInterAreaPortals < 0 || numInterAreaPortals > file->Length() - file->Tell() ) {
+		numPortalAreas = numInterAreaPortals = 0;
+		return false;
+	}
+	if ( numPortalAreas == 0 ) {
+		return true;
+	}
+
+	portalAreas = (portalArea_t *)R_ClearedStaticAlloc( numPortalAreas * sizeof( portalAreas[0] ) );
+	areaScreenRect = (idScreenRect *) R_ClearedStaticAlloc( numPortalAreas * sizeof( idScreenRect ) );
+
+	// set the doubly linked lists
+	SetupAreaRefs();
+
+	doublePortals = (doublePortal_t *)R_ClearedStaticAlloc( numInterAreaPortals * sizeof( doublePortals[0] ) );
+
+	for ( int i = 0 ; i < numInterAreaPortals ; i++ ) {
+		int		numPoints, a1, a2;
+		portal_t	*p;
+
+		file->ReadInt( numPoints );
+		file->ReadInt( a1 );
+		file->ReadInt( a2 );
+		if ( numPoints < 3 || numPoints > ( file->Length() - file->Tell() ) / (int)sizeof( idVec3 ) ||
+				a1 < 0 || a1 >= numPortalAreas || a2 < 0 || a2 >= numPortalAreas ) {
+			return false;
+		}
+
+		idWinding *w = new idWinding( numPoints );
+		w->SetNumPoints( numPoints );
+		for ( int j = 0 ; j < numPoints ; j++ ) {
+			file->ReadVec3( (*w)[j].ToVec3() );
+			// no texture coordinates
+			(*w)[j][3] = 0;
+			(*w)[j][4] = 0;
+		}
+
+		// the same two portals ParseInterAreaPortals makes
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a2;
+		p->doublePortal = &doublePortals[i];
+		p->w = w;
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a1].portals;
+		portalAreas[a1].portals = p;
+
+		doublePortals[i].portals[0] = p;
+
+		p = (portal_t *)R_ClearedStaticAlloc( sizeof( *p ) );
+		p->intoArea = a1;
+		p->doublePortal = &doublePortals[i];
+		p->w = w->Reverse();
+		p->w->GetPlane( p->plane );
+
+		p->next = portalAreas[a2].portals;
+		portalAreas[a2].portals = p;
+
+		doublePortals[i].portals[1] = p;
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::ReadBinaryNodes
+================
+*/
+bool idRenderWorldLocal::ReadBinaryNodes( idFile *file ) {
+	file->ReadInt( numAreaNodes );
+	if ( numAreaNodes <= 0 || numAreaNodes > ( file->Length() - file->Tell() ) / ( 4 * (int)sizeof( float ) + 2 * (int)sizeof( int ) ) ) {
+		numAreaNodes = 0;
+		return false;
+	}
+	areaNodes = (areaNode_t *)R_ClearedStaticAlloc( numAreaNodes * sizeof( areaNodes[0] ) );
+
+	for ( int i = 0 ; i < numAreaNodes ; i++ ) {
+		areaNode_t	*node = &areaNodes[i];
+
+		file->ReadFloat( node->plane[0] );
+		file->ReadFloat( node->plane[1] );
+		file->ReadFloat( node->plane[2] );
+		file->ReadFloat( node->plane[3] );
+		file->ReadInt( node->children[0] );
+		file->ReadInt( node->children[1] );
+
+		// CommonChildrenArea_r walks the children, so don't trust them blindly
+		for ( int j = 0 ; j < 2 ; j++ ) {
+			if ( node->children[j] > 0 ? node->children[j] <= i || node->children[j] >= numAreaNodes
+					: -1 - node->children[j] >= numPortalAreas && -1 - node->children[j] != AREANUM_SOLID ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+idRenderWorldLocal::LoadBinaryWorld
+
+The binary world is written by the first text load of a .proc to generated/<map>.bproc
+and holds the finished area and shadow models, so loading it is a single file read and
+no FinishSurfaces.  It is only used while the .proc timestamp and length match.  On any
+failure the partially loaded world is freed and false is returned, so the text .proc
+gets parsed.
+================
+*/
+bool idRenderWorldLocal::LoadBinaryWorld( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) {
+	idStr			binaryName;
+	void *			buffer;
+	int				magic, version, byteOrder, vertSize, indexSize;
+	unsigned int	cachedTimeStamp, options;
+	int				cachedLength, numModels;
+
+	if ( !r_useCachedWorld.GetBool() || sourceLength <= 0 ) {
+		return false;
+	}
+
+	R_BinaryWorldFileName( fileName, binaryName );
+
+	int length = fileSystem->ReadFile( binaryName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory file( binaryName, (const char *)buffer, length );
+	bool valid = false;
+
+	file.ReadInt( magic );
+	file.ReadInt( version );
+	file.Read( &byteOrder, sizeof( byteOrder ) );
+	file.ReadInt( vertSize );
+	file.ReadInt( indexSize );
+	file.ReadUnsignedInt( cachedTimeStamp );
+	file.ReadInt( cachedLength );
+	file.ReadUnsignedInt( options );
+	file.ReadInt( numModels );
+
+	if ( magic == BPROC_MAGIC && version == BPROC_VERSION && byteOrder == 1 &&
+			vertSize == sizeof( idDrawVert ) && indexSize == sizeof( glIndex_t ) &&
+			cachedTimeStamp == (unsigned int)sourceTimeStamp && cachedLength == sourceLength &&
+			options == idRenderModelStatic::BinaryModelOptions() && numModels >= 0 ) {
+		valid = true;
+		for ( int i = 0 ; i < numModels && valid ; i++ ) {
+			idRenderModel *model = ReadBinaryModel( &file );
+			if ( model == NULL ) {
+				valid = false;
+				break;
+			}
+
+			// add it to the model manager list
+			renderModelManager->AddModel( model );
+
+			// save it in the list to free when clearing this map
+			localModels.Append( model );
+		}
+		valid = valid && ReadBinaryPortals( &file ) && ReadBinaryNodes( &file );
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	if ( !valid ) {
+		common->DPrintf( "%s is out of date\n", binaryName.c_str() );
+		FreeWorld();
+	}
+	return valid;
+}
+
+/*
+================
+idRenderWorldLocal::WriteBinaryWorld
+
+Written in native byte order after the text .proc has been parsed
+================
+*/
+void idRenderWorldLocal::WriteBinaryWorld( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) const {
+	idStr		binaryName;
+	const int	byteOrder = 1;
+
+	if ( !r_useCachedWorld.GetBool() || sourceLength <= 0 || numAreaNodes <= 0 ) {
+		return;
+	}
+
+	R_BinaryWorldFileName( fileName, binaryName );
+
+	idFile *file = fileSystem->OpenFileWrite( binaryName, "fs_basepath" );
+	if ( file == NULL ) {
+		common->DPrintf( "couldn't write world cache file %s\n", binaryName.c_str() );
+		return;
+	}
+
+	file->WriteInt( BPROC_MAGIC );
+	file->WriteInt( BPROC_VERSION );
+	file->Write( &byteOrder, sizeof( byteOrder ) );
+	file->WriteInt( sizeof( idDrawVert ) );
+	file->WriteInt( sizeof( glIndex_t ) );
+	file->WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+	file->WriteInt( sourceLength );
+	file->WriteUnsignedInt( idRenderModelStatic::BinaryModelOptions() );
+
+	file->WriteInt( localModels.Num() );
+	for ( int i = 0 ; i < localModels.Num() ; i++ ) {
+		const idRenderModelStatic *model = static_cast<const idRenderModelStatic *>( localModels[i] );
+
+		file->WriteString( model->Name() );
+		model->WriteBinarySurfaces( file );
+	}
+
+	file->WriteInt( numPortalAreas );
+	file->WriteInt( numInterAreaPortals );
+	for ( int i = 0 ; i < numInterAreaPortals ; i++ ) {
+		const portal_t *p = doublePortals[i].portals[0];
+		const idWinding *w = p->w;
+
+		file->WriteInt( w->GetNumPoints() );
+		file->WriteInt( doublePortals[i].portals[1]->intoArea );
+		file->WriteInt( p->intoArea );
+		for ( int j = 0 ; j < w->GetNumPoints() ; j++ ) {
+			file->WriteVec3( (*w)[j].ToVec3() );
+		}
+	}
+
+	file->WriteInt( numAreaNodes );
+	for ( int i = 0 ; i < numAreaNodes ; i++ ) {
+		const areaNode_t *node = &areaNodes[i];
+
+		file->WriteFloat( node->plane[0] );
+		file->WriteFloat( node->plane[1] );
+		file->WriteFloat( node->plane[2] );
+		file->WriteFloat( node->plane[3] );
+		file->WriteInt( node->children[0] );
+		file->WriteInt( node->children[1] );
+	}
+
+	fileSystem->CloseFile( file );
+}
+
 /*
 ================
 idRenderWorldLocal::CommonChildrenArea_r
@@ -440,11 +729,6 @@ void idRenderWorldLocal::FreeDefs() {
 
 	generateAllInteractionsCalled = false;
 
-	if ( interactionTable ) {
-		R_StaticFree( interactionTable );
-		interactionTable = NULL;
-	}
-
 	// free all lightDefs
 	for ( i = 0 ; i < lightDefs.Num() ; i++ ) {
 		idRenderLightLocal	*light;
@@ -466,6 +750,10 @@ void idRenderWorldLocal::FreeDefs() {
 			entityDefs[i] = NULL;
 		}
 	}
+
+	// all interactions have been unlinked, release the per light tables as well
+	interactionTable.Clear();
+	shadowCache.Clear();
 }
 
 /*
@@ -498,7 +786,7 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 	// if we are reloading the same map, check the timestamp
 	// and try to skip all the work
 	ID_TIME_T currentTimeStamp;
-	fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
+	int sourceLength = fileSystem->ReadFile( filename, NULL, &currentTimeStamp );
 
 	if ( name == mapName ) {
 		if ( currentTimeStamp != FILE_NOT_FOUND_TIMESTAMP && currentTimeStamp == mapTimeStamp ) {
@@ -514,13 +802,17 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 
 	FreeWorld();
 
-	src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
-	if ( !src->IsLoaded() ) {
-		common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
-		ClearWorld();
-		return false;
-	}
+	bool binaryLoaded = LoadBinaryWorld( filename, currentTimeStamp, sourceLength );
 
+	src = NULL;
+	if ( !binaryLoaded ) {
+		src = new idLexer( filename, LEXFL_NOSTRINGCONCAT | LEXFL_NODOLLARPRECOMPILE );
+		if ( !src->IsLoaded() ) {
+			common->Printf( "idRenderWorldLocal::InitFromMap: %s not found\n", filename.c_str() );
+			ClearWorld();
+			return false;
+		}
+	}
 
 	mapName = name;
 	mapTimeStamp = currentTimeStamp;
@@ -530,14 +822,14 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 		WriteLoadMap();
 	}
 
-	if ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) {
+	if ( src && ( !src->ReadToken( &token ) || token.Icmp( PROC_FILE_ID ) ) ) {
 		common->Printf( "idRenderWorldLocal::InitFromMap: bad id '%s' instead of '%s'\n", token.c_str(), PROC_FILE_ID );
 		delete src;
 		return false;
 	}
 
-	// parse the file
-	while ( 1 ) {
+	// parse the file, unless it came from the binary cache
+	while ( src ) {
 		if ( !src->ReadToken( &token ) ) {
 			break;
 		}
@@ -577,7 +869,11 @@ bool idRenderWorldLocal::InitFromMap( const char *name ) {
 		src->Error( "idRenderWorldLocal::InitFromMap: bad token \"%s\"", token.c_str() );
 	}
 
-	delete src;
+	if ( src ) {
+		delete src;
+
+		WriteBinaryWorld( filename, currentTimeStamp, sourceLength );
+	}
 
 	// if it was a trivial map without any areas, create a single area
 	if ( !numPortalAreas ) {
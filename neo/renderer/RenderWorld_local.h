@@ -159,13 +159,12 @@ public:
 	idBlockAlloc<areaNumRef_t, 1024>	areaNumRefAllocator;
 
 	// all light / entity interactions are referenced here for fast lookup without
-	// having to crawl the doubly linked lists.  EnntityDefs are sequential for better
-	// cache access, because the table is accessed by light in idRenderWorldLocal::CreateLightDefInteractions()
-	// Growing this table is time consuming, so we add a pad value to the number
-	// of entityDefs and lightDefs
-	idInteraction **		interactionTable;
-	int						interactionTableWidth;		// entityDefs
-	int						interactionTableHeight;		// lightDefs
+	// having to crawl the doubly linked lists.  The table is accessed by light in
+	// idRenderWorldLocal::CreateLightDefInteractions()
+	idInteractionTable		interactionTable;
+
+	// shadow volumes of recently freed interactions, see idInteraction::CreateInteraction()
+	idShadowVolumeCache		shadowCache;
 
 
 	bool					generateAllInteractionsCalled;
@@ -178,6 +177,11 @@ public:
 	void					SetupAreaRefs();
 	void					ParseInterAreaPortals( idLexer *src );
 	void					ParseNodes( idLexer *src );
+	idRenderModel *			ReadBinaryModel( idFile *file );
+	bool					ReadBinaryPortals( idFile *file );
+	bool					ReadBinaryNodes( idFile *file );
+	bool					LoadBinaryWorld( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength );
+	void					WriteBinaryWorld( const char *fileName, ID_TIME_T sourceTimeStamp, int sourceLength ) const;
 	int						CommonChildrenArea_r( areaNode_t *node );
 	void					FreeWorld();
 	void					ClearWorld();
@@ -237,7 +241,6 @@ public:
 	//--------------------------
 	// RenderWorld.cpp
 
-	void					ResizeInteractionTable();
 
 	void					AddEntityRefToArea( idRenderEntityLocal *def, portalArea_t *area );
 	void					AddLightRefToArea( idRenderLightLocal *light, portalArea_t *area );
@@ -836,6 +836,8 @@ they were considered, but not actually visible.
 =============
 */
 void idRenderWorldLocal::FindViewLightsAndEntities( void ) {
+	PROFILE_SCOPE( "idRenderWorldLocal::FindViewLightsAndEntities" );
+
 	// clear the visible lightDef and entityDef lists
 	tr.viewDef->viewLights = NULL;
 	tr.viewDef->viewEntitys = NULL;
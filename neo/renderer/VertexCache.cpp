@@ -105,8 +105,11 @@ void idVertexCache::ActuallyFree( vertCache_t *block ) {
             // implementations in some form. Changed a bit to map to NULL pointer
             // with block size. Removing this is probably ok but you cannot remove
             // the if ( block->vbo ) cause then it will crash.
-            GL_BindBuffer(GL_ARRAY_BUFFER_ARB, block->vbo);
-            glBufferData(GL_ARRAY_BUFFER_ARB, block->size, NULL, GL_DYNAMIC_DRAW_ARB);
+            // Skipped while the render thread owns the context.
+            if ( !deferUploads ) {
+                GL_BindBuffer(GL_ARRAY_BUFFER_ARB, block->vbo);
+                glBufferData(GL_ARRAY_BUFFER_ARB, block->size, NULL, GL_DYNAMIC_DRAW_ARB);
+            }
         } else if ( block->virtMem ) {
 			Mem_Free( block->virtMem );
 			block->virtMem = NULL;
@@ -190,8 +193,11 @@ void idVertexCache::Init() {
 	this->freeStaticHeaders.next = this->freeStaticHeaders.prev = &this->freeStaticHeaders;
     staticHeaders.next = staticHeaders.prev = &staticHeaders;
 	freeDynamicHeaders.next = freeDynamicHeaders.prev = &freeDynamicHeaders;
-	dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
-	deferredFreeList.next = deferredFreeList.prev = &deferredFreeList;
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		dynamicHeaders[i].next = dynamicHeaders[i].prev = &dynamicHeaders[i];
+		deferredFreeList[i].next = deferredFreeList[i].prev = &deferredFreeList[i];
+	}
+	deferUploads = false;
 
 	// set up the dynamic frame memory
 	frameBytes = FRAME_MEMORY_BYTES;
@@ -222,6 +228,9 @@ the cached data isn't valid
 ===========
 */
 void idVertexCache::PurgeAll() {
+	// the back end may still be drawing from these
+	R_SyncRenderThread();
+
 	while( staticHeaders.next != &staticHeaders ) {
 		ActuallyFree( staticHeaders.next );
 	}
@@ -234,6 +243,20 @@ idVertexCache::Shutdown
 */
 void idVertexCache::Shutdown() {
 	headerAllocator.Shutdown();
+
+	for ( int i = 0 ; i < NUM_VERTEX_FRAMES ; i++ ) {
+		vertCacheUploadList_t &list = uploadLists[i];
+		list.uploads.Clear();
+		list.numFlushed = 0;
+		Mem_Free16( list.staticStaging );
+		list.staticStaging = NULL;
+		list.staticStagingSize = 0;
+		list.staticStagingUsed = 0;
+		Mem_Free16( list.tempStaging );
+		list.tempStaging = NULL;
+		list.tempStagingSize = 0;
+		list.tempBytes = 0;
+	}
 }
 
 /*
@@ -256,7 +279,13 @@ void idVertexCache::Alloc( void *data, int size, vertCache_t **buffer, bool inde
 		for ( int i = 0; i < EXPAND_HEADERS; i++ ) {
 			block = headerAllocator.Alloc ();
 
-			glGenBuffers( 1, &block->vbo );
+			if ( deferUploads ) {
+				// generated by the back end on the first upload
+				block->vbo = 0;
+			} else {
+				glGenBuffers( 1, &block->vbo );
+			}
+			block->virtMem = NULL;
             block->size = 0;
             block->next = this->freeStaticHeaders.next;
             block->prev = &this->freeStaticHeaders;
@@ -290,14 +319,26 @@ void idVertexCache::Alloc( void *data, int size, vertCache_t **buffer, bool inde
     block->target = target;
     block->usage = usage;
 
-    if ( block->vbo ) {
+    if ( deferUploads ) {
+        vertCacheUploadList_t &list = uploadLists[listNum];
+        vertCacheUpload_t &upload = list.uploads.Alloc();
+        upload.block = block;
+        upload.target = target;
+        upload.usage = usage;
+        upload.size = size;
+        upload.stagingOffset = list.staticStagingUsed;
+        ReserveStaging( list.staticStaging, list.staticStagingSize, list.staticStagingUsed, list.staticStagingUsed + size );
+        SIMDProcessor->Memcpy( list.staticStaging + upload.stagingOffset, data, size );
+        list.staticStagingUsed += size;
+    } else {
+        if ( !block->vbo ) {
+            // headers expanded while uploads were deferred get their buffer here
+            glGenBuffers( 1, &block->vbo );
+        }
         // orphan the buffer in case it needs respecifying (it usually will)
         GL_BindBuffer( target, block->vbo );
         glBufferData( target, (GLsizeiptr) size, NULL, usage );
         glBufferData( target, (GLsizeiptr) size, data, usage );
-    } else {
-        block->virtMem = Mem_Alloc( size );
-        SIMDProcessor->Memcpy( block->virtMem, data, size );
     }
 	block->next->prev = block->prev;
 	block->prev->next = block->next;
@@ -381,11 +422,12 @@ void idVertexCache::Free( vertCache_t *block ) {
 	block->next->prev = block->prev;
 	block->prev->next = block->next;
 
-	block->next = deferredFreeList.next;
-	block->prev = &deferredFreeList;
+	vertCache_t &freeList = deferredFreeList[listNum];
+	block->next = freeList.next;
+	block->prev = &freeList;
     
-	deferredFreeList.next->prev = block;
-	deferredFreeList.next = block;
+	freeList.next->prev = block;
+	freeList.next = block;
 }
 
 /*
@@ -397,14 +439,21 @@ We can't simply sync with the GPU and overwrite what we have, because
 there may still be future references to dynamically created surfaces.
 ===========
 */
-vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
+vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size, int alignment ) {
 	vertCache_t	*block;
 
 	if ( size <= 0 ) {
 		common->Error( "idVertexCache::AllocFrameTemp: size = %i\n", size );
 	}
 
-	if ( dynamicAllocThisFrame + size > frameBytes ) {
+	// pad the shared space so the block starts on the requested boundary,
+	// static blocks always start at offset 0 so the overflow case is aligned
+	int padding = 0;
+	if ( alignment > 1 ) {
+		padding = ( alignment - ( dynamicAllocThisFrame % alignment ) ) % alignment;
+	}
+
+	if ( dynamicAllocThisFrame + padding + size > frameBytes ) {
 		// if we don't have enough room in the temp block, allocate a static block,
 		// but immediately free it so it will get freed at the next frame
         this->tempOverflow = true;
@@ -431,11 +480,13 @@ vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
 	block = freeDynamicHeaders.next;
 	block->next->prev = block->prev;
 	block->prev->next = block->next;
-	block->next = dynamicHeaders.next;
-	block->prev = &dynamicHeaders;
+	block->next = dynamicHeaders[listNum].next;
+	block->prev = &dynamicHeaders[listNum];
 	block->next->prev = block;
 	block->prev->next = block;
 
+	dynamicAllocThisFrame += padding;
+
 	block->size = size;
 	block->tag = TAG_TEMP;
 	block->indexBuffer = false;
@@ -448,6 +499,16 @@ vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
 	// copy the data
 	block->virtMem = tempBuffers[listNum]->virtMem;
 
+	if ( deferUploads ) {
+		// FlushUploads sends the whole staging area up at once
+		vertCacheUploadList_t &list = uploadLists[listNum];
+		block->vbo = tempBuffers[listNum]->vbo;
+		ReserveStaging( list.tempStaging, list.tempStagingSize, list.tempBytes, dynamicAllocThisFrame );
+		SIMDProcessor->Memcpy( list.tempStaging + block->offset, data, size );
+		list.tempBytes = dynamicAllocThisFrame;
+		return block;
+	}
+
     if ( ( block->vbo = tempBuffers[listNum]->vbo ) != 0 ) {
         GL_BindBuffer( GL_ARRAY_BUFFER, block->vbo );
 
@@ -478,6 +539,82 @@ vertCache_t	*idVertexCache::AllocFrameTemp( void *data, int size ) {
 	return block;
 }
 
+/*
+===========
+idVertexCache::ReserveStaging
+
+Grows a staging area to at least the given size, keeping the used part.
+Only called by the front end, the back end never sees a list that is being filled.
+===========
+*/
+void idVertexCache::ReserveStaging( byte *&staging, int &stagingSize, int used, int size ) {
+	if ( size <= stagingSize ) {
+		return;
+	}
+	int newSize = Max( stagingSize * 2, 0x100000 );
+	while ( newSize < size ) {
+		newSize *= 2;
+	}
+	byte *newStaging = (byte *)Mem_Alloc16( newSize );
+	if ( used ) {
+		SIMDProcessor->Memcpy( newStaging, staging, used );
+	}
+	Mem_Free16( staging );
+	staging = newStaging;
+	stagingSize = newSize;
+}
+
+/*
+===========
+idVertexCache::SetDeferUploads
+===========
+*/
+void idVertexCache::SetDeferUploads( bool defer ) {
+	deferUploads = defer;
+}
+
+/*
+===========
+idVertexCache::CloseUploads
+===========
+*/
+int idVertexCache::CloseUploads() {
+	return listNum;
+}
+
+/*
+===========
+idVertexCache::FlushUploads
+
+The front end doesn't touch the list again until the
+render thread has been synced, so nothing is locked here
+===========
+*/
+void idVertexCache::FlushUploads( int listIndex ) {
+	vertCacheUploadList_t &list = uploadLists[listIndex];
+
+	for ( ; list.numFlushed < list.uploads.Num() ; list.numFlushed++ ) {
+		const vertCacheUpload_t &upload = list.uploads[list.numFlushed];
+		vertCache_t *block = upload.block;
+
+		if ( !block->vbo ) {
+			glGenBuffers( 1, &block->vbo );
+		}
+		// orphan the buffer in case it needs respecifying (it usually will)
+		GL_BindBuffer( upload.target, block->vbo );
+		glBufferData( upload.target, (GLsizeiptr) upload.size, NULL, upload.usage );
+		glBufferData( upload.target, (GLsizeiptr) upload.size, list.staticStaging + upload.stagingOffset, upload.usage );
+	}
+
+	if ( list.tempBytes ) {
+		// everything since the start of the frame, in case an earlier flush
+		// already went out for a mid frame capture
+		GL_BindBuffer( GL_ARRAY_BUFFER, tempBuffers[listIndex]->vbo );
+		glBufferData( GL_ARRAY_BUFFER, (GLsizeiptr) frameBytes, NULL, GL_STREAM_DRAW );
+		glBufferSubData( GL_ARRAY_BUFFER, 0, (GLsizeiptr) list.tempBytes, list.tempStaging );
+	}
+}
+
 /*
 ===========
 idVertexCache::EndFrame
@@ -513,21 +650,31 @@ void idVertexCache::EndFrame() {
 	dynamicCountThisFrame = 0;
 	tempOverflow = false;
 
-	// free all the deferred free headers
-	while( deferredFreeList.next != &deferredFreeList ) {
-		ActuallyFree( deferredFreeList.next );
+	// free the deferred free headers and the frame temp headers of the last
+	// frame that used this listNum, the render thread may still be drawing
+	// the frame that was just issued, but it is done with that one
+	vertCache_t &freeList = deferredFreeList[listNum];
+	while( freeList.next != &freeList ) {
+		ActuallyFree( freeList.next );
 	}
 
-	// free all the frame temp headers
-	vertCache_t	*block = dynamicHeaders.next;
-	if ( block != &dynamicHeaders ) {
+	vertCache_t &tempHeaders = dynamicHeaders[listNum];
+	vertCache_t	*block = tempHeaders.next;
+	if ( block != &tempHeaders ) {
 		block->prev = &freeDynamicHeaders;
-		dynamicHeaders.prev->next = freeDynamicHeaders.next;
-		freeDynamicHeaders.next->prev = dynamicHeaders.prev;
+		tempHeaders.prev->next = freeDynamicHeaders.next;
+		freeDynamicHeaders.next->prev = tempHeaders.prev;
 		freeDynamicHeaders.next = block;
 
-		dynamicHeaders.next = dynamicHeaders.prev = &dynamicHeaders;
+		tempHeaders.next = tempHeaders.prev = &tempHeaders;
 	}
+
+	// its uploads were flushed along with its commands
+	vertCacheUploadList_t &list = uploadLists[listNum];
+	list.uploads.SetNum( 0, false );
+	list.numFlushed = 0;
+	list.staticStagingUsed = 0;
+	list.tempBytes = 0;
 }
 
 /*
@@ -53,6 +53,27 @@ typedef struct vertCache_s {
 	int				frameUsed;			// it can't be purged if near the current frame
 } vertCache_t;
 
+// a static allocation made while uploads are deferred
+typedef struct {
+	vertCache_t *	block;
+	GLenum			target;
+	GLenum			usage;
+	int				size;
+	int				stagingOffset;		// into vertCacheUploadList_t::staticStaging
+} vertCacheUpload_t;
+
+// everything the back end has to upload before drawing a frame, one per NUM_VERTEX_FRAMES
+typedef struct {
+	idList<vertCacheUpload_t>	uploads;
+	int				numFlushed;			// uploads already performed by the back end
+	byte *			staticStaging;
+	int				staticStagingSize;
+	int				staticStagingUsed;
+	byte *			tempStaging;		// mirrors tempBuffers[], uploaded in one piece
+	int				tempStagingSize;
+	int				tempBytes;
+} vertCacheUploadList_t;
+
 
 class idVertexCache {
 public:
@@ -83,7 +104,9 @@ public:
 	// will change every frame.
 	// will return NULL if the vertex cache is completely full
 	// As with Position(), this may not actually be a pointer you can access.
-	vertCache_t	*	AllocFrameTemp( void *data, int bytes );
+	// A non-zero alignment rounds the offset up, which is required when the
+	// block will be bound with glBindBufferRange as a uniform buffer.
+	vertCache_t	*	AllocFrameTemp( void *data, int bytes, int alignment = 0 );
 
 	// notes that a buffer is used this frame, so it can't be purged
 	// out from under the GPU
@@ -102,9 +125,21 @@ public:
 	// listVertexCache calls this
 	void			List();
 
+	// While uploads are deferred Alloc and AllocFrameTemp make no GL calls,
+	// the data is staged and the back end uploads it with FlushUploads, so
+	// the front end can run while the render thread owns the context.
+	void			SetDeferUploads( bool defer );
+
+	// returns the upload list for the commands issued this frame
+	int				CloseUploads();
+
+	// back end only, performs the uploads staged in the list
+	void			FlushUploads( int list );
+
 private:
 	void			InitMemoryBlocks( int size );
 	void			ActuallyFree( vertCache_t *block );
+	void			ReserveStaging( byte *&staging, int &stagingSize, int used, int size );
 
 	static idCVar	r_showVertexCache;
 	static idCVar   r_useArbBufferRange;
@@ -130,12 +165,15 @@ private:
 
 	vertCache_t		freeStaticHeaders;		// head of doubly linked list
 	vertCache_t		freeDynamicHeaders;		// head of doubly linked list
-	vertCache_t		dynamicHeaders;			// head of doubly linked list
-	vertCache_t		deferredFreeList;		// head of doubly linked list
+	vertCache_t		dynamicHeaders[NUM_VERTEX_FRAMES];	// head of doubly linked list, the back end may still read last frame's
+	vertCache_t		deferredFreeList[NUM_VERTEX_FRAMES];	// head of doubly linked list, freed NUM_VERTEX_FRAMES frames later
 	vertCache_t		staticHeaders;			// head of doubly linked list in MRU order,
 											// staticHeaders.next is most recently used
 
 	int				frameBytes;				// for each of NUM_VERTEX_FRAMES frames
+
+	bool			deferUploads;
+	vertCacheUploadList_t	uploadLists[NUM_VERTEX_FRAMES];
 };
 
 extern	idVertexCache	vertexCache;
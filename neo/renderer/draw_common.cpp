@@ -670,6 +670,7 @@ void RB_STD_T_RenderShaderPasses( const drawSurf_t *surf ) {
     glVertexAttribPointer( PC_ATTRIB_INDEX_NORMAL, 3, GL_FLOAT, false, sizeof( idDrawVert ), ac->normal.ToFloatPtr() );
     
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_COLOR );
+	backEnd.glState.colorArrayEnabled = true;
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_TANGENT );
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_BITANGENT );
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_NORMAL );
@@ -821,6 +822,7 @@ void RB_STD_T_RenderShaderPasses( const drawSurf_t *surf ) {
 	}
     
     glDisableVertexAttribArray( PC_ATTRIB_INDEX_COLOR );
+	backEnd.glState.colorArrayEnabled = false;
     glDisableVertexAttribArray( PC_ATTRIB_INDEX_TANGENT );
     glDisableVertexAttribArray( PC_ATTRIB_INDEX_BITANGENT );
     glDisableVertexAttribArray( PC_ATTRIB_INDEX_NORMAL );
@@ -1554,6 +1556,7 @@ void RB_STD_CreateDrawInteractions(const drawSurf_t *surf) {
 	glEnableVertexAttribArray(PC_ATTRIB_INDEX_BITANGENT);
 	glEnableVertexAttribArray(PC_ATTRIB_INDEX_NORMAL);
 	glEnableVertexAttribArray(PC_ATTRIB_INDEX_COLOR);
+	backEnd.glState.colorArrayEnabled = true;
 
 	for (; surf; surf = surf->nextOnLight) {
 		// perform setup here that will not change over multiple interaction passes
@@ -1577,6 +1580,7 @@ void RB_STD_CreateDrawInteractions(const drawSurf_t *surf) {
 	glDisableVertexAttribArray(PC_ATTRIB_INDEX_BITANGENT);
 	glDisableVertexAttribArray(PC_ATTRIB_INDEX_NORMAL);
     glDisableVertexAttribArray(PC_ATTRIB_INDEX_COLOR);
+	backEnd.glState.colorArrayEnabled = false;
     
 	// disable features
 	GL_SelectTextureNoClient(4);
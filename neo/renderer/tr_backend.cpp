@@ -55,6 +55,7 @@ void RB_SetDefaultGLState( void ) {
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_ST );
     glEnableVertexAttribArray( PC_ATTRIB_INDEX_VERTEX );
     glDisableVertexAttribArray( PC_ATTRIB_INDEX_COLOR );
+	backEnd.glState.colorArrayEnabled = false;
 
 	//
 	// make sure our GL state vector is set correctly
@@ -591,6 +592,8 @@ void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds ) {
 	// r_debugRenderToTexture
 	int	c_draw3d = 0, c_draw2d = 0, c_setBuffers = 0, c_swapBuffers = 0, c_copyRenders = 0;
 
+	PROFILE_SCOPE( "RB_ExecuteBackEndCommands" );
+
 	if ( cmds->commandId == RC_NOP && !cmds->next ) {
 		return;
 	}
@@ -602,8 +605,11 @@ void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds ) {
 	// needed for editor rendering
 	RB_SetDefaultGLState();
 
-	// upload any image loads that have completed
-	globalImages->CompleteBackgroundImageLoads();
+	// upload any image loads that have completed, the front end
+	// does it in LoadQueuedImages while the render thread is active
+	if ( !tr.smpActive ) {
+		globalImages->CompleteBackgroundImageLoads();
+	}
 
 	for ( ; cmds ; cmds = (const emptyCommand_t *)cmds->next ) {
 		switch ( cmds->commandId ) {
@@ -651,3 +657,49 @@ void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds ) {
     
     renderLog.EndFrame();
 }
+
+/*
+====================
+RB_ExecuteFrame
+
+Uploads the vertex cache data the front end staged for the frame
+and draws its command list.  Runs on the render thread with r_useSMP.
+====================
+*/
+void RB_ExecuteFrame( frameData_t *frame ) {
+	vertexCache.FlushUploads( frame->vertexCacheUploads );
+
+	// r_skipBackEnd allows the entire time of the back end
+	// to be removed from performance measurements, although
+	// nothing will be drawn to the screen.  If the prints
+	// are going to a file, or r_skipBackEnd is later disabled,
+	// usefull data can be received.
+
+	// r_skipRender is usually more usefull, because it will still
+	// draw 2D graphics
+	if ( !r_skipBackEnd.GetBool() ) {
+		RB_ExecuteBackEndCommands( frame->cmdHead );
+	}
+}
+
+/*
+====================
+RB_RenderThread
+
+The GL context is only current on this thread between
+GLimp_WakeBackEnd and the front end's R_SyncRenderThread.
+====================
+*/
+void RB_RenderThread( void ) {
+	while ( 1 ) {
+		frameData_t *frame = (frameData_t *)GLimp_BackEndSleep();
+		if ( !frame ) {
+			// R_ShutdownRenderThread
+			break;
+		}
+
+		GLimp_ActivateContext();
+		RB_ExecuteFrame( frame );
+		GLimp_DeactivateContext();
+	}
+}
@@ -0,0 +1,232 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+===========================================================================================
+
+FRONT END BENCHMARK
+
+While a render demo is replayed by benchFrontEnd the main phases of the front end are
+timed every frame, and when the demo ends the per frame times are written out as JSON
+with percentiles.  The phases only cover front end work, the back end and the buffer
+swap are not part of them.  The demo still runs through the normal renderer, so it
+needs a GL context like timeDemo does.
+
+===========================================================================================
+*/
+
+static const char *frontEndPhaseNames[FE_NUM_PHASES] = {
+	"renderView",
+	"portalFlow",
+	"occlusion",
+	"lightSurfaces",
+	"dynamicModels",
+	"interactions",
+	"shadows",
+	"sort"
+};
+
+static idList<float>	frontEndSamples[FE_NUM_PHASES];		// msec of each recorded frame
+
+typedef struct {
+	float	mean;
+	float	min;
+	float	max;
+	float	p50;
+	float	p90;
+	float	p95;
+	float	p99;
+} frontEndPhaseStats_t;
+
+/*
+================
+R_BeginFrontEndPhase
+
+Returns the start time for R_EndFrontEndPhase, or 0 if the benchmark isn't recording
+================
+*/
+double R_BeginFrontEndPhase( void ) {
+	if ( !tr.frontEndBenchmark ) {
+		return 0.0;
+	}
+	return Sys_GetClockTicks();
+}
+
+/*
+================
+R_EndFrontEndPhase
+================
+*/
+void R_EndFrontEndPhase( frontEndPhase_t phase, double start ) {
+	if ( !tr.frontEndBenchmark ) {
+		return;
+	}
+	tr.pc.frontEndPhaseMsec[phase] += ( Sys_GetClockTicks() - start ) * 1000.0 / Sys_ClockTicksPerSecond();
+}
+
+/*
+================
+R_RecordFrontEndBenchmarkFrame
+
+Called by EndFrame before the performance counters are cleared
+================
+*/
+void R_RecordFrontEndBenchmarkFrame( void ) {
+	if ( !tr.frontEndBenchmark || !tr.pc.c_numViews ) {
+		return;
+	}
+	for ( int i = 0 ; i < FE_NUM_PHASES ; i++ ) {
+		frontEndSamples[i].Append( tr.pc.frontEndPhaseMsec[i] );
+	}
+}
+
+/*
+================
+R_FrontEndPercentile
+
+Nearest rank percentile of sorted samples
+================
+*/
+static float R_FrontEndPercentile( const idList<float> &sorted, float percent ) {
+	int rank = idMath::Ftoi( idMath::Ceil( percent * 0.01f * sorted.Num() ) ) - 1;
+	rank = Max( 0, Min( sorted.Num() - 1, rank ) );
+	return sorted[rank];
+}
+
+/*
+================
+R_SortFloat
+================
+*/
+static int R_SortFloat( const float *a, const float *b ) {
+	return ( *a < *b ) ? -1 : ( ( *a > *b ) ? 1 : 0 );
+}
+
+/*
+================
+R_FrontEndPhaseStats
+================
+*/
+static void R_FrontEndPhaseStats( const idList<float> &samples, frontEndPhaseStats_t &stats ) {
+	memset( &stats, 0, sizeof( stats ) );
+	if ( !samples.Num() ) {
+		return;
+	}
+
+	idList<float> sorted = samples;
+	sorted.Sort( R_SortFloat );
+
+	float sum = 0.0f;
+	for ( int i = 0 ; i < sorted.Num() ; i++ ) {
+		sum += sorted[i];
+	}
+	stats.mean = sum / sorted.Num();
+	stats.min = sorted[0];
+	stats.max = sorted[sorted.Num() - 1];
+	stats.p50 = R_FrontEndPercentile( sorted, 50.0f );
+	stats.p90 = R_FrontEndPercentile( sorted, 90.0f );
+	stats.p95 = R_FrontEndPercentile( sorted, 95.0f );
+	stats.p99 = R_FrontEndPercentile( sorted, 99.0f );
+}
+
+/*
+================
+idRenderSystemLocal::BeginFrontEndBenchmark
+================
+*/
+void idRenderSystemLocal::BeginFrontEndBenchmark( void ) {
+	for ( int i = 0 ; i < FE_NUM_PHASES ; i++ ) {
+		frontEndSamples[i].Clear();
+		frontEndSamples[i].SetGranularity( 1024 );
+	}
+	memset( pc.frontEndPhaseMsec, 0, sizeof( pc.frontEndPhaseMsec ) );
+	frontEndBenchmark = true;
+}
+
+/*
+================
+idRenderSystemLocal::EndFrontEndBenchmark
+
+Prints the results and writes them to benchmarks/<demo>_frontend.json
+================
+*/
+void idRenderSystemLocal::EndFrontEndBenchmark( const char *demoName ) {
+	if ( !frontEndBenchmark ) {
+		return;
+	}
+	frontEndBenchmark = false;
+
+	const int numFrames = frontEndSamples[0].Num();
+
+	idStr fileName = demoName;
+	fileName.StripPath();
+	fileName.StripFileExtension();
+	fileName = va( "benchmarks/%s_frontend.json", fileName.c_str() );
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( f ) {
+		f->Printf( "{\n" );
+		f->Printf( "\t\"demo\": \"%s\",\n", demoName );
+		f->Printf( "\t\"frames\": %i,\n", numFrames );
+		f->Printf( "\t\"unit\": \"msec\",\n" );
+		f->Printf( "\t\"phases\": {\n" );
+	}
+
+	common->Printf( "front end benchmark of %s, %i frames, msec\n", demoName, numFrames );
+	common->Printf( "%-14s %8s %8s %8s %8s %8s %8s\n", "phase", "mean", "p50", "p90", "p95", "p99", "max" );
+
+	for ( int i = 0 ; i < FE_NUM_PHASES ; i++ ) {
+		frontEndPhaseStats_t stats;
+		R_FrontEndPhaseStats( frontEndSamples[i], stats );
+
+		common->Printf( "%-14s %8.3f %8.3f %8.3f %8.3f %8.3f %8.3f\n", frontEndPhaseNames[i],
+			stats.mean, stats.p50, stats.p90, stats.p95, stats.p99, stats.max );
+
+		if ( f ) {
+			f->Printf( "\t\t\"%s\": { \"mean\": %.4f, \"min\": %.4f, \"max\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f }%s\n",
+				frontEndPhaseNames[i], stats.mean, stats.min, stats.max, stats.p50, stats.p90, stats.p95, stats.p99,
+				( i < FE_NUM_PHASES - 1 ) ? "," : "" );
+		}
+
+		frontEndSamples[i].Clear();
+	}
+
+	if ( f ) {
+		f->Printf( "\t}\n" );
+		f->Printf( "}\n" );
+		fileSystem->CloseFile( f );
+		common->Printf( "wrote %s\n", fileName.c_str() );
+	} else {
+		common->Warning( "couldn't write %s", fileName.c_str() );
+	}
+}
@@ -0,0 +1,328 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+===========================================================================================
+
+PERFORMANCE COUNTER HISTORY
+
+The front and back end counters are copied into a ring every frame before they are
+cleared, together with the game and render times and the heap stats.  perfHistoryDump
+writes the ring to a file and perfHistoryStream appends every frame to a file as it is
+recorded, so long runs can be graphed.  A .json file name selects JSON, anything else
+is written as CSV.
+
+===========================================================================================
+*/
+
+const int PERF_HISTORY_FRAMES	= 4096;		// must be a power of two
+
+typedef struct {
+	int						frame;
+	int						time;			// Sys_Milliseconds at the end of the frame
+	int						gameMsec;		// game logic time, the com_speeds gfr
+	int						heapBlocks;
+	int						heapBytes;
+	int						frameDataBytes;
+	performanceCounters_t	pc;
+	backEndCounters_t		bc;
+} perfFrame_t;
+
+typedef struct {
+	const char *			name;
+	int						offset;
+	bool					isFloat;
+} perfField_t;
+
+#define PERF_INT( x )		{ #x, (int)offsetof( perfFrame_t, x ), false }
+#define PERF_FLOAT( x )		{ #x, (int)offsetof( perfFrame_t, x ), true }
+
+static const perfField_t perfFields[] = {
+	PERF_INT( frame ),
+	PERF_INT( time ),
+	PERF_INT( gameMsec ),
+	PERF_INT( pc.frontEndMsec ),
+	PERF_INT( bc.msec ),
+	PERF_INT( heapBlocks ),
+	PERF_INT( heapBytes ),
+	PERF_INT( frameDataBytes ),
+	PERF_INT( pc.c_numViews ),
+	PERF_INT( pc.c_visibleViewEntities ),
+	PERF_INT( pc.c_shadowViewEntities ),
+	PERF_INT( pc.c_viewLights ),
+	PERF_INT( pc.c_sphere_cull_in ),
+	PERF_INT( pc.c_sphere_cull_clip ),
+	PERF_INT( pc.c_sphere_cull_out ),
+	PERF_INT( pc.c_box_cull_in ),
+	PERF_INT( pc.c_box_cull_out ),
+	PERF_INT( pc.c_createInteractions ),
+	PERF_INT( pc.c_createLightTris ),
+	PERF_INT( pc.c_createShadowVolumes ),
+	PERF_INT( pc.c_shadowCacheHits ),
+	PERF_INT( pc.c_shadowCacheMisses ),
+	PERF_INT( pc.c_generateMd5 ),
+	PERF_INT( pc.c_entityDefCallbacks ),
+	PERF_INT( pc.c_alloc ),
+	PERF_INT( pc.c_free ),
+	PERF_INT( pc.c_deformedSurfaces ),
+	PERF_INT( pc.c_deformedVerts ),
+	PERF_INT( pc.c_deformedIndexes ),
+	PERF_INT( pc.c_tangentIndexes ),
+	PERF_INT( pc.c_entityUpdates ),
+	PERF_INT( pc.c_lightUpdates ),
+	PERF_INT( pc.c_entityReferences ),
+	PERF_INT( pc.c_lightReferences ),
+	PERF_INT( pc.c_guiSurfs ),
+	PERF_INT( pc.c_occluderTris ),
+	PERF_INT( pc.c_occludedEntities ),
+	PERF_INT( pc.c_occludedLights ),
+	PERF_INT( bc.c_surfaces ),
+	PERF_INT( bc.c_shaders ),
+	PERF_INT( bc.c_vertexes ),
+	PERF_INT( bc.c_indexes ),
+	PERF_INT( bc.c_totalIndexes ),
+	PERF_INT( bc.c_drawElements ),
+	PERF_INT( bc.c_drawIndexes ),
+	PERF_INT( bc.c_drawVertexes ),
+	PERF_INT( bc.c_drawRefIndexes ),
+	PERF_INT( bc.c_drawRefVertexes ),
+	PERF_INT( bc.c_shadowElements ),
+	PERF_INT( bc.c_shadowIndexes ),
+	PERF_INT( bc.c_shadowVertexes ),
+	PERF_INT( bc.c_vboIndexes ),
+	PERF_FLOAT( bc.c_overDraw ),
+	PERF_INT( bc.c_uniformUploads ),
+	PERF_INT( bc.c_uniformVectors ),
+	PERF_INT( bc.c_uniformVectorsSkipped )
+};
+
+static const int		numPerfFields = sizeof( perfFields ) / sizeof( perfFields[0] );
+
+static perfFrame_t		perfHistory[PERF_HISTORY_FRAMES];
+static int				perfHistoryCount;		// frames recorded since startup
+
+static idFile *			perfStreamFile;
+static bool				perfStreamJSON;
+static int				perfStreamRows;
+
+/*
+================
+R_PerfFileIsJSON
+================
+*/
+static bool R_PerfFileIsJSON( const idStr &fileName ) {
+	idStr ext;
+	fileName.ExtractFileExtension( ext );
+	return ( ext.Icmp( "json" ) == 0 );
+}
+
+/*
+================
+R_WritePerfHeader
+================
+*/
+static void R_WritePerfHeader( idFile *f, bool json ) {
+	if ( json ) {
+		f->Printf( "{\"frames\":[\n" );
+		return;
+	}
+	for ( int i = 0 ; i < numPerfFields ; i++ ) {
+		f->Printf( "%s%s", perfFields[i].name, ( i < numPerfFields - 1 ) ? "," : "\n" );
+	}
+}
+
+/*
+================
+R_WritePerfRow
+================
+*/
+static void R_WritePerfRow( idFile *f, bool json, const perfFrame_t *frame, bool first ) {
+	const byte *base = (const byte *)frame;
+
+	if ( json ) {
+		f->Printf( "%s{", first ? "" : ",\n" );
+	}
+	for ( int i = 0 ; i < numPerfFields ; i++ ) {
+		const perfField_t &field = perfFields[i];
+		const char *separator = ( i < numPerfFields - 1 ) ? "," : "";
+		if ( json ) {
+			f->Printf( "\"%s\":", field.name );
+		}
+		if ( field.isFloat ) {
+			f->Printf( "%.3f%s", *(const float *)( base + field.offset ), separator );
+		} else {
+			f->Printf( "%i%s", *(const int *)( base + field.offset ), separator );
+		}
+	}
+	f->Printf( json ? "}" : "\n" );
+}
+
+/*
+================
+R_WritePerfFooter
+================
+*/
+static void R_WritePerfFooter( idFile *f, bool json ) {
+	if ( json ) {
+		f->Printf( "\n]}\n" );
+	}
+}
+
+/*
+================
+R_RecordPerfHistory
+
+Called by R_PerformanceCounters before the counters are cleared
+================
+*/
+void R_RecordPerfHistory( void ) {
+	perfFrame_t *frame = &perfHistory[perfHistoryCount & ( PERF_HISTORY_FRAMES - 1 )];
+	memoryStats_t heap;
+
+	Mem_GetStats( heap );
+
+	frame->frame = tr.frameCount;
+	frame->time = Sys_Milliseconds();
+	frame->gameMsec = time_gameFrame;
+	frame->heapBlocks = heap.num;
+	frame->heapBytes = heap.totalSize;
+	frame->frameDataBytes = R_CountFrameData();
+	frame->pc = tr.pc;
+	frame->bc = backEnd.pc;
+	perfHistoryCount++;
+
+	if ( perfStreamFile ) {
+		R_WritePerfRow( perfStreamFile, perfStreamJSON, frame, perfStreamRows == 0 );
+		perfStreamRows++;
+		// keep most of a soak run if the game dies before the stream is closed
+		if ( ( perfStreamRows & 63 ) == 0 ) {
+			perfStreamFile->Flush();
+		}
+	}
+}
+
+/*
+================
+R_ClosePerfStream
+================
+*/
+static void R_ClosePerfStream( void ) {
+	if ( !perfStreamFile ) {
+		return;
+	}
+	R_WritePerfFooter( perfStreamFile, perfStreamJSON );
+	common->Printf( "wrote %i frames to %s\n", perfStreamRows, perfStreamFile->GetName() );
+	fileSystem->CloseFile( perfStreamFile );
+	perfStreamFile = NULL;
+	perfStreamRows = 0;
+}
+
+/*
+================
+R_ShutdownPerfHistory
+================
+*/
+void R_ShutdownPerfHistory( void ) {
+	R_ClosePerfStream();
+}
+
+/*
+================
+R_PerfHistoryDump_f
+
+perfHistoryDump [file] [frames]
+================
+*/
+void R_PerfHistoryDump_f( const idCmdArgs &args ) {
+	idStr fileName;
+	if ( args.Argc() > 1 ) {
+		fileName = args.Argv( 1 );
+		fileName.DefaultFileExtension( ".csv" );
+	} else {
+		fileName = va( "perf/history%i.csv", tr.frameCount );
+	}
+
+	int numFrames = Min( perfHistoryCount, PERF_HISTORY_FRAMES );
+	if ( args.Argc() > 2 ) {
+		numFrames = Max( 0, Min( numFrames, atoi( args.Argv( 2 ) ) ) );
+	}
+	if ( !numFrames ) {
+		common->Printf( "no frames recorded\n" );
+		return;
+	}
+
+	idFile *f = fileSystem->OpenFileWrite( fileName );
+	if ( !f ) {
+		common->Warning( "couldn't write %s", fileName.c_str() );
+		return;
+	}
+
+	const bool json = R_PerfFileIsJSON( fileName );
+	R_WritePerfHeader( f, json );
+	for ( int i = perfHistoryCount - numFrames ; i < perfHistoryCount ; i++ ) {
+		R_WritePerfRow( f, json, &perfHistory[i & ( PERF_HISTORY_FRAMES - 1 )], i == perfHistoryCount - numFrames );
+	}
+	R_WritePerfFooter( f, json );
+	fileSystem->CloseFile( f );
+
+	common->Printf( "wrote %i frames to %s\n", numFrames, fileName.c_str() );
+}
+
+/*
+================
+R_PerfHistoryStream_f
+
+perfHistoryStream [file], without a file the current stream is closed
+================
+*/
+void R_PerfHistoryStream_f( const idCmdArgs &args ) {
+	R_ClosePerfStream();
+
+	if ( args.Argc() < 2 ) {
+		return;
+	}
+
+	idStr fileName = args.Argv( 1 );
+	fileName.DefaultFileExtension( ".csv" );
+
+	perfStreamFile = fileSystem->OpenFileWrite( fileName );
+	if ( !perfStreamFile ) {
+		common->Warning( "couldn't write %s", fileName.c_str() );
+		return;
+	}
+	perfStreamJSON = R_PerfFileIsJSON( fileName );
+	perfStreamRows = 0;
+	R_WritePerfHeader( perfStreamFile, perfStreamJSON );
+
+	common->Printf( "streaming performance counters to %s\n", fileName.c_str() );
+}
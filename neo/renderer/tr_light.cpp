@@ -42,6 +42,38 @@ VERTEX CACHE GENERATORS
 ===========================================================================================
 */
 
+/*
+==================
+R_CreateSkinnedAmbientCache
+
+GPU skinned surfaces reference the bind pose vertexes of their deformInfo,
+so only the joint palette has to be uploaded each frame
+==================
+*/
+static bool R_CreateSkinnedAmbientCache( srfTriangles_t *tri ) {
+	deformInfo_t *deform = const_cast<deformInfo_t *>( tri->skinnedDeformInfo );
+
+	if ( !deform->skinnedCache ) {
+		int size = deform->numOutputVerts * ( sizeof( deform->skinnedVerts[0] ) + sizeof( deform->skinnedWeights[0] ) );
+		vertexCache.Alloc( deform->skinnedVerts, size, &deform->skinnedCache );
+		if ( !deform->skinnedCache ) {
+			return false;
+		}
+	}
+	tri->ambientCache = deform->skinnedCache;
+
+	if ( !tri->jointCache || tri->jointCacheFrame != tr.frameCount ) {
+		// a bound range smaller than the matrices_ubo block is undefined, so the palette is padded to all of it
+		tri->jointCache = vertexCache.AllocFrameTemp( tri->skinnedJoints, MAX_SKINNING_JOINTS * sizeof( tri->skinnedJoints[0] ),
+														glConfig.uniformBufferOffsetAlignment );
+		if ( !tri->jointCache ) {
+			return false;
+		}
+		tri->jointCacheFrame = tr.frameCount;
+	}
+	return true;
+}
+
 /*
 ==================
 R_CreateAmbientCache
@@ -50,6 +82,9 @@ Create it if needed
 ==================
 */
 bool R_CreateAmbientCache( srfTriangles_t *tri, bool needsLighting ) {
+	if ( tri->skinnedDeformInfo ) {
+		return R_CreateSkinnedAmbientCache( tri );
+	}
 	if ( tri->ambientCache ) {
 		return true;
 	}
@@ -338,11 +373,9 @@ void idRenderWorldLocal::CreateLightDefInteractions( idRenderLightLocal *ldef )
 
 			// if any of the edef's interaction match this light, we don't
 			// need to consider it. 
-			if ( r_useInteractionTable.GetBool() && this->interactionTable ) {
-				// allocating these tables may take several megs on big maps, but it saves 3% to 5% of
-				// the CPU time.  The table is updated at interaction::AllocAndLink() and interaction::UnlinkAndFree()
-				int index = ldef->index * this->interactionTableWidth + edef->index;
-				inter = this->interactionTable[ index ];
+			if ( r_useInteractionTable.GetBool() ) {
+				// the table is updated at interaction::AllocAndLink() and interaction::UnlinkAndFree()
+				inter = this->interactionTable.Find( ldef->index, edef->index );
 				if ( inter ) {
 					// if this entity wasn't in view already, the scissor rect will be empty,
 					// so it will only be used for shadow casting
@@ -407,6 +440,55 @@ void idRenderWorldLocal::CreateLightDefInteractions( idRenderLightLocal *ldef )
 
 //===============================================================================================================
 
+/*
+=================
+R_SnapshotTriSurf
+
+With the render thread drawing the previous frame, the front end may replace
+the vertex cache pointers of a dynamic model's surface before the back end
+gets to it, so the drawSurf references a frame memory copy of the header.
+
+GPU skinned surfaces always get a copy that carries the skinning state of
+the ambient surface, so the back end never reads the light tris' ambient
+surface, which the next frame's UpdateSurface and R_CreateSkinnedAmbientCache
+rewrite.  Fog and blend lights draw the CPU positions with the fixed function
+fallback, and those are skinned in place by the next frame, so they are
+copied to frame memory as well.
+=================
+*/
+static const srfTriangles_t *R_SnapshotTriSurf( const srfTriangles_t *tri, const idRenderLightLocal *light ) {
+	if ( !tri ) {
+		return tri;
+	}
+
+	const srfTriangles_t *ambientTri = ( tri->ambientSurface != NULL ) ? tri->ambientSurface : tri;
+	if ( !tr.smpActive && ambientTri->skinnedDeformInfo == NULL ) {
+		return tri;
+	}
+
+	srfTriangles_t *copy = (srfTriangles_t *)R_FrameAlloc( sizeof( *copy ) );
+	memcpy( copy, tri, sizeof( *copy ) );
+
+	if ( ambientTri->skinnedDeformInfo != NULL ) {
+		copy->skinnedDeformInfo = ambientTri->skinnedDeformInfo;
+		copy->numSkinnedJoints = ambientTri->numSkinnedJoints;
+		copy->jointCache = ambientTri->jointCache;
+		copy->skinnedVertsValid = ambientTri->skinnedVertsValid;
+
+		if ( tr.smpActive ) {
+			const idMaterial *lightShader = ( light != NULL ) ? light->lightShader : NULL;
+			if ( copy->skinnedVertsValid && lightShader != NULL && ( lightShader->IsFogLight() || lightShader->IsBlendLight() ) ) {
+				idDrawVert *verts = (idDrawVert *)R_FrameAlloc( tri->numVerts * sizeof( verts[0] ) );
+				SIMDProcessor->Memcpy( verts, tri->verts, tri->numVerts * sizeof( verts[0] ) );
+				copy->verts = verts;
+			} else {
+				copy->skinnedVertsValid = false;
+			}
+		}
+	}
+	return copy;
+}
+
 /*
 =================
 R_LinkLightSurf
@@ -422,7 +504,7 @@ void R_LinkLightSurf( const drawSurf_t **link, const srfTriangles_t *tri, const
 
 	drawSurf = (drawSurf_t *)R_FrameAlloc( sizeof( *drawSurf ) );
 
-	drawSurf->geo = tri;
+	drawSurf->geo = R_SnapshotTriSurf( tri, light );
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
@@ -538,7 +620,7 @@ stencil clears and interaction drawing
 */
 int	c_clippedLight, c_unclippedLight;
 
-idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
+idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight, frontEndJobCounters_t *counters ) {
 	idScreenRect	r;
 	srfTriangles_t *tri;
 	idPlane			eye, clip;
@@ -564,7 +646,7 @@ idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 
 		// if it is near clipped, clip the winding polygons to the view frustum
 		if ( clip[3] <= 1 ) {
-			c_clippedLight++;
+			counters->c_clippedLight++;
 			if ( r_useClippedLightScissors.GetInteger() ) {
 				return R_ClippedLightScissorRectangle( vLight );
 			} else {
@@ -597,11 +679,196 @@ idScreenRect	R_CalcLightScissorRectangle( viewLight_t *vLight ) {
 	// add the fudge boundary
 	r.Expand();
 
-	c_unclippedLight++;
+	counters->c_unclippedLight++;
 
 	return r;
 }
 
+/*
+=================
+R_RunFrontEndJobs
+
+Runs the job function for each element of the array, either on the
+job workers or inline if r_useParallelAddSurfaces is 0.
+
+The elements are split into a few batches for each thread, so the job
+overhead is paid per batch, and a thread that gets the expensive elements
+doesn't hold up the others for long.
+=================
+*/
+typedef struct {
+	jobRun_t			function;
+	byte *				elements;
+	int					elementSize;
+	int					numElements;
+} frontEndJobBatch_t;
+
+static const int FRONT_END_BATCHES_PER_THREAD = 4;
+
+static void R_FrontEndJobBatch( void *data ) {
+	frontEndJobBatch_t *batch = (frontEndJobBatch_t *)data;
+
+	for ( int i = 0 ; i < batch->numElements ; i++ ) {
+		batch->function( batch->elements + i * batch->elementSize );
+	}
+}
+
+static void R_RunFrontEndJobs( jobRun_t function, void *elements, int elementSize, int numElements ) {
+	const int numThreads = parallelJobManager->GetNumWorkers() + 1;
+
+	if ( !r_useParallelAddSurfaces.GetBool() || numThreads == 1 || numElements <= 1 ) {
+		for ( int i = 0 ; i < numElements ; i++ ) {
+			function( (byte *)elements + i * elementSize );
+		}
+		return;
+	}
+
+	const int numBatches = Min( numElements, numThreads * FRONT_END_BATCHES_PER_THREAD );
+	frontEndJobBatch_t *batches = (frontEndJobBatch_t *)R_FrameAlloc( numBatches * sizeof( batches[0] ) );
+
+	tr.frontEndJobsActive = true;
+	for ( int i = 0 ; i < numBatches ; i++ ) {
+		const int first = i * numElements / numBatches;
+		const int last = ( i + 1 ) * numElements / numBatches;
+		batches[i].function = function;
+		batches[i].elements = (byte *)elements + first * elementSize;
+		batches[i].elementSize = elementSize;
+		batches[i].numElements = last - first;
+		tr.frontEndJobs->AddJob( R_FrontEndJobBatch, &batches[i] );
+	}
+	tr.frontEndJobs->Submit();
+	tr.frontEndJobs->Wait();
+	tr.frontEndJobsActive = false;
+}
+
+/*
+=================
+R_SumFrontEndJobCounters
+
+The jobs count into their own setup, this adds them up on the main thread
+=================
+*/
+static void R_SumFrontEndJobCounters( const frontEndJobCounters_t *counters ) {
+	tr.pc.c_box_cull_in += counters->c_box_cull_in;
+	tr.pc.c_box_cull_out += counters->c_box_cull_out;
+	c_clippedLight += counters->c_clippedLight;
+	c_unclippedLight += counters->c_unclippedLight;
+	tr.pc.c_tangentIndexes += counters->c_tangentIndexes;
+}
+
+typedef struct {
+	viewLight_t *		vLight;
+	bool				setupDone;			// false if it has to run on the main thread
+	bool				removeFromView;
+	frontEndJobCounters_t	counters;
+} lightSetup_t;
+
+/*
+=================
+R_SetupViewLight
+
+The part of R_AddLightSurfaces that only writes to the viewLight and frame
+memory, so it can run as a job for each light.
+
+Evaluates the light shader registers and the scissor rect, and decides if
+the light can be removed from the view because it is suppressed or turned off.
+=================
+*/
+static void R_SetupViewLight( lightSetup_t *setup ) {
+	viewLight_t *vLight = setup->vLight;
+	idRenderLightLocal *light = vLight->lightDef;
+	const idMaterial *lightShader = light->lightShader;
+
+	setup->setupDone = true;
+	setup->removeFromView = false;
+
+	// see if we are suppressing the light in this view
+	if ( !r_skipSuppress.GetBool() ) {
+		if ( light->parms.suppressLightInViewID
+		&& light->parms.suppressLightInViewID == tr.viewDef->renderView.viewID ) {
+			setup->removeFromView = true;
+			return;
+		}
+		if ( light->parms.allowLightInViewID 
+		&& light->parms.allowLightInViewID != tr.viewDef->renderView.viewID ) {
+			setup->removeFromView = true;
+			return;
+		}
+	}
+
+	// evaluate the light shader registers
+	float *lightRegs =(float *)R_FrameAlloc( lightShader->GetNumRegisters() * sizeof( float ) );
+	vLight->shaderRegisters = lightRegs;
+	lightShader->EvaluateRegisters( lightRegs, light->parms.shaderParms, tr.viewDef, light->parms.referenceSound );
+
+	// if this is a purely additive light and no stage in the light shader evaluates
+	// to a positive light value, we can completely skip the light
+	if ( !lightShader->IsFogLight() && !lightShader->IsBlendLight() ) {
+		int lightStageNum;
+		for ( lightStageNum = 0 ; lightStageNum < lightShader->GetNumStages() ; lightStageNum++ ) {
+			const shaderStage_t	*lightStage = lightShader->GetStage( lightStageNum );
+
+			// ignore stages that fail the condition
+			if ( !lightRegs[ lightStage->conditionRegister ] ) {
+				continue;
+			}
+
+			const int *registers = lightStage->color.registers;
+
+			// snap tiny values to zero to avoid lights showing up with the wrong color
+			if ( lightRegs[ registers[0] ] < 0.001f ) {
+				lightRegs[ registers[0] ] = 0.0f;
+			}
+			if ( lightRegs[ registers[1] ] < 0.001f ) {
+				lightRegs[ registers[1] ] = 0.0f;
+			}
+			if ( lightRegs[ registers[2] ] < 0.001f ) {
+				lightRegs[ registers[2] ] = 0.0f;
+			}
+
+			if ( lightRegs[ registers[0] ] > 0.0f ||
+					lightRegs[ registers[1] ] > 0.0f ||
+						lightRegs[ registers[2] ] > 0.0f ) {
+				break;
+			}
+		}
+		if ( lightStageNum == lightShader->GetNumStages() ) {
+			// we went through all the stages and didn't find one that adds anything
+			// remove the light from the viewLights list, and change its frame marker
+			// so interaction generation doesn't think the light is visible and
+			// create a shadow for it
+			setup->removeFromView = true;
+			return;
+		}
+	}
+
+	if ( r_useLightScissors.GetBool() ) {
+		// calculate the screen area covered by the light frustum
+		// which will be used to crop the stencil cull
+		idScreenRect scissorRect = R_CalcLightScissorRectangle( vLight, &setup->counters );
+		// intersect with the portal crossing scissor rectangle
+		vLight->scissorRect.Intersect( scissorRect );
+	}
+}
+
+/*
+=================
+R_SetupViewLightJob
+=================
+*/
+static void R_SetupViewLightJob( void *data ) {
+	lightSetup_t *setup = (lightSetup_t *)data;
+	const idRenderLightLocal *light = setup->vLight->lightDef;
+
+	PROFILE_SCOPE( "R_SetupViewLightJob" );
+
+	// the sound amplitude can only be queried from the main thread
+	if ( light->lightShader->ReferencesSound() && light->parms.referenceSound ) {
+		return;
+	}
+	R_SetupViewLight( setup );
+}
+
 /*
 =================
 R_AddLightSurfaces
@@ -618,97 +885,67 @@ turned off, or completely off screen.
 
 Create any new interactions needed between the viewLights
 and the viewEntitys due to game movement
+
+The shader registers and scissor rects of all lights are calculated by
+jobs first, everything that touches the world, the vertex cache or static
+memory is done afterwards in viewLights order.  The prelight shadows and
+the interaction creation stay serial: they allocate from the vertex cache
+and the unlocked static block allocators of tr_trisurf.cpp, build shadow
+volumes in the static buffers of tr_stencilshadow.cpp, and insert into the
+interaction tables and the shadow volume cache.
 =================
 */
 void R_AddLightSurfaces( void ) {
 	viewLight_t		*vLight;
 	idRenderLightLocal *light;
 	viewLight_t		**ptr;
+	int				numLights;
 
-	// go through each visible light, possibly removing some from the list
-	ptr = &tr.viewDef->viewLights;
-	while ( *ptr ) {
-		vLight = *ptr;
-		light = vLight->lightDef;
+	PROFILE_SCOPE( "R_AddLightSurfaces" );
 
-		const idMaterial	*lightShader = light->lightShader;
-		if ( !lightShader ) {
+	numLights = 0;
+	for ( vLight = tr.viewDef->viewLights ; vLight ; vLight = vLight->next ) {
+		if ( !vLight->lightDef->lightShader ) {
 			common->Error( "R_AddLightSurfaces: NULL lightShader" );
 		}
+		numLights++;
+	}
+	if ( !numLights ) {
+		return;
+	}
 
-		// see if we are suppressing the light in this view
-		if ( !r_skipSuppress.GetBool() ) {
-			if ( light->parms.suppressLightInViewID
-			&& light->parms.suppressLightInViewID == tr.viewDef->renderView.viewID ) {
-				*ptr = vLight->next;
-				light->viewCount = -1;
-				continue;
-			}
-			if ( light->parms.allowLightInViewID 
-			&& light->parms.allowLightInViewID != tr.viewDef->renderView.viewID ) {
-				*ptr = vLight->next;
-				light->viewCount = -1;
-				continue;
-			}
-		}
-
-		// evaluate the light shader registers
-		float *lightRegs =(float *)R_FrameAlloc( lightShader->GetNumRegisters() * sizeof( float ) );
-		vLight->shaderRegisters = lightRegs;
-		lightShader->EvaluateRegisters( lightRegs, light->parms.shaderParms, tr.viewDef, light->parms.referenceSound );
+	lightSetup_t *setups = (lightSetup_t *)R_ClearedFrameAlloc( numLights * sizeof( setups[0] ) );
+	int i = 0;
+	for ( vLight = tr.viewDef->viewLights ; vLight ; vLight = vLight->next, i++ ) {
+		setups[i].vLight = vLight;
+	}
 
-		// if this is a purely additive light and no stage in the light shader evaluates
-		// to a positive light value, we can completely skip the light
-		if ( !lightShader->IsFogLight() && !lightShader->IsBlendLight() ) {
-			int lightStageNum;
-			for ( lightStageNum = 0 ; lightStageNum < lightShader->GetNumStages() ; lightStageNum++ ) {
-				const shaderStage_t	*lightStage = lightShader->GetStage( lightStageNum );
+	R_RunFrontEndJobs( R_SetupViewLightJob, setups, sizeof( setups[0] ), numLights );
 
-				// ignore stages that fail the condition
-				if ( !lightRegs[ lightStage->conditionRegister ] ) {
-					continue;
-				}
+	// go through each visible light, possibly removing some from the list
+	ptr = &tr.viewDef->viewLights;
+	for ( i = 0 ; i < numLights ; i++ ) {
+		lightSetup_t *setup = &setups[i];
+		vLight = setup->vLight;
+		light = vLight->lightDef;
 
-				const int *registers = lightStage->color.registers;
+		assert( *ptr == vLight );
 
-				// snap tiny values to zero to avoid lights showing up with the wrong color
-				if ( lightRegs[ registers[0] ] < 0.001f ) {
-					lightRegs[ registers[0] ] = 0.0f;
-				}
-				if ( lightRegs[ registers[1] ] < 0.001f ) {
-					lightRegs[ registers[1] ] = 0.0f;
-				}
-				if ( lightRegs[ registers[2] ] < 0.001f ) {
-					lightRegs[ registers[2] ] = 0.0f;
-				}
+		if ( !setup->setupDone ) {
+			R_SetupViewLight( setup );
+		}
+		R_SumFrontEndJobCounters( &setup->counters );
 
-				if ( lightRegs[ registers[0] ] > 0.0f ||
-						lightRegs[ registers[1] ] > 0.0f ||
-							lightRegs[ registers[2] ] > 0.0f ) {
-					break;
-				}
-			}
-			if ( lightStageNum == lightShader->GetNumStages() ) {
-				// we went through all the stages and didn't find one that adds anything
-				// remove the light from the viewLights list, and change its frame marker
-				// so interaction generation doesn't think the light is visible and
-				// create a shadow for it
-				*ptr = vLight->next;
-				light->viewCount = -1;
-				continue;
-			}
+		if ( setup->removeFromView ) {
+			*ptr = vLight->next;
+			light->viewCount = -1;
+			continue;
 		}
 
-		if ( r_useLightScissors.GetBool() ) {
-			// calculate the screen area covered by the light frustum
-			// which will be used to crop the stencil cull
-			idScreenRect scissorRect = R_CalcLightScissorRectangle( vLight );
-			// intersect with the portal crossing scissor rectangle
-			vLight->scissorRect.Intersect( scissorRect );
+		const idMaterial	*lightShader = light->lightShader;
 
-			if ( r_showLightScissors.GetBool() ) {
-				R_ShowColoredScreenRect( vLight->scissorRect, light->index );
-			}
+		if ( r_useLightScissors.GetBool() && r_showLightScissors.GetBool() ) {
+			R_ShowColoredScreenRect( vLight->scissorRect, light->index );
 		}
 
 #if 0
@@ -726,8 +963,8 @@ void R_AddLightSurfaces( void ) {
 		// if we are doing a soft-shadow novelty test, regenerate the light with
 		// a random offset every time
 		if ( r_lightSourceRadius.GetFloat() != 0.0f ) {
-			for ( int i = 0 ; i < 3 ; i++ ) {
-				light->globalLightOrigin[i] += r_lightSourceRadius.GetFloat() * ( -1 + 2 * (rand()&0xfff)/(float)0xfff );
+			for ( int j = 0 ; j < 3 ; j++ ) {
+				light->globalLightOrigin[j] += r_lightSourceRadius.GetFloat() * ( -1 + 2 * (rand()&0xfff)/(float)0xfff );
 			}
 		}
 
@@ -835,24 +1072,14 @@ bool R_IssueEntityDefCallback( idRenderEntityLocal *def ) {
 
 /*
 ===================
-R_EntityDefDynamicModel
+R_InstantiateEntityDefDynamicModel
 
-Issues a deferred entity callback if necessary.
-If the model isn't dynamic, it returns the original.
-Returns the cached dynamic model if present, otherwise creates
-it and any necessary overlays
+Creates the snapshot of a dynamic model if the entity doesn't have one for
+this frame.  Returns true if a new snapshot was made, which still needs
+R_FinishEntityDefDynamicModel after any skinning deferred by tr.deferSkinning
 ===================
 */
-idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
-	bool callbackUpdate;
-
-	// allow deferred entities to construct themselves
-	if ( def->parms.callback ) {
-		callbackUpdate = R_IssueEntityDefCallback( def );
-	} else {
-		callbackUpdate = false;
-	}
-
+static bool R_InstantiateEntityDefDynamicModel( idRenderEntityLocal *def, bool callbackUpdate ) {
 	idRenderModel *model = def->parms.hModel;
 
 	if ( !model ) {
@@ -862,7 +1089,7 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	if ( model->IsDynamicModel() == DM_STATIC ) {
 		def->dynamicModel = NULL;
 		def->dynamicModelFrameCount = 0;
-		return model;
+		return false;
 	}
 
 	// continously animating models (particle systems, etc) will have their snapshot updated every single view
@@ -870,46 +1097,89 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 		R_ClearEntityDefDynamicModel( def );
 	}
 
-	// if we don't have a snapshot of the dynamic model, generate it now
-	if ( !def->dynamicModel ) {
+	if ( def->dynamicModel ) {
+		return false;
+	}
+
+	// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
+	def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
+	def->dynamicModel = def->cachedDynamicModel;
+	def->dynamicModelFrameCount = tr.frameCount;
+
+	return true;
+}
 
-		// instantiate the snapshot of the dynamic model, possibly reusing memory from the cached snapshot
-		def->cachedDynamicModel = model->InstantiateDynamicModel( &def->parms, tr.viewDef, def->cachedDynamicModel );
+/*
+===================
+R_FinishEntityDefDynamicModel
 
-		if ( def->cachedDynamicModel ) {
+Adds the overlays to a new snapshot and sets the model depth hack
+===================
+*/
+static void R_FinishEntityDefDynamicModel( idRenderEntityLocal *def, bool newSnapshot ) {
+	if ( !def->dynamicModel ) {
+		return;
+	}
 
-			// add any overlays to the snapshot of the dynamic model
-			if ( def->overlay && !r_skipOverlays.GetBool() ) {
-				def->overlay->AddOverlaySurfacesToModel( def->cachedDynamicModel );
-			} else {
-				idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->cachedDynamicModel );
-			}
+	if ( newSnapshot ) {
+		// add any overlays to the snapshot of the dynamic model
+		if ( def->overlay && !r_skipOverlays.GetBool() ) {
+			// the overlay vertexes are copied from the deformed surfaces
+			R_SkinModelVerts( def->dynamicModel );
+			def->overlay->AddOverlaySurfacesToModel( def->dynamicModel );
+		} else {
+			idRenderModelOverlay::RemoveOverlaySurfacesFromModel( def->dynamicModel );
+		}
 
-			if ( r_checkBounds.GetBool() ) {
-				idBounds b = def->cachedDynamicModel->Bounds();
-				if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
-						b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
-						b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
-						b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
-						b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
-						b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
-					common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
-				}
+		if ( r_checkBounds.GetBool() ) {
+			idBounds b = def->dynamicModel->Bounds();
+			if (	b[0][0] < def->referenceBounds[0][0] - CHECK_BOUNDS_EPSILON ||
+					b[0][1] < def->referenceBounds[0][1] - CHECK_BOUNDS_EPSILON ||
+					b[0][2] < def->referenceBounds[0][2] - CHECK_BOUNDS_EPSILON ||
+					b[1][0] > def->referenceBounds[1][0] + CHECK_BOUNDS_EPSILON ||
+					b[1][1] > def->referenceBounds[1][1] + CHECK_BOUNDS_EPSILON ||
+					b[1][2] > def->referenceBounds[1][2] + CHECK_BOUNDS_EPSILON ) {
+				common->Printf( "entity %i dynamic model exceeded reference bounds\n", def->index );
 			}
 		}
-
-		def->dynamicModel = def->cachedDynamicModel;
-		def->dynamicModelFrameCount = tr.frameCount;
 	}
 
 	// set model depth hack value
-	if ( def->dynamicModel && model->DepthHack() != 0.0f && tr.viewDef ) {
+	idRenderModel *model = def->parms.hModel;
+	if ( model->DepthHack() != 0.0f && tr.viewDef ) {
 		idPlane eye, clip;
 		idVec3 ndc;
 		R_TransformModelToClip( def->parms.origin, tr.viewDef->worldSpace.modelViewMatrix, tr.viewDef->projectionMatrix, eye, clip );
 		R_TransformClipToDevice( clip, tr.viewDef, ndc );
 		def->parms.modelDepthHack = model->DepthHack() * ( 1.0f - ndc.z );
 	}
+}
+
+/*
+===================
+R_EntityDefDynamicModel
+
+Issues a deferred entity callback if necessary.
+If the model isn't dynamic, it returns the original.
+Returns the cached dynamic model if present, otherwise creates
+it and any necessary overlays
+===================
+*/
+idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
+	bool callbackUpdate;
+
+	// allow deferred entities to construct themselves
+	if ( def->parms.callback ) {
+		callbackUpdate = R_IssueEntityDefCallback( def );
+	} else {
+		callbackUpdate = false;
+	}
+
+	bool newSnapshot = R_InstantiateEntityDefDynamicModel( def, callbackUpdate );
+	if ( def->parms.hModel->IsDynamicModel() == DM_STATIC ) {
+		return def->parms.hModel;
+	}
+	R_FinishEntityDefDynamicModel( def, newSnapshot );
 
 	// FIXME: if any of the surfaces have deforms, create a frame-temporary model with references to the
 	// undeformed surfaces.  This would allow deforms to be light interacting.
@@ -917,30 +1187,79 @@ idRenderModel *R_EntityDefDynamicModel( idRenderEntityLocal *def ) {
 	return def->dynamicModel;
 }
 
+/*
+=================
+R_DrawSurfSortKey
+
+The material sort is stored in the upper 32 bits with its float bits flipped so
+that unsigned integer order matches float order.
+
+Surfaces with equal sort keys keep the order they were added in, because the
+radix sort in R_SortDrawSurfs is stable.  This is required for everything that
+blends and for gui surfaces, which layer coplanar images on top of each other.
+
+Opaque entity surfaces can be drawn in any order, so the lower 32 bits group
+them by glsl program, then material, then entity, and finally front to back to
+reduce program and texture changes in the back end:
+
+	bits 26-31	glsl program of the first program stage, 0 for the standard stages
+	bits 12-25	material decl index
+	bits  6-11	entity index
+	bits  0- 5	distance to the view origin in 128 unit steps
+=================
+*/
+static uint64 R_DrawSurfSortKey( const srfTriangles_t *tri, const viewEntity_t *space, const idMaterial *shader ) {
+	const float sort = shader->GetSort();
+	dword sortBits = *reinterpret_cast<const dword *>( &sort );
+	sortBits = ( sortBits & 0x80000000 ) ? ~sortBits : ( sortBits | 0x80000000 );
+
+	uint64 key = (uint64)sortBits << 32;
+
+	if ( sort != SS_OPAQUE || space->entityDef == NULL ) {
+		return key;
+	}
+
+	int program = 0;
+	for ( int i = 0; i < shader->GetNumStages(); i++ ) {
+		const newShaderStage_t *newStage = shader->GetStage( i )->newStage;
+		if ( newStage ) {
+			program = newStage->glslProgram + 1;
+			break;
+		}
+	}
+
+	idVec3 center;
+	R_LocalPointToGlobal( space->modelMatrix, tri->bounds.GetCenter(), center );
+	const int depth = idMath::FtoiFast( ( center - tr.viewDef->renderView.vieworg ).LengthFast() * ( 1.0f / 128.0f ) );
+
+	key |= (uint64)( program & 63 ) << 26;
+	key |= (uint64)( shader->Index() & 16383 ) << 12;
+	key |= (uint64)( space->entityDef->index & 63 ) << 6;
+	key |= (uint64)Min( depth, 63 );
+
+	return key;
+}
+
 /*
 =================
 R_AddDrawSurf
 =================
 */
 void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const renderEntity_t *renderEntity,
-					const idMaterial *shader, const idScreenRect &scissor ) {
+					const idMaterial *shader, const idScreenRect &scissor, const float *shaderRegisters ) {
 	drawSurf_t		*drawSurf;
 	const float		*shaderParms;
 	static float	refRegs[MAX_EXPRESSION_REGISTERS];	// don't put on stack, or VC++ will do a page touch
 	float			generatedShaderParms[MAX_ENTITY_SHADER_PARMS];
 
 	drawSurf = (drawSurf_t *)R_FrameAlloc( sizeof( *drawSurf ) );
-	drawSurf->geo = tri;
+	drawSurf->geo = R_SnapshotTriSurf( tri, NULL );
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
-	drawSurf->sort = shader->GetSort() + tr.sortOffset;
+	drawSurf->sort = R_DrawSurfSortKey( tri, space, shader );
 	drawSurf->dsFlags = 0;
 
-	// bumping this offset each time causes surfaces with equal sort orders to still
-	// deterministically draw in the order they are added
-	tr.sortOffset += 0.000001f;
-
 	// if it doesn't fit, resize the list
 	if ( tr.viewDef->numDrawSurfs == tr.viewDef->maxDrawSurfs ) {
 		drawSurf_t	**old = tr.viewDef->drawSurfs;
@@ -964,6 +1283,9 @@ void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const
 	if ( constRegs ) {
 		// shader only uses constant values
 		drawSurf->shaderRegisters = constRegs;
+	} else if ( shaderRegisters ) {
+		// already evaluated by a front end job
+		drawSurf->shaderRegisters = shaderRegisters;
 	} else {
 		float *regs = (float *)R_FrameAlloc( shader->GetNumRegisters() * sizeof( float ) );
 		drawSurf->shaderRegisters = regs;
@@ -1055,6 +1377,25 @@ void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const
 	// adds for this view
 }
 
+typedef struct {
+	const idMaterial *	shader;				// after skin remapping, NULL if not drawn
+	const float *		shaderRegisters;	// NULL if they have to be evaluated on the main thread
+	bool				culled;
+} ambientSurfSetup_t;
+
+typedef struct {
+	viewEntity_t *			vEntity;
+	bool					skip;			// xray mismatch or no model surfaces
+	bool					instantiate;	// the dynamic model is needed for the ambient surfaces
+	bool					callbackUpdate;
+	bool					newSnapshot;	// R_FinishEntityDefDynamicModel is needed after the skinning jobs
+	idRenderModel *			model;			// NULL if the ambient surfaces aren't added
+	float					floatTime;		// view time of the entity's time group
+	int						time;
+	ambientSurfSetup_t *	surfaces;		// NULL if the surfaces weren't set up by a job
+	frontEndJobCounters_t	counters;
+} entitySetup_t;
+
 /*
 ===============
 R_AddAmbientDrawsurfs
@@ -1062,14 +1403,19 @@ R_AddAmbientDrawsurfs
 Adds surfaces for the given viewEntity
 Walks through the viewEntitys list and creates drawSurf_t for each surface of
 each viewEntity that has a non-empty scissorRect
+
+If surfSetups is not NULL, the skin remapping, culling and shader registers
+have already been done by R_SetupAmbientSurfacesJob
 ===============
 */
-static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
+static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity, const ambientSurfSetup_t *surfSetups ) {
 	int					i, total;
 	idRenderEntityLocal	*def;
 	srfTriangles_t		*tri;
 	idRenderModel		*model;
 	const idMaterial	*shader;
+	const float			*shaderRegisters;
+	bool				culled;
 
 	def = vEntity->entityDef;
 
@@ -1096,10 +1442,20 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 		if ( !tri->numIndexes ) {
 			continue;
 		}
-		shader = surf->shader;
-		shader = R_RemapShaderBySkin( shader, def->parms.customSkin, def->parms.customShader );
 
-		R_GlobalShaderOverride( &shader );
+		if ( surfSetups ) {
+			shader = surfSetups[i].shader;
+			shaderRegisters = surfSetups[i].shaderRegisters;
+			culled = surfSetups[i].culled;
+		} else {
+			shader = surf->shader;
+			shader = R_RemapShaderBySkin( shader, def->parms.customSkin, def->parms.customShader );
+
+			R_GlobalShaderOverride( &shader );
+
+			shaderRegisters = NULL;
+			culled = false;		// checked below
+		}
 
 		if ( !shader ) {	
 			continue;
@@ -1109,7 +1465,7 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 		}
 
 		// debugging tool to make sure we are have the correct pre-calculated bounds
-		if ( r_checkBounds.GetBool() ) {
+		if ( r_checkBounds.GetBool() && ( tri->skinnedDeformInfo == NULL || tri->skinnedVertsValid ) ) {
 			int j, k;
 			for ( j = 0 ; j < tri->numVerts ; j++ ) {
 				for ( k = 0 ; k < 3 ; k++ ) {
@@ -1130,7 +1486,11 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 			}
 		}
 
-		if ( !R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum ) ) {
+		if ( !surfSetups ) {
+			culled = R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum );
+		}
+
+		if ( !culled ) {
 
 			def->visibleCount = tr.viewCount;
 
@@ -1150,7 +1510,7 @@ static void R_AddAmbientDrawsurfs( viewEntity_t *vEntity ) {
 			}
 
 			// add the surface for drawing
-			R_AddDrawSurf( tri, vEntity, &vEntity->entityDef->parms, shader, vEntity->scissorRect );
+			R_AddDrawSurf( tri, vEntity, &vEntity->entityDef->parms, shader, vEntity->scissorRect, shaderRegisters );
 
 			// ambientViewCount is used to allow light interactions to be rejected
 			// if the ambient surface isn't visible at all
@@ -1178,6 +1538,139 @@ idScreenRect R_CalcEntityScissorRectangle( viewEntity_t *vEntity ) {
 	return R_ScreenRectFromViewFrustumBounds( bounds );
 }
 
+/*
+===================
+R_CalcEntityScissorJob
+===================
+*/
+static void R_CalcEntityScissorJob( void *data ) {
+	entitySetup_t *setup = (entitySetup_t *)data;
+	viewEntity_t *vEntity = setup->vEntity;
+
+	// calculate the screen area covered by the entity
+	idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
+	// intersect with the portal crossing scissor rectangle
+	vEntity->scissorRect.Intersect( scissorRect );
+}
+
+/*
+===================
+R_SetupAmbientSurfacesJob
+
+Skin remapping, culling and shader register evaluation for all
+the ambient surfaces of an instantiated model.
+Only run when r_materialOverride is empty, because that needs a decl lookup.
+===================
+*/
+static void R_SetupAmbientSurfacesJob( void *data ) {
+	entitySetup_t *setup = (entitySetup_t *)data;
+	viewEntity_t *vEntity = setup->vEntity;
+	const renderEntity_t *renderEntity = &vEntity->entityDef->parms;
+	idRenderModel *model = setup->model;
+
+	PROFILE_SCOPE( "R_SetupAmbientSurfacesJob" );
+
+	if ( !model ) {
+		return;
+	}
+
+	// entities in a different time group see a different shader time
+	const viewDef_t *view = tr.viewDef;
+	viewDef_t timeGroupView;
+	if ( setup->floatTime != tr.viewDef->floatTime || setup->time != tr.viewDef->renderView.time ) {
+		timeGroupView = *tr.viewDef;
+		timeGroupView.floatTime = setup->floatTime;
+		timeGroupView.renderView.time = setup->time;
+		view = &timeGroupView;
+	}
+
+	int total = model->NumSurfaces();
+	ambientSurfSetup_t *surfSetups = (ambientSurfSetup_t *)R_FrameAlloc( total * sizeof( surfSetups[0] ) );
+
+	for ( int i = 0 ; i < total ; i++ ) {
+		const modelSurface_t *surf = model->Surface( i );
+		ambientSurfSetup_t *surfSetup = &surfSetups[i];
+
+		surfSetup->shader = NULL;
+		surfSetup->shaderRegisters = NULL;
+		surfSetup->culled = true;
+
+		const srfTriangles_t *tri = surf->geometry;
+		if ( !tri || !tri->numIndexes ) {
+			continue;
+		}
+
+		const idMaterial *shader = R_RemapShaderBySkin( surf->shader, renderEntity->customSkin, renderEntity->customShader );
+		R_GlobalShaderOverride( &shader );
+		if ( !shader || !shader->IsDrawn() ) {
+			continue;
+		}
+		surfSetup->shader = shader;
+
+		surfSetup->culled = R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum, &setup->counters );
+		if ( surfSetup->culled ) {
+			continue;
+		}
+
+		// reference shaders and sound amplitudes are left to R_AddDrawSurf on the main thread
+		if ( shader->ConstantRegisters() || renderEntity->referenceShader ) {
+			continue;
+		}
+		if ( shader->ReferencesSound() && renderEntity->referenceSound ) {
+			continue;
+		}
+
+		float *regs = (float *)R_FrameAlloc( shader->GetNumRegisters() * sizeof( float ) );
+		shader->EvaluateRegisters( regs, renderEntity->shaderParms, view, renderEntity->referenceSound );
+		surfSetup->shaderRegisters = regs;
+	}
+
+	setup->surfaces = surfSetups;
+}
+
+/*
+===================
+R_BeginEntityTimeGroup
+
+Entities in a time group are instantiated and have their shaders evaluated
+with the time of their group
+===================
+*/
+static void R_BeginEntityTimeGroup( const viewEntity_t *vEntity, float &oldFloatTime, int &oldTime ) {
+	game->SelectTimeGroup( vEntity->entityDef->parms.timeGroup );
+
+	if ( vEntity->entityDef->parms.timeGroup ) {
+		oldFloatTime = tr.viewDef->floatTime;
+		oldTime = tr.viewDef->renderView.time;
+
+		tr.viewDef->floatTime = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup ) * 0.001;
+		tr.viewDef->renderView.time = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup );
+	}
+}
+
+/*
+===================
+R_EndEntityTimeGroup
+===================
+*/
+static void R_EndEntityTimeGroup( const viewEntity_t *vEntity, float oldFloatTime, int oldTime ) {
+	if ( vEntity->entityDef->parms.timeGroup ) {
+		tr.viewDef->floatTime = oldFloatTime;
+		tr.viewDef->renderView.time = oldTime;
+	}
+}
+
+/*
+===================
+R_SkinDeferredSurfaceJob
+===================
+*/
+static void R_SkinDeferredSurfaceJob( void *data ) {
+	PROFILE_SCOPE( "R_SkinDeferredSurfaceJob" );
+
+	R_SkinDeferredSurface( (deferredSkin_t *)data );
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1187,71 +1680,161 @@ interactions get created.  This is all done on a sort-by-model basis
 to keep source data in cache (most likely L2) as any interactions and
 shadows are generated, since dynamic models will typically be lit by
 two or more lights.
+
+The entity scissors, the md5 skinning and the ambient surface setup run
+as jobs.  The entity callbacks are all issued before any model is
+instantiated, the instantiation allocates the md5 surfaces and leaves
+the vertex transforms, bounds and tangents to the skinning jobs, and the
+draw surfaces and interactions are linked after the jobs in viewEntitys
+order, so the result is identical to a serial run.
+
+The callbacks run game code, and the other dynamic models allocate from
+the static block allocators of tr_trisurf.cpp, so they stay serial, as do
+entities that are only instantiated for their shadows by
+idInteraction::AddActiveInteraction.  Interaction and shadow volume creation
+also stay on the main thread, they share those allocators, the vertex
+cache, the static buffers of tr_stencilshadow.cpp, the interaction tables
+and the shadow volume cache.
 ===================
 */
 void R_AddModelSurfaces( void ) {
 	viewEntity_t		*vEntity;
 	idInteraction		*inter, *next;
-	idRenderModel		*model;
+	int					numEntities;
+	int					i;
+	float				oldFloatTime;
+	int					oldTime;
+
+	PROFILE_SCOPE( "R_AddModelSurfaces" );
 
 	// clear the ambient surface list
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
-	// go through each entity that is either visible to the view, or to
-	// any light that intersects the view (for shadows)
+	numEntities = 0;
 	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next ) {
+		numEntities++;
+	}
+	if ( !numEntities ) {
+		return;
+	}
 
-		if ( r_useEntityScissors.GetBool() ) {
-			// calculate the screen area covered by the entity
-			idScreenRect scissorRect = R_CalcEntityScissorRectangle( vEntity );
-			// intersect with the portal crossing scissor rectangle
-			vEntity->scissorRect.Intersect( scissorRect );
+	entitySetup_t *setups = (entitySetup_t *)R_ClearedFrameAlloc( numEntities * sizeof( setups[0] ) );
+	i = 0;
+	for ( vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next, i++ ) {
+		setups[i].vEntity = vEntity;
+	}
 
-			if ( r_showEntityScissors.GetBool() ) {
-				R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
-			}
+	if ( r_useEntityScissors.GetBool() ) {
+		R_RunFrontEndJobs( R_CalcEntityScissorJob, setups, sizeof( setups[0] ), numEntities );
+	}
+
+	// go through each entity that is either visible to the view, or to
+	// any light that intersects the view (for shadows), and find the
+	// ones that need their dynamic models for the ambient surfaces
+	double dynamicModelStart = R_BeginFrontEndPhase();
+	for ( i = 0 ; i < numEntities ; i++ ) {
+		entitySetup_t *setup = &setups[i];
+		vEntity = setup->vEntity;
+
+		if ( r_useEntityScissors.GetBool() && r_showEntityScissors.GetBool() ) {
+			R_ShowColoredScreenRect( vEntity->scissorRect, vEntity->entityDef->index );
 		}
 
-		float oldFloatTime;
-		int oldTime;
+		if ( tr.viewDef->isXraySubview && vEntity->entityDef->parms.xrayIndex == 1 ) {
+			setup->skip = true;
+			continue;
+		} else if ( !tr.viewDef->isXraySubview && vEntity->entityDef->parms.xrayIndex == 2 ) {
+			setup->skip = true;
+			continue;
+		}
 
-		game->SelectTimeGroup( vEntity->entityDef->parms.timeGroup );
+		if ( vEntity->scissorRect.IsEmpty() ) {
+			continue;
+		}
 
-		if ( vEntity->entityDef->parms.timeGroup ) {
-			oldFloatTime = tr.viewDef->floatTime;
-			oldTime = tr.viewDef->renderView.time;
+		// allow deferred entities to construct themselves, before any
+		// skinning is deferred that a callback could invalidate
+		if ( vEntity->entityDef->parms.callback ) {
+			R_BeginEntityTimeGroup( vEntity, oldFloatTime, oldTime );
+			setup->callbackUpdate = R_IssueEntityDefCallback( vEntity->entityDef );
+			R_EndEntityTimeGroup( vEntity, oldFloatTime, oldTime );
+		}
+		setup->instantiate = true;
+	}
 
-			tr.viewDef->floatTime = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup ) * 0.001;
-			tr.viewDef->renderView.time = game->GetTimeGroupTime( vEntity->entityDef->parms.timeGroup );
+	// instantiate the dynamic models, the md5 surfaces are skinned by the jobs below
+	tr.deferSkinning = r_useParallelAddSurfaces.GetBool() && parallelJobManager->GetNumWorkers() > 0;
+	tr.deferredSkins.SetNum( 0, false );
+	for ( i = 0 ; i < numEntities ; i++ ) {
+		entitySetup_t *setup = &setups[i];
+		vEntity = setup->vEntity;
+
+		if ( !setup->instantiate ) {
+			continue;
 		}
 
-		if ( tr.viewDef->isXraySubview && vEntity->entityDef->parms.xrayIndex == 1 ) {
-			if ( vEntity->entityDef->parms.timeGroup ) {
-				tr.viewDef->floatTime = oldFloatTime;
-				tr.viewDef->renderView.time = oldTime;
-			}
+		R_BeginEntityTimeGroup( vEntity, oldFloatTime, oldTime );
+		setup->newSnapshot = R_InstantiateEntityDefDynamicModel( vEntity->entityDef, setup->callbackUpdate );
+		setup->floatTime = tr.viewDef->floatTime;
+		setup->time = tr.viewDef->renderView.time;
+		R_EndEntityTimeGroup( vEntity, oldFloatTime, oldTime );
+	}
+	tr.deferSkinning = false;
+
+	R_RunFrontEndJobs( R_SkinDeferredSurfaceJob, tr.deferredSkins.Ptr(), sizeof( deferredSkin_t ), tr.deferredSkins.Num() );
+
+	for ( i = 0 ; i < tr.deferredSkins.Num() ; i++ ) {
+		deferredSkin_t *skin = &tr.deferredSkins[i];
+		skin->modelBounds->AddPoint( skin->tri->bounds[0] );
+		skin->modelBounds->AddPoint( skin->tri->bounds[1] );
+		R_SumFrontEndJobCounters( &skin->counters );
+	}
+	tr.deferredSkins.SetNum( 0, false );
+
+	for ( i = 0 ; i < numEntities ; i++ ) {
+		entitySetup_t *setup = &setups[i];
+		vEntity = setup->vEntity;
+
+		if ( !setup->instantiate ) {
 			continue;
-		} else if ( !tr.viewDef->isXraySubview && vEntity->entityDef->parms.xrayIndex == 2 ) {
-			if ( vEntity->entityDef->parms.timeGroup ) {
-				tr.viewDef->floatTime = oldFloatTime;
-				tr.viewDef->renderView.time = oldTime;
-			}
+		}
+
+		idRenderModel *model;
+		if ( vEntity->entityDef->parms.hModel->IsDynamicModel() == DM_STATIC ) {
+			model = vEntity->entityDef->parms.hModel;
+		} else {
+			R_FinishEntityDefDynamicModel( vEntity->entityDef, setup->newSnapshot );
+			model = vEntity->entityDef->dynamicModel;
+		}
+		if ( model == NULL || model->NumSurfaces() <= 0 ) {
+			setup->skip = true;
+		} else {
+			setup->model = model;
+		}
+	}
+	R_EndFrontEndPhase( FE_PHASE_DYNAMIC_MODELS, dynamicModelStart );
+
+	// a material override needs a decl lookup, so leave the surfaces to R_AddAmbientDrawsurfs
+	if ( r_materialOverride.GetString()[0] == '\0' ) {
+		R_RunFrontEndJobs( R_SetupAmbientSurfacesJob, setups, sizeof( setups[0] ), numEntities );
+	}
+
+	for ( i = 0 ; i < numEntities ; i++ ) {
+		entitySetup_t *setup = &setups[i];
+		vEntity = setup->vEntity;
+
+		R_SumFrontEndJobCounters( &setup->counters );
+
+		if ( setup->skip ) {
 			continue;
 		}
 
-		// add the ambient surface if it has a visible rectangle
-		if ( !vEntity->scissorRect.IsEmpty() ) {
-			model = R_EntityDefDynamicModel( vEntity->entityDef );
-			if ( model == NULL || model->NumSurfaces() <= 0 ) {
-				if ( vEntity->entityDef->parms.timeGroup ) {
-					tr.viewDef->floatTime = oldFloatTime;
-					tr.viewDef->renderView.time = oldTime;
-				}
-				continue;
-			}
+		R_BeginEntityTimeGroup( vEntity, oldFloatTime, oldTime );
 
-			R_AddAmbientDrawsurfs( vEntity );
+		// add the ambient surface if it has a visible rectangle
+		if ( setup->model ) {
+			R_AddAmbientDrawsurfs( vEntity, setup->surfaces );
 			tr.pc.c_visibleViewEntities++;
 		} else {
 			tr.pc.c_shadowViewEntities++;
@@ -1260,6 +1843,7 @@ void R_AddModelSurfaces( void ) {
 		//
 		// for all the entity / light interactions on this entity, add them to the view
 		//
+		double interactionStart = R_BeginFrontEndPhase();
 		if ( tr.viewDef->isXraySubview ) {
 			if ( vEntity->entityDef->parms.xrayIndex == 2 ) {
 				for ( inter = vEntity->entityDef->firstInteraction; inter != NULL && !inter->IsEmpty(); inter = next ) {
@@ -1285,12 +1869,9 @@ void R_AddModelSurfaces( void ) {
 				inter->AddActiveInteraction();
 			}
 		}
+		R_EndFrontEndPhase( FE_PHASE_INTERACTIONS, interactionStart );
 
-		if ( vEntity->entityDef->parms.timeGroup ) {
-			tr.viewDef->floatTime = oldFloatTime;
-			tr.viewDef->renderView.time = oldTime;
-		}
-
+		R_EndEntityTimeGroup( vEntity, oldFloatTime, oldTime );
 	}
 }
 
@@ -774,6 +774,9 @@ void R_FreeDerivedData( void ) {
 			}
 			R_FreeLightDefDerivedData( light );
 		}
+
+		// the freed interactions left their shadow volumes here
+		rw->shadowCache.Clear();
 	}
 }
 
@@ -115,7 +115,7 @@ typedef struct drawSurf_s {
 	const srfTriangles_t	*geo;
 	const struct viewEntity_s *space;
 	const idMaterial		*material;	// may be NULL for shadow volumes
-	float					sort;		// material->sort, modified by gui / entity sort offsets
+	uint64					sort;		// packed sort key, material->sort in the upper 32 bits, see R_DrawSurfSortKey
 	const float				*shaderRegisters;	// evaluated and adjusted for referenceShaders
 	const struct drawSurf_s	*nextOnLight;	// viewLight chains
 	idScreenRect			scissorRect;	// for scissor clipping, local inside renderView viewport
@@ -360,6 +360,8 @@ typedef struct viewEntity_s {
 
 	float				modelMatrix[16];		// local coords to global coords
 	float				modelViewMatrix[16];	// local coords to eye coords
+
+	idBounds			modelBounds;			// only set for r_showViewEntitys by R_PrepareDebugTools
 } viewEntity_t;
 
 
@@ -520,27 +522,42 @@ typedef struct frameMemoryBlock_s {
 	byte	base[4];	// dynamically allocated as [size]
 } frameMemoryBlock_t;
 
-// all of the information needed by the back end must be
-// contained in a frameData_t.  This entire structure is
-// duplicated so the front and back end can run in parallel
-// on an SMP machine (OBSOLETE: this capability has been removed)
+// every thread that allocates frame memory bumps its own chain of
+// blocks, so front end jobs don't have to lock for each allocation.
+// Arena 0 belongs to the main thread, arena N to job worker N.
 typedef struct {
-	// one or more blocks of memory for all frame
-	// temporary allocations
+	// one or more blocks of memory, all empty at the start of the frame
 	frameMemoryBlock_t	*memory;
 
 	// alloc will point somewhere into the memory chain
 	frameMemoryBlock_t	*alloc;
 
+	int					used;				// bytes used the last time it was counted
+	int					highwater;			// max used on any frame
+} frameArena_t;
+
+const int	MAX_FRAME_ARENAS =			MAX_JOB_THREADS + 1;
+
+// all of the information needed by the back end must be
+// contained in a frameData_t.  This entire structure is
+// duplicated so the front and back end can run in parallel
+// on an SMP machine, see r_useSMP
+typedef struct {
+	// per thread memory for all frame temporary allocations,
+	// worker arenas get their first block on demand
+	frameArena_t		arenas[MAX_FRAME_ARENAS];
+
 	srfTriangles_t *	firstDeferredFreeTriSurf;
 	srfTriangles_t *	lastDeferredFreeTriSurf;
 
-	int					memoryHighwater;	// max used on any frame
+	int					memoryHighwater;	// max used by all arenas together on any frame
 
 	// the currently building command list 
 	// commands can be inserted at the front if needed, as for required
 	// dynamically generated textures
 	emptyCommand_t	*cmdHead, *cmdTail;		// may be of other command type based on commandId
+
+	int					vertexCacheUploads;	// idVertexCache upload list the back end flushes before drawing
 } frameData_t;
 
 extern	frameData_t	*frameData;
@@ -549,6 +566,13 @@ extern	frameData_t	*frameData;
 
 void R_LockSurfaceScene( viewDef_t *parms );
 void R_ClearCommandChain( void );
+
+// waits for the render thread to finish the frame it was handed and takes the
+// GL context back, anything on the main thread that touches GL state or data
+// the back end may still be reading must call this first
+void R_SyncRenderThread( void );
+void R_ShutdownRenderThread( void );
+void R_RenderThreadStats_f( const idCmdArgs &args );
 void R_AddDrawViewCmd( viewDef_t *parms );
 
 void R_ReloadGuis_f( const idCmdArgs &args );
@@ -565,6 +589,20 @@ const idMaterial *R_RemapShaderBySkin( const idMaterial *shader, const idDeclSki
 //====================================================
 
 
+// front end phases timed while benchFrontEnd replays a demo, the
+// interactions include the shadows created for them
+typedef enum {
+	FE_PHASE_RENDER_VIEW,		// all of R_RenderView, subviews included
+	FE_PHASE_PORTAL_FLOW,		// FindViewLightsAndEntities
+	FE_PHASE_OCCLUSION,			// R_OcclusionCullViewLightsAndEntities
+	FE_PHASE_LIGHT_SURFACES,	// R_AddLightSurfaces
+	FE_PHASE_DYNAMIC_MODELS,	// R_EntityDefDynamicModel in R_AddModelSurfaces
+	FE_PHASE_INTERACTIONS,		// AddActiveInteraction in R_AddModelSurfaces
+	FE_PHASE_SHADOWS,			// R_CreateShadowVolume
+	FE_PHASE_SORT,				// R_SortDrawSurfs
+	FE_NUM_PHASES
+} frontEndPhase_t;
+
 /*
 ** performanceCounters_t
 */
@@ -587,9 +625,40 @@ typedef struct {
 	int		c_tangentIndexes;	// R_DeriveTangents()
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs;
+	int		c_occluderTris, c_occludedEntities, c_occludedLights;
+	int		c_shadowCacheHits, c_shadowCacheMisses;
 	int		frontEndMsec;		// sum of time in all RE_RenderScene's in a frame
+	float	frontEndPhaseMsec[FE_NUM_PHASES];	// only measured while tr.frontEndBenchmark is set
 } performanceCounters_t;
 
+/*
+** frontEndJobCounters_t
+**
+** counted by a front end job instead of tr.pc, and summed
+** on the main thread after the jobs are done
+*/
+typedef struct {
+	int		c_box_cull_in, c_box_cull_out;
+	int		c_clippedLight, c_unclippedLight;
+	int		c_tangentIndexes;
+} frontEndJobCounters_t;
+
+/*
+** deferredSkin_t
+**
+** an md5 surface that idRenderModelMD5::InstantiateDynamicModel left
+** for R_AddModelSurfaces to skin in a front end job
+*/
+class idMD5Mesh;
+
+typedef struct {
+	idMD5Mesh *				mesh;
+	const renderEntity_t *	ent;
+	srfTriangles_t *		tri;
+	idBounds *				modelBounds;	// snapshot bounds, grown on the main thread after the jobs
+	frontEndJobCounters_t	counters;
+} deferredSkin_t;
+
 
 typedef struct {
 	int		current2DMap;
@@ -606,6 +675,7 @@ typedef struct {
 	int			faceCulling;
 	int			glStateBits;
 	bool		forceGlState;		// the next GL_State will ignore glStateBits and set everything
+	bool		colorArrayEnabled;	// PC_ATTRIB_INDEX_COLOR vertex attrib array, restored after skinned draws
 } glstate_t;
 
 
@@ -629,6 +699,10 @@ typedef struct {
 	int		c_vboIndexes;
 	float	c_overDraw;	
 
+	int		c_uniformUploads;			// glUniform4fv calls
+	int		c_uniformVectors;			// vectors uploaded by them
+	int		c_uniformVectorsSkipped;	// vectors not uploaded because the program already had the value
+
 	int		msec;			// total msec for backend run
 } backEndCounters_t;
 
@@ -712,6 +786,9 @@ public:
 	virtual void			CaptureRenderToFile( const char *fileName, bool fixAlpha );
 	virtual void			UnCrop();
 	virtual bool			UploadImage( const char *imageName, const byte *data, int width, int height );
+	virtual void			SyncRenderThread( void );
+	virtual void			BeginFrontEndBenchmark( void );
+	virtual void			EndFrontEndBenchmark( const char *demoName );
 
 public:
 	// internal functions
@@ -740,7 +817,15 @@ public:
 
 	idVec4					ambientLightVector;	// used for "ambient bump mapping"
 
-	float					sortOffset;				// for determinist sorting of equal sort materials
+	idParallelJobList *		frontEndJobs;			// light and entity setup jobs of R_AddLightSurfaces / R_AddModelSurfaces
+	bool					frontEndJobsActive;		// R_FrameAlloc may be called from several threads
+	bool					deferSkinning;			// md5 instantiation adds to deferredSkins instead of skinning
+	idList<deferredSkin_t>	deferredSkins;
+
+	bool					smpActive;				// the back end runs on the render thread, see R_SyncRenderThread
+	bool					renderThreadBusy;		// a frame has been handed to the render thread and not synced yet
+
+	bool					frontEndBenchmark;		// the front end phases are timed, see tr_benchmark.cpp
 
 	idList<idRenderWorldLocal*>worlds;
 
@@ -818,7 +903,7 @@ extern idCVar r_checkBounds;			// compare all surface bounds with precalculated
 extern idCVar r_useLightPortalFlow;		// 1 = do a more precise area reference determination
 extern idCVar r_useShadowSurfaceScissor;// 1 = scissor shadows by the scissor rect of the interaction surfaces
 extern idCVar r_useConstantMaterials;	// 1 = use pre-calculated material registers if possible
-extern idCVar r_useInteractionTable;	// create a full entityDefs * lightDefs table to make finding interactions faster
+extern idCVar r_useInteractionTable;	// use the per light interaction hash tables instead of scanning the entity interaction lists
 extern idCVar r_useNodeCommonChildren;	// stop pushing reference bounds early when possible
 extern idCVar r_useSilRemap;			// 1 = consider verts with the same XYZ, but different ST the same for shadows
 extern idCVar r_useCulling;				// 0 = none, 1 = sphere, 2 = sphere + box
@@ -827,6 +912,9 @@ extern idCVar r_useLightScissors;		// 1 = use custom scissor rectangle for each
 extern idCVar r_useClippedLightScissors;// 0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always
 extern idCVar r_useEntityCulling;		// 0 = none, 1 = box
 extern idCVar r_useEntityScissors;		// 1 = use custom scissor rectangle for each entity
+extern idCVar r_useOcclusionCulling;	// 1 = cull entities and lights hidden behind the world with a software depth buffer
+extern idCVar r_useSMP;					// 1 = run the back end on its own thread, overlapped with the next front end frame
+extern idCVar r_useParallelAddSurfaces;	// 1 = run the per-light and per-entity setup of the front end as jobs
 extern idCVar r_useInteractionCulling;	// 1 = cull interactions
 extern idCVar r_useInteractionScissors;	// 1 = use a custom scissor rectangle for each interaction
 extern idCVar r_useFrustumFarDistance;	// if != 0 force the view frustum far distance to this distance
@@ -835,12 +923,15 @@ extern idCVar r_usePreciseTriangleInteractions;	// 1 = do winding clipping to de
 extern idCVar r_useTurboShadow;			// 1 = use the infinite projection with W technique for dynamic shadows
 extern idCVar r_useExternalShadows;		// 1 = skip drawing caps when outside the light volume
 extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow volumes
+extern idCVar r_useShadowCache;			// 1 = reuse the shadow volumes of freed interactions if nothing they depend on changed
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
+extern idCVar r_useGPUSkinning;		// 1 = blend md5 meshes with the joint palette in the vertex programs
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
 extern idCVar r_useTwoSidedStencil;		// 1 = do stencil shadows in one pass with different ops on each side
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
 extern idCVar r_usePortals;				// 1 = use portals to perform area culling, otherwise draw everything
+extern idCVar r_useCachedWorld;			// 1 = load the binary world cache instead of parsing the .proc
 extern idCVar r_useStateCaching;		// avoid redundant state changes in GL_*() calls
 extern idCVar r_useEntityCallbacks;		// if 0, issue the callback immediately at update time, rather than defering
 extern idCVar r_lightAllBackFaces;		// light all the back faces, even when they would be shadowed
@@ -885,6 +976,8 @@ extern idCVar r_showDemo;				// report reads and writes to the demo file
 extern idCVar r_showDynamic;			// report stats on dynamic surface generation
 extern idCVar r_showIntensity;			// draw the screen colors based on intensity, red = 0, green = 128, blue = 255
 extern idCVar r_showDefs;				// report the number of modeDefs and lightDefs in view
+extern idCVar r_showOcclusionCulling;	// report the number of occluder triangles and occluded entities and lights
+extern idCVar r_showUniforms;			// report uniform uploads and the redundant ones that were skipped
 extern idCVar r_showTrace;				// show the intersection of an eye trace with the world
 extern idCVar r_showSmp;				// show which end (front or back) is blocking
 extern idCVar r_showDepth;				// display the contents of the depth buffer and the depth range
@@ -1095,9 +1188,10 @@ MAIN
 void R_RenderView( viewDef_t *parms );
 
 // performs radius cull first, then corner cull
-bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
+// jobs pass their own counters, otherwise tr.pc is counted
+bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, frontEndJobCounters_t *counters = NULL );
 bool R_RadiusCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
-bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes );
+bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, frontEndJobCounters_t *counters = NULL );
 
 void R_AxisToModelMatrix( const idMat3 &axis, const idVec3 &origin, float modelMatrix[16] );
 
@@ -1141,7 +1235,7 @@ viewEntity_t *R_SetEntityDefViewEntity( idRenderEntityLocal *def );
 viewLight_t *R_SetLightDefViewLight( idRenderLightLocal *def );
 
 void R_AddDrawSurf( const srfTriangles_t *tri, const viewEntity_t *space, const renderEntity_t *renderEntity,
-					const idMaterial *shader, const idScreenRect &scissor );
+					const idMaterial *shader, const idScreenRect &scissor, const float *shaderRegisters = NULL );
 
 void R_LinkLightSurf( const drawSurf_t **link, const srfTriangles_t *tri, const viewEntity_t *space, 
 				   const idRenderLightLocal *light, const idMaterial *shader, const idScreenRect &scissor, bool viewInsideShadow );
@@ -1170,6 +1264,41 @@ void R_AddLightSurfaces( void );
 void R_AddModelSurfaces( void );
 void R_RemoveUnecessaryViewLights( void );
 
+/*
+============================================================
+
+TR_OCCLUSION
+
+============================================================
+*/
+
+void R_OcclusionCullViewLightsAndEntities( void );
+
+/*
+============================================================
+
+TR_BENCHMARK
+
+============================================================
+*/
+
+double R_BeginFrontEndPhase( void );
+void R_EndFrontEndPhase( frontEndPhase_t phase, double start );
+void R_RecordFrontEndBenchmarkFrame( void );
+
+/*
+============================================================
+
+TR_HISTORY
+
+============================================================
+*/
+
+void R_RecordPerfHistory( void );
+void R_ShutdownPerfHistory( void );
+void R_PerfHistoryDump_f( const idCmdArgs &args );
+void R_PerfHistoryStream_f( const idCmdArgs &args );
+
 void R_FreeDerivedData( void );
 void R_ReCreateWorldReferences( void );
 
@@ -1330,6 +1459,10 @@ void				R_ReallyFreeStaticTriSurf( srfTriangles_t *tri );
 void				R_FreeDeferredTriSurfs( frameData_t *frame );
 int					R_TriSurfMemory( const srfTriangles_t *tri );
 
+// binary cache of a finished surface in native byte order, the read returns NULL for bad data
+void				R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri );
+srfTriangles_t *	R_ReadStaticTriSurf( idFile *f );
+
 void				R_BoundTriSurf( srfTriangles_t *tri );
 void				R_RemoveDuplicatedTriangles( srfTriangles_t *tri );
 void				R_CreateSilIndexes( srfTriangles_t *tri );
@@ -1348,7 +1481,17 @@ srfTriangles_t *	R_MergeTriangles( const srfTriangles_t *tri1, const srfTriangle
 
 // if the deformed verts have significant enough texture coordinate changes to reverse the texture
 // polarity of a triangle, the tangents will be incorrect
-void				R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes = true );
+void				R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes = true, frontEndJobCounters_t *counters = NULL );
+
+// the matrices_ubo uniform block holds 408 float4, three rows for each joint
+const int MAX_SKINNING_JOINTS = 408 / 3;
+
+// joint influences for GPU skinning, stored directly after the bind pose
+// idDrawVert array in the static vertex cache
+typedef struct skinnedWeight_s {
+	byte			jointIndexes[4];		// into the joint palette of the surface
+	byte			jointWeights[4];		// sums to 255
+} skinnedWeight_t;
 
 // deformable meshes precalculate as much as possible from a base frame, then generate
 // complete srfTriangles_t from just a new set of vertexes
@@ -1375,12 +1518,29 @@ typedef struct deformInfo_s {
 	silEdge_t *		silEdges;
 
 	dominantTri_t *	dominantTris;
+
+	// only set if the surface can be skinned by the vertex programs
+	idDrawVert *		skinnedVerts;		// [numOutputVerts] bind pose with normals and tangents
+	skinnedWeight_t *	skinnedWeights;		// [numOutputVerts] in the same allocation as skinnedVerts
+	struct vertCache_s *skinnedCache;		// skinnedVerts followed by skinnedWeights
 } deformInfo_t;
 
 
 deformInfo_t *		R_BuildDeformInfo( int numVerts, const idDrawVert *verts, int numIndexes, const int *indexes, bool useUnsmoothedTangents );
+// verts and weights are [numSourceVerts], mirrored vertexes are replicated
+void				R_BuildDeformInfoSkinning( deformInfo_t *deformInfo, const idDrawVert *verts, const skinnedWeight_t *weights );
+// GPU skinned surfaces only get CPU positions when these are called
+void				R_SkinTriSurfVerts( srfTriangles_t *tri );
+void				R_SkinModelVerts( idRenderModel *model );
+// the job half of a deferred md5 surface, see deferredSkin_t
+void				R_SkinDeferredSurface( deferredSkin_t *skin );
 void				R_FreeDeformInfo( deformInfo_t *deformInfo );
 int					R_DeformInfoMemoryUsed( deformInfo_t *deformInfo );
+// binary cache of a deform info in native byte order, the read returns NULL for bad data
+void				R_WriteDeformInfo( idFile *f, const deformInfo_t *deformInfo );
+deformInfo_t *		R_ReadDeformInfo( idFile *f );
+
+void				R_TestGPUSkinning_f( const idCmdArgs &args );
 
 /*
 ============================================================
@@ -1408,6 +1568,7 @@ void R_ToggleSmpFrame( void );
 void *R_FrameAlloc( int bytes );
 void *R_ClearedFrameAlloc( int bytes );
 void R_FrameFree( void *data );
+void R_FrameAllocStats_f( const idCmdArgs &args );
 
 void *R_StaticAlloc( int bytes );		// just malloc with error checking
 void *R_ClearedStaticAlloc( int bytes );	// with memset
@@ -1435,7 +1596,7 @@ void RB_ShowLightCount( drawSurf_t **drawSurfs, int numDrawSurfs );
 void RB_PolygonClear( void );
 void RB_ScanStencilBuffer( void );
 void RB_ShowDestinationAlpha( void );
-void RB_ShowOverdraw( void );
+void R_PrepareDebugTools( viewDef_t *viewDef );
 void RB_RenderDebugTools( drawSurf_t **drawSurfs, int numDrawSurfs );
 void RB_ShutdownDebugTools( void );
 
@@ -1453,6 +1614,8 @@ void RB_SetGL2D( void );
 void RB_ShowImages( void );
 
 void RB_ExecuteBackEndCommands( const emptyCommand_t *cmds );
+void RB_ExecuteFrame( frameData_t *frame );
+void RB_RenderThread( void );
 
 
 /*
@@ -178,6 +178,10 @@ void R_ShowColoredScreenRect( const idScreenRect &rect, int colorIndex ) {
 	}
 }
 
+// frameData points at one of these, the other one belongs to the back end
+static frameData_t *	smpFrameData[2];
+static int				smpFrame;
+
 /*
 ====================
 R_ToggleSmpFrame
@@ -187,23 +191,32 @@ void R_ToggleSmpFrame( void ) {
 	if ( r_lockSurfaces.GetBool() ) {
 		return;
 	}
-	R_FreeDeferredTriSurfs( frameData );
 
 	// clear frame-temporary data
 	frameData_t		*frame;
+	frameArena_t	*arena;
 	frameMemoryBlock_t	*block;
 
 	// update the highwater mark
 	R_CountFrameData();
 
+	// the frame just issued may still be drawing on the render thread,
+	// so build the next one in the other frameData, whose back end
+	// finished before R_SyncRenderThread returned at the top of EndFrame
+	smpFrame ^= 1;
+	frameData = smpFrameData[smpFrame];
 	frame = frameData;
 
-	// reset the memory allocation to the first block
-	frame->alloc = frame->memory;
+	// surfaces freed while this frameData was last built can't be referenced anymore
+	R_FreeDeferredTriSurfs( frame );
 
-	// clear all the blocks
-	for ( block = frame->memory ; block ; block = block->next ) {
-		block->used = 0;
+	// reset every arena to its first block and clear all the blocks
+	for ( int i = 0 ; i < MAX_FRAME_ARENAS ; i++ ) {
+		arena = &frame->arenas[i];
+		arena->alloc = arena->memory;
+		for ( block = arena->memory ; block ; block = block->next ) {
+			block->used = 0;
+		}
 	}
 
 	R_ClearCommandChain();
@@ -213,6 +226,32 @@ void R_ToggleSmpFrame( void ) {
 //=====================================================
 
 #define	MEMORY_BLOCK_SIZE	0x100000
+#define	WORKER_BLOCK_SIZE	0x40000
+
+/*
+=====================
+R_AllocFrameMemoryBlock
+=====================
+*/
+static frameMemoryBlock_t *R_AllocFrameMemoryBlock( int size ) {
+	frameMemoryBlock_t *block;
+
+	// the heap isn't thread safe, so jobs take turns growing their arenas
+	if ( tr.frontEndJobsActive ) {
+		Sys_EnterCriticalSection( CRITICAL_SECTION_TWO );
+	}
+	block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
+	if ( tr.frontEndJobsActive ) {
+		Sys_LeaveCriticalSection( CRITICAL_SECTION_TWO );
+	}
+	if ( !block ) {
+		common->FatalError( "R_FrameAlloc: Mem_Alloc() failed" );
+	}
+	block->size = size;
+	block->used = 0;
+	block->next = NULL;
+	return block;
+}
 
 /*
 =====================
@@ -224,19 +263,25 @@ void R_ShutdownFrameData( void ) {
 	frameMemoryBlock_t *block;
 
 	// free any current data
-	frame = frameData;
-	if ( !frame ) {
+	if ( !frameData ) {
 		return;
 	}
 
-	R_FreeDeferredTriSurfs( frame );
+	for ( int i = 0 ; i < 2 ; i++ ) {
+		frame = smpFrameData[i];
+
+		R_FreeDeferredTriSurfs( frame );
 
-	frameMemoryBlock_t *nextBlock;
-	for ( block = frame->memory ; block ; block = nextBlock ) {
-		nextBlock = block->next;
-		Mem_Free( block );
+		for ( int j = 0 ; j < MAX_FRAME_ARENAS ; j++ ) {
+			frameMemoryBlock_t *nextBlock;
+			for ( block = frame->arenas[j].memory ; block ; block = nextBlock ) {
+				nextBlock = block->next;
+				Mem_Free( block );
+			}
+		}
+		Mem_Free( frame );
+		smpFrameData[i] = NULL;
 	}
-	Mem_Free( frame );
 	frameData = NULL;
 }
 
@@ -246,24 +291,23 @@ R_InitFrameData
 =====================
 */
 void R_InitFrameData( void ) {
-	int size;
 	frameData_t *frame;
 	frameMemoryBlock_t *block;
 
 	R_ShutdownFrameData();
 
-	frameData = (frameData_t *)Mem_ClearedAlloc( sizeof( *frameData ));
-	frame = frameData;
-	size = MEMORY_BLOCK_SIZE;
-	block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-	if ( !block ) {
-		common->FatalError( "R_InitFrameData: Mem_Alloc() failed" );
+	for ( int i = 0 ; i < 2 ; i++ ) {
+		frame = (frameData_t *)Mem_ClearedAlloc( sizeof( *frame ));
+		block = R_AllocFrameMemoryBlock( MEMORY_BLOCK_SIZE );
+		frame->arenas[0].memory = block;
+		frame->arenas[0].alloc = block;
+		frame->memoryHighwater = 0;
+		smpFrameData[i] = frame;
 	}
-	block->size = size;
-	block->used = 0;
-	block->next = NULL;
-	frame->memory = block;
-	frame->memoryHighwater = 0;
+
+	// the toggle makes smpFrameData[0] current
+	smpFrame = 1;
+	frameData = smpFrameData[smpFrame];
 
 	R_ToggleSmpFrame();
 }
@@ -271,20 +315,31 @@ void R_InitFrameData( void ) {
 /*
 ================
 R_CountFrameData
+
+Updates the per arena and total highwater marks of the current frame.
 ================
 */
 int R_CountFrameData( void ) {
 	frameData_t		*frame;
+	frameArena_t	*arena;
 	frameMemoryBlock_t	*block;
 	int				count;
 
 	count = 0;
 	frame = frameData;
-	for ( block = frame->memory ; block ; block=block->next ) {
-		count += block->used;
-		if ( block == frame->alloc ) {
-			break;
+	for ( int i = 0 ; i < MAX_FRAME_ARENAS ; i++ ) {
+		arena = &frame->arenas[i];
+		arena->used = 0;
+		for ( block = arena->memory ; block ; block=block->next ) {
+			arena->used += block->used;
+			if ( block == arena->alloc ) {
+				break;
+			}
+		}
+		if ( arena->used > arena->highwater ) {
+			arena->highwater = arena->used;
 		}
+		count += arena->used;
 	}
 
 	// note if this is a new highwater mark
@@ -295,6 +350,54 @@ int R_CountFrameData( void ) {
 	return count;
 }
 
+/*
+================
+R_FrameAllocStats_f
+
+Prints the frame memory used by every thread, use it
+to size MEMORY_BLOCK_SIZE and WORKER_BLOCK_SIZE.
+================
+*/
+void R_FrameAllocStats_f( const idCmdArgs &args ) {
+	frameMemoryBlock_t	*block;
+
+	if ( !frameData ) {
+		return;
+	}
+
+	R_CountFrameData();
+
+	int totalUsed = 0;
+	int totalHighwater = 0;
+	int totalAllocated = 0;
+
+	common->Printf( "arena       used  highwater  allocated blocks\n" );
+	for ( int i = 0 ; i < MAX_FRAME_ARENAS ; i++ ) {
+		// the other frame is either idle or being drawn, its blocks stay untouched
+		const frameArena_t *arena = &frameData->arenas[i];
+		const frameArena_t *other = &smpFrameData[smpFrame ^ 1]->arenas[i];
+		int highwater = Max( arena->highwater, other->highwater );
+		int allocated = 0;
+		int numBlocks = 0;
+		for ( int j = 0 ; j < 2 ; j++ ) {
+			for ( block = smpFrameData[j]->arenas[i].memory ; block ; block = block->next ) {
+				allocated += block->size;
+				numBlocks++;
+			}
+		}
+		if ( !numBlocks ) {
+			continue;
+		}
+		common->Printf( "%5i %10i %10i %10i %6i %s\n", i, arena->used, highwater, allocated, numBlocks,
+			i == 0 ? "main" : "worker" );
+		totalUsed += arena->used;
+		totalHighwater += highwater;
+		totalAllocated += allocated;
+	}
+	common->Printf( "total %10i %10i %10i\n", totalUsed, totalHighwater, totalAllocated );
+	common->Printf( "frame highwater: %i\n", Max( smpFrameData[0]->memoryHighwater, smpFrameData[1]->memoryHighwater ) );
+}
+
 /*
 =================
 R_StaticAlloc
@@ -362,49 +465,57 @@ from this frame.
 
 The memory is NOT zero filled.
 Should part of this be inlined in a macro?
+
+While tr.frontEndJobsActive is set, front end jobs
+may allocate at the same time as the main thread,
+each thread bumps its own arena without locking.
 ================
 */
 void *R_FrameAlloc( int bytes ) {
-	frameData_t		*frame;
+	frameArena_t	*arena;
 	frameMemoryBlock_t	*block;
 	void			*buf;
     
 	bytes = (bytes+16)&~15;
-	// see if it can be satisfied in the current block
-	frame = frameData;
-	block = frame->alloc;
+	// each job worker bumps its own arena, the main thread
+	// and the jobs it runs inline use arena 0
+	int threadIndex = parallelJobManager->GetThreadIndex();
+	if ( threadIndex >= MAX_FRAME_ARENAS || ( threadIndex != 0 && !tr.frontEndJobsActive ) ) {
+		// the render thread or a job outside the front end would share an arena
+		common->FatalError( "R_FrameAlloc: called from thread %i outside the front end", threadIndex );
+	}
+	arena = &frameData->arenas[ threadIndex ];
+	block = arena->alloc;
 
-	if ( block->size - block->used >= bytes ) {
+	// see if it can be satisfied in the current block
+	if ( block && block->size - block->used >= bytes ) {
 		buf = block->base + block->used;
 		block->used += bytes;
 		return buf;
 	}
 
-	// advance to the next memory block if available
-	block = block->next;
-	// create a new block if we are at the end of
-	// the chain
-	if ( !block ) {
-		int		size;
-
-		size = MEMORY_BLOCK_SIZE;
-		block = (frameMemoryBlock_t *)Mem_Alloc( size + sizeof( *block ) );
-		if ( !block ) {
-			common->FatalError( "R_FrameAlloc: Mem_Alloc() failed" );
+	// advance to the next memory block that is large enough, all
+	// blocks past alloc are still empty this frame
+	frameMemoryBlock_t *prev = block;
+	for ( block = block ? block->next : arena->memory ; block ; block = block->next ) {
+		if ( block->size >= bytes ) {
+			break;
 		}
-		block->size = size;
-		block->used = 0;
-		block->next = NULL;
-		frame->alloc->next = block;
+		prev = block;
 	}
 
-	// we could fix this if we needed to...
-	if ( bytes > block->size ) {
-		common->FatalError( "R_FrameAlloc of %i exceeded MEMORY_BLOCK_SIZE",
-			bytes );
+	// create a new block if we are at the end of the chain
+	if ( !block ) {
+		int size = ( arena == &frameData->arenas[0] ) ? MEMORY_BLOCK_SIZE : WORKER_BLOCK_SIZE;
+		block = R_AllocFrameMemoryBlock( Max( size, bytes ) );
+		if ( prev ) {
+			prev->next = block;
+		} else {
+			arena->memory = block;
+		}
 	}
 
-	frame->alloc = block;
+	arena->alloc = block;
 
 	block->used = bytes;
 
@@ -624,7 +735,7 @@ Can still generate a few false positives when the box is outside a corner.
 Returns true if the box is outside the given global frustum, (positive sides are out)
 =================
 */
-bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes ) {
+bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, frontEndJobCounters_t *counters ) {
 	int			i, j;
 	idVec3		transformed[8];
 	float		dists[8];
@@ -656,12 +767,20 @@ bool R_CornerCullLocalBox( const idBounds &bounds, const float modelMatrix[16],
 		}
 		if ( j == 8 ) {
 			// all points were behind one of the planes
-			tr.pc.c_box_cull_out++;
+			if ( counters != NULL ) {
+				counters->c_box_cull_out++;
+			} else {
+				tr.pc.c_box_cull_out++;
+			}
 			return true;
 		}
 	}
 
-	tr.pc.c_box_cull_in++;
+	if ( counters != NULL ) {
+		counters->c_box_cull_in++;
+	} else {
+		tr.pc.c_box_cull_in++;
+	}
 
 	return false;		// not culled
 }
@@ -674,11 +793,11 @@ Performs quick test before expensive test
 Returns true if the box is outside the given global frustum, (positive sides are out)
 =================
 */
-bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes ) {
+bool R_CullLocalBox( const idBounds &bounds, const float modelMatrix[16], int numPlanes, const idPlane *planes, frontEndJobCounters_t *counters ) {
 	if ( R_RadiusCullLocalBox( bounds, modelMatrix, numPlanes, planes ) ) {
 		return true;
 	}
-	return R_CornerCullLocalBox( bounds, modelMatrix, numPlanes, planes );
+	return R_CornerCullLocalBox( bounds, modelMatrix, numPlanes, planes, counters );
 }
 
 /*
@@ -1023,37 +1142,77 @@ DRAWSURF SORTING
 */
 
 
+typedef struct {
+	uint64			key;
+	drawSurf_t *	surf;
+} drawSurfSort_t;
+
 /*
-=======================
-R_QsortSurfaces
+=================
+R_SortDrawSurfs
+
+Least significant digit radix sort on the packed 64 bit drawSurf_t::sort keys,
+eight bits per pass.  The histograms of all digits are built in a single pass
+over the keys and digits that are the same for every surface are skipped, which
+is usually the case for most of the upper bits.
 
-=======================
+The sort is stable, so surfaces with equal keys stay in the order they were
+added, see R_DrawSurfSortKey.
+=================
 */
-static int R_QsortSurfaces( const void *a, const void *b ) {
-	const drawSurf_t	*ea, *eb;
+static void R_SortDrawSurfs( void ) {
+	const int numDrawSurfs = tr.viewDef->numDrawSurfs;
+	drawSurf_t **drawSurfs = tr.viewDef->drawSurfs;
+	int histogram[8][256];
+	int i, pass;
 
-	ea = *(drawSurf_t **)a;
-	eb = *(drawSurf_t **)b;
+	PROFILE_SCOPE( "R_SortDrawSurfs" );
 
-	if ( ea->sort < eb->sort ) {
-		return -1;
+	if ( numDrawSurfs < 2 ) {
+		return;
 	}
-	if ( ea->sort > eb->sort ) {
-		return 1;
+
+	drawSurfSort_t *src = (drawSurfSort_t *)R_FrameAlloc( numDrawSurfs * sizeof( drawSurfSort_t ) );
+	drawSurfSort_t *dst = (drawSurfSort_t *)R_FrameAlloc( numDrawSurfs * sizeof( drawSurfSort_t ) );
+
+	memset( histogram, 0, sizeof( histogram ) );
+	for ( i = 0; i < numDrawSurfs; i++ ) {
+		const uint64 key = drawSurfs[i]->sort;
+		src[i].key = key;
+		src[i].surf = drawSurfs[i];
+		for ( pass = 0; pass < 8; pass++ ) {
+			histogram[pass][( key >> ( pass * 8 ) ) & 255]++;
+		}
 	}
-	return 0;
-}
 
+	for ( pass = 0; pass < 8; pass++ ) {
+		int *count = histogram[pass];
+		const int shift = pass * 8;
 
-/*
-=================
-R_SortDrawSurfs
-=================
-*/
-static void R_SortDrawSurfs( void ) {
-	// sort the drawsurfs by sort type, then orientation, then shader
-	qsort( tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, sizeof( tr.viewDef->drawSurfs[0] ),
-		R_QsortSurfaces );
+		// all keys share this digit
+		if ( count[( src[0].key >> shift ) & 255] == numDrawSurfs ) {
+			continue;
+		}
+
+		int offset = 0;
+		for ( i = 0; i < 256; i++ ) {
+			const int c = count[i];
+			count[i] = offset;
+			offset += c;
+		}
+
+		for ( i = 0; i < numDrawSurfs; i++ ) {
+			dst[count[( src[i].key >> shift ) & 255]++] = src[i];
+		}
+
+		drawSurfSort_t *temp = src;
+		src = dst;
+		dst = temp;
+	}
+
+	for ( i = 0; i < numDrawSurfs; i++ ) {
+		drawSurfs[i] = src[i].surf;
+	}
 }
 
 
@@ -1082,6 +1241,8 @@ void R_RenderView( viewDef_t *parms ) {
 		return;
 	}
 
+	PROFILE_SCOPE( "R_RenderView" );
+
 	tr.viewCount++;
 
 	// save view in case we are a subview
@@ -1089,8 +1250,6 @@ void R_RenderView( viewDef_t *parms ) {
 
 	tr.viewDef = parms;
 
-	tr.sortOffset = 0;
-
 	// set the matrix for world space to eye space
 	R_SetViewMatrix( tr.viewDef );
 
@@ -1104,15 +1263,24 @@ void R_RenderView( viewDef_t *parms ) {
 
 	// identify all the visible portalAreas, and the entityDefs and
 	// lightDefs that are in them and pass culling.
+	double phaseStart = R_BeginFrontEndPhase();
 	static_cast<idRenderWorldLocal *>(parms->renderWorld)->FindViewLightsAndEntities();
+	R_EndFrontEndPhase( FE_PHASE_PORTAL_FLOW, phaseStart );
 
 	// constrain the view frustum to the view lights and entities
 	R_ConstrainViewFrustum();
 
+	// drop the lights and entities that are hidden behind the world geometry
+	phaseStart = R_BeginFrontEndPhase();
+	R_OcclusionCullViewLightsAndEntities();
+	R_EndFrontEndPhase( FE_PHASE_OCCLUSION, phaseStart );
+
 	// make sure that interactions exist for all light / entity combinations
 	// that are visible
 	// add any pre-generated light shadows, and calculate the light shader values
+	phaseStart = R_BeginFrontEndPhase();
 	R_AddLightSurfaces();
+	R_EndFrontEndPhase( FE_PHASE_LIGHT_SURFACES, phaseStart );
 
 	// adds ambient surfaces and create any necessary interaction surfaces to add to the light
 	// lists
@@ -1122,7 +1290,9 @@ void R_RenderView( viewDef_t *parms ) {
 	R_RemoveUnecessaryViewLights();
 
 	// sort all the ambient surfaces for translucency ordering
+	phaseStart = R_BeginFrontEndPhase();
 	R_SortDrawSurfs();
+	R_EndFrontEndPhase( FE_PHASE_SORT, phaseStart );
 
 	// generate any subviews (mirrors, cameras, etc) before adding this view
 	if ( R_GenerateSubViews() ) {
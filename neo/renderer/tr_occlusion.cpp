@@ -0,0 +1,509 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+===========================================================================================
+
+SOFTWARE OCCLUSION CULLING
+
+The opaque surfaces of the visible world areas are rasterized into a small
+depth buffer, then the bounds of every viewEntity and viewLight are tested
+against it.  The test errs on the side of visibility: the occluders are
+written with the farthest depth they have inside each pixel, the buffer is
+eroded so partially covered pixels count as empty, and a box is only occluded
+if its nearest corner is behind the occluders on every pixel it touches.
+
+The buffer holds 1/w of the nearest occluder, which is linear in screen space,
+and 0 where nothing was drawn.
+
+===========================================================================================
+*/
+
+static const int	OCCLUSION_BUFFER_WIDTH	= 256;
+static const int	OCCLUSION_BUFFER_HEIGHT	= 128;
+
+// fixed point precision of the rasterizer, and the largest buffer
+// coordinate that can't overflow the 64 bit edge functions
+static const int	OCCLUSION_SUBPIXELS		= 16;
+static const float	OCCLUSION_GUARD_BAND	= 1 << 20;
+
+// a box must be this much behind the occluders, relative to its depth
+static const float	OCCLUSION_DEPTH_EPSILON	= 0.001f;
+
+typedef struct {
+	float *			depth;					// OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT
+	float			worldToClip[16];
+	float			nearW;					// anything closer is near clipped
+	float			windowToBufferX;		// buffer pixels per window pixel
+	float			windowToBufferY;
+} occlusionBuffer_t;
+
+/*
+==================
+R_OcclusionClipToBuffer
+
+Converts a clip space point that is in front of the near plane to buffer
+pixels and 1/w
+==================
+*/
+static ID_INLINE void R_OcclusionClipToBuffer( const idVec4 &clip, idVec3 &out ) {
+	float invW = 1.0f / clip.w;
+	out.x = ( 0.5f + 0.5f * clip.x * invW ) * OCCLUSION_BUFFER_WIDTH;
+	out.y = ( 0.5f + 0.5f * clip.y * invW ) * OCCLUSION_BUFFER_HEIGHT;
+	out.z = invW;
+}
+
+/*
+==================
+R_OcclusionTransform
+==================
+*/
+static ID_INLINE void R_OcclusionTransform( const float m[16], const idVec3 &in, idVec4 &out ) {
+	out.x = in.x * m[0] + in.y * m[4] + in.z * m[8] + m[12];
+	out.y = in.x * m[1] + in.y * m[5] + in.z * m[9] + m[13];
+	out.z = in.x * m[2] + in.y * m[6] + in.z * m[10] + m[14];
+	out.w = in.x * m[3] + in.y * m[7] + in.z * m[11] + m[15];
+}
+
+/*
+==================
+R_OcclusionRasterizeTriangle
+
+Takes buffer space vertices, the winding doesn't matter because back faces
+have already been rejected in world space.
+
+Coverage is sampled at pixel centers with exact fixed point edge functions
+and a tie rule, so triangles that share an edge leave no cracks.  Each covered
+pixel gets the farthest depth of the triangle plane inside the pixel.
+==================
+*/
+static void R_OcclusionRasterizeTriangle( occlusionBuffer_t *buffer, const idVec3 &a, const idVec3 &b, const idVec3 &c ) {
+	const idVec3 *v[3] = { &a, &b, &c };
+	int64 fx[3], fy[3];
+
+	for ( int i = 0 ; i < 3 ; i++ ) {
+		// too far outside the guard band for the fixed point math
+		if ( idMath::Fabs( v[i]->x ) > OCCLUSION_GUARD_BAND || idMath::Fabs( v[i]->y ) > OCCLUSION_GUARD_BAND ) {
+			return;
+		}
+		fx[i] = idMath::FtoiFast( v[i]->x * OCCLUSION_SUBPIXELS );
+		fy[i] = idMath::FtoiFast( v[i]->y * OCCLUSION_SUBPIXELS );
+	}
+
+	int64 area = ( fx[1] - fx[0] ) * ( fy[2] - fy[0] ) - ( fx[2] - fx[0] ) * ( fy[1] - fy[0] );
+	if ( area == 0 ) {
+		return;
+	}
+	if ( area < 0 ) {
+		idSwap( v[1], v[2] );
+		idSwap( fx[1], fx[2] );
+		idSwap( fy[1], fy[2] );
+		area = -area;
+	}
+
+	int minX = idMath::FtoiFast( idMath::Floor( Min3( v[0]->x, v[1]->x, v[2]->x ) ) );
+	int maxX = idMath::FtoiFast( idMath::Ceil( Max3( v[0]->x, v[1]->x, v[2]->x ) ) );
+	int minY = idMath::FtoiFast( idMath::Floor( Min3( v[0]->y, v[1]->y, v[2]->y ) ) );
+	int maxY = idMath::FtoiFast( idMath::Ceil( Max3( v[0]->y, v[1]->y, v[2]->y ) ) );
+	minX = Max( minX, 0 );
+	minY = Max( minY, 0 );
+	maxX = Min( maxX, OCCLUSION_BUFFER_WIDTH - 1 );
+	maxY = Min( maxY, OCCLUSION_BUFFER_HEIGHT - 1 );
+	if ( minX > maxX || minY > maxY ) {
+		return;
+	}
+
+	// edge functions at the center of the first pixel, positive inside
+	int64 edgeStart[3], edgeStepX[3], edgeStepY[3];
+	int64 sampleX = minX * OCCLUSION_SUBPIXELS + OCCLUSION_SUBPIXELS / 2;
+	int64 sampleY = minY * OCCLUSION_SUBPIXELS + OCCLUSION_SUBPIXELS / 2;
+	for ( int i = 0 ; i < 3 ; i++ ) {
+		int j = ( i + 1 ) % 3;
+		int64 dx = fx[j] - fx[i];
+		int64 dy = fy[j] - fy[i];
+		edgeStart[i] = dx * ( sampleY - fy[i] ) - dy * ( sampleX - fx[i] );
+		edgeStepX[i] = -dy * OCCLUSION_SUBPIXELS;
+		edgeStepY[i] = dx * OCCLUSION_SUBPIXELS;
+		// samples exactly on an edge belong to only one of the two triangles sharing it
+		if ( !( dy > 0 || ( dy == 0 && dx < 0 ) ) ) {
+			edgeStart[i] -= 1;
+		}
+	}
+
+	// the depth plane, moved to the farthest value inside each pixel
+	float det = ( v[1]->x - v[0]->x ) * ( v[2]->y - v[0]->y ) - ( v[2]->x - v[0]->x ) * ( v[1]->y - v[0]->y );
+	if ( det <= 0.0f ) {
+		return;
+	}
+	float invDet = 1.0f / det;
+	float dzdx = ( ( v[1]->z - v[0]->z ) * ( v[2]->y - v[0]->y ) - ( v[2]->z - v[0]->z ) * ( v[1]->y - v[0]->y ) ) * invDet;
+	float dzdy = ( ( v[2]->z - v[0]->z ) * ( v[1]->x - v[0]->x ) - ( v[1]->z - v[0]->z ) * ( v[2]->x - v[0]->x ) ) * invDet;
+	float dzc = v[0]->z - dzdx * v[0]->x - dzdy * v[0]->y - 0.5f * ( idMath::Fabs( dzdx ) + idMath::Fabs( dzdy ) );
+	float minZ = Min3( v[0]->z, v[1]->z, v[2]->z );
+
+	for ( int y = minY ; y <= maxY ; y++ ) {
+		int64 e0 = edgeStart[0];
+		int64 e1 = edgeStart[1];
+		int64 e2 = edgeStart[2];
+		float z = dzdx * ( minX + 0.5f ) + dzdy * ( y + 0.5f ) + dzc;
+		float *row = buffer->depth + y * OCCLUSION_BUFFER_WIDTH;
+
+		for ( int x = minX ; x <= maxX ; x++ ) {
+			if ( ( e0 | e1 | e2 ) >= 0 ) {
+				float d = Max( z, minZ );
+				if ( d > row[x] ) {
+					row[x] = d;
+				}
+			}
+			e0 += edgeStepX[0];
+			e1 += edgeStepX[1];
+			e2 += edgeStepX[2];
+			z += dzdx;
+		}
+
+		edgeStart[0] += edgeStepY[0];
+		edgeStart[1] += edgeStepY[1];
+		edgeStart[2] += edgeStepY[2];
+	}
+}
+
+/*
+==================
+R_OcclusionErodeBuffer
+
+A pixel with a covered center can still be partially uncovered at an occluder
+silhouette.  Taking the farthest depth of the 3x3 neighborhood makes sure a
+pixel is only treated as hidden if the occluders cover all of it.
+==================
+*/
+static void R_OcclusionErodeBuffer( occlusionBuffer_t *buffer ) {
+	float *depth = buffer->depth;
+	float *temp = (float *)R_FrameAlloc( OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT * sizeof( float ) );
+
+	for ( int y = 0 ; y < OCCLUSION_BUFFER_HEIGHT ; y++ ) {
+		const float *in = depth + y * OCCLUSION_BUFFER_WIDTH;
+		float *out = temp + y * OCCLUSION_BUFFER_WIDTH;
+		for ( int x = 0 ; x < OCCLUSION_BUFFER_WIDTH ; x++ ) {
+			float d = in[x];
+			if ( x > 0 ) {
+				d = Min( d, in[x - 1] );
+			}
+			if ( x < OCCLUSION_BUFFER_WIDTH - 1 ) {
+				d = Min( d, in[x + 1] );
+			}
+			out[x] = d;
+		}
+	}
+
+	for ( int y = 0 ; y < OCCLUSION_BUFFER_HEIGHT ; y++ ) {
+		const float *in = temp + y * OCCLUSION_BUFFER_WIDTH;
+		const float *above = ( y > 0 ) ? in - OCCLUSION_BUFFER_WIDTH : in;
+		const float *below = ( y < OCCLUSION_BUFFER_HEIGHT - 1 ) ? in + OCCLUSION_BUFFER_WIDTH : in;
+		float *out = depth + y * OCCLUSION_BUFFER_WIDTH;
+		for ( int x = 0 ; x < OCCLUSION_BUFFER_WIDTH ; x++ ) {
+			out[x] = Min3( above[x], in[x], below[x] );
+		}
+	}
+}
+
+/*
+==================
+R_OcclusionDrawClippedTriangle
+
+Clips a clip space triangle to the near plane and rasterizes the result.
+==================
+*/
+static void R_OcclusionDrawClippedTriangle( occlusionBuffer_t *buffer, const idVec4 &a, const idVec4 &b, const idVec4 &c ) {
+	const idVec4 *in[3] = { &a, &b, &c };
+	idVec4	clipped[4];
+	idVec3	screen[4];
+	int		numClipped = 0;
+
+	for ( int i = 0 ; i < 3 ; i++ ) {
+		const idVec4 &p = *in[i];
+		const idVec4 &q = *in[( i + 1 ) % 3];
+		float dp = p.w - buffer->nearW;
+		float dq = q.w - buffer->nearW;
+
+		if ( dp >= 0.0f ) {
+			clipped[numClipped++] = p;
+		}
+		if ( ( dp >= 0.0f ) != ( dq >= 0.0f ) ) {
+			float f = dp / ( dp - dq );
+			clipped[numClipped++] = p + f * ( q - p );
+		}
+	}
+
+	if ( numClipped < 3 ) {
+		return;
+	}
+
+	for ( int i = 0 ; i < numClipped ; i++ ) {
+		R_OcclusionClipToBuffer( clipped[i], screen[i] );
+	}
+	for ( int i = 2 ; i < numClipped ; i++ ) {
+		R_OcclusionRasterizeTriangle( buffer, screen[0], screen[i - 1], screen[i] );
+	}
+}
+
+/*
+==================
+R_OcclusionIsOccluder
+
+Only surfaces that are guaranteed to be drawn solid can hide anything.
+==================
+*/
+static bool R_OcclusionIsOccluder( const idMaterial *shader ) {
+	if ( !shader || !shader->IsDrawn() ) {
+		return false;
+	}
+	if ( shader->Coverage() != MC_OPAQUE || shader->GetSort() != SS_OPAQUE ) {
+		return false;
+	}
+	if ( shader->Deform() != DFRM_NONE || shader->HasSubview() ) {
+		return false;
+	}
+	return true;
+}
+
+/*
+==================
+R_OcclusionDrawArea
+
+Rasterizes the opaque, front facing triangles of a world area model.
+==================
+*/
+static void R_OcclusionDrawArea( occlusionBuffer_t *buffer, const viewEntity_t *vEntity ) {
+	const idRenderEntityLocal *def = vEntity->entityDef;
+	const idRenderModel *model = def->parms.hModel;
+	float localToClip[16];
+	idVec3 localViewOrigin;
+
+	R_MatrixMultiply( vEntity->modelMatrix, buffer->worldToClip, localToClip );
+	R_GlobalPointToLocal( vEntity->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin );
+
+	for ( int i = 0 ; i < model->NumSurfaces() ; i++ ) {
+		const modelSurface_t *surf = model->Surface( i );
+		const srfTriangles_t *tri = surf->geometry;
+
+		if ( !tri || !tri->numIndexes || !R_OcclusionIsOccluder( surf->shader ) ) {
+			continue;
+		}
+		if ( R_CullLocalBox( tri->bounds, vEntity->modelMatrix, 5, tr.viewDef->frustum ) ) {
+			continue;
+		}
+
+		idVec4 *clip = (idVec4 *)R_FrameAlloc( tri->numVerts * sizeof( clip[0] ) );
+		for ( int j = 0 ; j < tri->numVerts ; j++ ) {
+			R_OcclusionTransform( localToClip, tri->verts[j].xyz, clip[j] );
+		}
+
+		bool twoSided = ( surf->shader->GetCullType() == CT_TWO_SIDED );
+
+		for ( int j = 0 ; j < tri->numIndexes ; j += 3 ) {
+			int i0 = tri->indexes[j + 0];
+			int i1 = tri->indexes[j + 1];
+			int i2 = tri->indexes[j + 2];
+
+			if ( !twoSided ) {
+				const idVec3 &p0 = tri->verts[i0].xyz;
+				idVec3 normal = ( tri->verts[i2].xyz - p0 ).Cross( tri->verts[i1].xyz - p0 );
+				if ( normal * ( localViewOrigin - p0 ) <= 0.0f ) {
+					continue;
+				}
+			}
+
+			const idVec4 &c0 = clip[i0];
+			const idVec4 &c1 = clip[i1];
+			const idVec4 &c2 = clip[i2];
+
+			// completely outside a side of the view frustum
+			if ( ( c0.x > c0.w && c1.x > c1.w && c2.x > c2.w ) || ( c0.x < -c0.w && c1.x < -c1.w && c2.x < -c2.w ) ||
+					( c0.y > c0.w && c1.y > c1.w && c2.y > c2.w ) || ( c0.y < -c0.w && c1.y < -c1.w && c2.y < -c2.w ) ) {
+				continue;
+			}
+
+			tr.pc.c_occluderTris++;
+
+			R_OcclusionDrawClippedTriangle( buffer, c0, c1, c2 );
+		}
+	}
+}
+
+/*
+==================
+R_OcclusionTestBox
+
+Returns true if the box is completely hidden by the occluders on all
+the pixels of the screen rect.
+==================
+*/
+static bool R_OcclusionTestBox( const occlusionBuffer_t *buffer, const idBounds &bounds, const float modelMatrix[16], const idScreenRect &scissor ) {
+	float localToClip[16];
+	idVec3 corner;
+	idVec4 clip;
+	idVec3 screen;
+	float minX, minY, maxX, maxY, nearZ;
+
+	if ( scissor.IsEmpty() ) {
+		return false;
+	}
+
+	R_MatrixMultiply( modelMatrix, buffer->worldToClip, localToClip );
+
+	minX = minY = idMath::INFINITY;
+	maxX = maxY = -idMath::INFINITY;
+	nearZ = 0.0f;
+	for ( int i = 0 ; i < 8 ; i++ ) {
+		corner[0] = bounds[( i >> 0 ) & 1][0];
+		corner[1] = bounds[( i >> 1 ) & 1][1];
+		corner[2] = bounds[( i >> 2 ) & 1][2];
+
+		R_OcclusionTransform( localToClip, corner, clip );
+
+		// the box reaches the near plane, so it is never hidden
+		if ( clip.w < buffer->nearW ) {
+			return false;
+		}
+
+		R_OcclusionClipToBuffer( clip, screen );
+		minX = Min( minX, screen.x );
+		minY = Min( minY, screen.y );
+		maxX = Max( maxX, screen.x );
+		maxY = Max( maxY, screen.y );
+		nearZ = Max( nearZ, screen.z );
+	}
+	nearZ += nearZ * OCCLUSION_DEPTH_EPSILON;
+
+	// all pixels touched by the box, cropped to the portal scissor
+	int x1 = Max( idMath::FtoiFast( idMath::Floor( minX ) ), idMath::FtoiFast( idMath::Floor( scissor.x1 * buffer->windowToBufferX ) ) );
+	int y1 = Max( idMath::FtoiFast( idMath::Floor( minY ) ), idMath::FtoiFast( idMath::Floor( scissor.y1 * buffer->windowToBufferY ) ) );
+	int x2 = Min( idMath::FtoiFast( idMath::Floor( maxX ) ), idMath::FtoiFast( idMath::Ceil( ( scissor.x2 + 1 ) * buffer->windowToBufferX ) ) - 1 );
+	int y2 = Min( idMath::FtoiFast( idMath::Floor( maxY ) ), idMath::FtoiFast( idMath::Ceil( ( scissor.y2 + 1 ) * buffer->windowToBufferY ) ) - 1 );
+	x1 = Max( x1, 0 );
+	y1 = Max( y1, 0 );
+	x2 = Min( x2, OCCLUSION_BUFFER_WIDTH - 1 );
+	y2 = Min( y2, OCCLUSION_BUFFER_HEIGHT - 1 );
+	if ( x1 > x2 || y1 > y2 ) {
+		// off screen, leave it to the frustum and scissor culling
+		return false;
+	}
+
+	for ( int y = y1 ; y <= y2 ; y++ ) {
+		const float *row = buffer->depth + y * OCCLUSION_BUFFER_WIDTH;
+		for ( int x = x1 ; x <= x2 ; x++ ) {
+			if ( row[x] <= nearZ ) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+/*
+==================
+R_OcclusionCullViewLightsAndEntities
+
+Called after FindViewLightsAndEntities, before any interactions or shadows are
+created.  Hidden lights are removed from the viewLights list.  Hidden entities
+get an empty scissor rect, so they don't add ambient or lit surfaces, but can
+still cast shadows onto visible surfaces.
+==================
+*/
+void R_OcclusionCullViewLightsAndEntities( void ) {
+	occlusionBuffer_t	buffer;
+	viewEntity_t		*vEntity;
+	viewLight_t			*vLight, **ptr;
+	int					numOccluders;
+
+	PROFILE_SCOPE( "R_OcclusionCullViewLightsAndEntities" );
+
+	if ( !r_useOcclusionCulling.GetBool() ) {
+		return;
+	}
+
+	// mirrors and remote views are cheap enough, and their
+	// clip planes and xray entities make the occluders unreliable
+	if ( tr.viewDef->isSubview || tr.viewDef->areaNum < 0 ) {
+		return;
+	}
+
+	R_MatrixMultiply( tr.viewDef->worldSpace.modelViewMatrix, tr.viewDef->projectionMatrix, buffer.worldToClip );
+	buffer.nearW = r_znear.GetFloat();
+	if ( tr.viewDef->renderView.cramZNear ) {
+		buffer.nearW *= 0.25f;
+	}
+	buffer.windowToBufferX = (float)OCCLUSION_BUFFER_WIDTH / ( tr.viewDef->viewport.x2 - tr.viewDef->viewport.x1 );
+	buffer.windowToBufferY = (float)OCCLUSION_BUFFER_HEIGHT / ( tr.viewDef->viewport.y2 - tr.viewDef->viewport.y1 );
+	buffer.depth = (float *)R_ClearedFrameAlloc( OCCLUSION_BUFFER_WIDTH * OCCLUSION_BUFFER_HEIGHT * sizeof( float ) );
+
+	// the world area models are the occluders, anything else
+	// may be hidden, skinned or moved by the game
+	numOccluders = 0;
+	for ( vEntity = tr.viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+		const idRenderModel *model = vEntity->entityDef->parms.hModel;
+		if ( !model || !model->IsStaticWorldModel() || idStr::Cmpn( model->Name(), "_area", 5 ) != 0 ) {
+			continue;
+		}
+		R_OcclusionDrawArea( &buffer, vEntity );
+		numOccluders++;
+	}
+	if ( !numOccluders ) {
+		return;
+	}
+
+	R_OcclusionErodeBuffer( &buffer );
+
+	for ( vEntity = tr.viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+		const idRenderEntityLocal *def = vEntity->entityDef;
+		if ( R_OcclusionTestBox( &buffer, def->referenceBounds, def->modelMatrix, vEntity->scissorRect ) ) {
+			vEntity->scissorRect.Clear();
+			tr.pc.c_occludedEntities++;
+		}
+	}
+
+	// removed lights won't create interactions, same as lights
+	// that are turned off in R_AddLightSurfaces
+	ptr = &tr.viewDef->viewLights;
+	while ( ( vLight = *ptr ) != NULL ) {
+		idRenderLightLocal *light = vLight->lightDef;
+		if ( R_OcclusionTestBox( &buffer, light->frustumTris->bounds, mat4_identity.ToFloatPtr(), vLight->scissorRect ) ) {
+			*ptr = vLight->next;
+			light->viewCount = -1;
+			tr.pc.c_occludedLights++;
+			continue;
+		}
+		ptr = &vLight->next;
+	}
+}
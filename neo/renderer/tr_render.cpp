@@ -49,6 +49,12 @@ This should never happen if the vertex cache is operating properly.
 =================
 */
 void RB_DrawElementsImmediate( const srfTriangles_t *tri ) {
+	// GPU skinned surfaces only have CPU positions when the front end asked for them,
+	// a pass that gets here without them is missing from R_SkinTriSurfVerts' callers
+	if ( tri->skinnedDeformInfo != NULL && !tri->skinnedVertsValid ) {
+		common->DWarning( "RB_DrawElementsImmediate: skinned surface without CPU vertexes, %i indexes not drawn", tri->numIndexes );
+		return;
+	}
 
 	backEnd.pc.c_drawElements++;
 	backEnd.pc.c_drawIndexes += tri->numIndexes;
@@ -72,12 +78,79 @@ void RB_DrawElementsImmediate( const srfTriangles_t *tri ) {
 }
 
 
+static const float zero[4] = { 0, 0, 0, 0 };
+static const float one[4] = { 1, 1, 1, 1 };
+
+static idVec4	rb_skinningColorModulate;
+static idVec4	rb_skinningColorAdd;
+
+/*
+================
+RB_BindSkinning
+
+GPU skinned surfaces draw the bind pose vertexes of the ambient surface,
+the joint indexes and weights follow them in the same vertex cache block
+and take the place of the vertex color.
+
+Only the drawSurf's frame memory copy of the header is read here, see
+R_SnapshotTriSurf, the front end of the next frame rewrites the surfaces.
+================
+*/
+static void RB_BindSkinning( const srfTriangles_t *tri ) {
+	const deformInfo_t *deform = tri->skinnedDeformInfo;
+	const vertCache_t *jointCache = tri->jointCache;
+
+	byte *ac = (byte *)vertexCache.Position( tri->ambientCache );
+	skinnedWeight_t *weights = (skinnedWeight_t *)( ac + deform->numOutputVerts * sizeof( idDrawVert ) );
+
+	glVertexAttribPointer( PC_ATTRIB_INDEX_COLOR, 4, GL_UNSIGNED_BYTE, true, sizeof( skinnedWeight_t ), weights->jointIndexes );
+	glVertexAttribPointer( PC_ATTRIB_INDEX_COLOR2, 4, GL_UNSIGNED_BYTE, true, sizeof( skinnedWeight_t ), weights->jointWeights );
+	glEnableVertexAttribArray( PC_ATTRIB_INDEX_COLOR );
+	glEnableVertexAttribArray( PC_ATTRIB_INDEX_COLOR2 );
+
+	glBindBufferRange( GL_UNIFORM_BUFFER, 0, jointCache->vbo, jointCache->offset, MAX_SKINNING_JOINTS * sizeof( idJointMat ) );
+
+	// the vertex color holds the joint indexes
+	rb_skinningColorModulate = *(const idVec4 *)renderProgManager.GetRenderParm( RENDERPARM_VERTEXCOLOR_MODULATE );
+	rb_skinningColorAdd = *(const idVec4 *)renderProgManager.GetRenderParm( RENDERPARM_VERTEXCOLOR_ADD );
+	renderProgManager.SetRenderParm( RENDERPARM_VERTEXCOLOR_MODULATE, zero );
+	renderProgManager.SetRenderParm( RENDERPARM_VERTEXCOLOR_ADD, one );
+	renderProgManager.SetRenderParm( RENDERPARM_ENABLE_SKINNING, one );
+}
+
+/*
+================
+RB_UnbindSkinning
+================
+*/
+static void RB_UnbindSkinning( const srfTriangles_t *tri ) {
+	idDrawVert *ac = (idDrawVert *)vertexCache.Position( tri->ambientCache );
+
+	glVertexAttribPointer( PC_ATTRIB_INDEX_COLOR, 4, GL_UNSIGNED_BYTE, false, sizeof( idDrawVert ), (void *)&ac->color );
+	if ( !backEnd.glState.colorArrayEnabled ) {
+		glDisableVertexAttribArray( PC_ATTRIB_INDEX_COLOR );
+	}
+	glDisableVertexAttribArray( PC_ATTRIB_INDEX_COLOR2 );
+
+	renderProgManager.SetRenderParm( RENDERPARM_VERTEXCOLOR_MODULATE, rb_skinningColorModulate.ToFloatPtr() );
+	renderProgManager.SetRenderParm( RENDERPARM_VERTEXCOLOR_ADD, rb_skinningColorAdd.ToFloatPtr() );
+	renderProgManager.SetRenderParm( RENDERPARM_ENABLE_SKINNING, zero );
+}
+
 /*
 ================
 RB_DrawElementsWithCounters
 ================
 */
 void RB_DrawElementsWithCounters( const srfTriangles_t *tri ) {
+	const bool skinned = ( tri->skinnedDeformInfo != NULL && tri->jointCache != NULL );
+
+	if ( skinned && !renderProgManager.ShaderUsesJoints() ) {
+		// fixed function passes can't blend the joints, the front end
+		// skins the vertexes on the CPU for fog and blend lights
+		RB_DrawElementsImmediate( tri );
+		return;
+	}
 
 	backEnd.pc.c_drawElements++;
 	backEnd.pc.c_drawIndexes += tri->numIndexes;
@@ -92,6 +165,10 @@ void RB_DrawElementsWithCounters( const srfTriangles_t *tri ) {
 		}
 	}
 
+	if ( skinned ) {
+		RB_BindSkinning( tri );
+	}
+
 	renderProgManager.CommitUniforms();
 
 	if ( tri->indexCache ) {
@@ -109,6 +186,10 @@ void RB_DrawElementsWithCounters( const srfTriangles_t *tri ) {
 						GL_INDEX_TYPE,
 						tri->indexes );
 	}
+
+	if ( skinned ) {
+		RB_UnbindSkinning( tri );
+	}
 }
 
 /*
@@ -771,8 +852,6 @@ void RB_DrawView( const void *data ) {
 
 	backEnd.pc.c_surfaces += backEnd.viewDef->numDrawSurfs;
 
-	RB_ShowOverdraw();
-
 	// render the scene, jumping to the hardware specific interaction renderers
 	RB_STD_DrawView();
 
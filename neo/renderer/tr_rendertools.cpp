@@ -296,10 +296,12 @@ static void R_ColorByStencilBuffer( void ) {
 
 /*
 ==================
-RB_ShowOverdraw
+R_ShowOverdraw
+
+Rewrites the draw surface list of the view, so it runs in the front end
 ==================
 */
-void RB_ShowOverdraw( void ) {
+static void R_ShowOverdraw( viewDef_t *viewDef ) {
 	const idMaterial *	material;
 	int					i;
 	drawSurf_t * *		drawSurfs;
@@ -316,11 +318,11 @@ void RB_ShowOverdraw( void ) {
 		return;
 	}
 
-	drawSurfs = backEnd.viewDef->drawSurfs;
-	numDrawSurfs = backEnd.viewDef->numDrawSurfs;
+	drawSurfs = viewDef->drawSurfs;
+	numDrawSurfs = viewDef->numDrawSurfs;
 
 	int interactions = 0;
-	for ( vLight = backEnd.viewDef->viewLights; vLight; vLight = vLight->next ) {
+	for ( vLight = viewDef->viewLights; vLight; vLight = vLight->next ) {
 		for ( surf = vLight->localInteractions; surf; surf = surf->nextOnLight ) {
 			interactions++;
 		}
@@ -329,7 +331,7 @@ void RB_ShowOverdraw( void ) {
 		}
 	}
 
-	drawSurf_t **newDrawSurfs = (drawSurf_t **)R_FrameAlloc( numDrawSurfs + interactions * sizeof( newDrawSurfs[0] ) );
+	drawSurf_t **newDrawSurfs = (drawSurf_t **)R_FrameAlloc( ( numDrawSurfs + interactions ) * sizeof( newDrawSurfs[0] ) );
 
 	for ( i = 0; i < numDrawSurfs; i++ ) {
 		surf = drawSurfs[i];
@@ -339,7 +341,7 @@ void RB_ShowOverdraw( void ) {
 		newDrawSurfs[i] = const_cast<drawSurf_t *>(surf);
 	}
 
-	for ( vLight = backEnd.viewDef->viewLights; vLight; vLight = vLight->next ) {
+	for ( vLight = viewDef->viewLights; vLight; vLight = vLight->next ) {
 		for ( surf = vLight->localInteractions; surf; surf = surf->nextOnLight ) {
 			const_cast<drawSurf_t *>(surf)->material = material;
 			newDrawSurfs[i++] = const_cast<drawSurf_t *>(surf);
@@ -354,20 +356,47 @@ void RB_ShowOverdraw( void ) {
 
 	switch( r_showOverDraw.GetInteger() ) {
 		case 1: // geometry overdraw
-			const_cast<viewDef_t *>(backEnd.viewDef)->drawSurfs = newDrawSurfs;
-			const_cast<viewDef_t *>(backEnd.viewDef)->numDrawSurfs = numDrawSurfs;
+			viewDef->drawSurfs = newDrawSurfs;
+			viewDef->numDrawSurfs = numDrawSurfs;
 			break;
 		case 2: // light interaction overdraw
-			const_cast<viewDef_t *>(backEnd.viewDef)->drawSurfs = &newDrawSurfs[numDrawSurfs];
-			const_cast<viewDef_t *>(backEnd.viewDef)->numDrawSurfs = interactions;
+			viewDef->drawSurfs = &newDrawSurfs[numDrawSurfs];
+			viewDef->numDrawSurfs = interactions;
 			break;
 		case 3: // geometry + light interaction overdraw
-			const_cast<viewDef_t *>(backEnd.viewDef)->drawSurfs = newDrawSurfs;
-			const_cast<viewDef_t *>(backEnd.viewDef)->numDrawSurfs += interactions;
+			viewDef->drawSurfs = newDrawSurfs;
+			viewDef->numDrawSurfs += interactions;
 			break;
 	}
 }
 
+/*
+==================
+R_PrepareDebugTools
+
+Called by the front end for every view it adds.  The debug tools that
+change the view or need front end data do that work here, the back end
+may be running on the render thread.
+==================
+*/
+void R_PrepareDebugTools( viewDef_t *viewDef ) {
+	R_ShowOverdraw( viewDef );
+
+	if ( r_showViewEntitys.GetBool() ) {
+		for ( viewEntity_t *vEntity = viewDef->viewEntitys ; vEntity ; vEntity = vEntity->next ) {
+			vEntity->modelBounds.Clear();
+			if ( !vEntity->entityDef ) {
+				continue;
+			}
+			idRenderModel *model = R_EntityDefDynamicModel( vEntity->entityDef );
+			if ( !model ) {
+				continue;	// particles won't instantiate without a current view
+			}
+			vEntity->modelBounds = model->Bounds( &vEntity->entityDef->parms );
+		}
+	}
+}
+
 /*
 ===================
 RB_ShowIntensity
@@ -865,8 +894,6 @@ static void RB_ShowViewEntitys( viewEntity_t *vModels ) {
 	glDisable( GL_SCISSOR_TEST );
 
 	for ( ; vModels ; vModels = vModels->next ) {
-		idBounds	b;
-
 		glLoadMatrixf( vModels->modelViewMatrix );
 
 		if ( !vModels->entityDef ) {
@@ -878,15 +905,12 @@ static void RB_ShowViewEntitys( viewEntity_t *vModels ) {
 		RB_DrawBounds( vModels->entityDef->referenceBounds );
 
 
-		// draw the model bounds in white
-		glColor3f( 1, 1, 1 );
-
-		idRenderModel *model = R_EntityDefDynamicModel( vModels->entityDef );
-		if ( !model ) {
-			continue;	// particles won't instantiate without a current view
+		// draw the model bounds in white, R_PrepareDebugTools got them from the front end
+		if ( vModels->modelBounds.IsCleared() ) {
+			continue;
 		}
-		b = model->Bounds( &vModels->entityDef->parms );
-		RB_DrawBounds( b );
+		glColor3f( 1, 1, 1 );
+		RB_DrawBounds( vModels->modelBounds );
 	}
 
 	glEnable( GL_DEPTH_TEST );
@@ -641,36 +641,36 @@ for each silhouette edge in the light
 */
 static void R_AddSilEdges( const srfTriangles_t *tri, unsigned short *pointCull, const idPlane frustum[6] ) {
 	int		v1, v2;
-	int		i;
-	silEdge_t	*sil;
-	int		numPlanes;
-
-	numPlanes = tri->numIndexes / 3;
+	int		i, numSilIndexes;
+	int		*silIndexes;
+	const silEdge_t	*sil;
 
-	// add sil edges for any true silhouette boundaries on the surface
+#ifdef _DEBUG
+	int numPlanes = tri->numIndexes / 3;
 	for ( i = 0 ; i < tri->numSilEdges ; i++ ) {
 		sil = tri->silEdges + i;
 		if ( sil->p1 < 0 || sil->p1 > numPlanes || sil->p2 < 0 || sil->p2 > numPlanes ) {
 			common->Error( "Bad sil planes" );
 		}
+	}
+#endif
 
-		// an edge will be a silhouette edge if the face on one side
-		// casts a shadow, but the face on the other side doesn't.
-		// "casts a shadow" means that it has some surface in the projection,
-		// not just that it has the correct facing direction
-		// This will cause edges that are exactly on the frustum plane
-		// to be considered sil edges if the face inside casts a shadow.
-		if ( !( faceCastsShadow[ sil->p1 ] ^ faceCastsShadow[ sil->p2 ] ) ) {
-			continue;
-		}
+	// an edge will be a silhouette edge if the face on one side
+	// casts a shadow, but the face on the other side doesn't.
+	// "casts a shadow" means that it has some surface in the projection,
+	// not just that it has the correct facing direction
+	// This will cause edges that are exactly on the frustum plane
+	// to be considered sil edges if the face inside casts a shadow.
+	// If the edge is completely off the negative side of
+	// a frustum plane, don't add it at all.  This can still
+	// happen even if the face is visible and casting a shadow
+	// if it is partially clipped
+	silIndexes = (int *)_alloca16( tri->numSilEdges * sizeof( silIndexes[0] ) );
+	numSilIndexes = SIMDProcessor->ShadowSilEdgeCull( silIndexes, tri->silEdges, tri->numSilEdges, faceCastsShadow, pointCull );
 
-		// if the edge is completely off the negative side of
-		// a frustum plane, don't add it at all.  This can still
-		// happen even if the face is visible and casting a shadow
-		// if it is partially clipped
-		if ( EDGE_CULLED( sil->v1, sil->v2 ) ) {
-			continue;
-		}
+	// add sil edges for any true silhouette boundaries on the surface
+	for ( i = 0 ; i < numSilIndexes ; i++ ) {
+		sil = tri->silEdges + silIndexes[i];
 
 		// see if the edge needs to be clipped
 		if ( EDGE_CLIPPED( sil->v1, sil->v2 ) ) {
@@ -751,8 +751,6 @@ Also inits the remap[] array to all -1
 static void R_CalcPointCull( const srfTriangles_t *tri, const idPlane frustum[6], unsigned short *pointCull ) {
 	int i;
 	int frontBits;
-	float *planeSide;
-	byte *side1, *side2;
 
 	SIMDProcessor->Memset( remap, -1, tri->numVerts * sizeof( remap[0] ) );
 
@@ -763,35 +761,16 @@ static void R_CalcPointCull( const srfTriangles_t *tri, const idPlane frustum[6]
 		}
 	}
 
-	// initialize point cull
-	for ( i = 0; i < tri->numVerts; i++ ) {
-		pointCull[i] = frontBits;
-	}
-
-	// if the surface is not completely inside the light frustum
+	// if the surface is completely inside the light frustum
 	if ( frontBits == ( ( ( 1 << 6 ) - 1 ) ) << 6 ) {
+		for ( i = 0; i < tri->numVerts; i++ ) {
+			pointCull[i] = frontBits;
+		}
 		return;
 	}
 
-	planeSide = (float *) _alloca16( tri->numVerts * sizeof( float ) );
-	side1 = (byte *) _alloca16( tri->numVerts * sizeof( byte ) );
-	side2 = (byte *) _alloca16( tri->numVerts * sizeof( byte ) );
-	SIMDProcessor->Memset( side1, 0, tri->numVerts * sizeof( byte ) );
-	SIMDProcessor->Memset( side2, 0, tri->numVerts * sizeof( byte ) );
-
-	for ( i = 0; i < 6; i++ ) {
-
-		if ( frontBits & (1<<(i+6)) ) {
-			continue;
-		}
-
-		SIMDProcessor->Dot( planeSide, frustum[i], tri->verts, tri->numVerts );
-		SIMDProcessor->CmpLT( side1, i, planeSide, LIGHT_CLIP_EPSILON, tri->numVerts );
-		SIMDProcessor->CmpGT( side2, i, planeSide, -LIGHT_CLIP_EPSILON, tri->numVerts );
-	}
-	for ( i = 0; i < tri->numVerts; i++ ) {
-		pointCull[i] |= side1[i] | (side2[i] << 6);
-	}
+	// test all remaining planes in a single pass over the vertices
+	SIMDProcessor->ShadowPointCull( pointCull, frustum, frontBits, LIGHT_CLIP_EPSILON, tri->verts, tri->numVerts );
 }
 
 /*
@@ -552,6 +552,8 @@ bool R_GenerateSubViews( void ) {
 	bool			subviews;
 	const idMaterial		*shader;
 
+	PROFILE_SCOPE( "R_GenerateSubViews" );
+
 	// for testing the performance hit
 	if ( r_skipSubviews.GetBool() ) {
 		return false;
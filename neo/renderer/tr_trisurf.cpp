@@ -341,11 +341,13 @@ R_FreeStaticTriSurfVertexCaches
 ==============
 */
 void R_FreeStaticTriSurfVertexCaches( srfTriangles_t *tri ) {
-	if ( tri->ambientSurface == NULL ) {
+	if ( tri->ambientSurface == NULL && tri->skinnedDeformInfo == NULL ) {
 		// this is a real model surface
 		vertexCache.Free( tri->ambientCache );
-		tri->ambientCache = NULL;
 	}
+	// a skinned surface references the bind pose cache of its deformInfo
+	tri->ambientCache = NULL;
+	tri->jointCache = NULL;
 	if ( tri->indexCache ) {
 		vertexCache.Free( tri->indexCache );
 		tri->indexCache = NULL;
@@ -412,6 +414,10 @@ void R_ReallyFreeStaticTriSurf( srfTriangles_t *tri ) {
 		triShadowVertexAllocator.Free( tri->shadowVertexes );
 	}
 
+	if ( tri->skinnedJoints != NULL ) {
+		Mem_Free16( tri->skinnedJoints );
+	}
+
 #ifdef _DEBUG
 	memset( tri, 0, sizeof( srfTriangles_t ) );
 #endif
@@ -1639,7 +1645,7 @@ This is called once for static surfaces, and every frame for deforming surfaces
 Builds tangents, normals, and face planes
 ==================
 */
-void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes ) {
+void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes, frontEndJobCounters_t *counters ) {
 	int				i;
 	idPlane			*planes;
 
@@ -1652,7 +1658,11 @@ void R_DeriveTangents( srfTriangles_t *tri, bool allocFacePlanes ) {
 		return;
 	}
 
-	tr.pc.c_tangentIndexes += tri->numIndexes;
+	if ( counters ) {
+		counters->c_tangentIndexes += tri->numIndexes;
+	} else {
+		tr.pc.c_tangentIndexes += tri->numIndexes;
+	}
 
 	if ( !tri->facePlanes && allocFacePlanes ) {
 		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
@@ -2209,12 +2219,124 @@ deformInfo_t *R_BuildDeformInfo( int numVerts, const idDrawVert *verts, int numI
 	return deform;
 }
 
+/*
+===================
+R_BuildDeformInfoSkinning
+
+Keeps a bind pose copy of the surface with normals and tangents, so
+the vertex programs can skin it from a static vertex cache instead of
+uploading deformed vertexes every frame
+===================
+*/
+void R_BuildDeformInfoSkinning( deformInfo_t *deform, const idDrawVert *verts, const skinnedWeight_t *weights ) {
+	srfTriangles_t	tri;
+	int				i, base;
+
+	assert( deform->skinnedVerts == NULL );
+
+	int vertBytes = deform->numOutputVerts * sizeof( deform->skinnedVerts[0] );
+	int weightBytes = deform->numOutputVerts * sizeof( deform->skinnedWeights[0] );
+	byte *data = (byte *)R_StaticAlloc( vertBytes + weightBytes );
+
+	deform->skinnedVerts = (idDrawVert *)data;
+	deform->skinnedWeights = (skinnedWeight_t *)( data + vertBytes );
+
+	SIMDProcessor->Memcpy( deform->skinnedVerts, verts, deform->numSourceVerts * sizeof( deform->skinnedVerts[0] ) );
+	SIMDProcessor->Memcpy( deform->skinnedWeights, weights, deform->numSourceVerts * sizeof( deform->skinnedWeights[0] ) );
+
+	// replicate the mirror seam vertexes
+	base = deform->numOutputVerts - deform->numMirroredVerts;
+	for ( i = 0; i < deform->numMirroredVerts; i++ ) {
+		deform->skinnedVerts[base + i] = deform->skinnedVerts[deform->mirroredVerts[i]];
+		deform->skinnedWeights[base + i] = deform->skinnedWeights[deform->mirroredVerts[i]];
+	}
+
+	// derive normals and tangents the same way the deformed surfaces do
+	memset( &tri, 0, sizeof( tri ) );
+	tri.deformedSurface = true;
+	tri.numVerts = deform->numOutputVerts;
+	tri.verts = deform->skinnedVerts;
+	tri.numIndexes = deform->numIndexes;
+	tri.indexes = deform->indexes;
+	tri.silIndexes = deform->silIndexes;
+	tri.numMirroredVerts = deform->numMirroredVerts;
+	tri.mirroredVerts = deform->mirroredVerts;
+	tri.numDupVerts = deform->numDupVerts;
+	tri.dupVerts = deform->dupVerts;
+	tri.numSilEdges = deform->numSilEdges;
+	tri.silEdges = deform->silEdges;
+	tri.dominantTris = deform->dominantTris;
+
+	R_DeriveTangents( &tri, false );
+}
+
+/*
+===================
+R_SkinTriSurfVerts
+
+GPU skinned surfaces don't transform their vertexes on the CPU.  When something other
+than the vertex programs needs the positions, this blends the bind pose with the joint
+palette the same way the vertex programs do, so shadows match what is drawn.
+===================
+*/
+void R_SkinTriSurfVerts( srfTriangles_t *tri ) {
+	int		i, j;
+
+	if ( tri->skinnedDeformInfo == NULL || tri->skinnedVertsValid ) {
+		return;
+	}
+
+	const deformInfo_t *deform = tri->skinnedDeformInfo;
+
+	assert( tri->numVerts == deform->numOutputVerts );
+
+	for ( i = 0; i < deform->numOutputVerts; i++ ) {
+		const idDrawVert &bindVert = deform->skinnedVerts[i];
+		const skinnedWeight_t &weight = deform->skinnedWeights[i];
+		const idVec4 bindPos( bindVert.xyz.x, bindVert.xyz.y, bindVert.xyz.z, 1.0f );
+
+		idVec3 pos = vec3_origin;
+		for ( j = 0; j < 4; j++ ) {
+			if ( weight.jointWeights[j] != 0 ) {
+				pos += ( tri->skinnedJoints[weight.jointIndexes[j]] * bindPos ) * ( weight.jointWeights[j] * ( 1.0f / 255.0f ) );
+			}
+		}
+		tri->verts[i].xyz = pos;
+		tri->verts[i].st = bindVert.st;
+	}
+
+	tri->facePlanesCalculated = false;
+	tri->skinnedVertsValid = true;
+}
+
+/*
+===================
+R_SkinModelVerts
+
+Makes the positions of all GPU skinned surfaces of an instantiated model valid
+===================
+*/
+void R_SkinModelVerts( idRenderModel *model ) {
+	for ( int i = 0; i < model->NumSurfaces(); i++ ) {
+		srfTriangles_t *tri = model->Surface( i )->geometry;
+		if ( tri != NULL ) {
+			R_SkinTriSurfVerts( tri );
+		}
+	}
+}
+
 /*
 ===================
 R_FreeDeformInfo
 ===================
 */
 void R_FreeDeformInfo( deformInfo_t *deformInfo ) {
+	if ( deformInfo->skinnedCache != NULL ) {
+		vertexCache.Free( deformInfo->skinnedCache );
+	}
+	if ( deformInfo->skinnedVerts != NULL ) {
+		R_StaticFree( deformInfo->skinnedVerts );
+	}
 	if ( deformInfo->indexes != NULL ) {
 		triIndexAllocator.Free( deformInfo->indexes );
 	}
@@ -2262,8 +2384,364 @@ int R_DeformInfoMemoryUsed( deformInfo_t *deformInfo ) {
 	if ( deformInfo->dupVerts != NULL ) {
 		total += deformInfo->numDupVerts * sizeof( deformInfo->dupVerts[0] );
 	}
+	if ( deformInfo->skinnedVerts != NULL ) {
+		total += deformInfo->numOutputVerts * ( sizeof( deformInfo->skinnedVerts[0] ) + sizeof( deformInfo->skinnedWeights[0] ) );
+	}
 
 	total += sizeof( *deformInfo );
 	return total;
 }
 
+
+/*
+===================================================================================
+
+BINARY CACHE
+
+The geometry and everything R_CleanupTriangles derives from it are written as raw
+arrays in native byte order, so the owner of the cache file has to reject files
+written on a machine with a different layout.  The vertex caches are not written,
+they are recreated on demand.
+
+===================================================================================
+*/
+
+/*
+===================
+R_ReadTriSurfCount
+
+Checks the count against the rest of the file before anything is allocated
+===================
+*/
+static bool R_ReadTriSurfCount( idFile *f, int &count, int elementSize ) {
+	if ( f->ReadInt( count ) != sizeof( count ) || count < 0 ) {
+		return false;
+	}
+	return ( count <= ( f->Length() - f->Tell() ) / elementSize );
+}
+
+/*
+===================
+R_ReadTriSurfArray
+===================
+*/
+static bool R_ReadTriSurfArray( idFile *f, void *data, int bytes ) {
+	return ( f->Read( data, bytes ) == bytes );
+}
+
+/*
+===================
+R_WriteStaticTriSurf
+===================
+*/
+void R_WriteStaticTriSurf( idFile *f, const srfTriangles_t *tri ) {
+	f->WriteVec3( tri->bounds[0] );
+	f->WriteVec3( tri->bounds[1] );
+	f->WriteBool( tri->generateNormals );
+	f->WriteBool( tri->tangentsCalculated );
+	f->WriteBool( tri->facePlanesCalculated );
+	f->WriteBool( tri->perfectHull );
+
+	// shadow models made by dmap have only shadow vertexes
+	f->WriteInt( tri->numVerts );
+	f->WriteBool( tri->verts != NULL );
+	if ( tri->verts != NULL ) {
+		f->Write( tri->verts, tri->numVerts * sizeof( tri->verts[0] ) );
+	}
+
+	f->WriteInt( tri->numIndexes );
+	f->Write( tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) );
+
+	f->WriteBool( tri->silIndexes != NULL );
+	if ( tri->silIndexes != NULL ) {
+		f->Write( tri->silIndexes, tri->numIndexes * sizeof( tri->silIndexes[0] ) );
+	}
+
+	f->WriteInt( tri->numMirroredVerts );
+	f->Write( tri->mirroredVerts, tri->numMirroredVerts * sizeof( tri->mirroredVerts[0] ) );
+
+	f->WriteInt( tri->numDupVerts );
+	f->Write( tri->dupVerts, tri->numDupVerts * 2 * sizeof( tri->dupVerts[0] ) );
+
+	f->WriteInt( tri->numSilEdges );
+	f->Write( tri->silEdges, tri->numSilEdges * sizeof( tri->silEdges[0] ) );
+
+	f->WriteBool( tri->facePlanes != NULL );
+	if ( tri->facePlanes != NULL ) {
+		f->Write( tri->facePlanes, ( tri->numIndexes / 3 ) * sizeof( tri->facePlanes[0] ) );
+	}
+
+	f->WriteBool( tri->dominantTris != NULL );
+	if ( tri->dominantTris != NULL ) {
+		f->Write( tri->dominantTris, tri->numVerts * sizeof( tri->dominantTris[0] ) );
+	}
+
+	f->WriteBool( tri->shadowVertexes != NULL );
+	if ( tri->shadowVertexes != NULL ) {
+		f->Write( tri->shadowVertexes, tri->numVerts * sizeof( tri->shadowVertexes[0] ) );
+	}
+	f->WriteInt( tri->numShadowIndexesNoFrontCaps );
+	f->WriteInt( tri->numShadowIndexesNoCaps );
+	f->WriteInt( tri->shadowCapPlaneBits );
+}
+
+/*
+===================
+R_ReadStaticTriSurfData
+===================
+*/
+static bool R_ReadStaticTriSurfData( idFile *f, srfTriangles_t *tri ) {
+	bool present;
+
+	f->ReadVec3( tri->bounds[0] );
+	f->ReadVec3( tri->bounds[1] );
+	f->ReadBool( tri->generateNormals );
+	f->ReadBool( tri->tangentsCalculated );
+	f->ReadBool( tri->facePlanesCalculated );
+	f->ReadBool( tri->perfectHull );
+
+	if ( !R_ReadTriSurfCount( f, tri->numVerts, sizeof( tri->shadowVertexes[0] ) ) ) {
+		return false;
+	}
+	f->ReadBool( present );
+	if ( present ) {
+		R_AllocStaticTriSurfVerts( tri, tri->numVerts );
+		if ( !R_ReadTriSurfArray( f, tri->verts, tri->numVerts * sizeof( tri->verts[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, tri->numIndexes, sizeof( tri->indexes[0] ) ) ) {
+		return false;
+	}
+	R_AllocStaticTriSurfIndexes( tri, tri->numIndexes );
+	if ( !R_ReadTriSurfArray( f, tri->indexes, tri->numIndexes * sizeof( tri->indexes[0] ) ) ) {
+		return false;
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		tri->silIndexes = triSilIndexAllocator.Alloc( tri->numIndexes );
+		if ( !R_ReadTriSurfArray( f, tri->silIndexes, tri->numIndexes * sizeof( tri->silIndexes[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, tri->numMirroredVerts, sizeof( tri->mirroredVerts[0] ) ) ) {
+		return false;
+	}
+	if ( tri->numMirroredVerts ) {
+		tri->mirroredVerts = triMirroredVertAllocator.Alloc( tri->numMirroredVerts );
+		if ( !R_ReadTriSurfArray( f, tri->mirroredVerts, tri->numMirroredVerts * sizeof( tri->mirroredVerts[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, tri->numDupVerts, 2 * sizeof( tri->dupVerts[0] ) ) ) {
+		return false;
+	}
+	if ( tri->numDupVerts ) {
+		tri->dupVerts = triDupVertAllocator.Alloc( tri->numDupVerts * 2 );
+		if ( !R_ReadTriSurfArray( f, tri->dupVerts, tri->numDupVerts * 2 * sizeof( tri->dupVerts[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, tri->numSilEdges, sizeof( tri->silEdges[0] ) ) ) {
+		return false;
+	}
+	if ( tri->numSilEdges ) {
+		tri->silEdges = triSilEdgeAllocator.Alloc( tri->numSilEdges );
+		if ( !R_ReadTriSurfArray( f, tri->silEdges, tri->numSilEdges * sizeof( tri->silEdges[0] ) ) ) {
+			return false;
+		}
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		R_AllocStaticTriSurfPlanes( tri, tri->numIndexes );
+		if ( !R_ReadTriSurfArray( f, tri->facePlanes, ( tri->numIndexes / 3 ) * sizeof( tri->facePlanes[0] ) ) ) {
+			return false;
+		}
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		tri->dominantTris = triDominantTrisAllocator.Alloc( tri->numVerts );
+		if ( !R_ReadTriSurfArray( f, tri->dominantTris, tri->numVerts * sizeof( tri->dominantTris[0] ) ) ) {
+			return false;
+		}
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		R_AllocStaticTriSurfShadowVerts( tri, tri->numVerts );
+		if ( !R_ReadTriSurfArray( f, tri->shadowVertexes, tri->numVerts * sizeof( tri->shadowVertexes[0] ) ) ) {
+			return false;
+		}
+	}
+	f->ReadInt( tri->numShadowIndexesNoFrontCaps );
+	f->ReadInt( tri->numShadowIndexesNoCaps );
+	return ( f->ReadInt( tri->shadowCapPlaneBits ) == sizeof( tri->shadowCapPlaneBits ) );
+}
+
+/*
+===================
+R_ReadStaticTriSurf
+
+Returns NULL if the file is truncated or corrupt
+===================
+*/
+srfTriangles_t *R_ReadStaticTriSurf( idFile *f ) {
+	srfTriangles_t *tri = R_AllocStaticTriSurf();
+
+	if ( !R_ReadStaticTriSurfData( f, tri ) ) {
+		R_ReallyFreeStaticTriSurf( tri );
+		return NULL;
+	}
+	return tri;
+}
+
+/*
+===================
+R_WriteDeformInfo
+
+The skinning vertex cache is not written, it is created on demand
+===================
+*/
+void R_WriteDeformInfo( idFile *f, const deformInfo_t *deform ) {
+	f->WriteInt( deform->numSourceVerts );
+	f->WriteInt( deform->numOutputVerts );
+
+	f->WriteInt( deform->numIndexes );
+	f->Write( deform->indexes, deform->numIndexes * sizeof( deform->indexes[0] ) );
+
+	f->WriteBool( deform->silIndexes != NULL );
+	if ( deform->silIndexes != NULL ) {
+		f->Write( deform->silIndexes, deform->numIndexes * sizeof( deform->silIndexes[0] ) );
+	}
+
+	f->WriteInt( deform->numMirroredVerts );
+	f->Write( deform->mirroredVerts, deform->numMirroredVerts * sizeof( deform->mirroredVerts[0] ) );
+
+	f->WriteInt( deform->numDupVerts );
+	f->Write( deform->dupVerts, deform->numDupVerts * 2 * sizeof( deform->dupVerts[0] ) );
+
+	f->WriteInt( deform->numSilEdges );
+	f->Write( deform->silEdges, deform->numSilEdges * sizeof( deform->silEdges[0] ) );
+
+	f->WriteBool( deform->dominantTris != NULL );
+	if ( deform->dominantTris != NULL ) {
+		f->Write( deform->dominantTris, deform->numOutputVerts * sizeof( deform->dominantTris[0] ) );
+	}
+
+	f->WriteBool( deform->skinnedVerts != NULL );
+	if ( deform->skinnedVerts != NULL ) {
+		f->Write( deform->skinnedVerts, deform->numOutputVerts * sizeof( deform->skinnedVerts[0] ) );
+		f->Write( deform->skinnedWeights, deform->numOutputVerts * sizeof( deform->skinnedWeights[0] ) );
+	}
+}
+
+/*
+===================
+R_ReadDeformInfoData
+===================
+*/
+static bool R_ReadDeformInfoData( idFile *f, deformInfo_t *deform ) {
+	bool present;
+
+	if ( !R_ReadTriSurfCount( f, deform->numSourceVerts, 1 ) || !R_ReadTriSurfCount( f, deform->numOutputVerts, 1 ) ) {
+		return false;
+	}
+
+	if ( !R_ReadTriSurfCount( f, deform->numIndexes, sizeof( deform->indexes[0] ) ) ) {
+		return false;
+	}
+	deform->indexes = triIndexAllocator.Alloc( deform->numIndexes );
+	if ( !R_ReadTriSurfArray( f, deform->indexes, deform->numIndexes * sizeof( deform->indexes[0] ) ) ) {
+		return false;
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		deform->silIndexes = triSilIndexAllocator.Alloc( deform->numIndexes );
+		if ( !R_ReadTriSurfArray( f, deform->silIndexes, deform->numIndexes * sizeof( deform->silIndexes[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, deform->numMirroredVerts, sizeof( deform->mirroredVerts[0] ) ) ) {
+		return false;
+	}
+	if ( deform->numMirroredVerts ) {
+		deform->mirroredVerts = triMirroredVertAllocator.Alloc( deform->numMirroredVerts );
+		if ( !R_ReadTriSurfArray( f, deform->mirroredVerts, deform->numMirroredVerts * sizeof( deform->mirroredVerts[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, deform->numDupVerts, 2 * sizeof( deform->dupVerts[0] ) ) ) {
+		return false;
+	}
+	if ( deform->numDupVerts ) {
+		deform->dupVerts = triDupVertAllocator.Alloc( deform->numDupVerts * 2 );
+		if ( !R_ReadTriSurfArray( f, deform->dupVerts, deform->numDupVerts * 2 * sizeof( deform->dupVerts[0] ) ) ) {
+			return false;
+		}
+	}
+
+	if ( !R_ReadTriSurfCount( f, deform->numSilEdges, sizeof( deform->silEdges[0] ) ) ) {
+		return false;
+	}
+	if ( deform->numSilEdges ) {
+		deform->silEdges = triSilEdgeAllocator.Alloc( deform->numSilEdges );
+		if ( !R_ReadTriSurfArray( f, deform->silEdges, deform->numSilEdges * sizeof( deform->silEdges[0] ) ) ) {
+			return false;
+		}
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		if ( deform->numOutputVerts > ( f->Length() - f->Tell() ) / (int)sizeof( deform->dominantTris[0] ) ) {
+			return false;
+		}
+		deform->dominantTris = triDominantTrisAllocator.Alloc( deform->numOutputVerts );
+		if ( !R_ReadTriSurfArray( f, deform->dominantTris, deform->numOutputVerts * sizeof( deform->dominantTris[0] ) ) ) {
+			return false;
+		}
+	}
+
+	f->ReadBool( present );
+	if ( present ) {
+		const int vertBytes = deform->numOutputVerts * sizeof( deform->skinnedVerts[0] );
+		const int weightBytes = deform->numOutputVerts * sizeof( deform->skinnedWeights[0] );
+		if ( deform->numOutputVerts > ( f->Length() - f->Tell() ) / (int)( sizeof( deform->skinnedVerts[0] ) + sizeof( deform->skinnedWeights[0] ) ) ) {
+			return false;
+		}
+		// same single allocation as R_BuildDeformInfoSkinning
+		byte *data = (byte *)R_StaticAlloc( vertBytes + weightBytes );
+		deform->skinnedVerts = (idDrawVert *)data;
+		deform->skinnedWeights = (skinnedWeight_t *)( data + vertBytes );
+		if ( !R_ReadTriSurfArray( f, data, vertBytes + weightBytes ) ) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/*
+===================
+R_ReadDeformInfo
+
+Returns NULL if the file is truncated or corrupt
+===================
+*/
+deformInfo_t *R_ReadDeformInfo( idFile *f ) {
+	deformInfo_t *deform = (deformInfo_t *)R_ClearedStaticAlloc( sizeof( *deform ) );
+
+	if ( !R_ReadDeformInfoData( f, deform ) ) {
+		R_FreeDeformInfo( deform );
+		return NULL;
+	}
+	return deform;
+}
@@ -600,6 +600,8 @@ Mac OSX version. The system uses it's own thread and an IOProc callback
 int idSoundSystemLocal::AsyncMix( int soundTime, float *mixBuffer ) {
 	int	inTime, numSpeakers;
 
+	PROFILE_SCOPE( "idSoundSystemLocal::AsyncMix" );
+
 	if ( !isInitialized || shutdown || !snd_audio_hw ) {
 		return 0;
 	}
@@ -625,6 +627,8 @@ called from async sound thread when com_asyncSound == 1 ( Windows )
 */
 int idSoundSystemLocal::AsyncUpdate( int inTime ) {
 
+	PROFILE_SCOPE( "idSoundSystemLocal::AsyncUpdate" );
+
 	if ( !isInitialized || shutdown || !snd_audio_hw ) {
 		return 0;
 	}
@@ -747,6 +751,8 @@ called by the sound thread when com_asyncSound is 3 ( Linux )
 */
 int idSoundSystemLocal::AsyncUpdateWrite( int inTime ) {
 
+	PROFILE_SCOPE( "idSoundSystemLocal::AsyncUpdateWrite" );
+
 	if ( !isInitialized || shutdown || !snd_audio_hw ) {
 		return 0;
 	}
@@ -421,6 +421,8 @@ void idSoundWorldLocal::MixLoop( int current44kHz, int numSpeakers, float *final
 	int i, j;
 	idSoundEmitterLocal *sound;
 
+	PROFILE_SCOPE( "idSoundWorldLocal::MixLoop" );
+
 	// if noclip flying outside the world, leave silence
 	if ( listenerArea == -1 ) {
 		if ( idSoundSystemLocal::useOpenAL )
@@ -28,11 +28,13 @@ If you have questions concerning this license or the applicable additional terms
 #include "../../idlib/precompiled.h"
 #include "../../renderer/tr_local.h"
 #include "local.h"
+#include "../posix/posix_public.h"
 
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <unistd.h>
+#include <pthread.h>
 
 extern "C" {
 #	include "libXNVCtrl/NVCtrlLib.h"
@@ -60,10 +62,6 @@ static bool vidmode_active = false;
 static int save_rampsize = 0;
 static unsigned short *save_red, *save_green, *save_blue;
 
-void GLimp_WakeBackEnd(void *a) {
-	common->DPrintf("GLimp_WakeBackEnd stub\n");
-}
-
 #ifdef ID_GL_HARDLINK
 void GLimp_EnableLogging(bool log) {
 	static bool logging;
@@ -75,18 +73,136 @@ void GLimp_EnableLogging(bool log) {
 }
 #endif
 
-void GLimp_FrontEndSleep() {
-	common->DPrintf("GLimp_FrontEndSleep stub\n");
+/*
+===============================================================
+
+SMP render thread
+
+the front end hands a completed frame to the back end with GLimp_WakeBackEnd
+and waits for it with GLimp_FrontEndSleep, the render thread parks in
+GLimp_BackEndSleep between frames. Same handshake as the win32 events.
+
+===============================================================
+*/
+
+static pthread_mutex_t	smpMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	smpCommandsCond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t	smpCompletedCond = PTHREAD_COND_INITIALIZER;
+static bool				smpCommands = false;		// the front end posted smpData
+static bool				smpCompleted = false;		// the back end is idle
+static void *			smpData = NULL;
+static void				(*glimpRenderThread)( void ) = NULL;
+static xthreadInfo		renderThreadInfo;
+
+/*
+===================
+GLimp_RenderThreadWrapper
+===================
+*/
+static unsigned int GLimp_RenderThreadWrapper( void * ) {
+	profiler->SetThreadName( "render" );
+
+	glimpRenderThread();
+
+	// unbind the context before we die
+	qglXMakeCurrent( dpy, None, NULL );
+
+	// let the front end out of GLimp_FrontEndSleep one last time
+	pthread_mutex_lock( &smpMutex );
+	smpCompleted = true;
+	pthread_cond_signal( &smpCompletedCond );
+	pthread_mutex_unlock( &smpMutex );
+
+	return 0;
 }
 
+/*
+=======================
+GLimp_SpawnRenderThread
+
+Returns false if the system only has a single processor
+=======================
+*/
+bool GLimp_SpawnRenderThread( void (*function)( void ) ) {
+	if ( renderThreadInfo.threadHandle ) {
+		common->Error( "GLimp_SpawnRenderThread: render thread already running" );
+	}
+	if ( sysconf( _SC_NPROCESSORS_ONLN ) < 2 ) {
+		return false;
+	}
+
+	smpCommands = false;
+	smpCompleted = false;
+	smpData = NULL;
+	glimpRenderThread = function;
+
+	Sys_CreateThread( (xthread_t)GLimp_RenderThreadWrapper, NULL, THREAD_ABOVE_NORMAL, renderThreadInfo, "render", g_threads, &g_thread_count );
+	if ( !renderThreadInfo.threadHandle ) {
+		common->Error( "GLimp_SpawnRenderThread: failed" );
+	}
+	return true;
+}
+
+/*
+===================
+GLimp_BackEndSleep
+===================
+*/
 void *GLimp_BackEndSleep() {
-	common->DPrintf("GLimp_BackEndSleep stub\n");
-	return 0;
+	void *data;
+
+	pthread_mutex_lock( &smpMutex );
+
+	// after this, the front end can exit GLimp_FrontEndSleep
+	smpCompleted = true;
+	pthread_cond_signal( &smpCompletedCond );
+
+	while ( !smpCommands ) {
+		pthread_cond_wait( &smpCommandsCond, &smpMutex );
+	}
+	smpCommands = false;
+	smpCompleted = false;
+	data = smpData;
+
+	pthread_mutex_unlock( &smpMutex );
+
+	return data;
 }
 
-bool GLimp_SpawnRenderThread(void (*a) ()) {
-	common->DPrintf("GLimp_SpawnRenderThread stub\n");
-	return false;
+/*
+===================
+GLimp_FrontEndSleep
+===================
+*/
+void GLimp_FrontEndSleep() {
+	pthread_mutex_lock( &smpMutex );
+	while ( !smpCompleted ) {
+		pthread_cond_wait( &smpCompletedCond, &smpMutex );
+	}
+	pthread_mutex_unlock( &smpMutex );
+}
+
+/*
+===================
+GLimp_WakeBackEnd
+===================
+*/
+void GLimp_WakeBackEnd( void *data ) {
+	pthread_mutex_lock( &smpMutex );
+	if ( smpCommands ) {
+		pthread_mutex_unlock( &smpMutex );
+		common->FatalError( "GLimp_WakeBackEnd: commands already signaled" );
+	}
+	smpData = data;
+	smpCommands = true;
+	smpCompleted = false;
+	pthread_cond_signal( &smpCommandsCond );
+	pthread_mutex_unlock( &smpMutex );
+
+	if ( !data && renderThreadInfo.threadHandle ) {
+		// the render thread is exiting, reap it
+		Posix_JoinThread( renderThreadInfo );
+	}
 }
 
 void GLimp_ActivateContext() {
@@ -37,6 +37,10 @@ If you have questions concerning this license or the applicable additional terms
 #include <sys/types.h>
 #include <fcntl.h>
 
+#if defined( __i386__ ) || defined( __x86_64__ )
+#include <cpuid.h>
+#endif
+
 #ifdef ID_MCHECK
 #include <mcheck.h>
 #endif
@@ -65,6 +69,9 @@ void Sys_AsyncThread( void ) {
 
 	// multi tick compensate for poor schedulers (Linux 2.4)
 	int ticked, to_ticked;
+
+	profiler->SetThreadName( "Async" );
+
 	now = Sys_Milliseconds();
 	ticked = now >> 4;
 	while (1) {
@@ -207,7 +214,56 @@ Sys_GetProcessorId
 ===============
 */
 cpuid_t Sys_GetProcessorId( void ) {
-	return CPUID_GENERIC;
+	static int flags = CPUID_NONE;
+
+	if ( flags != CPUID_NONE ) {
+		return (cpuid_t)flags;
+	}
+
+	flags = CPUID_GENERIC;
+
+#if defined( __i386__ ) || defined( __x86_64__ )
+	unsigned int eax, ebx, ecx, edx;
+	unsigned int maxLeaf = __get_cpuid_max( 0, NULL );
+
+	if ( maxLeaf >= 1 && __get_cpuid( 1, &eax, &ebx, &ecx, &edx ) ) {
+		if ( edx & bit_MMX ) {
+			flags |= CPUID_MMX;
+		}
+		if ( edx & bit_SSE ) {
+			flags |= CPUID_SSE | CPUID_FTZ;
+		}
+		if ( edx & bit_SSE2 ) {
+			flags |= CPUID_SSE2;
+		}
+		if ( ecx & bit_SSE3 ) {
+			flags |= CPUID_SSE3;
+		}
+		if ( edx & bit_CMOV ) {
+			flags |= CPUID_CMOV;
+		}
+
+		// AVX is only usable when the OS saves the YMM state on context switches
+		if ( ( ecx & bit_AVX ) && ( ecx & bit_OSXSAVE ) ) {
+			unsigned int xcr0, xcr0hi;
+			__asm__ __volatile__( "xgetbv" : "=a" (xcr0), "=d" (xcr0hi) : "c" (0) );
+			if ( ( xcr0 & 6 ) == 6 ) {
+				flags |= CPUID_AVX;
+				if ( ecx & bit_FMA ) {
+					flags |= CPUID_FMA3;
+				}
+				if ( maxLeaf >= 7 ) {
+					__cpuid_count( 7, 0, eax, ebx, ecx, edx );
+					if ( ebx & bit_AVX2 ) {
+						flags |= CPUID_AVX2;
+					}
+				}
+			}
+		}
+	}
+#endif
+
+	return (cpuid_t)flags;
 }
 
 /*
@@ -216,7 +272,41 @@ Sys_GetProcessorString
 ===============
 */
 const char *Sys_GetProcessorString( void ) {
-	return "generic";
+	static idStr string;
+
+	if ( string.Length() ) {
+		return string.c_str();
+	}
+
+	int flags = Sys_GetProcessorId();
+
+	string = "generic CPU";
+	if ( flags & ( CPUID_MMX | CPUID_SSE ) ) {
+		string += " with ";
+		if ( flags & CPUID_MMX ) {
+			string += "MMX & ";
+		}
+		if ( flags & CPUID_SSE ) {
+			string += "SSE & ";
+		}
+		if ( flags & CPUID_SSE2 ) {
+			string += "SSE2 & ";
+		}
+		if ( flags & CPUID_SSE3 ) {
+			string += "SSE3 & ";
+		}
+		if ( flags & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( flags & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( flags & CPUID_FMA3 ) {
+			string += "FMA3 & ";
+		}
+		string.StripTrailing( " & " );
+	}
+	return string.c_str();
 }
 
 /*
@@ -984,6 +984,7 @@ Sys_AsyncThread
 =================
 */
 void Sys_AsyncThread( void ) {
+	profiler->SetThreadName( "Async" );
 	while ( 1 ) {
 		usleep( 16666 );
 		common->Async();
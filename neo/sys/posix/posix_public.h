@@ -40,6 +40,7 @@ void		Posix_EarlyInit( );
 void		Posix_LateInit( );
 
 void		Posix_InitPThreads( );
+void		Posix_JoinThread( xthreadInfo& info );	// for threads that exit on their own
 void		Posix_InitSigs( );
 void		Posix_ClearSigs( );
 
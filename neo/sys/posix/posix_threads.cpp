@@ -35,6 +35,7 @@ If you have questions concerning this license or the applicable additional terms
 #include <sys/time.h>
 #include <pwd.h>
 #include <pthread.h>
+#include <sched.h>
 
 #include "../../idlib/precompiled.h"
 #include "posix_public.h"
@@ -149,13 +150,15 @@ thread create and destroy
 */
 
 // not a hard limit, just what we keep track of for debugging
-#define MAX_THREADS 10
+#define MAX_THREADS 32
 xthreadInfo *g_threads[MAX_THREADS];
 
 int g_thread_count = 0;
 
 typedef void *(*pthread_function_t) (void *);
 
+static void Posix_RemoveThreadInfo( xthreadInfo& info );
+
 /*
 ==================
 Sys_CreateThread
@@ -196,6 +199,31 @@ void Sys_DestroyThread( xthreadInfo& info ) {
 		common->Error( "ERROR: pthread_join %s failed\n", info.name );
 	}
 	info.threadHandle = 0;
+	Posix_RemoveThreadInfo( info );
+}
+
+/*
+==================
+Posix_JoinThread
+
+waits for a thread that is exiting on its own, as opposed to Sys_DestroyThread
+==================
+*/
+void Posix_JoinThread( xthreadInfo& info ) {
+	assert( info.threadHandle );
+	if ( pthread_join( ( pthread_t )info.threadHandle, NULL ) != 0 ) {
+		common->Error( "ERROR: pthread_join %s failed\n", info.name );
+	}
+	info.threadHandle = 0;
+	Posix_RemoveThreadInfo( info );
+}
+
+/*
+==================
+Posix_RemoveThreadInfo
+==================
+*/
+static void Posix_RemoveThreadInfo( xthreadInfo& info ) {
 	Sys_EnterCriticalSection( );
 	for( int i = 0 ; i < g_thread_count ; i++ ) {
 		if ( &info == g_threads[ i ] ) {
@@ -238,6 +266,572 @@ const char* Sys_GetThreadName( int *index ) {
 	return "main";
 }
 
+/*
+=========================================================
+Parallel jobs
+
+every worker owns a queue. Submit deals the jobs of a list out round-robin,
+a worker pops the newest job of its own queue and steals the oldest job of
+another queue when it runs dry. the thread waiting on a list steals as well,
+so a list never stalls on a worker that has not woken up yet.
+=========================================================
+*/
+
+idCVar jobs_numThreads( "jobs_numThreads", "-1", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE | CVAR_NOCHEAT, "number of job worker threads, -1 = one less than the number of cores, 0 = run all jobs on the submitting thread. changes take effect after a restart, except 0", -1, MAX_JOB_THREADS );
+idCVar jobs_affinity( "jobs_affinity", "0", CVAR_SYSTEM | CVAR_BOOL | CVAR_ARCHIVE | CVAR_NOCHEAT, "lock each job worker to its own core" );
+
+const int MAX_QUEUED_JOBS = 4096;		// per worker, jobs that don't fit run on the submitting thread
+
+class idParallelJobListLocal;
+
+typedef struct job_s {
+	jobRun_t					function;
+	void *						data;
+	idParallelJobListLocal *	list;
+} job_t;
+
+typedef struct {
+	pthread_mutex_t		lock;
+	job_t *				jobs[MAX_QUEUED_JOBS];
+	int					first;				// oldest job, stolen by other threads
+	int					count;				// only changed under the lock, peeked at with Job_QueueCount
+} jobQueue_t;
+
+typedef struct {
+	int					threadIndex;
+	bool				allocated;			// created by Job_GetScratch, freed on thread exit
+	byte *				memory;
+	int					used;
+	int					highWater;
+} jobScratch_t;
+
+typedef struct {
+	xthreadInfo			info;
+	char				name[32];
+	int					index;
+	jobScratch_t		scratch;
+	int					jobsExecuted;
+	int					jobsStolen;
+} jobWorker_t;
+
+static jobQueue_t		jobQueues[MAX_JOB_THREADS];
+static jobWorker_t		jobWorkers[MAX_JOB_THREADS];
+static int				jobNumWorkers;
+static volatile int		jobsPending;			// queued but not yet started
+static volatile int		jobNextThreadIndex;		// last index given to a thread that isn't a worker
+static volatile bool	jobsShutdown;
+static pthread_mutex_t	jobWakeLock;
+static pthread_cond_t	jobWakeCond;
+static pthread_key_t	jobScratchKey;
+
+/*
+==================
+Job_FreeScratch
+thread exit destructor for scratch memory created for non-worker threads
+==================
+*/
+static void Job_FreeScratch( void *data ) {
+	jobScratch_t *scratch = (jobScratch_t *)data;
+	if ( scratch != NULL && scratch->allocated ) {
+		free( scratch->memory );
+		free( scratch );
+	}
+}
+
+/*
+==================
+Job_GetScratch
+==================
+*/
+static jobScratch_t *Job_GetScratch( void ) {
+	jobScratch_t *scratch = (jobScratch_t *)pthread_getspecific( jobScratchKey );
+	if ( scratch == NULL ) {
+		// a thread helping out in Wait(), running jobs inline or asking for its
+		// index gets one past the workers, so it never shares their resources
+		scratch = (jobScratch_t *)calloc( 1, sizeof( jobScratch_t ) );
+		scratch->threadIndex = __sync_add_and_fetch( &jobNextThreadIndex, 1 );
+		scratch->allocated = true;
+		scratch->memory = (byte *)malloc( JOB_SCRATCH_SIZE );
+		pthread_setspecific( jobScratchKey, scratch );
+	}
+	return scratch;
+}
+
+/*
+==================
+Job_Execute
+==================
+*/
+static void Job_Execute( job_t *job, jobScratch_t *scratch );
+
+/*
+==================
+Job_QueueCount
+the owner and the thieves check for work without taking the lock,
+the count is re-checked under the lock before a job is taken
+==================
+*/
+static int Job_QueueCount( const jobQueue_t *queue ) {
+	return __atomic_load_n( &queue->count, __ATOMIC_RELAXED );
+}
+
+/*
+==================
+Job_Push
+==================
+*/
+static bool Job_Push( int queueNum, job_t *job ) {
+	jobQueue_t *queue = &jobQueues[queueNum];
+	pthread_mutex_lock( &queue->lock );
+	if ( queue->count >= MAX_QUEUED_JOBS ) {
+		pthread_mutex_unlock( &queue->lock );
+		return false;
+	}
+	queue->jobs[( queue->first + queue->count ) % MAX_QUEUED_JOBS] = job;
+	__atomic_store_n( &queue->count, queue->count + 1, __ATOMIC_RELAXED );
+	pthread_mutex_unlock( &queue->lock );
+	return true;
+}
+
+/*
+==================
+Job_Pop
+takes the newest job, only called by the owner of the queue
+==================
+*/
+static job_t *Job_Pop( int queueNum ) {
+	jobQueue_t *queue = &jobQueues[queueNum];
+	if ( Job_QueueCount( queue ) == 0 ) {
+		return NULL;
+	}
+	job_t *job = NULL;
+	pthread_mutex_lock( &queue->lock );
+	if ( queue->count > 0 ) {
+		__atomic_store_n( &queue->count, queue->count - 1, __ATOMIC_RELAXED );
+		job = queue->jobs[( queue->first + queue->count ) % MAX_QUEUED_JOBS];
+	}
+	pthread_mutex_unlock( &queue->lock );
+	return job;
+}
+
+/*
+==================
+Job_Steal
+takes the oldest job of the first non-empty queue after skipQueue
+==================
+*/
+static job_t *Job_Steal( int skipQueue ) {
+	for ( int i = 1; i <= jobNumWorkers; i++ ) {
+		jobQueue_t *queue = &jobQueues[( skipQueue + i ) % jobNumWorkers];
+		if ( Job_QueueCount( queue ) == 0 ) {
+			continue;
+		}
+		job_t *job = NULL;
+		pthread_mutex_lock( &queue->lock );
+		if ( queue->count > 0 ) {
+			job = queue->jobs[queue->first];
+			queue->first = ( queue->first + 1 ) % MAX_QUEUED_JOBS;
+			__atomic_store_n( &queue->count, queue->count - 1, __ATOMIC_RELAXED );
+		}
+		pthread_mutex_unlock( &queue->lock );
+		if ( job != NULL ) {
+			return job;
+		}
+	}
+	return NULL;
+}
+
+/*
+==================
+Job_WorkerThread
+==================
+*/
+static unsigned int Job_WorkerThread( void *parm ) {
+	jobWorker_t *worker = (jobWorker_t *)parm;
+
+#ifdef __linux__
+	pthread_setname_np( pthread_self(), worker->name );
+	if ( jobs_affinity.GetBool() ) {
+		int numCores = sysconf( _SC_NPROCESSORS_ONLN );
+		if ( numCores > 1 ) {
+			cpu_set_t cpus;
+			CPU_ZERO( &cpus );
+			// leave the first core to the main thread
+			CPU_SET( 1 + worker->index % ( numCores - 1 ), &cpus );
+			pthread_setaffinity_np( pthread_self(), sizeof( cpus ), &cpus );
+		}
+	}
+#endif
+
+	pthread_setspecific( jobScratchKey, &worker->scratch );
+	profiler->SetThreadName( worker->name );
+
+	while( 1 ) {
+		job_t *job = Job_Pop( worker->index );
+		if ( job == NULL ) {
+			job = Job_Steal( worker->index );
+			if ( job != NULL ) {
+				worker->jobsStolen++;
+			}
+		}
+		if ( job != NULL ) {
+			__sync_fetch_and_sub( &jobsPending, 1 );
+			Job_Execute( job, &worker->scratch );
+			worker->jobsExecuted++;
+			continue;
+		}
+
+		// the submitter changes jobsPending before taking the lock, so a wake up can't be lost
+		pthread_mutex_lock( &jobWakeLock );
+		while ( jobsPending <= 0 && !jobsShutdown ) {
+			pthread_cond_wait( &jobWakeCond, &jobWakeLock );
+		}
+		bool quit = jobsShutdown;
+		pthread_mutex_unlock( &jobWakeLock );
+		if ( quit ) {
+			break;
+		}
+	}
+	return 0;
+}
+
+/*
+==============================================================
+
+	idParallelJobListLocal
+
+==============================================================
+*/
+
+class idParallelJobListLocal : public idParallelJobList {
+public:
+							idParallelJobListLocal( const char *name );
+	virtual					~idParallelJobListLocal( void );
+
+	virtual void			AddJob( jobRun_t function, void *data );
+	virtual void			Submit( void );
+	virtual void			Wait( void );
+	virtual bool			TryWait( void );
+	virtual bool			IsSubmitted( void ) const { return submitted; }
+	virtual int				NumJobs( void ) const { return jobs.Num(); }
+	virtual const char *	GetName( void ) const { return name.c_str(); }
+
+	volatile int			numRemaining;
+
+private:
+	idStr					name;
+	idList<job_t>			jobs;
+	bool					submitted;
+	int						nextQueue;
+};
+
+/*
+==================
+idParallelJobListLocal::idParallelJobListLocal
+==================
+*/
+idParallelJobListLocal::idParallelJobListLocal( const char *name ) {
+	this->name = name;
+	jobs.SetGranularity( 64 );
+	numRemaining = 0;
+	submitted = false;
+	nextQueue = 0;
+}
+
+/*
+==================
+idParallelJobListLocal::~idParallelJobListLocal
+==================
+*/
+idParallelJobListLocal::~idParallelJobListLocal( void ) {
+	if ( submitted ) {
+		Wait();
+	}
+}
+
+/*
+==================
+idParallelJobListLocal::AddJob
+==================
+*/
+void idParallelJobListLocal::AddJob( jobRun_t function, void *data ) {
+	assert( !submitted );
+	job_t &job = jobs.Alloc();
+	job.function = function;
+	job.data = data;
+	job.list = this;
+}
+
+/*
+==================
+idParallelJobListLocal::Submit
+==================
+*/
+void idParallelJobListLocal::Submit( void ) {
+	assert( !submitted );
+	submitted = true;
+
+	if ( jobNumWorkers == 0 || jobs_numThreads.GetInteger() == 0 ) {
+		numRemaining = jobs.Num();
+		jobScratch_t *scratch = Job_GetScratch();
+		for ( int i = 0; i < jobs.Num(); i++ ) {
+			Job_Execute( &jobs[i], scratch );
+		}
+		return;
+	}
+
+	numRemaining = jobs.Num();
+	__sync_fetch_and_add( &jobsPending, jobs.Num() );
+
+	jobScratch_t *scratch = NULL;
+	for ( int i = 0; i < jobs.Num(); i++ ) {
+		if ( !Job_Push( nextQueue, &jobs[i] ) ) {
+			// all queues are backed up, don't make it worse
+			__sync_fetch_and_sub( &jobsPending, 1 );
+			if ( scratch == NULL ) {
+				scratch = Job_GetScratch();
+			}
+			Job_Execute( &jobs[i], scratch );
+		}
+		nextQueue = ( nextQueue + 1 ) % jobNumWorkers;
+	}
+
+	pthread_mutex_lock( &jobWakeLock );
+	pthread_cond_broadcast( &jobWakeCond );
+	pthread_mutex_unlock( &jobWakeLock );
+}
+
+/*
+==================
+idParallelJobListLocal::Wait
+==================
+*/
+void idParallelJobListLocal::Wait( void ) {
+	if ( !submitted ) {
+		return;
+	}
+	jobScratch_t *scratch = NULL;
+	while ( numRemaining > 0 ) {
+		job_t *job = ( jobNumWorkers > 0 ) ? Job_Steal( nextQueue ) : NULL;
+		if ( job != NULL ) {
+			__sync_fetch_and_sub( &jobsPending, 1 );
+			if ( scratch == NULL ) {
+				scratch = Job_GetScratch();
+			}
+			Job_Execute( job, scratch );
+		} else {
+			// the last jobs are running on the workers
+			sched_yield();
+		}
+	}
+	__sync_synchronize();
+	jobs.SetNum( 0, false );
+	submitted = false;
+}
+
+/*
+==================
+idParallelJobListLocal::TryWait
+==================
+*/
+bool idParallelJobListLocal::TryWait( void ) {
+	if ( submitted && numRemaining > 0 ) {
+		return false;
+	}
+	Wait();
+	return true;
+}
+
+/*
+==================
+Job_Execute
+==================
+*/
+static void Job_Execute( job_t *job, jobScratch_t *scratch ) {
+	PROFILE_SCOPE( "job" );
+	scratch->used = 0;
+	job->function( job->data );
+	if ( scratch->used > scratch->highWater ) {
+		scratch->highWater = scratch->used;
+	}
+	__sync_fetch_and_sub( &job->list->numRemaining, 1 );
+}
+
+/*
+==============================================================
+
+	idParallelJobManagerLocal
+
+==============================================================
+*/
+
+class idParallelJobManagerLocal : public idParallelJobManager {
+public:
+							idParallelJobManagerLocal( void ) { initialized = false; }
+
+	virtual void			Init( void );
+	virtual void			Shutdown( void );
+
+	virtual idParallelJobList *	AllocJobList( const char *name );
+	virtual void			FreeJobList( idParallelJobList *jobList );
+
+	virtual int				GetNumWorkers( void ) const { return jobNumWorkers; }
+	virtual int				GetThreadIndex( void ) const;
+	virtual void *			AllocScratch( int bytes );
+
+	static void				ListJobThreads_f( const idCmdArgs &args );
+
+private:
+	bool					initialized;
+};
+
+static idParallelJobManagerLocal	parallelJobManagerLocal;
+idParallelJobManager *				parallelJobManager = &parallelJobManagerLocal;
+
+/*
+==================
+idParallelJobManagerLocal::Init
+==================
+*/
+void idParallelJobManagerLocal::Init( void ) {
+	if ( initialized ) {
+		return;
+	}
+	initialized = true;
+
+	pthread_mutex_init( &jobWakeLock, NULL );
+	pthread_cond_init( &jobWakeCond, NULL );
+	jobsPending = 0;
+	jobsShutdown = false;
+
+	// the initializing thread is the main thread and keeps index 0,
+	// threads that register later are numbered after the workers
+	jobNextThreadIndex = MAX_JOB_THREADS;
+	Job_GetScratch()->threadIndex = 0;
+
+	int numThreads = jobs_numThreads.GetInteger();
+	if ( numThreads < 0 ) {
+		numThreads = sysconf( _SC_NPROCESSORS_ONLN ) - 1;
+	}
+	jobNumWorkers = idMath::ClampInt( 0, MAX_JOB_THREADS, numThreads );
+
+	for ( int i = 0; i < jobNumWorkers; i++ ) {
+		jobQueue_t *queue = &jobQueues[i];
+		pthread_mutex_init( &queue->lock, NULL );
+		queue->first = 0;
+		queue->count = 0;
+
+		jobWorker_t *worker = &jobWorkers[i];
+		memset( worker, 0, sizeof( *worker ) );
+		idStr::snPrintf( worker->name, sizeof( worker->name ), "JobWorker%d", i );
+		worker->index = i;
+		worker->scratch.threadIndex = i + 1;
+		worker->scratch.memory = (byte *)malloc( JOB_SCRATCH_SIZE );
+		Sys_CreateThread( (xthread_t)Job_WorkerThread, worker, THREAD_NORMAL, worker->info, worker->name, g_threads, &g_thread_count );
+	}
+
+	cmdSystem->AddCommand( "listJobThreads", ListJobThreads_f, CMD_FL_SYSTEM, "lists the job worker threads" );
+
+	common->Printf( "%d job worker threads started\n", jobNumWorkers );
+}
+
+/*
+==================
+idParallelJobManagerLocal::Shutdown
+==================
+*/
+void idParallelJobManagerLocal::Shutdown( void ) {
+	if ( !initialized ) {
+		return;
+	}
+
+	pthread_mutex_lock( &jobWakeLock );
+	jobsShutdown = true;
+	pthread_cond_broadcast( &jobWakeCond );
+	pthread_mutex_unlock( &jobWakeLock );
+
+	for ( int i = 0; i < jobNumWorkers; i++ ) {
+		jobWorker_t *worker = &jobWorkers[i];
+		pthread_join( ( pthread_t )worker->info.threadHandle, NULL );
+		worker->info.threadHandle = 0;
+		Posix_RemoveThreadInfo( worker->info );
+		free( worker->scratch.memory );
+		worker->scratch.memory = NULL;
+		pthread_mutex_destroy( &jobQueues[i].lock );
+	}
+	jobNumWorkers = 0;
+
+	// the destructor only runs on thread exit, the main thread never gets there
+	Job_FreeScratch( pthread_getspecific( jobScratchKey ) );
+	pthread_setspecific( jobScratchKey, NULL );
+
+	pthread_cond_destroy( &jobWakeCond );
+	pthread_mutex_destroy( &jobWakeLock );
+
+	cmdSystem->RemoveCommand( "listJobThreads" );
+
+	initialized = false;
+}
+
+/*
+==================
+idParallelJobManagerLocal::AllocJobList
+==================
+*/
+idParallelJobList *idParallelJobManagerLocal::AllocJobList( const char *name ) {
+	return new idParallelJobListLocal( name );
+}
+
+/*
+==================
+idParallelJobManagerLocal::FreeJobList
+==================
+*/
+void idParallelJobManagerLocal::FreeJobList( idParallelJobList *jobList ) {
+	delete jobList;
+}
+
+/*
+==================
+idParallelJobManagerLocal::GetThreadIndex
+==================
+*/
+int idParallelJobManagerLocal::GetThreadIndex( void ) const {
+	if ( !initialized ) {
+		return 0;
+	}
+	return Job_GetScratch()->threadIndex;
+}
+
+/*
+==================
+idParallelJobManagerLocal::AllocScratch
+==================
+*/
+void *idParallelJobManagerLocal::AllocScratch( int bytes ) {
+	jobScratch_t *scratch = Job_GetScratch();
+	bytes = ( bytes + 15 ) & ~15;
+	if ( scratch->used + bytes > JOB_SCRATCH_SIZE ) {
+		return NULL;
+	}
+	void *ptr = scratch->memory + scratch->used;
+	scratch->used += bytes;
+	return ptr;
+}
+
+/*
+==================
+idParallelJobManagerLocal::ListJobThreads_f
+==================
+*/
+void idParallelJobManagerLocal::ListJobThreads_f( const idCmdArgs &args ) {
+	common->Printf( "%d job worker threads%s\n", jobNumWorkers, jobs_numThreads.GetInteger() == 0 ? " (disabled)" : "" );
+	for ( int i = 0; i < jobNumWorkers; i++ ) {
+		const jobWorker_t *worker = &jobWorkers[i];
+		common->Printf( "%-12s %8d jobs %8d stolen %6d kB scratch high water\n", worker->name, worker->jobsExecuted, worker->jobsStolen, worker->scratch.highWater >> 10 );
+	}
+}
+
 /*
 =========================================================
 Async Thread
@@ -288,5 +882,8 @@ void Posix_InitPThreads( ) {
 	for ( i = 0; i < MAX_THREADS; i++ ) {
 		g_threads[ i ] = NULL;
 	}	
+
+	// scratch memory of threads running jobs
+	pthread_key_create( &jobScratchKey, Job_FreeScratch );
 }
 
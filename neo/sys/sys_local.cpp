@@ -156,6 +156,10 @@ void idSysLocal::FPU_EnableExceptions( int exceptions ) {
 	Sys_FPU_EnableExceptions( exceptions );
 }
 
+idParallelJobManager *idSysLocal::GetJobManager( void ) {
+	return parallelJobManager;
+}
+
 /*
 =================
 Sys_TimeStampToStr
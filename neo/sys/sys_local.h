@@ -71,6 +71,8 @@ public:
 
 	virtual void			OpenURL( const char *url, bool quit );
 	virtual void			StartProcess( const char *exeName, bool quit );
+
+	virtual idParallelJobManager *	GetJobManager( void );
 };
 
 #endif /* !__SYS_LOCAL__ */
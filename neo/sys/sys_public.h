@@ -56,6 +56,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #define ID_INLINE						__forceinline
 #define ID_STATIC_TEMPLATE				static
+#define ID_THREAD_LOCAL					__declspec(thread)
 
 #define assertmem( x, y )				assert( _CrtIsValidPointer( x, y, true ) )
 
@@ -94,6 +95,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #define ID_INLINE						inline
 #define ID_STATIC_TEMPLATE
+#define ID_THREAD_LOCAL					__thread
 
 #define assertmem( x, y )
 
@@ -128,6 +130,7 @@ If you have questions concerning this license or the applicable additional terms
 
 #define ID_INLINE						inline
 #define ID_STATIC_TEMPLATE
+#define ID_THREAD_LOCAL					__thread
 
 #define assertmem( x, y )
 
@@ -154,7 +157,10 @@ typedef enum {
 	CPUID_HTT							= 0x01000,	// Hyper-Threading Technology
 	CPUID_CMOV							= 0x02000,	// Conditional Move (CMOV) and fast floating point comparison (FCOMI) instructions
 	CPUID_FTZ							= 0x04000,	// Flush-To-Zero mode (denormal results are flushed to zero)
-	CPUID_DAZ							= 0x08000	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_DAZ							= 0x08000,	// Denormals-Are-Zero mode (denormal source operands are set to zero)
+	CPUID_AVX							= 0x10000,	// Advanced Vector Extensions (with OS support for saving the YMM registers)
+	CPUID_AVX2							= 0x20000,	// Advanced Vector Extensions 2
+	CPUID_FMA3							= 0x40000	// Fused Multiply-Add (three operand form)
 } cpuid_t;
 
 typedef enum {
@@ -491,7 +497,7 @@ typedef struct {
 	unsigned long	threadId;
 } xthreadInfo;
 
-const int MAX_THREADS				= 10;
+const int MAX_THREADS				= 32;
 extern xthreadInfo *g_threads[MAX_THREADS];
 extern int			g_thread_count;
 
@@ -502,13 +508,15 @@ void				Sys_DestroyThread( xthreadInfo& info ); // sets threadHandle back to 0
 // if index != NULL, set the index in g_threads array (use -1 for "main" thread)
 const char *		Sys_GetThreadName( int *index = 0 );
  
-const int MAX_CRITICAL_SECTIONS		= 4;
+const int MAX_CRITICAL_SECTIONS		= 6;
 
 enum {
 	CRITICAL_SECTION_ZERO = 0,
 	CRITICAL_SECTION_ONE,
 	CRITICAL_SECTION_TWO,
-	CRITICAL_SECTION_THREE
+	CRITICAL_SECTION_THREE,		// zone heap while Mem_EnableThreadSafety is on
+	CRITICAL_SECTION_FOUR,		// idStr data allocator, taken before the heap lock
+	CRITICAL_SECTION_FIVE		// profiler thread registration
 };
 
 void				Sys_EnterCriticalSection( int index = CRITICAL_SECTION_ZERO );
@@ -526,6 +534,66 @@ enum {
 void				Sys_WaitForEvent( int index = TRIGGER_EVENT_ZERO );
 void				Sys_TriggerEvent( int index = TRIGGER_EVENT_ZERO );
 
+/*
+==============================================================
+
+	Parallel jobs
+
+	A job list collects function/data pairs, Submit() hands them to the
+	worker threads and Wait() blocks until all of them have run. The thread
+	calling Wait() executes pending jobs itself instead of sleeping.
+	Job functions must not touch the zone heap, use the scratch memory of
+	the executing thread instead. Jobs that can't avoid it, like the renderprog
+	conversion, have to be submitted between Mem_EnableThreadSafety( true )
+	and Mem_EnableThreadSafety( false ).
+
+==============================================================
+*/
+
+typedef void ( *jobRun_t )( void * );
+
+const int MAX_JOB_THREADS			= 16;
+const int JOB_SCRATCH_SIZE			= 256 * 1024;
+
+class idParallelJobList {
+public:
+	virtual					~idParallelJobList( void ) {}
+
+	// adds a job, the list must not be submitted
+	virtual void			AddJob( jobRun_t function, void *data ) = 0;
+	// starts executing the jobs, runs them on the calling thread if jobs_numThreads is 0
+	virtual void			Submit( void ) = 0;
+	// blocks until all jobs have completed, afterwards the list is empty and can be reused
+	virtual void			Wait( void ) = 0;
+	// returns true and resets the list if all jobs have completed, never blocks
+	virtual bool			TryWait( void ) = 0;
+	virtual bool			IsSubmitted( void ) const = 0;
+	virtual int				NumJobs( void ) const = 0;
+	virtual const char *	GetName( void ) const = 0;
+};
+
+class idParallelJobManager {
+public:
+	virtual					~idParallelJobManager( void ) {}
+
+	virtual void			Init( void ) = 0;
+	virtual void			Shutdown( void ) = 0;
+
+	virtual idParallelJobList *	AllocJobList( const char *name ) = 0;
+	virtual void			FreeJobList( idParallelJobList *jobList ) = 0;
+
+	// number of worker threads, 0 when all jobs run on the submitting thread
+	virtual int				GetNumWorkers( void ) const = 0;
+	// 0 for the thread that called Init, 1 to GetNumWorkers() for job workers, and
+	// a unique index above MAX_JOB_THREADS for every other thread that asks
+	virtual int				GetThreadIndex( void ) const = 0;
+	// 16 byte aligned memory owned by the calling thread, released when the next job starts
+	// returns NULL if JOB_SCRATCH_SIZE is exceeded
+	virtual void *			AllocScratch( int bytes ) = 0;
+};
+
+extern idParallelJobManager *	parallelJobManager;
+
 /*
 ==============================================================
 
@@ -568,6 +636,8 @@ public:
 
 	virtual void			OpenURL( const char *url, bool quit ) = 0;
 	virtual void			StartProcess( const char *exePath, bool quit ) = 0;
+
+	virtual idParallelJobManager *	GetJobManager( void ) = 0;
 };
 
 extern idSys *				sys;
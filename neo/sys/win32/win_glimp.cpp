@@ -1074,6 +1074,9 @@ static void GLimp_RenderThreadWrapper( void ) {
 
 	// unbind the context before we die
 	qwglMakeCurrent( win32.hDC, NULL );
+
+	// let the front end out of GLimp_FrontEndSleep one last time
+	SetEvent( win32.renderCompletedEvent );
 }
 
 /*
@@ -122,6 +122,78 @@ void Sys_DestroyThread( xthreadInfo& info ) {
 	info.threadHandle = 0;
 }
 
+/*
+==============================================================
+
+	Parallel jobs
+
+	the work-stealing workers live in sys/posix, here all jobs run
+	on the submitting thread
+
+==============================================================
+*/
+
+class idParallelJobListWin32 : public idParallelJobList {
+public:
+							idParallelJobListWin32( const char *name ) { this->name = name; submitted = false; }
+
+	virtual void			AddJob( jobRun_t function, void *data ) { assert( !submitted ); job_t &job = jobs.Alloc(); job.function = function; job.data = data; }
+	virtual void			Submit( void );
+	virtual void			Wait( void ) { jobs.SetNum( 0, false ); submitted = false; }
+	virtual bool			TryWait( void ) { Wait(); return true; }
+	virtual bool			IsSubmitted( void ) const { return submitted; }
+	virtual int				NumJobs( void ) const { return jobs.Num(); }
+	virtual const char *	GetName( void ) const { return name.c_str(); }
+
+private:
+	typedef struct {
+		jobRun_t			function;
+		void *				data;
+	} job_t;
+
+	idStr					name;
+	idList<job_t>			jobs;
+	bool					submitted;
+};
+
+ALIGN16( static byte jobScratch[JOB_SCRATCH_SIZE] );
+static int		jobScratchUsed;
+
+void idParallelJobListWin32::Submit( void ) {
+	assert( !submitted );
+	submitted = true;
+	for ( int i = 0; i < jobs.Num(); i++ ) {
+		jobScratchUsed = 0;
+		jobs[i].function( jobs[i].data );
+	}
+}
+
+class idParallelJobManagerWin32 : public idParallelJobManager {
+public:
+	virtual void			Init( void ) {}
+	virtual void			Shutdown( void ) {}
+
+	virtual idParallelJobList *	AllocJobList( const char *name ) { return new idParallelJobListWin32( name ); }
+	virtual void			FreeJobList( idParallelJobList *jobList ) { delete jobList; }
+
+	virtual int				GetNumWorkers( void ) const { return 0; }
+	virtual int				GetThreadIndex( void ) const { return 0; }
+	virtual void *			AllocScratch( int bytes );
+};
+
+void *idParallelJobManagerWin32::AllocScratch( int bytes ) {
+	bytes = ( bytes + 15 ) & ~15;
+	if ( jobScratchUsed + bytes > JOB_SCRATCH_SIZE ) {
+		return NULL;
+	}
+	void *ptr = jobScratch + jobScratchUsed;
+	jobScratchUsed += bytes;
+	return ptr;
+}
+
+static idParallelJobManagerWin32	parallelJobManagerWin32;
+idParallelJobManager *				parallelJobManager = &parallelJobManagerWin32;
+
 /*
 ==================
 Sys_Sentry
@@ -874,6 +946,8 @@ static void Sys_AsyncThread( void *parm ) {
 	int		wakeNumber;
 	int		startTime;
 
+	profiler->SetThreadName( "Async" );
+
 	startTime = Sys_Milliseconds();
 	wakeNumber = 0;
 
@@ -1075,6 +1149,15 @@ void Sys_Init( void ) {
 		if ( win32.cpuid & CPUID_SSE3 ) {
 			string += "SSE3 & ";
 		}
+		if ( win32.cpuid & CPUID_AVX ) {
+			string += "AVX & ";
+		}
+		if ( win32.cpuid & CPUID_AVX2 ) {
+			string += "AVX2 & ";
+		}
+		if ( win32.cpuid & CPUID_FMA3 ) {
+			string += "FMA3 & ";
+		}
 		if ( win32.cpuid & CPUID_HTT ) {
 			string += "HTT & ";
 		}
@@ -1104,6 +1187,12 @@ void Sys_Init( void ) {
 				id |= CPUID_SSE2;
 			} else if ( token.Icmp( "sse3" ) == 0 ) {
 				id |= CPUID_SSE3;
+			} else if ( token.Icmp( "avx" ) == 0 ) {
+				id |= CPUID_AVX;
+			} else if ( token.Icmp( "avx2" ) == 0 ) {
+				id |= CPUID_AVX2;
+			} else if ( token.Icmp( "fma3" ) == 0 ) {
+				id |= CPUID_FMA3;
 			} else if ( token.Icmp( "htt" ) == 0 ) {
 				id |= CPUID_HTT;
 			}
@@ -1029,3 +1029,51 @@ void RunReach_f( const idCmdArgs &args ) {
 	common->SetRefreshOnPrint( false );
 	common->PrintWarnings();
 }
+
+/*
+============
+ConvertAAS_f
+============
+*/
+void ConvertAAS_f( const idCmdArgs &args ) {
+	idAASSettings settings;
+	idStr mapName, fileName;
+
+	if ( args.Argc() <= 1 ) {
+		common->Printf( "convertAAS <mapfile>\n" );
+		return;
+	}
+
+	// get the aas settings definitions
+	const idDict *dict = gameEdit->FindEntityDefDict( "aas_types", false );
+	if ( !dict ) {
+		common->Error( "Unable to find entityDef for 'aas_types'" );
+	}
+
+	mapName = args.Argv( 1 );
+	mapName.BackSlashesToSlashes();
+	if ( mapName.Icmpn( "maps/", 4 ) != 0 ) {
+		mapName = "maps/" + mapName;
+	}
+
+	const idKeyValue *kv = dict->MatchPrefix( "type" );
+	while( kv != NULL ) {
+		const idDict *settingsDict = gameEdit->FindEntityDefDict( kv->GetValue(), false );
+		if ( !settingsDict ) {
+			common->Warning( "Unable to find '%s' in def/aas.def", kv->GetValue().c_str() );
+		} else {
+			settings.FromDict( kv->GetValue(), settingsDict );
+			fileName = mapName;
+			fileName.SetFileExtension( settings.fileExtension );
+
+			// always parse the text file, so the binary file gets the map CRC stored in it
+			idAASFileLocal *file = new idAASFileLocal();
+			if ( fileSystem->ReadFile( fileName, NULL, NULL ) > 0 && file->LoadText( fileName, 0 ) ) {
+				file->WriteBinary( fileName );
+			}
+			delete file;
+		}
+
+		kv = dict->MatchPrefix( "type", kv );
+	}
+}
@@ -32,6 +32,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "AASFile.h"
 #include "AASFile_local.h"
 
+static idCVar aas_binaryFiles( "aas_binaryFiles", "1", CVAR_SYSTEM | CVAR_BOOL, "load AAS files from the binary version next to them, writing it after a text load" );
+
 
 /*
 ===============================================================================
@@ -1097,16 +1099,46 @@ idAASFileLocal::Load
 ================
 */
 bool idAASFileLocal::Load( const idStr &fileName, unsigned int mapFileCRC ) {
+	name = fileName;
+	crc = mapFileCRC;
+
+	common->Printf( "[Load AAS]\n" );
+	common->Printf( "loading %s\n", name.c_str() );
+
+	if ( LoadBinary( fileName, mapFileCRC ) ) {
+		common->Printf( "done.\n" );
+		return true;
+	}
+
+	if ( !LoadText( fileName, mapFileCRC ) ) {
+		return false;
+	}
+
+	// the next load of this file can skip the parsing
+	if ( aas_binaryFiles.GetBool() ) {
+		WriteBinary( name );
+	}
+	crc = mapFileCRC;
+
+	common->Printf( "done.\n" );
+
+	return true;
+}
+
+/*
+================
+idAASFileLocal::LoadText
+
+Parses the text file only, on success crc is the map CRC stored in the file
+================
+*/
+bool idAASFileLocal::LoadText( const idStr &fileName, unsigned int mapFileCRC ) {
 	idLexer src( LEXFL_NOFATALERRORS | LEXFL_NOSTRINGESCAPECHARS | LEXFL_NOSTRINGCONCAT | LEXFL_ALLOWPATHNAMES );
 	idToken token;
 	int depth;
 	unsigned int c;
 
 	name = fileName;
-	crc = mapFileCRC;
-
-	common->Printf( "[Load AAS]\n" );
-	common->Printf( "loading %s\n", name.c_str() );
 
 	if ( !src.LoadFile( name ) ) {
 		return false;
@@ -1191,7 +1223,376 @@ bool idAASFileLocal::Load( const idStr &fileName, unsigned int mapFileCRC ) {
 		src.Error( "idAASFileLocal::Load: tree depth = %d", depth );
 	}
 
-	common->Printf( "done.\n" );
+	crc = c;
+
+	return true;
+}
+
+/*
+===============================================================================
+
+	Binary AAS file
+
+	The binary file holds everything the text file does plus the area bounds,
+	centers and travel flags FinishAreas and the parsing calculate.  The arrays
+	are written in native byte order exactly as they are laid out in the
+	idLists, so loading is a copy into each list.  The header has the size of
+	every structure, the map CRC, the timestamp and length of the text file
+	the binary file was written from and a CRC of the data.  When the text file
+	exists the binary file is only used while the text file is unchanged, so
+	the binary file can also be shipped on its own.
+
+===============================================================================
+*/
+
+/*
+================
+AAS_BinaryFileName
+================
+*/
+static idStr AAS_BinaryFileName( const idStr &fileName ) {
+	return fileName + "b";
+}
+
+/*
+================
+AAS_WriteBinaryList
+================
+*/
+template< class type >
+static void AAS_WriteBinaryList( idFile *fp, const idList<type> &list ) {
+	fp->WriteInt( list.Num() );
+	fp->Write( list.Ptr(), list.Num() * sizeof( type ) );
+}
+
+/*
+================
+AAS_ReadBinaryList
+================
+*/
+template< class type >
+static bool AAS_ReadBinaryList( idFile *fp, idList<type> &list ) {
+	int num;
+
+	fp->ReadInt( num );
+	if ( num < 0 || num > ( fp->Length() - fp->Tell() ) / (int)sizeof( type ) ) {
+		return false;
+	}
+	list.SetNum( num, false );
+	return ( fp->Read( list.Ptr(), num * sizeof( type ) ) == num * (int)sizeof( type ) );
+}
+
+/*
+================
+idAASFileLocal::WriteBinaryData
+================
+*/
+void idAASFileLocal::WriteBinaryData( idFile *fp ) const {
+	int i, num;
+	idReachability *reach;
+
+	// settings
+	fp->WriteInt( settings.numBoundingBoxes );
+	for ( i = 0; i < MAX_AAS_BOUNDING_BOXES; i++ ) {
+		fp->WriteVec3( settings.boundingBoxes[i][0] );
+		fp->WriteVec3( settings.boundingBoxes[i][1] );
+	}
+	fp->WriteBool( settings.usePatches );
+	fp->WriteBool( settings.writeBrushMap );
+	fp->WriteBool( settings.playerFlood );
+	fp->WriteBool( settings.noOptimize );
+	fp->WriteBool( settings.allowSwimReachabilities );
+	fp->WriteBool( settings.allowFlyReachabilities );
+	fp->WriteString( settings.fileExtension );
+	fp->WriteVec3( settings.gravity );
+	fp->WriteVec3( settings.gravityDir );
+	fp->WriteVec3( settings.invGravityDir );
+	fp->WriteFloat( settings.gravityValue );
+	fp->WriteFloat( settings.maxStepHeight );
+	fp->WriteFloat( settings.maxBarrierHeight );
+	fp->WriteFloat( settings.maxWaterJumpHeight );
+	fp->WriteFloat( settings.maxFallHeight );
+	fp->WriteFloat( settings.minFloorCos );
+	fp->WriteInt( settings.tt_barrierJump );
+	fp->WriteInt( settings.tt_startCrouching );
+	fp->WriteInt( settings.tt_waterJump );
+	fp->WriteInt( settings.tt_startWalkOffLedge );
+
+	// arrays
+	AAS_WriteBinaryList( fp, planeList );
+	AAS_WriteBinaryList( fp, vertices );
+	AAS_WriteBinaryList( fp, edges );
+	AAS_WriteBinaryList( fp, edgeIndex );
+	AAS_WriteBinaryList( fp, faces );
+	AAS_WriteBinaryList( fp, faceIndex );
+	AAS_WriteBinaryList( fp, areas );
+	AAS_WriteBinaryList( fp, nodes );
+	AAS_WriteBinaryList( fp, portals );
+	AAS_WriteBinaryList( fp, portalIndex );
+	AAS_WriteBinaryList( fp, clusters );
+
+	// reachabilities in list order
+	for ( i = 0; i < areas.Num(); i++ ) {
+		for ( num = 0, reach = areas[i].reach; reach; reach = reach->next ) {
+			num++;
+		}
+		fp->WriteInt( num );
+		for ( reach = areas[i].reach; reach; reach = reach->next ) {
+			fp->WriteInt( reach->travelType );
+			fp->WriteShort( reach->toAreaNum );
+			fp->WriteVec3( reach->start );
+			fp->WriteVec3( reach->end );
+			fp->WriteInt( reach->edgeNum );
+			fp->WriteUnsignedShort( reach->travelTime );
+			if ( reach->travelType == TFL_SPECIAL ) {
+				static_cast<idReachability_Special *>(reach)->dict.WriteToFileHandle( fp );
+			}
+		}
+	}
+}
+
+/*
+================
+idAASFileLocal::ReadBinaryReachabilities
+================
+*/
+bool idAASFileLocal::ReadBinaryReachabilities( idFile *fp, int areaNum ) {
+	int num, j;
+	aasArea_t *area;
+	idReachability reach, *newReach, **last;
+	idReachability_Special *special;
+
+	area = &areas[areaNum];
+	area->reach = NULL;
+	area->rev_reach = NULL;
+
+	fp->ReadInt( num );
+	if ( num < 0 || num > MAX_REACH_PER_AREA ) {
+		return false;
+	}
+	last = &area->reach;
+	for ( j = 0; j < num; j++ ) {
+		fp->ReadInt( reach.travelType );
+		fp->ReadShort( reach.toAreaNum );
+		fp->ReadVec3( reach.start );
+		fp->ReadVec3( reach.end );
+		fp->ReadInt( reach.edgeNum );
+		fp->ReadUnsignedShort( reach.travelTime );
+		if ( reach.toAreaNum < 0 || reach.toAreaNum >= areas.Num() ) {
+			return false;
+		}
+		switch( reach.travelType ) {
+			case TFL_SPECIAL:
+				newReach = special = new idReachability_Special();
+				special->dict.ReadFromFileHandle( fp );
+				break;
+			default:
+				newReach = new idReachability();
+				break;
+		}
+		newReach->CopyBase( reach );
+		newReach->fromAreaNum = areaNum;
+		newReach->next = NULL;
+		*last = newReach;
+		last = &newReach->next;
+	}
+	return true;
+}
+
+/*
+================
+idAASFileLocal::ReadBinaryData
+================
+*/
+bool idAASFileLocal::ReadBinaryData( idFile *fp ) {
+	int i;
+
+	// settings
+	fp->ReadInt( settings.numBoundingBoxes );
+	if ( settings.numBoundingBoxes < 0 || settings.numBoundingBoxes > MAX_AAS_BOUNDING_BOXES ) {
+		return false;
+	}
+	for ( i = 0; i < MAX_AAS_BOUNDING_BOXES; i++ ) {
+		fp->ReadVec3( settings.boundingBoxes[i][0] );
+		fp->ReadVec3( settings.boundingBoxes[i][1] );
+	}
+	fp->ReadBool( settings.usePatches );
+	fp->ReadBool( settings.writeBrushMap );
+	fp->ReadBool( settings.playerFlood );
+	fp->ReadBool( settings.noOptimize );
+	fp->ReadBool( settings.allowSwimReachabilities );
+	fp->ReadBool( settings.allowFlyReachabilities );
+	fp->ReadString( settings.fileExtension );
+	fp->ReadVec3( settings.gravity );
+	fp->ReadVec3( settings.gravityDir );
+	fp->ReadVec3( settings.invGravityDir );
+	fp->ReadFloat( settings.gravityValue );
+	fp->ReadFloat( settings.maxStepHeight );
+	fp->ReadFloat( settings.maxBarrierHeight );
+	fp->ReadFloat( settings.maxWaterJumpHeight );
+	fp->ReadFloat( settings.maxFallHeight );
+	fp->ReadFloat( settings.minFloorCos );
+	fp->ReadInt( settings.tt_barrierJump );
+	fp->ReadInt( settings.tt_startCrouching );
+	fp->ReadInt( settings.tt_waterJump );
+	fp->ReadInt( settings.tt_startWalkOffLedge );
+
+	// arrays
+	if ( !AAS_ReadBinaryList( fp, planeList ) ||
+			!AAS_ReadBinaryList( fp, vertices ) ||
+			!AAS_ReadBinaryList( fp, edges ) ||
+			!AAS_ReadBinaryList( fp, edgeIndex ) ||
+			!AAS_ReadBinaryList( fp, faces ) ||
+			!AAS_ReadBinaryList( fp, faceIndex ) ||
+			!AAS_ReadBinaryList( fp, areas ) ||
+			!AAS_ReadBinaryList( fp, nodes ) ||
+			!AAS_ReadBinaryList( fp, portals ) ||
+			!AAS_ReadBinaryList( fp, portalIndex ) ||
+			!AAS_ReadBinaryList( fp, clusters ) ) {
+		areas.Clear();
+		return false;
+	}
+
+	// the reachability pointers in the areas are not valid
+	for ( i = 0; i < areas.Num(); i++ ) {
+		areas[i].reach = NULL;
+		areas[i].rev_reach = NULL;
+	}
+	for ( i = 0; i < areas.Num(); i++ ) {
+		if ( !ReadBinaryReachabilities( fp, i ) ) {
+			return false;
+		}
+	}
+
+	LinkReversedReachability();
+
+	return true;
+}
+
+/*
+================
+idAASFileLocal::LoadBinary
+================
+*/
+bool idAASFileLocal::LoadBinary( const idStr &fileName, unsigned int mapFileCRC ) {
+	idStr binaryName;
+	void *buffer;
+	int length, id, version, byteOrder, sourceLength, cachedLength, dataLength;
+	int sizes[10];
+	unsigned int mapCRC, cachedTimeStamp, dataCRC;
+	ID_TIME_T sourceTimeStamp;
+
+	if ( !aas_binaryFiles.GetBool() ) {
+		return false;
+	}
+
+	binaryName = AAS_BinaryFileName( fileName );
+	length = fileSystem->ReadFile( binaryName, &buffer, NULL );
+	if ( length <= 0 ) {
+		return false;
+	}
+
+	idFile_Memory fp( binaryName, (const char *) buffer, length );
+
+	fp.ReadInt( id );
+	fp.ReadInt( version );
+	fp.Read( &byteOrder, sizeof( byteOrder ) );
+	for ( int i = 0; i < 10; i++ ) {
+		fp.ReadInt( sizes[i] );
+	}
+	fp.ReadUnsignedInt( mapCRC );
+	fp.ReadUnsignedInt( cachedTimeStamp );
+	fp.ReadInt( cachedLength );
+	fp.ReadUnsignedInt( dataCRC );
+	fp.ReadInt( dataLength );
+
+	const int expectedSizes[10] = { sizeof( idPlane ), sizeof( aasVertex_t ), sizeof( aasEdge_t ), sizeof( aasIndex_t ),
+		sizeof( aasFace_t ), sizeof( aasArea_t ), sizeof( aasNode_t ), sizeof( aasPortal_t ), sizeof( aasCluster_t ), sizeof( idReachability ) };
+
+	bool valid = ( id == AAS_BINARY_FILEID && version == AAS_BINARY_FILEVERSION && byteOrder == 1 &&
+					memcmp( sizes, expectedSizes, sizeof( sizes ) ) == 0 &&
+					( !mapFileCRC || mapCRC == mapFileCRC ) &&
+					dataLength == fp.Length() - fp.Tell() );
+
+	// when the text file is there the binary file has to be written from it
+	sourceLength = fileSystem->ReadFile( fileName, NULL, &sourceTimeStamp );
+	if ( valid && sourceLength > 0 ) {
+		valid = ( cachedLength == sourceLength && cachedTimeStamp == (unsigned int)sourceTimeStamp );
+	}
+
+	if ( valid ) {
+		const char *data = ( (const char *) buffer ) + fp.Tell();
+		valid = ( CRC32_BlockChecksum( data, dataLength ) == dataCRC );
+		if ( !valid ) {
+			common->Warning( "AAS file '%s' is corrupt", binaryName.c_str() );
+		}
+	}
+
+	if ( valid ) {
+		Clear();
+		valid = ReadBinaryData( &fp );
+		if ( !valid ) {
+			common->Warning( "AAS file '%s' is corrupt", binaryName.c_str() );
+			DeleteReachabilities();
+			Clear();
+			settings = idAASSettings();
+		}
+	}
+
+	fileSystem->FreeFile( buffer );
+
+	return valid;
+}
+
+/*
+================
+idAASFileLocal::WriteBinary
+
+Writes the binary version of the AAS file in memory next to the text file
+================
+*/
+bool idAASFileLocal::WriteBinary( const idStr &fileName ) const {
+	idStr binaryName;
+	idFile *fp;
+	idFile_Memory data( "aasData" );
+	ID_TIME_T sourceTimeStamp;
+	int sourceLength;
+	const int byteOrder = 1;
+
+	binaryName = AAS_BinaryFileName( fileName );
+	sourceLength = fileSystem->ReadFile( fileName, NULL, &sourceTimeStamp );
+
+	WriteBinaryData( &data );
+
+	fp = fileSystem->OpenFileWrite( binaryName, "fs_devpath" );
+	if ( !fp ) {
+		common->Warning( "Error opening %s", binaryName.c_str() );
+		return false;
+	}
+
+	fp->WriteInt( AAS_BINARY_FILEID );
+	fp->WriteInt( AAS_BINARY_FILEVERSION );
+	fp->Write( &byteOrder, sizeof( byteOrder ) );
+	fp->WriteInt( sizeof( idPlane ) );
+	fp->WriteInt( sizeof( aasVertex_t ) );
+	fp->WriteInt( sizeof( aasEdge_t ) );
+	fp->WriteInt( sizeof( aasIndex_t ) );
+	fp->WriteInt( sizeof( aasFace_t ) );
+	fp->WriteInt( sizeof( aasArea_t ) );
+	fp->WriteInt( sizeof( aasNode_t ) );
+	fp->WriteInt( sizeof( aasPortal_t ) );
+	fp->WriteInt( sizeof( aasCluster_t ) );
+	fp->WriteInt( sizeof( idReachability ) );
+	fp->WriteUnsignedInt( crc );
+	fp->WriteUnsignedInt( (unsigned int)sourceTimeStamp );
+	fp->WriteInt( sourceLength );
+	fp->WriteUnsignedInt( CRC32_BlockChecksum( data.GetDataPtr(), data.Length() ) );
+	fp->WriteInt( data.Length() );
+	fp->Write( data.GetDataPtr(), data.Length() );
+
+	fileSystem->CloseFile( fp );
+
+	common->Printf( "wrote %s\n", binaryName.c_str() );
 
 	return true;
 }
@@ -40,6 +40,10 @@ If you have questions concerning this license or the applicable additional terms
 #define AAS_FILEID					"DewmAAS"
 #define AAS_FILEVERSION				"1.07"
 
+// binary AAS file written next to the text file, with a 'b' appended to the extension
+#define AAS_BINARY_FILEID			( ( 'B' << 24 ) | ( 'A' << 16 ) | ( 'A' << 8 ) | 'S' )
+#define AAS_BINARY_FILEVERSION		1
+
 // travel flags
 #define TFL_INVALID					BIT(0)		// not valid
 #define TFL_WALK					BIT(1)		// walking
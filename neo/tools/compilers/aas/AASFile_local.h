@@ -63,7 +63,10 @@ public:
 
 public:
 	bool						Load( const idStr &fileName, unsigned int mapFileCRC );
+	bool						LoadText( const idStr &fileName, unsigned int mapFileCRC );
 	bool						Write( const idStr &fileName, unsigned int mapFileCRC );
+	bool						LoadBinary( const idStr &fileName, unsigned int mapFileCRC );
+	bool						WriteBinary( const idStr &fileName ) const;
 
 	int							MemorySize( void ) const;
 	void						ReportRoutingEfficiency( void ) const;
@@ -86,6 +89,9 @@ private:
 	bool						ParseNodes( idLexer &src );
 	bool						ParsePortals( idLexer &src );
 	bool						ParseClusters( idLexer &src );
+	bool						ReadBinaryReachabilities( idFile *fp, int areaNum );
+	void						WriteBinaryData( idFile *fp ) const;
+	bool						ReadBinaryData( idFile *fp );
 
 private:
 	int							BoundsReachableAreaNum_r( int nodeNum, const idBounds &bounds, const int areaFlags, const int excludeTravelFlags ) const;